@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+
+// Keeps the optimiser from discarding a benchmarked result
+template <typename T>
+inline void do_not_optimise (const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+class Runner
+{
+    public:
+        explicit Runner (std::string filter)
+            : filter_(std::move(filter))
+        {}
+
+        // Repeats `fn` for at least `min_time` and prints the mean time per
+        // call, plus throughput when `bytes` (processed per call) is non-zero.
+        void measure (
+            const std::string& label,
+            std::size_t bytes,
+            const std::function<void()>& fn,
+            std::chrono::milliseconds min_time = std::chrono::milliseconds(300)
+        )
+        {
+            if (!filter_.empty() && label.find(filter_) == std::string::npos)
+            {
+                return;
+            }
+
+            using clock = std::chrono::steady_clock;
+
+            fn(); // warm-up
+
+            std::size_t iterations = 0;
+            const auto start = clock::now();
+            auto elapsed = clock::duration::zero();
+            do
+            {
+                fn();
+                ++iterations;
+                elapsed = clock::now() - start;
+            } while (elapsed < min_time);
+
+            const double ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+            if (bytes > 0)
+            {
+                const double mib_s = (bytes / (1024.0 * 1024.0)) / (ns / 1e9);
+                std::printf("%-48s %12.0f ns/op %10.1f MiB/s\n", label.c_str(), ns, mib_s);
+            }
+            else
+            {
+                std::printf("%-48s %12.0f ns/op\n", label.c_str(), ns);
+            }
+        }
+
+    private:
+        std::string filter_;
+};
+
+using BenchFn = void (*)(Runner&);
+
+inline std::vector<std::pair<const char*, BenchFn>>& registry ()
+{
+    static std::vector<std::pair<const char*, BenchFn>> benches;
+    return benches;
+}
+
+struct Registration
+{
+    Registration (const char* name, BenchFn fn)
+    {
+        registry().emplace_back(name, fn);
+    }
+};
+
+} // namespace bench
+
+#define BENCHMARK(name) \
+    static void name(bench::Runner&); \
+    static bench::Registration name##_registration(#name, &name); \
+    static void name(bench::Runner& runner)
@@ -0,0 +1,24 @@
+#include "Bench.h"
+#include "crypto/CryptoContext.h"
+
+#include <cstdio>
+#include <string>
+
+// Usage: vault_bench [filter]
+// Runs every registered benchmark whose labels contain `filter`.
+int main (int argc, char** argv)
+{
+    if (!crypto::CryptoContext::init())
+    {
+        std::fprintf(stderr, "libsodium failed to initialise\n");
+        return 1;
+    }
+
+    bench::Runner runner(argc > 1 ? argv[1] : "");
+    for (const auto& [name, fn] : bench::registry())
+    {
+        std::printf("--- %s ---\n", name);
+        fn(runner);
+    }
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include "Bench.h"
+#include "app/Action.h"
+#include "app/Application.h"
+#include "crypto/CryptoContext.h"
+#include "ui/ScriptedUI.h"
+#include "util/SecureString.h"
+#include "vault/Entry.h"
+#include "vault/VaultFile.h"
+#include "vault/VaultFileError.h"
+#include "vault/VaultSession.h"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+// A full interactive session driven through ScriptedUI, so handler and state
+// machine costs are measured without ncurses. Unlocking runs the KDF, which
+// dominates; the add/list/save share shows up against the entry count.
+BENCHMARK(app_workflow)
+{
+    crypto::CryptoContext::init();
+
+    const auto path = std::filesystem::temp_directory_path() / "vault_bench_workflow.vault";
+    const util::SecureString password("bench-password");
+
+    for (std::size_t count : { std::size_t{10}, std::size_t{10000} })
+    {
+        std::filesystem::remove(path);
+        vault::VaultFile::create_new(path, password);
+        {
+            auto session = vault::VaultFile::load(path, password);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const std::string name = "entry-" + std::to_string(i);
+                session.value().add_entry(vault::Entry{
+                    util::SecureString{name.c_str()},
+                    util::SecureString{"user@example.com"},
+                    util::SecureString{"correct horse battery staple"}
+                });
+            }
+            session.value().save();
+        }
+
+        std::size_t added = 0;
+        runner.measure("unlock/add/list/save " + std::to_string(count) + " entries", 0, [&]
+        {
+            const std::string name = "added-" + std::to_string(added++);
+
+            auto script = std::make_unique<ui::ScriptedUI>();
+            script->then_action(app::Action::Unlock).then_password(password.c_str())
+                .then_action(app::Action::AddEntry)
+                    .then_input(name).then_input("user").then_generate(true)
+                .then_action(app::Action::ListEntries)
+                .then_action(app::Action::SaveAndClose)
+                .then_action(app::Action::Quit);
+
+            app::Application app(path.string(), std::move(script));
+            app.run(app);
+        });
+    }
+
+    std::filesystem::remove(path);
+}
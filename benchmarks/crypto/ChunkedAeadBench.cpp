@@ -0,0 +1,49 @@
+#include "Bench.h"
+#include "crypto/ChunkedAead.h"
+#include "crypto/CipherSuite.h"
+#include "crypto/CryptoContext.h"
+#include "crypto/CryptoTypes.h"
+#include "crypto/SecureBuffer.h"
+#include "crypto/VaultCrypto.h"
+
+#include <cstddef>
+#include <string>
+
+// Single-message sealing against chunked sealing spread across all cores,
+// for payloads large enough that chunking kicks in on save.
+BENCHMARK(chunked_aead)
+{
+    const auto suite = crypto::select_cipher_suite();
+    const std::size_t sizes[] = { 4 * 1024 * 1024, 64 * 1024 * 1024 };
+
+    crypto::ByteBuffer key(crypto::key_size(suite));
+    crypto::ByteBuffer nonce(crypto::nonce_size(suite));
+    crypto::CryptoContext::random_bytes(key);
+    crypto::CryptoContext::random_bytes(nonce);
+
+    for (std::size_t size : sizes)
+    {
+        crypto::ByteBuffer plaintext(size, 0x5A);
+        crypto::SecureBuffer out(
+            crypto::ChunkedAead::ciphertext_size(suite, size, crypto::DEFAULT_CHUNK_SIZE)
+        );
+        crypto::SecureBuffer opened(size);
+
+        const std::string label = crypto::to_string(suite) + " " + std::to_string(size / (1024 * 1024)) + " MiB";
+        runner.measure(label + " single seal", size, [&]
+        {
+            auto sealed = crypto::VaultCrypto::encrypt_into(suite, key, nonce, plaintext, out);
+            bench::do_not_optimise(sealed.value());
+        });
+        runner.measure(label + " chunked seal", size, [&]
+        {
+            auto sealed = crypto::ChunkedAead::seal(suite, key, nonce, plaintext, out);
+            bench::do_not_optimise(out.data());
+        });
+        runner.measure(label + " chunked open", size, [&]
+        {
+            auto result = crypto::ChunkedAead::open(suite, key, nonce, out, opened);
+            bench::do_not_optimise(result.value());
+        });
+    }
+}
@@ -0,0 +1,35 @@
+#include "Bench.h"
+#include "ui/IncrementalFilter.h"
+#include "vault/EntryTable.h"
+
+#include <string>
+
+// Per-keystroke cost of type-to-filter on a large vault. The first
+// character scans every name; later ones only the survivors.
+BENCHMARK(incremental_filter)
+{
+    vault::EntryTable entries;
+    entries.reserve(100000);
+    for (std::size_t i = 0; i < 100000; ++i)
+    {
+        const std::string name = "host-" + std::to_string(i) + ".example.com";
+        entries.push_back(name, "user@example.com", "secret");
+    }
+
+    ui::IncrementalFilter filter(entries);
+
+    runner.measure("filter 100k first keystroke", 0, [&]
+    {
+        filter.push('7');
+        bench::do_not_optimise(filter.matches().size());
+        filter.pop();
+    });
+
+    filter.push('7');
+    runner.measure("filter 100k narrowing keystroke", 0, [&]
+    {
+        filter.push('7');
+        bench::do_not_optimise(filter.matches().size());
+        filter.pop();
+    });
+}
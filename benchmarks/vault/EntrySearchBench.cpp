@@ -0,0 +1,42 @@
+#include "Bench.h"
+#include "vault/EntrySearch.h"
+#include "vault/EntryTable.h"
+
+#include <string>
+
+// Full-vault substring search per kernel against the naive per-entry scan,
+// on hostname/email-shaped entries.
+BENCHMARK(entry_search)
+{
+    vault::EntryTable entries;
+    entries.reserve(100000);
+    for (std::size_t i = 0; i < 100000; ++i)
+    {
+        const std::string name = "host-" + std::to_string(i) + ".internal.example.com";
+        const std::string username = "user" + std::to_string(i % 977) + "@Example.org";
+        entries.push_back(name, username, "secret");
+    }
+
+    const char* needles[] = { "host-4242.", "example.ORG", "user976@" };
+
+    for (const char* needle : needles)
+    {
+        runner.measure(std::string("naive 100k \"") + needle + "\"", 0, [&]
+        {
+            bench::do_not_optimise(vault::EntrySearch::find_naive(entries, needle).size());
+        });
+
+        for (auto kernel : { vault::SearchKernel::Scalar, vault::SearchKernel::Sse2, vault::SearchKernel::Avx2 })
+        {
+            if (!vault::is_available(kernel))
+            {
+                continue;
+            }
+            const vault::EntrySearch search(entries, kernel);
+            runner.measure(vault::to_string(kernel) + " 100k \"" + needle + "\"", 0, [&]
+            {
+                bench::do_not_optimise(search.find(needle).size());
+            });
+        }
+    }
+}
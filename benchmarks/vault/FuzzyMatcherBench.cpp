@@ -0,0 +1,26 @@
+#include "Bench.h"
+#include "vault/EntryTable.h"
+#include "vault/FuzzyMatcher.h"
+
+#include <string>
+
+// Ranked fuzzy lookup over a large vault: the bounded heap keeps the cost
+// at scoring plus O(N log K), with no full sort.
+BENCHMARK(fuzzy_matcher)
+{
+    vault::StringColumn names;
+    names.reserve(100000, 100000 * 36);
+    for (std::size_t i = 0; i < 100000; ++i)
+    {
+        names.push_back("service-" + std::to_string(i) + "-enterprise.example.com");
+    }
+
+    for (const char* pattern : { "s42 ent", "xmpl", "zzz" })
+    {
+        const vault::FuzzyMatcher matcher(pattern);
+        runner.measure(std::string("fuzzy 100k top-50 \"") + pattern + "\"", 0, [&]
+        {
+            bench::do_not_optimise(matcher.top(names, 50).size());
+        });
+    }
+}
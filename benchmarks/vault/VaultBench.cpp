@@ -0,0 +1,221 @@
+#include "Bench.h"
+#include "crypto/CryptoContext.h"
+#include "crypto/CryptoTypes.h"
+#include "util/SecureString.h"
+#include "vault/BackupStore.h"
+#include "vault/Entry.h"
+#include "vault/EntryTable.h"
+#include "vault/Vault.h"
+#include "vault/VaultFile.h"
+#include "vault/VaultSession.h"
+#include "vault/VaultShards.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <ranges>
+#include <sodium.h>
+#include <string>
+
+// Churn at the front of a large vault: each removal backfills from the end
+// instead of shifting every later entry down, so the cost does not grow
+// with the entry count.
+BENCHMARK(vault_remove)
+{
+    vault::Vault vault;
+    for (std::size_t i = 0; i < 100000; ++i)
+    {
+        const std::string name = "service-" + std::to_string(i);
+        vault.add_entry(vault::Entry(
+            util::SecureString{name.c_str()},
+            util::SecureString{"user@example.com"},
+            util::SecureString{"secret"}
+        ));
+    }
+
+    std::size_t next = 100000;
+    runner.measure("vault 100k remove first + add", 0, [&]
+    {
+        vault.remove_entry(vault.id_at(0));
+        const std::string name = "service-" + std::to_string(next++);
+        bench::do_not_optimise(vault.add_entry(vault::Entry(
+            util::SecureString{name.c_str()},
+            util::SecureString{"user@example.com"},
+            util::SecureString{"secret"}
+        )).has_value());
+    });
+}
+
+// Sorted listings on a large table: once an order has been built, showing
+// a screenful costs the same as in vault order, and each edit patches the
+// built orders instead of re-sorting them.
+BENCHMARK(sorted_views)
+{
+    vault::EntryTable table;
+    table.reserve(100000);
+    for (std::size_t i = 0; i < 100000; ++i)
+    {
+        // Scattered so the orders differ from insertion order
+        const std::size_t key = (i * 7919) % 100000;
+        table.push_back(
+            "service-" + std::to_string(key),
+            "user" + std::to_string(key % 977) + "@example.com",
+            "secret",
+            {},
+            static_cast<int64_t>(key)
+        );
+    }
+
+    for (auto order : { vault::EntryOrder::Name, vault::EntryOrder::Username, vault::EntryOrder::Modified })
+    {
+        table.sorted_rows(order);
+    }
+
+    runner.measure("sorted 100k first 50 by name (cached)", 0, [&]
+    {
+        std::size_t bytes = 0;
+        for (const vault::EntryView entry : table.sorted(vault::EntryOrder::Name) | std::views::take(50))
+        {
+            bytes += entry.name.size();
+        }
+        bench::do_not_optimise(bytes);
+    });
+
+    std::size_t next = 0;
+    runner.measure("sorted 100k rename with 3 orders built", 0, [&]
+    {
+        const std::string name = "renamed-" + std::to_string(next++);
+        table.set(next % table.size(), vault::EntryField::Name, name);
+        bench::do_not_optimise(table.size());
+    });
+}
+
+// Whole-vault encode and decode. Both size their buffers in a pass over
+// the field lengths first, so neither regrows an allocation midway.
+BENCHMARK(vault_serialise)
+{
+    vault::Vault vault;
+    for (std::size_t i = 0; i < 100000; ++i)
+    {
+        const std::string name = "service-" + std::to_string(i) + ".example.com";
+        vault.add_entry(vault::Entry(
+            util::SecureString{name.c_str()},
+            util::SecureString{"user@example.com"},
+            util::SecureString{"correct-horse-battery-staple"}
+        ));
+    }
+
+    const crypto::SecureBuffer payload = vault.serialise();
+    runner.measure("vault 100k serialise", payload.size(), [&]
+    {
+        bench::do_not_optimise(vault.serialise().size());
+    });
+
+    crypto::SecureBuffer reused;
+    runner.measure("vault 100k serialise reused buffer", payload.size(), [&]
+    {
+        vault.serialise(reused);
+        bench::do_not_optimise(reused.size());
+    });
+
+    runner.measure("vault 100k serialise streamed", payload.size(), [&]
+    {
+        size_t streamed = 0;
+        vault.serialise_to([&streamed](std::span<const uint8_t> piece)
+        {
+            streamed += piece.size();
+        });
+        bench::do_not_optimise(streamed);
+    });
+
+    runner.measure("vault 100k deserialise", payload.size(), [&]
+    {
+        bench::do_not_optimise(vault::Vault::deserialise(payload).has_value());
+    });
+}
+
+// Saving after a single edit. The single-file layout re-encrypts and
+// rewrites the whole vault every time; the sharded layout rewrites one
+// shard and the manifest, so its cost follows the change.
+BENCHMARK(vault_sharded_save)
+{
+    crypto::CryptoContext::init();
+
+    const auto path = std::filesystem::temp_directory_path() / "vault_bench_sharded.vault";
+    const util::SecureString password("bench-password");
+
+    for (const std::uint32_t shards : { std::uint32_t{0}, std::uint32_t{64} })
+    {
+        std::filesystem::remove(path);
+        std::filesystem::remove_all(vault::VaultShards::directory(path));
+        if (shards == 0)
+        {
+            vault::VaultFile::create_new(path, password);
+        }
+        else
+        {
+            vault::VaultFile::create_sharded(path, password, shards);
+        }
+
+        auto session = vault::VaultFile::load(path, password);
+        for (std::size_t i = 0; i < 100000; ++i)
+        {
+            const std::string name = "service-" + std::to_string(i) + ".example.com";
+            session.value().add_entry(vault::Entry(
+                util::SecureString{name.c_str()},
+                util::SecureString{"user@example.com"},
+                util::SecureString{"correct-horse-battery-staple"}
+            ));
+        }
+        session.value().save();
+
+        const vault::EntryId edited = session.value().id_at(500);
+        std::size_t round = 0;
+        const std::string label = shards == 0
+            ? "vault 100k save one edit, single file"
+            : "vault 100k save one edit, 64 shards";
+        runner.measure(label, 0, [&]
+        {
+            const std::string secret = "rotated-" + std::to_string(round++);
+            session.value().set_field(edited, vault::EntryField::Secret, util::SecureString{secret.c_str()});
+            bench::do_not_optimise(session.value().save().has_value());
+        });
+    }
+    std::filesystem::remove(path);
+    std::filesystem::remove_all(vault::VaultShards::directory(path));
+}
+
+// An hourly snapshot after one edit: chunks shared with the previous
+// snapshot are hashed but not rewritten, so each run costs chunking the
+// payload plus sealing the one or two chunks around the edit.
+BENCHMARK(vault_backup_snapshot)
+{
+    crypto::CryptoContext::init();
+
+    const auto root = std::filesystem::temp_directory_path() / "vault_bench.vault.backups";
+    std::filesystem::remove_all(root);
+    vault::BackupStore store(root, crypto::ByteBuffer(crypto_kdf_KEYBYTES, 0x42));
+
+    vault::Vault vault;
+    for (std::size_t i = 0; i < 100000; ++i)
+    {
+        const std::string name = "service-" + std::to_string(i) + ".example.com";
+        vault.add_entry(vault::Entry(
+            util::SecureString{name.c_str()},
+            util::SecureString{"user@example.com"},
+            util::SecureString{"correct-horse-battery-staple"}
+        ));
+    }
+    const vault::EntryId edited = vault.id_at(500);
+    std::int64_t taken = 0;
+    store.snapshot(vault.serialise(), taken);
+
+    const std::size_t payload = vault.serialise().size();
+    runner.measure("vault 100k hourly snapshot one edit", payload, [&]
+    {
+        const std::string secret = "rotated-" + std::to_string(taken);
+        vault.set_field(edited, vault::EntryField::Secret, util::SecureString{secret.c_str()});
+        taken += 60 * 60;
+        bench::do_not_optimise(store.snapshot(vault.serialise(), taken).has_value());
+    });
+    std::filesystem::remove_all(root);
+}
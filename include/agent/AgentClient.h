@@ -0,0 +1,49 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include "agent/AgentError.h"
+#include "agent/AgentProtocol.h"
+#include "crypto/SecureBuffer.h"
+#include "util/Expected.h"
+#include "util/SecureString.h"
+#include "vault/Entry.h"
+
+namespace agent
+{
+
+// One connection to a running AgentServer. Requests are answered in order
+// and the connection can be reused for any number of them.
+class AgentClient
+{
+    public:
+        // Fails with NotRunning if nothing is listening, and refuses an
+        // agent owned by another user
+        static util::Expected<AgentClient, AgentError> connect (
+            const std::filesystem::path& socket_path = default_socket_path()
+        );
+
+        AgentClient (AgentClient&& other) noexcept;
+        AgentClient& operator= (AgentClient&&) = delete;
+        AgentClient (const AgentClient&) = delete;
+        AgentClient& operator= (const AgentClient&) = delete;
+        ~AgentClient ();
+
+        util::Expected<vault::Entry, AgentError> get (const util::SecureString& name);
+        util::Expected<std::vector<util::SecureString>, AgentError> list ();
+        util::Expected<void, AgentError> add (const vault::Entry& entry);
+
+        // Asks the agent to wipe its session and exit
+        util::Expected<void, AgentError> lock ();
+
+    private:
+        explicit AgentClient (int fd) noexcept : fd_(fd) {}
+
+        util::Expected<Message, AgentError> request (const Message& message);
+
+        int fd_ = -1;
+        crypto::SecureBuffer buffer_;
+};
+
+} // namespace agent
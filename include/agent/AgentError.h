@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+namespace agent
+{
+enum class AgentError
+{
+    SocketError,
+    AlreadyRunning,
+    NotRunning,
+    PermissionDenied,
+    ConnectionClosed,
+    TimedOut,
+    ProtocolError,
+    Locked,
+    EntryNotFound,
+    DuplicateEntry,
+    SaveFailed
+};
+
+inline std::string to_string (AgentError error)
+{
+    switch (error)
+    {
+        case AgentError::SocketError:
+            return "Agent socket error";
+        case AgentError::AlreadyRunning:
+            return "An agent is already listening on this socket";
+        case AgentError::NotRunning:
+            return "No agent is running";
+        case AgentError::PermissionDenied:
+            return "Agent socket permissions are unsafe";
+        case AgentError::ConnectionClosed:
+            return "Agent closed the connection";
+        case AgentError::TimedOut:
+            return "Agent connection timed out";
+        case AgentError::ProtocolError:
+            return "Malformed agent message";
+        case AgentError::Locked:
+            return "Agent is locked";
+        case AgentError::EntryNotFound:
+            return "Entry not found";
+        case AgentError::DuplicateEntry:
+            return "Duplicate Entry";
+        case AgentError::SaveFailed:
+            return "Agent failed to save the vault";
+        default:
+            throw std::invalid_argument("Unknown AgentError value");
+    }
+}
+}
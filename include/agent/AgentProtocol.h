@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <sys/un.h>
+#include <vector>
+
+#include "agent/AgentError.h"
+#include "crypto/SecureBuffer.h"
+#include "util/Expected.h"
+#include "util/SecureString.h"
+
+namespace agent
+{
+
+// --- Wire format ---
+// Every message is a frame: u32 body length, then the body. A body is a u8
+// code (Command for requests, Status for responses), a u32 field count and
+// that many fields, each a u32 length followed by its bytes. All integers
+// are little-endian.
+constexpr std::size_t MAX_FRAME_SIZE = std::size_t{1} << 20;
+
+// Body bytes before the first field, and before each field's bytes
+constexpr std::size_t MESSAGE_HEADER_SIZE = sizeof(uint8_t) + sizeof(uint32_t);
+constexpr std::size_t FIELD_HEADER_SIZE = sizeof(uint32_t);
+
+enum class Command : uint8_t
+{
+    Get = 1,  // name -> name, username, secret
+    List = 2, // [u32 first index] -> entry names from there, a frame's worth
+    Add = 3,  // name, username, secret ->
+    Lock = 4  // wipe the session and stop serving
+};
+
+enum class Status : uint8_t
+{
+    Ok = 0,
+    NotFound = 1,
+    Duplicate = 2,
+    BadRequest = 3,
+    SaveFailed = 4,
+    More = 5  // Ok, but a List page stopped short of the last name
+};
+
+struct Message
+{
+    uint8_t code = 0;
+    std::vector<util::SecureString> fields;
+};
+
+// Writes the whole frame, length prefix included, into `out`
+void encode_message (const Message& message, crypto::SecureBuffer& out);
+
+// Parses a frame body (without its length prefix)
+util::Expected<Message, AgentError> decode_message (std::span<const uint8_t> body);
+
+using FrameDeadline = std::chrono::steady_clock::time_point;
+constexpr FrameDeadline NO_DEADLINE = FrameDeadline::max();
+
+// Frame I/O on a connected socket, blocking or not. The whole frame must
+// move before `deadline` or the call fails with TimedOut, so a peer that
+// trickles bytes or stops reading cannot hold the caller. read_frame
+// leaves the body in `body`, which is locked memory since requests may
+// carry secrets.
+util::Expected<void, AgentError> write_frame (
+    int fd,
+    std::span<const uint8_t> frame,
+    FrameDeadline deadline = NO_DEADLINE
+);
+util::Expected<void, AgentError> read_frame (
+    int fd,
+    crypto::SecureBuffer& body,
+    FrameDeadline deadline = NO_DEADLINE
+);
+
+// $VAULT_AGENT_SOCK if set, else $XDG_RUNTIME_DIR/vault-agent.sock, else
+// agent.sock in a per-user /tmp/vault-agent-<uid> directory, which
+// AgentServer::listen creates mode 0700
+std::filesystem::path default_socket_path ();
+
+// Fails if `path` does not fit in sun_path
+util::Expected<sockaddr_un, AgentError> socket_address (const std::filesystem::path& path);
+
+} // namespace agent
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+#include "agent/AgentError.h"
+#include "agent/AgentProtocol.h"
+#include "crypto/SecureBuffer.h"
+#include "util/Expected.h"
+#include "vault/VaultSession.h"
+
+namespace agent
+{
+
+constexpr std::chrono::seconds DEFAULT_IDLE_TIMEOUT{15 * 60};
+
+// Holds one unlocked VaultSession and answers Get/List/Add requests from
+// processes of the same user, so only the first unlock pays for Argon2.
+//
+// The socket is created mode 0600 in a directory others cannot write to
+// (created 0700 if missing), and every connection's SO_PEERCRED uid must
+// match ours. Each request and response frame has a deadline well under
+// `idle_timeout`, so a stalled client cannot keep the vault unlocked. After
+// `idle_timeout` without a request, or on a Lock request, any access
+// stats Get recorded are saved, the session is wiped and run() returns.
+class AgentServer
+{
+    public:
+        static util::Expected<AgentServer, AgentError> listen (
+            std::filesystem::path socket_path,
+            vault::VaultSession session,
+            std::chrono::milliseconds idle_timeout = DEFAULT_IDLE_TIMEOUT
+        );
+
+        // Keeps the agent's memory out of core dumps and away from ptrace,
+        // and locks it into RAM when RLIMIT_MEMLOCK allows. Best effort;
+        // call once, before unlocking.
+        static void harden_process () noexcept;
+
+        AgentServer (AgentServer&& other) noexcept;
+        AgentServer& operator= (AgentServer&&) = delete;
+        AgentServer (const AgentServer&) = delete;
+        AgentServer& operator= (const AgentServer&) = delete;
+
+        // Closes every connection and removes the socket file
+        ~AgentServer ();
+
+        util::Expected<void, AgentError> run ();
+
+        bool is_locked () const noexcept { return !session_.has_value(); }
+
+    private:
+        AgentServer (
+            int listen_fd,
+            std::filesystem::path socket_path,
+            vault::VaultSession session,
+            std::chrono::milliseconds idle_timeout
+        );
+
+        void accept_client ();
+
+        // false once the connection should be closed
+        bool serve_client (int fd);
+
+        Message handle (Message request);
+        // Saves access stats recorded since the last save, then wipes the
+        // session
+        void lock ();
+
+        int listen_fd_ = -1;
+        std::filesystem::path socket_path_;
+        std::optional<vault::VaultSession> session_;
+        std::chrono::milliseconds idle_timeout_;
+        // A Get recorded an access that no save has written yet
+        bool access_unsaved_ = false;
+        std::vector<int> clients_;
+
+        // Request and response frames, reused and wiped between requests
+        crypto::SecureBuffer request_buffer_;
+        crypto::SecureBuffer response_buffer_;
+};
+
+} // namespace agent
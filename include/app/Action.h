@@ -10,6 +10,7 @@ enum class Action
 	Unlock,
 	AddEntry,
 	RemoveEntry,
+	EditEntry,
 	ListEntries,
     Save,
 	SaveAndClose,
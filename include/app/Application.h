@@ -4,7 +4,7 @@
 #include <optional>
 #include <string>
 
-#include "ui/TerminalUI.h"
+#include "ui/UserInterface.h"
 #include "vault/VaultSession.h"
 
 namespace app { enum class Action; }
@@ -16,7 +16,11 @@ namespace app
 class Application
 {
 public:
-    explicit Application(std::string vault_path);
+    // `ui` defaults to the ncurses TerminalUI
+    explicit Application(
+        std::string vault_path,
+        std::unique_ptr<ui::UserInterface> ui = nullptr
+    );
 
     void run(Application& app);
 
@@ -31,6 +35,7 @@ private:
     bool handle_unlock();
     bool handle_add_entry();
     bool handle_remove_entry();
+    bool handle_edit_entry();
     bool handle_list_entries();
     bool handle_save_only();
     bool handle_save_and_close();
@@ -40,7 +45,7 @@ private:
     std::string vault_path_;
     std::unique_ptr<State> current_state_;
     std::optional<vault::VaultSession> session_;
-    ui::TerminalUI ui_;
+    std::unique_ptr<ui::UserInterface> ui_;
     bool running_ { true };
 };
 
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+#include "util/Expected.h"
+
+namespace vault { class VaultSession; }
+namespace vault { enum class VaultFileError; }
+
+namespace app
+{
+
+// Headless front end over an unlocked session: one JSON object per input
+// line, one JSON result per output line, in order.
+//
+//   {"op":"get","name":N}      -> {"ok":true,"name":N,"username":U,"secret":S}
+//                                 plus "tags":[T, ...] when it has any
+//   {"op":"list"}              -> {"ok":true,"names":[N, ...]}
+//   {"op":"add","name":N,"username":U,"secret":S}  and optional "tags":"T,..."
+//   {"op":"remove","name":N}
+//   {"op":"update","name":N}   plus any of "new_name", "username", "secret"
+//   {"op":"tag","name":N,"tag":T}, {"op":"untag","name":N,"tag":T}
+//   {"op":"tagged","tags":"T,..."} -> {"ok":true,"names":[N, ...]}, entries
+//                                 carrying every one of the tags
+//   {"op":"save"}              checkpoint now instead of only at the end
+//
+// Any "id" member is echoed back. A failed command answers
+// {"ok":false,"error":"..."} and the batch carries on. Changes are written
+// once, by finish(), rather than per command.
+class BatchMode
+{
+    public:
+        explicit BatchMode (vault::VaultSession& session) : session_(session) {}
+
+        // Appends the result line for `line`, without a newline, to `out`.
+        // `out` may hold secrets afterwards; the caller wipes it.
+        void execute (std::string_view line, std::string& out);
+
+        // Saves if anything changed since the last save
+        util::Expected<void, vault::VaultFileError> finish ();
+
+        // Executes every line of `in`, then finish()
+        util::Expected<void, vault::VaultFileError> run (
+            std::istream& in,
+            std::ostream& out
+        );
+
+        bool dirty () const noexcept
+        {
+            return dirty_;
+        }
+
+    private:
+        vault::VaultSession& session_;
+        bool dirty_ = false;
+};
+
+} // namespace app
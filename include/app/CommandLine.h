@@ -0,0 +1,34 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+namespace app
+{
+
+// Non-interactive subcommands, for scripts and the unlock agent:
+//
+//   vault agent [--idle SECONDS]   unlock once and serve requests
+//   vault batch [--password-fd FD] unlock once, run JSON-lines commands from
+//                                  stdin (see BatchMode), save at the end
+//   vault backup [--password-fd FD]
+//                                  unlock once, snapshot the vault into its
+//                                  backup store and prune old snapshots
+//   vault get NAME                 print NAME's secret
+//   vault list                     print every entry name
+//   vault add NAME USERNAME        add an entry; the secret is read from stdin
+//   vault lock                     wipe the agent's session and stop it
+//
+// With VAULT_KEY_CACHE_TTL=SECONDS set, `agent` reuses a key cached in the
+// kernel keyring by an earlier unlock instead of prompting; so do `batch` and
+// `backup`.
+//
+// Returns the process exit code, or nullopt if argv names no subcommand and
+// the interactive UI should start instead.
+std::optional<int> run_command_line (
+    int argc,
+    char** argv,
+    const std::string& vault_path
+);
+
+} // namespace app
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "crypto/CipherSuite.h"
+#include "crypto/CryptoError.h"
+#include "util/Expected.h"
+
+namespace crypto
+{
+
+// Plaintext bytes per chunk unless the caller says otherwise
+constexpr std::size_t DEFAULT_CHUNK_SIZE = std::size_t{1} << 20;
+
+// Splits a payload into fixed-size chunks, each sealed as its own AEAD
+// message so they can be processed in parallel on util::ThreadPool::shared().
+// The ciphertext is the concatenation of chunk_ciphertext || tag for each
+// chunk; every chunk but the last carries exactly `chunk_size` plaintext
+// bytes.
+//
+// Chunk i is sealed under the base nonce with (i << 1 | final) XORed into its
+// last eight bytes (little-endian), so chunks cannot be reordered, dropped
+// from the end, or extended past the chunk flagged as final. The caller's
+// associated data is bound to every chunk.
+class ChunkedAead
+{
+    public:
+        // Number of chunks for a plaintext; an empty plaintext is one chunk
+        static std::size_t chunk_count (
+            std::size_t plaintext_size,
+            std::size_t chunk_size
+        ) noexcept;
+
+        static std::size_t ciphertext_size (
+            CipherSuite suite,
+            std::size_t plaintext_size,
+            std::size_t chunk_size
+        ) noexcept;
+
+        // Inverse of ciphertext_size; fails if no plaintext length maps to it
+        static util::Expected<std::size_t, CryptoError> plaintext_size (
+            CipherSuite suite,
+            std::size_t ciphertext_size,
+            std::size_t chunk_size
+        ) noexcept;
+
+        // `out` needs ciphertext_size() bytes and must not overlap `plaintext`
+        static util::Expected<void, CryptoError> seal (
+            CipherSuite suite,
+            std::span<const uint8_t> key,
+            std::span<const uint8_t> nonce,
+            std::span<const uint8_t> plaintext,
+            std::span<uint8_t> out,
+            std::size_t chunk_size = DEFAULT_CHUNK_SIZE,
+            std::span<const uint8_t> aad = {}
+        );
+
+        // `out` needs plaintext_size() bytes and must not overlap `ciphertext`
+        static util::Expected<std::size_t, CryptoError> open (
+            CipherSuite suite,
+            std::span<const uint8_t> key,
+            std::span<const uint8_t> nonce,
+            std::span<const uint8_t> ciphertext,
+            std::span<uint8_t> out,
+            std::size_t chunk_size = DEFAULT_CHUNK_SIZE,
+            std::span<const uint8_t> aad = {}
+        );
+
+        // Decrypts `data` in place; the plaintext ends up contiguous at the
+        // front of `data`. Returns its length.
+        static util::Expected<std::size_t, CryptoError> open_in_place (
+            CipherSuite suite,
+            std::span<const uint8_t> key,
+            std::span<const uint8_t> nonce,
+            std::span<uint8_t> data,
+            std::size_t chunk_size = DEFAULT_CHUNK_SIZE,
+            std::span<const uint8_t> aad = {}
+        );
+};
+
+} // namespace crypto
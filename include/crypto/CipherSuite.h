@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace crypto
+{
+
+// AEAD used for a vault payload. Values are stored in the file header, so
+// never renumber them.
+enum class CipherSuite : std::uint8_t
+{
+    XChaCha20Poly1305 = 1,
+    Aes256Gcm = 2,
+    Aegis256 = 3
+};
+
+// True if `id` names a suite this build knows about (it may still be
+// unavailable on this CPU)
+bool is_known_cipher_suite (std::uint8_t id) noexcept;
+
+// True if this build and this CPU can run `suite`. AES-256-GCM needs
+// hardware AES; AEGIS-256 needs libsodium >= 1.0.19.
+bool is_available (CipherSuite suite) noexcept;
+
+// Suite for new vaults: AEGIS-256 when the CPU has AES instructions,
+// otherwise XChaCha20-Poly1305. Both open on any host, so a vault made
+// here stays portable. AES-256-GCM is never picked by default, since a
+// host without hardware AES cannot open it at all; pass it explicitly.
+CipherSuite select_cipher_suite () noexcept;
+
+std::size_t key_size (CipherSuite suite) noexcept;
+std::size_t nonce_size (CipherSuite suite) noexcept;
+std::size_t tag_size (CipherSuite suite) noexcept;
+
+inline std::string to_string (CipherSuite suite)
+{
+    switch (suite)
+    {
+        case CipherSuite::XChaCha20Poly1305:
+            return "XChaCha20-Poly1305";
+        case CipherSuite::Aes256Gcm:
+            return "AES-256-GCM";
+        case CipherSuite::Aegis256:
+            return "AEGIS-256";
+        default:
+            return "Unknown cipher suite";
+    }
+}
+
+} // namespace crypto
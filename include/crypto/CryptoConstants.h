@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <sodium.h>
 
+#include "crypto/CryptoTypes.h"
+
 namespace crypto 
 {
 
@@ -12,9 +14,14 @@ constexpr std::size_t NONCE_SIZE = crypto_aead_xchacha20poly1305_ietf_NPUBBYTES;
 constexpr std::size_t SALT_SIZE = crypto_pwhash_SALTBYTES;
 constexpr std::size_t TAG_SIZE = crypto_aead_xchacha20poly1305_ietf_ABYTES;
 
-// --- Argon2id parameters (interactive / vault-grade) ---
-constexpr uint32_t ARGON_MEM_KIB = crypto_pwhash_MEMLIMIT_INTERACTIVE / 1024;
-constexpr uint32_t ARGON_ITERS = crypto_pwhash_OPSLIMIT_INTERACTIVE;
+// --- Argon2id parameters (moderate / vault-grade) ---
+// These are the costs derive_key() actually runs with. v1 headers recorded the
+// interactive limits here while deriving with the moderate ones, so v1 header
+// values are never trusted.
+constexpr uint32_t ARGON_MEM_KIB = crypto_pwhash_MEMLIMIT_MODERATE / 1024;
+constexpr uint32_t ARGON_ITERS = crypto_pwhash_OPSLIMIT_MODERATE;
 constexpr uint32_t ARGON_PARALLELISM = 1;
 
+constexpr KdfParams DEFAULT_KDF_PARAMS { ARGON_MEM_KIB, ARGON_ITERS, ARGON_PARALLELISM };
+
 } // namespace crypto
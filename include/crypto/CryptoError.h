@@ -13,7 +13,10 @@ enum class CryptoError
     EncryptionFailed,
     DecryptionFailed,
     AuthenticationFailed,
-    CryptoInitFailed
+    CryptoInitFailed,
+    UnsupportedCipher,
+    KeyNotCached,
+    KeyringError
 };
 
 inline std::string to_string (CryptoError error)
@@ -36,6 +39,12 @@ inline std::string to_string (CryptoError error)
             return "Authentication Failed";
         case CryptoError::CryptoInitFailed:
             return "Crypto Initialisation Failed";
+        case CryptoError::UnsupportedCipher:
+            return "Unsupported Cipher Suite";
+        case CryptoError::KeyNotCached:
+            return "Key Not Cached";
+        case CryptoError::KeyringError:
+            return "Kernel Keyring Error";
         default:
             throw std::invalid_argument("Unknown CryptoError value");
     }
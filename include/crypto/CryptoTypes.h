@@ -5,4 +5,12 @@
 
 namespace  crypto {
 using ByteBuffer = std::vector<std::uint8_t>;
+
+// Argon2id cost parameters as recorded in a vault header
+struct KdfParams
+{
+    std::uint32_t mem_kib;
+    std::uint32_t iters;
+    std::uint32_t parallelism;
+};
 } // namespace crypto
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include "crypto/CryptoError.h"
+#include "crypto/CryptoTypes.h"
+#include "util/Expected.h"
+
+namespace crypto
+{
+
+// Derived keys held in the Linux session keyring (add_key/keyctl), so later
+// processes in the same login session can skip the KDF. Keys live only in
+// kernel memory, are readable only by their possessor, and expire after a
+// kernel-enforced timeout. Nothing is written to disk.
+class KeyringCache
+{
+    public:
+        // Replaces any key already stored under `description`
+        static util::Expected<void, CryptoError> store (
+            const std::string& description,
+            std::span<const uint8_t> key,
+            std::chrono::seconds ttl
+        );
+
+        // KeyNotCached if absent, expired or revoked
+        static util::Expected<ByteBuffer, CryptoError> fetch (
+            const std::string& description
+        );
+
+        static void revoke (const std::string& description) noexcept;
+};
+
+} // namespace crypto
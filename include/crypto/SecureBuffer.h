@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace crypto
+{
+
+// Growable byte buffer in locked, guarded memory (sodium_malloc). Capacity
+// is kept across resize()/clear(), so a buffer reused for every save or load
+// stops allocating once it has grown to the vault's size. Contents are wiped
+// on clear, on regrowth and on destruction.
+class SecureBuffer
+{
+    public:
+        SecureBuffer () noexcept = default;
+        explicit SecureBuffer (std::size_t size);
+
+        SecureBuffer (const SecureBuffer&) = delete;
+        SecureBuffer& operator= (const SecureBuffer&) = delete;
+
+        SecureBuffer (SecureBuffer&& other) noexcept;
+        SecureBuffer& operator= (SecureBuffer&& other) noexcept;
+
+        ~SecureBuffer ();
+
+        // Grows capacity to at least `capacity`, preserving contents
+        void reserve (std::size_t capacity);
+
+        // Sets the logical size; only allocates if it exceeds capacity
+        void resize (std::size_t size);
+
+        // Wipes the contents and sets size to zero, keeping the allocation
+        void clear () noexcept;
+
+        std::uint8_t* data () noexcept { return data_; }
+        const std::uint8_t* data () const noexcept { return data_; }
+        std::size_t size () const noexcept { return size_; }
+        std::size_t capacity () const noexcept { return capacity_; }
+        bool empty () const noexcept { return size_ == 0; }
+
+        std::span<std::uint8_t> span () noexcept { return { data_, size_ }; }
+        std::span<const std::uint8_t> span () const noexcept { return { data_, size_ }; }
+
+        operator std::span<std::uint8_t> () noexcept { return span(); }
+        operator std::span<const std::uint8_t> () const noexcept { return span(); }
+
+    private:
+        void release () noexcept;
+
+        std::uint8_t* data_ = nullptr;
+        std::size_t size_ = 0;
+        std::size_t capacity_ = 0;
+};
+
+} // namespace crypto
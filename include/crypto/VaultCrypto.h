@@ -1,5 +1,6 @@
 #pragma once
 
+#include "crypto/CipherSuite.h"
 #include "crypto/CryptoTypes.h"
 #include "crypto/CryptoError.h"
 #include "util/Expected.h"
@@ -18,19 +19,94 @@ class VaultCrypto
 	          std::span<const uint8_t> salt
         );
 
+        // Argon2id with explicit costs (as read from a v2 header)
+        static util::Expected<ByteBuffer, CryptoError> derive_key (
+	          const util::SecureString& password,
+	          std::span<const uint8_t> salt,
+            const KdfParams& params
+        );
+
         // --- Encryption ---
         // AEAD encrypt (XChaCha20-Poly1305)
+        // `aad` is authenticated but not encrypted (e.g. the file header)
+        static util::Expected<ByteBuffer, CryptoError> encrypt (
+	          const ByteBuffer& key,
+            std::span<const uint8_t> nonce,
+	          const ByteBuffer& plaintext,
+            std::span<const uint8_t> aad = {}
+        );
+
+        // AEAD encrypt with an explicit suite; `nonce` must be
+        // nonce_size(suite) bytes
         static util::Expected<ByteBuffer, CryptoError> encrypt (
+            CipherSuite suite,
 	          const ByteBuffer& key,
-            const ByteBuffer& nonce,
-	          const ByteBuffer& plaintext
+            std::span<const uint8_t> nonce,
+	          std::span<const uint8_t> plaintext,
+            std::span<const uint8_t> aad = {}
         );
 
          // --- Decryption ---   
         static util::Expected<ByteBuffer, CryptoError> decrypt (
 	          const ByteBuffer& key,
             std::span<const uint8_t> nonce,
-	          const ByteBuffer& ciphertext
+	          std::span<const uint8_t> ciphertext,
+            std::span<const uint8_t> aad = {}
+        );
+
+        static util::Expected<ByteBuffer, CryptoError> decrypt (
+            CipherSuite suite,
+	          const ByteBuffer& key,
+            std::span<const uint8_t> nonce,
+	          std::span<const uint8_t> ciphertext,
+            std::span<const uint8_t> aad = {}
+        );
+
+        // --- Caller-provided buffers ---
+        // These never allocate. `out` may be the same memory as the input
+        // (in-place operation) but must not partially overlap it.
+
+        // Writes ciphertext || tag into `out`, which needs
+        // plaintext.size() + tag_size(suite) bytes. Returns bytes written.
+        static util::Expected<std::size_t, CryptoError> encrypt_into (
+            CipherSuite suite,
+            std::span<const uint8_t> key,
+            std::span<const uint8_t> nonce,
+            std::span<const uint8_t> plaintext,
+            std::span<uint8_t> out,
+            std::span<const uint8_t> aad = {}
+        );
+
+        // Writes the plaintext into `out`, which needs
+        // ciphertext.size() - tag_size(suite) bytes. Returns bytes written.
+        static util::Expected<std::size_t, CryptoError> decrypt_into (
+            CipherSuite suite,
+            std::span<const uint8_t> key,
+            std::span<const uint8_t> nonce,
+            std::span<const uint8_t> ciphertext,
+            std::span<uint8_t> out,
+            std::span<const uint8_t> aad = {}
+        );
+
+        // Detached tag: `out` is plaintext-sized, `tag` is tag_size(suite)
+        static util::Expected<void, CryptoError> encrypt_detached (
+            CipherSuite suite,
+            std::span<const uint8_t> key,
+            std::span<const uint8_t> nonce,
+            std::span<const uint8_t> plaintext,
+            std::span<uint8_t> out,
+            std::span<uint8_t> tag,
+            std::span<const uint8_t> aad = {}
+        );
+
+        static util::Expected<void, CryptoError> decrypt_detached (
+            CipherSuite suite,
+            std::span<const uint8_t> key,
+            std::span<const uint8_t> nonce,
+            std::span<const uint8_t> ciphertext,
+            std::span<const uint8_t> tag,
+            std::span<uint8_t> out,
+            std::span<const uint8_t> aad = {}
         );
 };
 }
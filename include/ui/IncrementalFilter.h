@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "vault/EntryTable.h"
+#include "vault/EntrySearch.h"
+
+namespace ui
+{
+
+// Type-to-filter over entry names and usernames. The first character scans
+// the packed vault::EntrySearch index; each later one narrows the previous
+// result set instead of rescanning. Every earlier result set is kept, so
+// backspace is a pop rather than a search.
+class IncrementalFilter
+{
+public:
+    explicit IncrementalFilter(const vault::EntryTable& entries);
+
+    const std::string& query() const noexcept { return query_; }
+
+    // Indices into the entries whose name or username contains query(),
+    // ignoring ASCII case, in vault order
+    const std::vector<size_t>& matches() const noexcept { return levels_.back(); }
+
+    void push(char c);
+    // No-op on an empty query
+    void pop();
+    void clear();
+
+private:
+    vault::EntrySearch search_;
+    std::string query_;
+    // levels_[i] holds the matches for the first i characters of query_
+    std::vector<std::vector<size_t>> levels_;
+};
+
+}
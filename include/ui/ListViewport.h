@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+
+namespace ui
+{
+
+// Selection and scroll position of a list taller than its window. Holds no
+// rows itself, only indices, so every move is O(1) whatever the row count
+// and the widget drawing it repaints only what a move reports.
+class ListViewport
+{
+public:
+    // What the last move invalidated
+    enum class Redraw
+    {
+        None,       // nothing changed
+        Selection,  // repaint rows previous() and selected()
+        Window      // the window scrolled; repaint every visible row
+    };
+
+    ListViewport(size_t rows, size_t height) noexcept;
+
+    size_t rows() const noexcept { return rows_; }
+    size_t height() const noexcept { return height_; }
+    size_t top() const noexcept { return top_; }
+    size_t selected() const noexcept { return selected_; }
+    size_t previous() const noexcept { return previous_; }
+
+    // Rows [top(), bottom()) are on screen
+    size_t bottom() const noexcept;
+
+    Redraw up() noexcept;
+    Redraw down() noexcept;
+    Redraw page_up() noexcept;
+    Redraw page_down() noexcept;
+    Redraw home() noexcept;
+    Redraw end() noexcept;
+
+    // New row count, e.g. after filtering; selects the first row
+    void reset(size_t rows) noexcept;
+
+private:
+    Redraw move_to(size_t row, size_t top) noexcept;
+    size_t max_top() const noexcept;
+
+    size_t rows_;
+    size_t height_;
+    size_t top_ = 0;
+    size_t selected_ = 0;
+    size_t previous_ = 0;
+};
+
+}
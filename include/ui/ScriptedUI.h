@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "ui/UserInterface.h"
+
+namespace ui
+{
+
+// In-memory UserInterface for tests and benchmarks. Answers are queued up
+// front and consumed in order; what the application showed is recorded.
+// Once the queued actions run out, prompt_action picks Quit where the menu
+// offers it and the menu's last option (Save and Close) otherwise, so
+// Application::run winds down instead of waiting for input.
+class ScriptedUI : public UserInterface
+{
+public:
+    // --- Script ---
+    ScriptedUI& then_action(app::Action action);
+    ScriptedUI& then_password(std::string_view password);
+    ScriptedUI& then_input(std::string_view input);
+    ScriptedUI& then_generate(bool generate);
+    ScriptedUI& then_remove(size_t index);
+    // Entry and field picked by the next select_entry/select_field pair
+    ScriptedUI& then_edit(size_t index, vault::EntryField field);
+    // Entry opened from the next list_entries call; repeat to open several
+    ScriptedUI& then_open(size_t index);
+
+    // --- Transcript ---
+    const std::vector<std::string>& messages() const noexcept { return messages_; }
+    const std::vector<std::string>& errors() const noexcept { return errors_; }
+    // Names from the most recent list_entries call, in display order
+    const std::vector<std::string>& listed() const noexcept { return listed_; }
+    // Hints given for the last hinted input, as typed in full
+    const NameHints& last_hints() const noexcept { return last_hints_; }
+    // Every menu offered, in order
+    const std::vector<std::vector<app::Action>>& menus() const noexcept { return menus_; }
+
+    void display_logo() override {}
+
+    void display_loading() override {}
+    void wipe_loading() override {}
+
+    void show_message(const std::string& message) override;
+    void show_error(const std::string& error) override;
+
+    app::Action prompt_action(const std::vector<app::MenuOption>& options) override;
+
+    std::vector<size_t> list_entries(
+        const vault::EntryTable& entries,
+        const std::vector<size_t>& pinned
+    ) override;
+    util::Expected<util::SecureString, std::string> prompt_master_password() override;
+    util::Expected<util::SecureString, std::string> prompt_input(std::string prompt) override;
+    util::Expected<util::SecureString, std::string> prompt_input(
+        std::string prompt,
+        const NameHinter& hints
+    ) override;
+    bool generate_password() override;
+    void display_entry(const vault::EntryView& entry) override;
+    util::Expected<size_t, char> remove_entry(const vault::EntryTable& entries) override;
+    util::Expected<size_t, char> select_entry(const vault::EntryTable& entries) override;
+    util::Expected<vault::EntryField, char> select_field(const vault::EntryView& entry) override;
+
+private:
+    std::deque<app::Action> actions_;
+    std::deque<util::SecureString> passwords_;
+    std::deque<util::SecureString> inputs_;
+    std::deque<bool> generate_;
+    std::deque<size_t> removals_;
+    std::deque<std::pair<size_t, vault::EntryField>> edits_;
+    std::vector<size_t> opens_;
+
+    std::vector<std::string> messages_;
+    std::vector<std::string> errors_;
+    std::vector<std::string> listed_;
+    std::vector<std::vector<app::Action>> menus_;
+    NameHints last_hints_;
+};
+
+}
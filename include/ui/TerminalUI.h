@@ -1,12 +1,15 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
+#include <mutex>
 #include <thread>
 #include <vector>
 #include <string>
 
 #include "app/Action.h"
 #include "app/State.h"
+#include "ui/UserInterface.h"
 #include "vault/Entry.h"
 #include "util/Expected.h"
 #include "util/SecureString.h"
@@ -16,7 +19,7 @@ namespace app { class State; }
 namespace ui
 {
 
-class TerminalUI
+class TerminalUI : public UserInterface
 {
 public:
     TerminalUI() 
@@ -24,35 +27,56 @@ public:
         initialize();
     }
 
-    ~TerminalUI()
+    ~TerminalUI() override
     {
         shutdown();
     }
 
     void initialize();
 
-    void display_logo();
+    void display_logo() override;
 
     void animate_loading();
-    void display_loading();
-    void wipe_loading();
+    void display_loading() override;
+    void wipe_loading() override;
 
-    void show_message(const std::string& message);
-    void show_error(const std::string& error);
+    void show_message(const std::string& message) override;
+    void show_error(const std::string& error) override;
 
     // Left side
-    app::Action prompt_action(const std::vector<app::MenuOption>& options);
+    app::Action prompt_action(const std::vector<app::MenuOption>& options) override;
 
     // Right side
-    void list_entries(const std::vector<vault::Entry>& entries);
-    util::Expected<util::SecureString, std::string> prompt_master_password();
-    util::Expected<util::SecureString, std::string> prompt_input(std::string prompt);
-    bool generate_password();
-    void display_entry(const vault::Entry& entry);
-    util::Expected<size_t, char> remove_entry (const std::vector<vault::Entry>& entries);
+    std::vector<size_t> list_entries(
+        const vault::EntryTable& entries,
+        const std::vector<size_t>& pinned
+    ) override;
+    util::Expected<util::SecureString, std::string> prompt_master_password() override;
+    util::Expected<util::SecureString, std::string> prompt_input(std::string prompt) override;
+    util::Expected<util::SecureString, std::string> prompt_input(
+        std::string prompt,
+        const NameHinter& hints
+    ) override;
+    bool generate_password() override;
+    void display_entry(const vault::EntryView& entry) override;
+    util::Expected<size_t, char> remove_entry (const vault::EntryTable& entries) override;
+    util::Expected<size_t, char> select_entry(const vault::EntryTable& entries) override;
+    util::Expected<vault::EntryField, char> select_field(const vault::EntryView& entry) override;
 
 private:
     void shutdown();
+
+    // Scrollable entry list plus a BACK row, drawn a window at a time.
+    // Typing filters the list by name and username, falling back to ranked
+    // fuzzy matches on the name. Unfiltered, `pinned` rows lead. `choose`
+    // runs on Enter over an entry and returns true to close the list.
+    // Returns the chosen index, or entries.size() for BACK.
+    size_t pick_entry(
+        const vault::EntryTable& entries,
+        const std::vector<size_t>& pinned,
+        const std::function<bool(size_t)>& choose
+    );
+
     int m_content_start_row_ = 0;
     int dyn_content_start_row_ = 0;
     int message_content_height_ = 3;
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "app/Action.h"
+#include "app/State.h"
+#include "util/Expected.h"
+#include "util/SecureString.h"
+#include "vault/Entry.h"
+#include "vault/EntryTable.h"
+
+namespace ui
+{
+
+// Feedback for a name as it is typed
+struct NameHints
+{
+    std::vector<util::SecureString> completions;
+    bool taken = false;
+};
+
+using NameHinter = std::function<NameHints(std::string_view typed)>;
+
+// Everything Application asks of its front end. TerminalUI draws it with
+// ncurses; ScriptedUI replays canned answers so workflows run without a TTY.
+class UserInterface
+{
+public:
+    virtual ~UserInterface() = default;
+
+    virtual void display_logo() = 0;
+
+    virtual void display_loading() = 0;
+    virtual void wipe_loading() = 0;
+
+    virtual void show_message(const std::string& message) = 0;
+    virtual void show_error(const std::string& error) = 0;
+
+    virtual app::Action prompt_action(const std::vector<app::MenuOption>& options) = 0;
+
+    // `pinned` entries (the most frecent) come first, the rest in vault
+    // order. Returns the indices opened, in order, so their use is recorded.
+    virtual std::vector<size_t> list_entries(
+        const vault::EntryTable& entries,
+        const std::vector<size_t>& pinned
+    ) = 0;
+    virtual util::Expected<util::SecureString, std::string> prompt_master_password() = 0;
+    virtual util::Expected<util::SecureString, std::string> prompt_input(std::string prompt) = 0;
+    // Shows `hints` for the text so far after every keystroke; Tab accepts
+    // the first completion
+    virtual util::Expected<util::SecureString, std::string> prompt_input(
+        std::string prompt,
+        const NameHinter& hints
+    ) = 0;
+    virtual bool generate_password() = 0;
+    virtual void display_entry(const vault::EntryView& entry) = 0;
+    virtual util::Expected<size_t, char> remove_entry(const vault::EntryTable& entries) = 0;
+    // For editing: the chosen entry, then which of its fields to change.
+    // Either answers 'l' when backed out of.
+    virtual util::Expected<size_t, char> select_entry(const vault::EntryTable& entries) = 0;
+    virtual util::Expected<vault::EntryField, char> select_field(const vault::EntryView& entry) = 0;
+};
+
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+namespace util
+{
+
+// --- Byte swapping ---
+// std::byteswap is C++23, so provide our own on top of std::bit_cast.
+template <typename T>
+    requires std::is_integral_v<T>
+constexpr T byteswap (T value) noexcept
+{
+    auto bytes = std::bit_cast<std::array<std::uint8_t, sizeof(T)>>(value);
+    std::reverse(bytes.begin(), bytes.end());
+    return std::bit_cast<T>(bytes);
+}
+
+// --- Fixed-width loads/stores ---
+// `order` is the byte order of the encoded data, not of the host.
+template <typename T>
+    requires std::is_integral_v<T>
+constexpr T load (
+    std::span<const std::uint8_t, sizeof(T)> in,
+    std::endian order = std::endian::little
+) noexcept
+{
+    std::array<std::uint8_t, sizeof(T)> bytes{};
+    std::copy(in.begin(), in.end(), bytes.begin());
+
+    T value = std::bit_cast<T>(bytes);
+    if (order != std::endian::native)
+    {
+        value = byteswap(value);
+    }
+    return value;
+}
+
+template <typename T>
+    requires std::is_integral_v<T>
+constexpr void store (
+    T value,
+    std::span<std::uint8_t, sizeof(T)> out,
+    std::endian order = std::endian::little
+) noexcept
+{
+    if (order != std::endian::native)
+    {
+        value = byteswap(value);
+    }
+    const auto bytes = std::bit_cast<std::array<std::uint8_t, sizeof(T)>>(value);
+    std::copy(bytes.begin(), bytes.end(), out.begin());
+}
+
+// --- LEB128 varints ---
+// Seven bits per byte, least significant group first, high bit set on every
+// byte but the last.
+constexpr std::size_t MAX_VARINT_SIZE = 10;
+
+constexpr std::size_t varint_size (std::uint64_t value) noexcept
+{
+    std::size_t size = 1;
+    while (value >= 0x80)
+    {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+// Returns the number of bytes written
+constexpr std::size_t store_varint (
+    std::uint64_t value,
+    std::span<std::uint8_t, MAX_VARINT_SIZE> out
+) noexcept
+{
+    std::size_t size = 0;
+    while (value >= 0x80)
+    {
+        out[size++] = static_cast<std::uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    out[size++] = static_cast<std::uint8_t>(value);
+    return size;
+}
+
+// --- Bounds-checked cursor over an encoded buffer ---
+// Reads never copy variable-length fields; they hand back views into the
+// underlying buffer. Every read fails (returns false) rather than running
+// past the end.
+class ByteReader
+{
+    public:
+        explicit ByteReader (
+            std::span<const std::uint8_t> data,
+            std::endian order = std::endian::little
+        ) noexcept
+            : data_(data), order_(order)
+        {}
+
+        template <typename T>
+            requires std::is_integral_v<T>
+        bool read (T& out) noexcept
+        {
+            if (remaining() < sizeof(T))
+            {
+                return false;
+            }
+            out = load<T>(data_.subspan(offset_).template first<sizeof(T)>(), order_);
+            offset_ += sizeof(T);
+            return true;
+        }
+
+        // Fails on truncation and on encodings longer than MAX_VARINT_SIZE
+        // or wider than 64 bits
+        bool read_varint (std::uint64_t& out) noexcept
+        {
+            std::uint64_t value = 0;
+            for (std::size_t i = 0; i < MAX_VARINT_SIZE && offset_ + i < data_.size(); ++i)
+            {
+                const std::uint8_t byte = data_[offset_ + i];
+                if (i == MAX_VARINT_SIZE - 1 && byte > 1)
+                {
+                    return false;
+                }
+                value |= static_cast<std::uint64_t>(byte & 0x7F) << (7 * i);
+                if ((byte & 0x80) == 0)
+                {
+                    out = value;
+                    offset_ += i + 1;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool read_bytes (std::size_t len, std::span<const std::uint8_t>& out) noexcept
+        {
+            if (remaining() < len)
+            {
+                return false;
+            }
+            out = data_.subspan(offset_, len);
+            offset_ += len;
+            return true;
+        }
+
+        bool skip (std::size_t len) noexcept
+        {
+            if (remaining() < len)
+            {
+                return false;
+            }
+            offset_ += len;
+            return true;
+        }
+
+        std::size_t offset () const noexcept { return offset_; }
+        std::size_t remaining () const noexcept { return data_.size() - offset_; }
+        bool at_end () const noexcept { return offset_ == data_.size(); }
+
+    private:
+        std::span<const std::uint8_t> data_;
+        std::endian order_;
+        std::size_t offset_ = 0;
+};
+
+} // namespace util
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace util
+{
+
+// Content-defined chunking (FastCDC). A gear hash rolling over the last 64
+// bytes picks cut points from the data itself, so inserting or deleting
+// bytes moves only the boundaries around the edit: everything after them
+// is cut exactly as before, and chunks of two versions of a file line up.
+//
+// Before `average` bytes a cut needs a stricter hash match and after it a
+// looser one, which keeps chunk sizes close to the average. Every chunk is
+// between `min_size` and `max_size` bytes, save a short last one.
+class ContentChunker
+{
+    public:
+        // `average` must be a power of two, with
+        // 64 <= min_size <= average <= max_size
+        ContentChunker (size_t min_size, size_t average, size_t max_size) noexcept;
+
+        // Length of the chunk at the front of `data`: all of it once it is
+        // no longer than `min_size`
+        size_t cut (std::span<const uint8_t> data) const noexcept;
+
+        // Calls `fn(chunk)` for each chunk of `data` in order
+        template <typename Fn>
+        void split (std::span<const uint8_t> data, Fn&& fn) const
+        {
+            while (!data.empty())
+            {
+                const size_t length = cut(data);
+                fn(data.first(length));
+                data = data.subspan(length);
+            }
+        }
+
+    private:
+        size_t min_size_;
+        size_t average_;
+        size_t max_size_;
+        uint64_t strict_mask_;
+        uint64_t loose_mask_;
+};
+
+} // namespace util
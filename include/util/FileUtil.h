@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace util
+{
+
+// Writes `contents` to a sibling temp file and renames it over `path`, so a
+// failed or interrupted write never leaves a truncated file behind. False
+// on any I/O failure, with the temp file removed.
+bool write_file_atomic (
+    const std::filesystem::path& path,
+    std::span<const uint8_t> contents
+);
+
+} // namespace util
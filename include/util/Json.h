@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "util/Expected.h"
+#include "util/SecureString.h"
+
+namespace util
+{
+
+enum class JsonError
+{
+    Syntax,
+    UnsupportedValue,
+    DuplicateKey
+};
+
+inline std::string to_string (JsonError error)
+{
+    switch (error)
+    {
+        case JsonError::Syntax:
+            return "Malformed JSON";
+        case JsonError::UnsupportedValue:
+            return "Only string values are supported";
+        case JsonError::DuplicateKey:
+            return "Duplicate JSON key";
+        default:
+            throw std::invalid_argument("Unknown JsonError value");
+    }
+}
+
+// A flat JSON object whose values are all strings, i.e. one JSON-lines
+// command. Values are decoded straight into SecureStrings since they may be
+// secrets; keys are plain strings.
+class JsonObject
+{
+    public:
+        static Expected<JsonObject, JsonError> parse (std::string_view text);
+
+        // nullptr if `key` is absent
+        const SecureString* find (std::string_view key) const noexcept;
+
+    private:
+        std::vector<std::pair<std::string, SecureString>> fields_;
+};
+
+// Appends `value` to `out` as a quoted, escaped JSON string. Callers holding
+// secrets in `out` wipe it themselves.
+void append_json_string (std::string& out, std::string_view value);
+
+} // namespace util
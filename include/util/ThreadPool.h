@@ -0,0 +1,184 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace util
+{
+
+// Shared flag for cooperative cancellation. Copies observe the same state.
+// Tasks submitted with a token are dropped if it is cancelled before they
+// start; running tasks may poll is_cancelled() to stop early.
+class CancellationToken
+{
+    public:
+        CancellationToken ()
+            : cancelled_(std::make_shared<std::atomic<bool>>(false))
+        {}
+
+        void cancel () noexcept
+        {
+            cancelled_->store(true, std::memory_order_release);
+        }
+
+        bool is_cancelled () const noexcept
+        {
+            return cancelled_->load(std::memory_order_acquire);
+        }
+
+    private:
+        std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+
+// Counters for one worker, as returned by ThreadPool::stats()
+struct WorkerStats
+{
+    std::uint64_t executed = 0;  // tasks run to completion on this worker
+    std::uint64_t stolen = 0;    // of those, taken from another worker's queue
+    std::uint64_t cancelled = 0; // tasks dropped because their token was cancelled
+};
+
+// Fixed-size work-stealing pool. Each worker owns a deque: it pushes and
+// pops at the back (newest first, cache-warm), while idle workers steal from
+// the front of the others. Tasks submitted from outside the pool are spread
+// round-robin; tasks submitted from a worker go to its own deque.
+//
+// The destructor runs every queued task before joining.
+class ThreadPool
+{
+    public:
+        // 0 means one worker per hardware thread
+        explicit ThreadPool (std::size_t workers = 0);
+        ~ThreadPool ();
+
+        ThreadPool (const ThreadPool&) = delete;
+        ThreadPool& operator= (const ThreadPool&) = delete;
+
+        // Process-wide pool sized to the hardware, created on first use
+        static ThreadPool& shared ();
+
+        std::size_t size () const noexcept { return workers_.size(); }
+
+        // Runs fn() on a worker. Exceptions propagate through the future.
+        template <typename F>
+        auto submit (F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+        {
+            using R = std::invoke_result_t<std::decay_t<F>>;
+
+            std::packaged_task<R()> task(std::forward<F>(fn));
+            auto future = task.get_future();
+            enqueue(Task([task = std::move(task)]() mutable
+            {
+                task();
+                return true;
+            }));
+            return future;
+        }
+
+        // As submit(fn), but the task is dropped if `token` is cancelled
+        // before it starts; its future then reports broken_promise.
+        template <typename F>
+        auto submit (
+            CancellationToken token,
+            F&& fn
+        ) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+        {
+            using R = std::invoke_result_t<std::decay_t<F>>;
+
+            std::packaged_task<R()> task(std::forward<F>(fn));
+            auto future = task.get_future();
+            enqueue(Task([task = std::move(task), token = std::move(token)]() mutable
+            {
+                if (token.is_cancelled())
+                {
+                    return false;
+                }
+                task();
+                return true;
+            }));
+            return future;
+        }
+
+        // Calls body(i) once for every i in [0, count) and returns when all
+        // calls have finished. The calling thread takes a share of the work,
+        // so this is safe to call from inside a pool task. body must be safe
+        // to call concurrently for distinct i and must not throw.
+        void parallel_for (
+            std::size_t count,
+            const std::function<void(std::size_t)>& body
+        );
+
+        // Snapshot of every worker's counters, indexed by worker
+        std::vector<WorkerStats> stats () const;
+
+    private:
+        // Move-only type-erased job; run() returns false if it was cancelled
+        class Task
+        {
+            public:
+                Task () = default;
+
+                template <typename F>
+                explicit Task (F&& fn)
+                    : impl_(std::make_unique<Model<std::decay_t<F>>>(std::forward<F>(fn)))
+                {}
+
+                bool run () { return impl_->run(); }
+                explicit operator bool () const noexcept { return impl_ != nullptr; }
+
+            private:
+                struct Concept
+                {
+                    virtual ~Concept () = default;
+                    virtual bool run () = 0;
+                };
+
+                template <typename F>
+                struct Model final : Concept
+                {
+                    explicit Model (F fn) : fn(std::move(fn)) {}
+                    bool run () override { return fn(); }
+                    F fn;
+                };
+
+                std::unique_ptr<Concept> impl_;
+        };
+
+        struct Worker
+        {
+            std::mutex mutex;
+            std::deque<Task> queue;
+            std::thread thread;
+
+            std::atomic<std::uint64_t> executed{0};
+            std::atomic<std::uint64_t> stolen{0};
+            std::atomic<std::uint64_t> cancelled{0};
+        };
+
+        void enqueue (Task task);
+        Task pop_local (std::size_t index);
+        Task steal (std::size_t thief);
+        void run_worker (std::size_t index);
+
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::atomic<std::size_t> next_worker_{0};
+
+        // Idle workers sleep here until something is queued
+        std::mutex sleep_mutex_;
+        std::condition_variable sleep_cv_;
+        std::atomic<std::size_t> pending_{0};
+        bool stopping_ = false;
+};
+
+} // namespace util
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace vault
+{
+
+// Content address of a stored blob: a keyed BLAKE2b-256 of its manifest,
+// so equal files share one id and the id reveals nothing without the key
+constexpr size_t BLOB_ID_SIZE = 32;
+using BlobId = std::array<uint8_t, BLOB_ID_SIZE>;
+
+// A blob as an entry refers to it
+struct Blob
+{
+    BlobId id{};
+    uint64_t size = 0; // plaintext bytes
+
+    bool operator== (const Blob&) const noexcept = default;
+};
+
+// A blob attached to an entry under a name unique within that entry, e.g.
+// "id_ed25519" or "recovery-codes.pdf"
+struct Attachment
+{
+    std::string name;
+    Blob blob;
+
+    bool operator== (const Attachment&) const noexcept = default;
+};
+
+// An encoded attachment, valid as long as the bytes it was decoded from
+struct AttachmentView
+{
+    std::string_view name;
+    Blob blob;
+};
+
+// --- Record encoding ---
+// An Attachment field's value is the blob id, the size as a varint, then
+// the name. EntryTable keeps a row's attachments as whole Attachment
+// fields, sorted by name, so a save copies them out unchanged.
+std::string encode_attachment (std::string_view name, const Blob& blob);
+
+// nullopt unless `value` is exactly one well-formed attachment with a
+// non-empty name
+std::optional<AttachmentView> decode_attachment (std::string_view value) noexcept;
+
+// Steps over the first field of `fields` (as EntryTable keeps them),
+// decoding it into `out`. False at the end or on malformed input.
+bool next_attachment (std::string_view& fields, AttachmentView& out) noexcept;
+
+// Calls `fn` with each attachment of a row, in name order
+template <typename Fn>
+void for_each_attachment (std::string_view fields, Fn&& fn)
+{
+    AttachmentView attachment;
+    while (next_attachment(fields, attachment))
+    {
+        fn(attachment);
+    }
+}
+
+} // namespace vault
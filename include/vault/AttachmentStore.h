@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "crypto/SecureBuffer.h"
+#include "util/Expected.h"
+#include "vault/Attachment.h"
+#include "vault/ObjectStore.h"
+
+namespace vault { enum class VaultFileError; }
+
+namespace vault
+{
+
+// Plaintext bytes per stored chunk; the last chunk of a blob may be shorter
+constexpr size_t ATTACHMENT_CHUNK_SIZE = size_t{256} << 10;
+
+// Encrypted, content-addressed blobs kept in a directory beside the vault
+// file, so attachments never enter the vault payload: unlocking and saving
+// cost the same however many megabytes are attached, and a blob is read
+// only when asked for.
+//
+// A blob is split into chunks and each is stored as its own object, named
+// by a keyed hash of its plaintext, then a manifest object lists the
+// chunks. The manifest's name is the blob's id. An object that already
+// exists is never written again, so re-attaching a file, or attaching two
+// files with chunks in common, stores nothing twice.
+//
+// Objects are sealed as ObjectStore describes.
+class AttachmentStore
+{
+    public:
+        // `vault_key` is the vault's KEY_SIZE-byte key. The store derives
+        // its own naming and sealing keys from it and keeps only those.
+        AttachmentStore (std::filesystem::path root, std::span<const uint8_t> vault_key);
+
+        // The store belonging to the vault file at `vault_path`
+        static std::filesystem::path beside (const std::filesystem::path& vault_path);
+
+        const std::filesystem::path& root () const noexcept
+        {
+            return objects_.root();
+        }
+
+        // Stores `data`, writing only the objects the store lacks
+        util::Expected<Blob, VaultFileError> put (std::span<const uint8_t> data);
+
+        // Decrypts a blob into one locked buffer. FileNotFound if an object
+        // is missing; CryptoError if one fails to authenticate or the chunks
+        // do not add up to `blob.size`.
+        util::Expected<crypto::SecureBuffer, VaultFileError> get (const Blob& blob) const;
+
+        bool contains (const BlobId& id) const
+        {
+            return objects_.contains(id);
+        }
+
+        // Deletes every object not reachable from the blobs in `live` (see
+        // Vault::attached_blobs), plus any temp files an interrupted write
+        // left behind. Returns the number of objects deleted.
+        util::Expected<size_t, VaultFileError> prune (std::span<const BlobId> live);
+
+    private:
+        struct Manifest
+        {
+            uint64_t size;
+            std::vector<BlobId> chunks;
+        };
+
+        // A manifest is the blob's size as a varint, then its chunk ids;
+        // one whose chunk count does not fit the size is refused
+        util::Expected<Manifest, VaultFileError> read_manifest (const BlobId& id) const;
+
+        ObjectStore objects_;
+};
+
+} // namespace vault
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "crypto/SecureBuffer.h"
+#include "util/ContentChunker.h"
+#include "util/Expected.h"
+#include "vault/Attachment.h"
+#include "vault/ObjectStore.h"
+
+namespace vault { enum class VaultFileError; }
+
+namespace vault
+{
+
+// Chunk sizes for snapshots. A one-entry edit rewrites about one average
+// chunk, and a snapshot manifest lists 36-odd bytes per chunk.
+constexpr size_t BACKUP_MIN_CHUNK_SIZE = size_t{4} << 10;
+constexpr size_t BACKUP_AVERAGE_CHUNK_SIZE = size_t{16} << 10;
+constexpr size_t BACKUP_MAX_CHUNK_SIZE = size_t{64} << 10;
+
+// Which snapshots survive BackupStore::prune. The newest `last` are always
+// kept; then, for each period, the newest snapshot of each of the most
+// recent `hourly` hours (days, weeks, 30-day months) that have one. Periods
+// are counted in UTC from the epoch.
+struct RetentionPolicy
+{
+    size_t last = 1;
+    size_t hourly = 24;
+    size_t daily = 7;
+    size_t weekly = 4;
+    size_t monthly = 12;
+};
+
+// Versioned, deduplicated backups of a vault, in a directory beside it.
+//
+// A snapshot is the vault's records payload, split into chunks by
+// content-defined chunking and stored as ObjectStore chunks, plus a sealed
+// manifest listing them. Chunks are named by a keyed hash rather than a
+// plain one, so the store reveals nothing about the payload to anyone
+// without the vault key. Successive versions of a vault share all but the
+// chunks around their edits, which are the only ones a new snapshot
+// writes: keeping hourly snapshots of a large vault costs the changed
+// chunks and a manifest per hour.
+//
+// Manifests live under snapshots/ as "<taken>-<id>", <taken> being zero-padded
+// seconds since the epoch so that listing needs no decryption; the time is
+// repeated inside the manifest and checked on restore. A snapshot holds the
+// vault's attachment references but not the blobs, which stay in the
+// AttachmentStore; VaultSession::prune_attachments keeps every blob a
+// snapshot refers to.
+class BackupStore
+{
+    public:
+        struct Snapshot
+        {
+            BlobId id{};
+            int64_t taken = 0;
+
+            bool operator== (const Snapshot&) const = default;
+        };
+
+        // `vault_key` is the vault's KEY_SIZE-byte key. The store derives
+        // its own naming and sealing keys from it and keeps only those.
+        BackupStore (std::filesystem::path root, std::span<const uint8_t> vault_key);
+
+        // The store belonging to the vault file at `vault_path`
+        static std::filesystem::path beside (const std::filesystem::path& vault_path);
+
+        const std::filesystem::path& root () const noexcept
+        {
+            return root_;
+        }
+
+        // Records `payload` (see Vault::serialise) as taken at `taken`,
+        // seconds since the epoch, writing only the chunks the store lacks
+        util::Expected<Snapshot, VaultFileError> snapshot (
+            std::span<const uint8_t> payload,
+            int64_t taken
+        );
+
+        // Every snapshot, oldest first
+        util::Expected<std::vector<Snapshot>, VaultFileError> list () const;
+
+        // The payload `snapshot` recorded, for Vault::deserialise.
+        // FileNotFound if it or a chunk is missing; CryptoError if anything
+        // fails to authenticate or does not add up.
+        util::Expected<crypto::SecureBuffer, VaultFileError> restore (const Snapshot& snapshot) const;
+
+        // Deletes the snapshots `policy` does not keep, then every chunk no
+        // kept snapshot lists. Returns the number of snapshots deleted.
+        util::Expected<size_t, VaultFileError> prune (const RetentionPolicy& policy);
+
+    private:
+        struct Manifest
+        {
+            uint64_t size;
+            std::vector<BlobId> chunks;
+            std::vector<uint32_t> lengths;
+        };
+
+        std::filesystem::path snapshot_path (const Snapshot& snapshot) const;
+
+        // A manifest is the time taken and payload size as varints, then a
+        // varint chunk count and per chunk a varint length and its id. One
+        // whose lengths do not add up to the size, or whose time is not the
+        // one in its file name, is refused.
+        util::Expected<Manifest, VaultFileError> read_manifest (const Snapshot& snapshot) const;
+
+        std::filesystem::path root_;
+        ObjectStore chunks_;
+        util::ContentChunker chunker_;
+};
+
+// Which of `snapshots`, oldest first, `policy` keeps
+std::vector<bool> retained (
+    std::span<const BackupStore::Snapshot> snapshots,
+    const RetentionPolicy& policy
+);
+
+} // namespace vault
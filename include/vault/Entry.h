@@ -1,14 +1,45 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "util/SecureString.h"
+#include "vault/Attachment.h"
+#include "vault/EntryRecord.h"
 
 namespace vault
 {
+
+// One editable part of an Entry
+enum class EntryField
+{
+    Name,
+    Username,
+    Secret
+};
+
+// How often and how recently an entry was opened, for frecency ranking
+struct AccessStats
+{
+    uint32_t count = 0;
+    int64_t last_access = 0; // Unix seconds
+};
+
 struct Entry
 {
     util::SecureString name;
     util::SecureString username;
     util::SecureString secret;
+    // Labels for grouping; order and repeats do not matter to the vault
+    std::vector<std::string> tags{};
+    // Files kept in the attachment store; names must be unique
+    std::vector<Attachment> attachments{};
+    // Usage, not identity: ignored by operator==
+    AccessStats access{};
 
     Entry(
         util::SecureString name_,
@@ -20,11 +51,75 @@ struct Entry
         , secret(std::move(secret_))
     {}
 
-    bool operator==(const Entry& other) const noexcept
+    bool operator==(const Entry& other) const noexcept;
+};
+
+// --- Field descriptors ---
+// Every string an entry holds, described once: the EntryField naming it,
+// the RecordField carrying it and the Entry member holding it. Equality,
+// EntryTable's columns (and with them wiping), the record encoding and its
+// size are all generated from this list, so a new string is its member,
+// its two enum values and one line here.
+struct StringFieldDescriptor
+{
+    EntryField field;
+    RecordField record;
+    util::SecureString Entry::* member;
+};
+
+inline constexpr std::array ENTRY_STRING_FIELDS = {
+    StringFieldDescriptor{ EntryField::Name,     RecordField::Name,     &Entry::name },
+    StringFieldDescriptor{ EntryField::Username, RecordField::Username, &Entry::username },
+    StringFieldDescriptor{ EntryField::Secret,   RecordField::Secret,   &Entry::secret }
+};
+
+inline constexpr size_t ENTRY_STRING_FIELD_COUNT = ENTRY_STRING_FIELDS.size();
+
+// Descriptor i is EntryField i, so anything per field can be an array
+// indexed by it
+static_assert([]
+{
+    for (size_t i = 0; i < ENTRY_STRING_FIELD_COUNT; ++i)
     {
-        return name == other.name &&
-               username == other.username &&
-               secret == other.secret;
+        if (ENTRY_STRING_FIELDS[i].field != static_cast<EntryField>(i))
+        {
+            return false;
+        }
     }
-};
+    return true;
+}(), "ENTRY_STRING_FIELDS must list every EntryField in order");
+
+// One value per string field, indexed by EntryField
+using EntryStrings = std::array<std::string_view, ENTRY_STRING_FIELD_COUNT>;
+
+constexpr size_t field_index (EntryField field) noexcept
+{
+    return static_cast<size_t>(field);
+}
+
+// The string field a record field carries, if it carries one
+constexpr const StringFieldDescriptor* string_field (RecordField record) noexcept
+{
+    for (const auto& descriptor : ENTRY_STRING_FIELDS)
+    {
+        if (descriptor.record == record)
+        {
+            return &descriptor;
+        }
+    }
+    return nullptr;
+}
+
+inline bool Entry::operator==(const Entry& other) const noexcept
+{
+    for (const auto& descriptor : ENTRY_STRING_FIELDS)
+    {
+        if (!(this->*descriptor.member == other.*descriptor.member))
+        {
+            return false;
+        }
+    }
+    return tags == other.tags && attachments == other.attachments;
+}
+
 }
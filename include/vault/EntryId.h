@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+namespace vault
+{
+
+// Stable handle to an entry. It names a slot in the vault's slot table plus
+// that slot's generation, so a handle kept past the entry's removal finds
+// nothing rather than whichever entry reuses the slot. Handles last for the
+// life of the in-memory vault, saves included; a reload issues new ones.
+class EntryId
+{
+    public:
+        constexpr EntryId () noexcept = default;
+
+        constexpr EntryId (uint32_t slot, uint32_t generation) noexcept
+            : value_((static_cast<uint64_t>(generation) << 32) | slot)
+        {}
+
+        constexpr uint32_t slot () const noexcept
+        {
+            return static_cast<uint32_t>(value_);
+        }
+
+        constexpr uint32_t generation () const noexcept
+        {
+            return static_cast<uint32_t>(value_ >> 32);
+        }
+
+        constexpr uint64_t value () const noexcept
+        {
+            return value_;
+        }
+
+        constexpr bool operator== (const EntryId&) const noexcept = default;
+
+    private:
+        // Generations start at 1, so the default handle is never valid
+        uint64_t value_ = 0;
+};
+
+} // namespace vault
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string_view>
+
+namespace vault
+{
+
+// --- Entry records ---
+// A records payload is a varint entry count, then per entry a varint byte
+// length and that many bytes of fields. Every field is a varint type, a
+// varint length and the value, so a reader steps over types it does not
+// know without decoding them. Integers are varints inside the value.
+enum class RecordField : uint32_t
+{
+    Name        = 1,
+    Username    = 2,
+    Secret      = 3,
+    Created     = 4, // Unix seconds
+    Modified    = 5, // Unix seconds
+    AccessCount = 6,
+    LastAccess  = 7, // Unix seconds
+    Tag         = 8, // One field per tag
+    Attachment  = 9  // One field per attachment; see Attachment.h
+};
+
+// Receives encoded bytes as they are produced. Each span is valid only for
+// the duration of the call.
+using RecordSink = std::function<void(std::span<const uint8_t>)>;
+
+// Writes fields into a span the caller has sized with size(), so a record's
+// length prefix can be written before the record itself. Given a sink, the
+// span is instead a staging block: each time it fills it is handed to the
+// sink and reused, so output of any length passes through it.
+class RecordWriter
+{
+    public:
+        explicit RecordWriter (std::span<uint8_t> out, const RecordSink* sink = nullptr) noexcept
+            : out_(out), sink_(sink)
+        {}
+
+        static size_t size (RecordField field, std::string_view value) noexcept;
+        static size_t size (RecordField field, uint64_t value) noexcept;
+
+        void varint (uint64_t value);
+        void field (RecordField field, std::string_view value);
+        void field (RecordField field, uint64_t value);
+
+        // Fields already encoded, e.g. ones kept from a newer writer
+        void raw (std::string_view fields);
+
+        // Bytes written so far, counting those already handed to the sink
+        size_t written () const noexcept
+        {
+            return flushed_ + used_;
+        }
+
+        // Hands whatever is staged to the sink
+        void flush ();
+
+    private:
+        // Without a sink, bytes past the end of the span are dropped
+        void put (const uint8_t* bytes, size_t len);
+
+        std::span<uint8_t> out_;
+        const RecordSink* sink_;
+        size_t used_ = 0;
+        size_t flushed_ = 0;
+};
+
+// Steps through the fields of one record
+class RecordReader
+{
+    public:
+        explicit RecordReader (std::span<const uint8_t> record) noexcept
+            : record_(record)
+        {}
+
+        // False at the end of the record, or on a malformed field, after
+        // which failed() is set
+        bool next (uint64_t& type, std::span<const uint8_t>& value) noexcept;
+
+        bool failed () const noexcept
+        {
+            return failed_;
+        }
+
+        // The whole of the field last returned, header included
+        std::span<const uint8_t> raw () const noexcept
+        {
+            return raw_;
+        }
+
+        // Decodes an integer field's value, which must be exactly one varint
+        static bool integer (std::span<const uint8_t> value, uint64_t& out) noexcept;
+
+    private:
+        std::span<const uint8_t> record_;
+        std::span<const uint8_t> raw_;
+        size_t offset_ = 0;
+        bool failed_ = false;
+};
+
+} // namespace vault
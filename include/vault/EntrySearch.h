@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "crypto/SecureBuffer.h"
+
+namespace vault { class EntryTable; }
+
+namespace vault
+{
+
+// Substring scanners, fastest last. The SIMD kernels compare the needle's
+// first and last bytes against 16 or 32 haystack positions at once and
+// only verify the middle where both match.
+enum class SearchKernel
+{
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+// True if this build and this CPU can run `kernel`
+bool is_available (SearchKernel kernel) noexcept;
+
+SearchKernel select_search_kernel () noexcept;
+
+inline std::string to_string (SearchKernel kernel)
+{
+    switch (kernel)
+    {
+        case SearchKernel::Scalar:
+            return "scalar";
+        case SearchKernel::Sse2:
+            return "SSE2";
+        case SearchKernel::Avx2:
+            return "AVX2";
+        default:
+            return "Unknown search kernel";
+    }
+}
+
+// Case-insensitive (ASCII) substring search over entry names and
+// usernames. Both fields are case-folded once into one packed buffer in
+// locked memory, each field NUL-terminated so no match spans two fields.
+// The index is a snapshot: rebuild it after the entries change.
+class EntrySearch
+{
+    public:
+        explicit EntrySearch (
+            const EntryTable& entries,
+            SearchKernel kernel = select_search_kernel()
+        );
+
+        // Ascending indices of the entries whose name or username contains
+        // `needle`; every entry for an empty needle
+        std::vector<size_t> find (std::string_view needle) const;
+
+        // As above, but only the text of `candidates` (ascending) is
+        // scanned, so a longer query narrows an earlier result without
+        // reading the rest of the vault
+        std::vector<size_t> find (
+            std::string_view needle,
+            std::span<const size_t> candidates
+        ) const;
+
+        size_t size () const noexcept
+        {
+            return offsets_.size() - 1;
+        }
+
+        SearchKernel kernel () const noexcept
+        {
+            return kernel_;
+        }
+
+        // One entry at a time, straight from the columns; the reference
+        // the kernels are tested and benchmarked against
+        static std::vector<size_t> find_naive (
+            const EntryTable& entries,
+            std::string_view needle
+        );
+
+    private:
+        // Position of the first match in [begin, end) of the packed text,
+        // or `end` if there is none
+        size_t scan (size_t begin, size_t end, std::string_view needle) const noexcept;
+
+        // Appends the entries in [first, last) whose text contains the
+        // already-folded needle
+        void scan_entries (
+            size_t first,
+            size_t last,
+            std::string_view folded,
+            std::vector<size_t>& matches
+        ) const;
+
+        crypto::SecureBuffer text_;
+        // Entry i occupies [offsets_[i], offsets_[i + 1]) of text_
+        std::vector<uint32_t> offsets_;
+        SearchKernel kernel_;
+};
+
+} // namespace vault
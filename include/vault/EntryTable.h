@@ -0,0 +1,252 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "crypto/SecureBuffer.h"
+#include "vault/Entry.h"
+
+namespace vault
+{
+
+// One string per row, stored back to back in a single locked buffer and
+// addressed by (offset, length) spans, in the manner of an Arrow string
+// column. Overwriting with a value that fits reuses the row's bytes;
+// anything else appends. Bytes given up either way are wiped at once and
+// reclaimed by compaction once they outweigh the live ones, so every
+// mutation is amortised O(1) in the row count.
+class StringColumn
+{
+    public:
+        size_t size () const noexcept
+        {
+            return spans_.size();
+        }
+
+        bool empty () const noexcept
+        {
+            return spans_.empty();
+        }
+
+        // Valid until the column next changes
+        std::string_view operator[] (size_t row) const noexcept
+        {
+            const Span& span = spans_[row];
+            return { reinterpret_cast<const char*>(bytes_.data()) + span.offset, span.length };
+        }
+
+        // Bytes held by live rows
+        size_t bytes () const noexcept
+        {
+            return bytes_.size() - dead_;
+        }
+
+        void reserve (size_t rows, size_t bytes);
+        void push_back (std::string_view value);
+        void set (size_t row, std::string_view value);
+
+        // The last row takes `row`'s place
+        void swap_remove (size_t row);
+
+        // Wipes every byte, keeping the allocation
+        void clear () noexcept;
+
+    private:
+        struct Span
+        {
+            uint32_t offset;
+            uint32_t length;
+        };
+
+        Span append (std::string_view value);
+        void retire (Span span) noexcept;
+        void compact_if_sparse ();
+
+        crypto::SecureBuffer bytes_;
+        std::vector<Span> spans_;
+        // Wiped bytes still inside bytes_
+        size_t dead_ = 0;
+};
+
+// A row's tags are kept sorted and NUL-separated in one string; this calls
+// `fn` with each of them
+template <typename Fn>
+void for_each_tag (std::string_view tags, Fn&& fn)
+{
+    while (!tags.empty())
+    {
+        const size_t end = tags.find('\0');
+        fn(tags.substr(0, end));
+        if (end == std::string_view::npos)
+        {
+            break;
+        }
+        tags.remove_prefix(end + 1);
+    }
+}
+
+// One row of an EntryTable, valid until the table next changes
+struct EntryView
+{
+    std::string_view name;
+    std::string_view username;
+    std::string_view secret;
+    AccessStats access;
+    int64_t created;
+    int64_t modified;
+    std::string_view tags; // see for_each_tag
+    std::string_view attachments; // see for_each_attachment
+};
+
+// Orders an EntryTable can list its rows in. Names and usernames compare
+// ignoring ASCII case, with byte order breaking ties. Modified puts the
+// latest change first. Ties fall back to the name, then the row, so every
+// order is total.
+enum class EntryOrder
+{
+    Name,
+    Username,
+    Modified
+};
+
+// The vault's entries, one column per field. A scan over names reads only
+// name bytes, and secrets sit in a locked region of their own that nothing
+// but a lookup of that row touches.
+class EntryTable
+{
+    public:
+        size_t size () const noexcept
+        {
+            return access_.size();
+        }
+
+        bool empty () const noexcept
+        {
+            return access_.empty();
+        }
+
+        // One column per ENTRY_STRING_FIELDS entry
+        const StringColumn& column (EntryField field) const noexcept
+        {
+            return strings_[field_index(field)];
+        }
+
+        const StringColumn& names () const noexcept { return column(EntryField::Name); }
+        const StringColumn& usernames () const noexcept { return column(EntryField::Username); }
+        const StringColumn& secrets () const noexcept { return column(EntryField::Secret); }
+
+        std::string_view name (size_t row) const noexcept { return names()[row]; }
+        std::string_view username (size_t row) const noexcept { return usernames()[row]; }
+        std::string_view secret (size_t row) const noexcept { return secrets()[row]; }
+
+        const AccessStats& access (size_t row) const noexcept { return access_[row]; }
+        AccessStats& access (size_t row) noexcept { return access_[row]; }
+
+        // Seconds since the epoch of the row's creation and last change
+        int64_t created (size_t row) const noexcept { return created_[row]; }
+        int64_t modified (size_t row) const noexcept { return modified_[row]; }
+
+        // Sorted and NUL-separated; see for_each_tag
+        std::string_view tags (size_t row) const noexcept { return tags_[row]; }
+
+        // Encoded Attachment fields in name order; see for_each_attachment
+        std::string_view attachments (size_t row) const noexcept { return attachments_[row]; }
+
+        // Encoded record fields this build does not know, kept as read so
+        // saving writes them back
+        std::string_view unknown_fields (size_t row) const noexcept { return unknown_[row]; }
+
+        EntryView operator[] (size_t row) const noexcept
+        {
+            return {
+                name(row), username(row), secret(row),
+                access_[row], created_[row], modified_[row], tags_[row],
+                attachments_[row]
+            };
+        }
+
+        // Rows in `order`. The permutation is sorted on first use and from
+        // then on patched by every mutation (a binary search and one shift
+        // per affected order), so listing again costs nothing. Valid until
+        // the table next changes.
+        std::span<const uint32_t> sorted_rows (EntryOrder order) const;
+
+        // The rows themselves in `order`, without copying any of them
+        auto sorted (EntryOrder order) const
+        {
+            return sorted_rows(order) | std::views::transform([this](uint32_t row)
+            {
+                return (*this)[row];
+            });
+        }
+
+        // `bytes` sizes each string column, indexed by EntryField
+        void reserve (
+            size_t rows,
+            const std::array<size_t, ENTRY_STRING_FIELD_COUNT>& bytes = {}
+        );
+
+        void push_back (
+            const EntryStrings& strings,
+            AccessStats access = {},
+            int64_t modified = 0
+        );
+
+        void push_back (
+            std::string_view name,
+            std::string_view username,
+            std::string_view secret,
+            AccessStats access = {},
+            int64_t modified = 0
+        )
+        {
+            push_back(EntryStrings{ name, username, secret }, access, modified);
+        }
+
+        void set (size_t row, EntryField field, std::string_view value);
+        void touch (size_t row, int64_t modified);
+        void set_created (size_t row, int64_t created) noexcept { created_[row] = created; }
+        void set_tags (size_t row, std::string_view tags) { tags_.set(row, tags); }
+        void set_attachments (size_t row, std::string_view fields) { attachments_.set(row, fields); }
+        void set_unknown_fields (size_t row, std::string_view fields) { unknown_.set(row, fields); }
+
+        // The last row takes `row`'s place
+        void swap_remove (size_t row);
+
+        // Wipes every column
+        void clear () noexcept;
+
+        // Row by row on the strings, tags and attachments; usage and times
+        // are ignored, as for Entry
+        bool operator== (const EntryTable& other) const noexcept;
+
+    private:
+        static constexpr size_t ORDER_COUNT = 3;
+
+        bool before (EntryOrder order, uint32_t a, uint32_t b) const noexcept;
+
+        // Take `row` out of, or put it back into, each built order whose bit
+        // is set in `orders`
+        void unlink (uint32_t row, unsigned orders);
+        void link (uint32_t row, unsigned orders);
+
+        std::array<StringColumn, ENTRY_STRING_FIELD_COUNT> strings_;
+        std::vector<AccessStats> access_;
+        std::vector<int64_t> created_;
+        std::vector<int64_t> modified_;
+        StringColumn tags_;
+        StringColumn attachments_;
+        StringColumn unknown_;
+
+        // Sorted lazily by the const sorted_rows(); a permutation exists
+        // only once its flag is set
+        mutable std::array<std::vector<uint32_t>, ORDER_COUNT> orders_;
+        mutable std::array<bool, ORDER_COUNT> ordered_{};
+};
+
+} // namespace vault
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vault { class StringColumn; }
+
+namespace vault
+{
+
+struct FuzzyMatch
+{
+    size_t index;
+    int score;
+};
+
+// fzf-style fuzzy matching of entry names. The pattern splits on spaces
+// into terms that must each appear in the name as a subsequence, ignoring
+// ASCII case ("gh ent" finds "github-enterprise"). A term scores per
+// matched character, with bonuses for word, camelCase and digit
+// boundaries, more for the first character and for consecutive runs, and
+// penalties for gaps; a match's score is the sum over its terms.
+class FuzzyMatcher
+{
+    public:
+        explicit FuzzyMatcher (std::string_view pattern);
+
+        // True if the pattern has no terms, so everything matches
+        bool empty () const noexcept
+        {
+            return terms_.empty();
+        }
+
+        // nullopt if some term is not a subsequence of `text`
+        std::optional<int> score (std::string_view text) const noexcept;
+
+        // The `limit` best-scoring of `names` (an EntryTable's name
+        // column), best first; ties go to the shorter name, then the
+        // earlier entry. Keeps a bounded heap per chunk rather than sorting
+        // the vault, and splits large vaults across
+        // util::ThreadPool::shared().
+        std::vector<FuzzyMatch> top (
+            const StringColumn& names,
+            size_t limit
+        ) const;
+
+    private:
+        // Case-folded, non-empty
+        std::vector<std::string> terms_;
+};
+
+} // namespace vault
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "crypto/SecureBuffer.h"
+#include "util/SecureString.h"
+
+namespace vault
+{
+
+// Prefix trie over entry names for completion, duplicate checks and
+// lookups by name, each name carrying a 32-bit value. Nodes
+// live in one locked, wiped crypto::SecureBuffer arena; children are kept
+// in byte order, so completions come out sorted. Freed nodes are recycled.
+class NameTrie
+{
+    public:
+        NameTrie ();
+
+        // Adds `name`, or gives a name already present the new `value`
+        void insert (std::string_view name, uint32_t value = 0);
+
+        // No-op if `name` is absent; prunes branches left empty
+        void erase (std::string_view name);
+
+        bool contains (std::string_view name) const noexcept
+        {
+            return value_of(name).has_value();
+        }
+
+        std::optional<uint32_t> value_of (std::string_view name) const noexcept;
+
+        // Up to `limit` names starting with `prefix`, in byte order. Finding
+        // the subtree walks one level per prefix byte, scanning up to 256
+        // siblings at each; the walk below stops as soon as `limit` names
+        // have been produced.
+        std::vector<util::SecureString> complete (
+            std::string_view prefix,
+            size_t limit
+        ) const;
+
+        size_t size () const noexcept
+        {
+            return names_;
+        }
+
+        // Wipes every node
+        void clear () noexcept;
+
+    private:
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        struct Node
+        {
+            uint32_t child = NONE;    // first child
+            uint32_t sibling = NONE;  // next sibling, or next free node
+            uint32_t value = NONE;    // set where a name ends
+            uint8_t byte = 0;
+        };
+
+        // The arena has no alignment guarantee, so nodes are copied in
+        // and out rather than referenced in place
+        Node load (uint32_t index) const noexcept;
+        void store (uint32_t index, const Node& node) noexcept;
+
+        uint32_t allocate (uint8_t byte);
+        void release (uint32_t index) noexcept;
+
+        uint32_t child_of (uint32_t parent, uint8_t byte) const noexcept;
+
+        // Index of the node reached by `key`, or NONE
+        uint32_t find (std::string_view key) const noexcept;
+
+        crypto::SecureBuffer nodes_;
+        uint32_t free_ = NONE;
+        size_t names_ = 0;
+};
+
+} // namespace vault
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "crypto/SecureBuffer.h"
+#include "util/Expected.h"
+#include "vault/Attachment.h"
+
+namespace vault { enum class VaultFileError; }
+
+namespace vault
+{
+
+// What an object holds. The kind is hashed into its name and bound to its
+// ciphertext, so a chunk can never pass for a manifest or a snapshot.
+enum class ObjectKind : uint8_t
+{
+    Chunk = 1,
+    Manifest = 2,
+    Snapshot = 3
+};
+
+// A directory of encrypted, content-addressed objects, the storage under
+// AttachmentStore and BackupStore. An object is named by a keyed hash of its
+// kind and plaintext, fanned out over 256 directories by the first byte of
+// that name, and is never written twice.
+//
+// Every object is nonce || AEAD(plaintext) || tag, with the object's kind
+// and name as associated data: an object swapped for another under a
+// different name fails to open.
+class ObjectStore
+{
+    public:
+        // `vault_key` is the vault's KEY_SIZE-byte key. Naming and sealing
+        // keys are derived from it under `kdf_context`, exactly
+        // crypto_kdf_CONTEXTBYTES characters, so stores under different
+        // contexts share neither names nor keys.
+        ObjectStore (
+            std::filesystem::path root,
+            std::span<const uint8_t> vault_key,
+            const char* kdf_context
+        );
+
+        const std::filesystem::path& root () const noexcept
+        {
+            return root_;
+        }
+
+        BlobId address (ObjectKind kind, std::span<const uint8_t> plaintext) const noexcept;
+        std::filesystem::path path_of (const BlobId& id) const;
+        bool contains (const BlobId& id) const;
+
+        // Seals `plaintext` as object `id` unless it already exists
+        util::Expected<void, VaultFileError> write (
+            ObjectKind kind,
+            const BlobId& id,
+            std::span<const uint8_t> plaintext,
+            crypto::SecureBuffer& scratch
+        );
+
+        // Reads object `id` into `buffer` and decrypts it there, returning
+        // the plaintext within it
+        util::Expected<std::span<const uint8_t>, VaultFileError> open (
+            ObjectKind kind,
+            const BlobId& id,
+            crypto::SecureBuffer& buffer
+        ) const;
+
+        // The same, for an object kept at a path of the caller's choosing
+        // rather than under its name
+        util::Expected<void, VaultFileError> seal_to (
+            const std::filesystem::path& path,
+            ObjectKind kind,
+            const BlobId& id,
+            std::span<const uint8_t> plaintext,
+            crypto::SecureBuffer& scratch
+        ) const;
+
+        util::Expected<std::span<const uint8_t>, VaultFileError> open_from (
+            const std::filesystem::path& path,
+            ObjectKind kind,
+            const BlobId& id,
+            crypto::SecureBuffer& buffer
+        ) const;
+
+        // Deletes every file under the root that is not an object named in
+        // `keep`, which must be sorted, including temp files an interrupted
+        // write left behind. Returns the number of files deleted.
+        util::Expected<size_t, VaultFileError> sweep (std::span<const BlobId> keep);
+
+    private:
+        std::filesystem::path root_;
+        crypto::SecureBuffer naming_key_;
+        crypto::SecureBuffer sealing_key_;
+};
+
+// An object's file name: its id as lowercase hex
+std::string to_hex (const BlobId& id);
+bool from_hex (std::string_view hex, BlobId& id) noexcept;
+
+} // namespace vault
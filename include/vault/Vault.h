@@ -1,43 +1,274 @@
 #pragma once
 
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 #include "crypto/CryptoTypes.h"
+#include "crypto/SecureBuffer.h"
 #include "util/Expected.h"
+#include "util/SecureString.h"
+#include "vault/Attachment.h"
+#include "vault/EntryId.h"
+#include "vault/EntryRecord.h"
+#include "vault/EntryTable.h"
+#include "vault/NameTrie.h"
+#include "vault/VaultHeader.h"
 
-namespace vault { class Entry; }
 namespace vault { enum class VaultError; }
 namespace vault { enum class VaultFileError; }
 
 namespace vault 
 {
 
+// Entries live in a slot map: entries() is a dense, columnar EntryTable
+// with no holes, and each entry also has a stable EntryId resolved through
+// a table of slots.
+// Removing an entry moves the last one into its place and tombstones its
+// slot (a new generation, then the free list), so removal is O(1) and never
+// shifts the rest. Indexes into entries() are only good until the next
+// removal; hold an EntryId across anything that may remove.
 class Vault 
 {
     public:
-        const std::vector<Entry>& entries () const noexcept
+        const EntryTable& entries () const noexcept
         {
             return entries_;
         }
 
-        util::Expected<void, VaultError> add_entry (Entry entry);
+        // Id of entries()[index]
+        EntryId id_at (size_t index) const noexcept
+        {
+            return ids_[index];
+        }
+
+        // Where `id` currently sits in entries(), if it is still live
+        std::optional<size_t> index_of (EntryId id) const noexcept;
+
+        // Adding and editing stamp the entry's modification time with `when`.
+        // update_entry replaces the three strings only; tags go through
+        // add_tag and remove_tag, attachments through attach and detach.
+        util::Expected<EntryId, VaultError> add_entry (
+            Entry entry,
+            std::chrono::system_clock::time_point when = std::chrono::system_clock::now()
+        );
 
         util::Expected<void, VaultError> update_entry (
-            size_t index,
-            Entry updated
+            EntryId id,
+            Entry updated,
+            std::chrono::system_clock::time_point when = std::chrono::system_clock::now()
+        );
+
+        // Replaces one field in place: the entry keeps its id and position
+        // and the other fields are left alone, so rotating a secret costs O(1)
+        util::Expected<void, VaultError> set_field (
+            EntryId id,
+            EntryField field,
+            util::SecureString value,
+            std::chrono::system_clock::time_point when = std::chrono::system_clock::now()
+        );
+
+        util::Expected<void, VaultError> remove_entry (EntryId id);
+
+        bool has_entry (std::string_view name) const noexcept
+        {
+            return names_.contains(name);
+        }
+
+        // The entry named exactly `name`, found through the name trie
+        // without scanning the entries
+        std::optional<EntryId> find_entry (std::string_view name) const noexcept;
+
+        // Up to `limit` entry names starting with `prefix`, sorted
+        std::vector<util::SecureString> complete_name (
+            std::string_view prefix,
+            size_t limit
+        ) const
+        {
+            return names_.complete(prefix, limit);
+        }
+
+        // --- Frecency ---
+        // Entries opened often and recently rank first. An entry scores
+        // count * 2^-(age / FRECENCY_HALF_LIFE) as if every use were its
+        // latest; all scores decay at the same rate, so the order only
+        // changes when an entry is used and the ranking is kept up to date
+        // per access instead of re-sorted per display.
+        static constexpr size_t FRECENT_COUNT = 5;
+        static constexpr std::chrono::seconds FRECENCY_HALF_LIFE = std::chrono::hours(72);
+
+        util::Expected<void, VaultError> record_access (
+            EntryId id,
+            std::chrono::system_clock::time_point when = std::chrono::system_clock::now()
         );
 
-        util::Expected<void, VaultError> remove_entry (size_t index);
+        // Indices of up to FRECENT_COUNT used entries, best first
+        std::vector<size_t> frecent () const;
+
+        // --- Tags ---
+        // Each tag keeps a posting list of the entries carrying it, sorted by
+        // id, so a query reads only the lists of the tags it names and never
+        // scans the entries. Adding a tag an entry has, or removing one it
+        // lacks, changes nothing.
+        util::Expected<void, VaultError> add_tag (
+            EntryId id,
+            std::string_view tag,
+            std::chrono::system_clock::time_point when = std::chrono::system_clock::now()
+        );
 
-        crypto::ByteBuffer serialise() const;
+        util::Expected<void, VaultError> remove_tag (
+            EntryId id,
+            std::string_view tag,
+            std::chrono::system_clock::time_point when = std::chrono::system_clock::now()
+        );
+
+        // Indices of the entries carrying every one of `tags`, ascending
+        std::vector<size_t> tagged (std::span<const std::string_view> tags) const;
+
+        // --- Attachments ---
+        // An entry refers to blobs in an AttachmentStore by id and size
+        // only, so attaching costs the vault a few dozen bytes however large
+        // the file. Attaching under a name the entry already uses replaces
+        // that attachment; detaching a name it lacks changes nothing.
+        util::Expected<void, VaultError> attach (
+            EntryId id,
+            std::string_view name,
+            const Blob& blob,
+            std::chrono::system_clock::time_point when = std::chrono::system_clock::now()
+        );
+
+        util::Expected<void, VaultError> detach (
+            EntryId id,
+            std::string_view name,
+            std::chrono::system_clock::time_point when = std::chrono::system_clock::now()
+        );
 
+        // Every blob some entry refers to, each once, for pruning the store
+        std::vector<BlobId> attached_blobs () const;
+
+        // As above, read straight from a records payload such as a backup
+        // snapshot: only Attachment fields are decoded and every other
+        // field is stepped over by its length, so no Vault is built
+        static util::Expected<std::vector<BlobId>, VaultFileError> attached_blobs (
+            std::span<const uint8_t> payload
+        );
+
+        // One TLV record per entry (see EntryRecord.h); only live entries
+        // are written, so the payload is always compact. Fields this build
+        // read but did not know are written back unchanged.
+        //
+        // The payload holds every secret in the clear, so it is written into
+        // locked memory allocated once at serialised_size() and wiped when
+        // freed.
+        crypto::SecureBuffer serialise () const;
+
+        // As above into `out`, whose allocation is reused once it has grown
+        // to the vault's size
+        void serialise (crypto::SecureBuffer& out) const;
+
+        // Only `rows` of entries(), in that order, as a payload of their
+        // own; a sharded vault saves each shard this way
+        void serialise_rows (std::span<const uint32_t> rows, crypto::SecureBuffer& out) const;
+
+        // As above into memory the caller owns. Returns false, writing
+        // nothing, if `out` is shorter than serialised_size().
+        bool serialise_into (std::span<uint8_t> out) const;
+
+        // Streams the payload through `sink` in pieces of `block` bytes (the
+        // last may be shorter), staged in one locked block that is wiped
+        // afterwards. The whole plaintext never exists at once, and a sink
+        // can encrypt each piece while the next is encoded; a block of the
+        // AEAD chunk size makes every piece exactly one chunk.
+        void serialise_to (
+            const RecordSink& sink,
+            size_t block = SERIALISE_BLOCK_SIZE
+        ) const;
+
+        static constexpr size_t SERIALISE_BLOCK_SIZE = size_t{64} << 10;
+
+        // Exact length of serialise()'s output, computed from the field
+        // descriptors without encoding anything
+        size_t serialised_size () const noexcept;
+
+        // `flags` are the header's and pick the payload layout: records, or
+        // the fixed layout of u32-prefixed name, username and secret
+        // strings. `byte_order` is only native for v1 payloads, which were
+        // written in host order.
         static util::Expected<Vault, VaultFileError> deserialise (
-            const crypto::ByteBuffer& data
+            std::span<const uint8_t> data,
+            std::endian byte_order = std::endian::little,
+            uint8_t flags = VAULT_FLAG_RECORDS
         );
 
         void secure_clear();
 
     private:
-        std::vector<Entry> entries_;
+        // An entry's place in entries_, or, once tombstoned, the next free
+        // slot
+        struct Slot
+        {
+            uint32_t index;
+            uint32_t generation;
+        };
+        static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+        // Everything about a new entry but its three strings
+        struct Metadata
+        {
+            AccessStats access{};
+            int64_t created = 0;
+            int64_t modified = 0;
+            std::string_view tags{};           // joined as EntryTable keeps them
+            std::string_view attachments{};    // likewise
+            std::string_view unknown_fields{};
+        };
+
+        struct TagHash
+        {
+            using is_transparent = void;
+
+            size_t operator() (std::string_view tag) const noexcept
+            {
+                return std::hash<std::string_view>{}(tag);
+            }
+        };
+
+        // Encodes the payload through `writer`, which must have room for
+        // serialised_size() bytes or a sink to hand them to
+        void write_records (RecordWriter& writer) const;
+
+        static util::Expected<Vault, VaultFileError> deserialise_records (
+            std::span<const uint8_t> data
+        );
+
+        util::Expected<EntryId, VaultError> insert (
+            const EntryStrings& strings,
+            const Metadata& meta
+        );
+
+        void index_tag (std::string_view tag, EntryId id);
+        void unindex_tag (std::string_view tag, EntryId id);
+
+        // Places `id` in frecent_ after its stats improved
+        void rank (EntryId id);
+        void rebuild_frecent ();
+
+        EntryTable entries_;
+        std::vector<EntryId> ids_; // parallel to entries_
+        std::vector<Slot> slots_;
+        uint32_t free_slot_ = NO_SLOT;
+
+        // Kept in step with entries_ by every mutation
+        NameTrie names_;
+        std::vector<EntryId> frecent_;
+        std::unordered_map<std::string, std::vector<EntryId>, TagHash, std::equal_to<>> tag_index_;
 };
 
 } // namespace vault
@@ -8,7 +8,9 @@ namespace vault
 enum class VaultError
 {
     DuplicateEntry,
-    EntryNotFound
+    EntryNotFound,
+    InvalidTag,
+    InvalidAttachment
 };
 
 inline std::string to_string(VaultError error)
@@ -19,6 +21,10 @@ inline std::string to_string(VaultError error)
             return "Duplicate Entry";
         case VaultError::EntryNotFound:
             return "Entry not found";
+        case VaultError::InvalidTag:
+            return "Tags must be non-empty and contain no NUL bytes";
+        case VaultError::InvalidAttachment:
+            return "Attachments need a non-empty name, unique within the entry";
         default:
             throw std::invalid_argument("Unknown Vault Error vault");
     }
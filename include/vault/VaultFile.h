@@ -1,43 +1,61 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
-#include <sodium/crypto_aead_xchacha20poly1305.h>
-#include <sodium/crypto_pwhash.h>
+#include <functional>
+#include <optional>
+#include <span>
 
+#include "crypto/CipherSuite.h"
 #include "crypto/CryptoTypes.h"
 #include "util/Expected.h"
+#include "util/SecureString.h"
+#include "vault/VaultHeader.h"
 
-namespace util { class SecureString; }
+namespace crypto { class SecureBuffer; }
 namespace vault { class Vault; }
 namespace vault { enum class VaultFileError; }
 namespace vault { class VaultSession; }
+namespace vault { class VaultShards; }
 
 namespace vault
 {
 
-// Define header constants
-constexpr uint32_t VAULT_MAGIC = 0x5641554C;
-constexpr uint8_t VAULT_VERSION = 1;
-constexpr uint8_t KDF_TYPE_ARGON2ID = 1;
-
-constexpr std::size_t VAULT_HEADER_SIZE =
-      sizeof(uint32_t) // magic
-    + sizeof(uint8_t)  // version
-    + sizeof(uint8_t)  // kdf_type
-    + sizeof(uint16_t) // reserved
-    + sizeof(uint32_t) // argon_mem_kib
-    + sizeof(uint32_t) // argon_iters
-    + sizeof(uint32_t) // argon_parallelism
-    + crypto_pwhash_SALTBYTES
-    + crypto_aead_xchacha20poly1305_ietf_NPUBBYTES;
+// Opt-in caching of derived keys in the kernel session keyring, so repeat
+// unlocks in one login session skip Argon2 (see crypto::KeyringCache)
+struct KeyCacheOptions
+{
+    bool enabled = false;
+    std::chrono::seconds ttl{300};
+
+    // Enabled when VAULT_KEY_CACHE_TTL holds a positive number of seconds
+    static KeyCacheOptions from_environment ();
+};
+
+// Asked for the master password only when no cached key can be used;
+// nullopt cancels the unlock
+using PasswordPrompt = std::function<std::optional<util::SecureString>()>;
 
 class VaultFile
 {
     public:
         // --- Create New ---
+        // The payload cipher defaults to the fastest suite this CPU supports
         static util::Expected<void, VaultFileError> create_new (
             const std::filesystem::path& path,
-            const util::SecureString& password
+            const util::SecureString& password,
+            crypto::CipherSuite suite = crypto::select_cipher_suite()
+        );
+
+        // Creates an empty vault in the sharded layout (see VaultShards.h):
+        // its entries are spread over `shard_count` files, and a save
+        // rewrites only those holding changed entries
+        static util::Expected<void, VaultFileError> create_sharded (
+            const std::filesystem::path& path,
+            const util::SecureString& password,
+            uint32_t shard_count,
+            crypto::CipherSuite suite = crypto::select_cipher_suite()
         );
 
         // --- Load Vault ---
@@ -45,12 +63,63 @@ class VaultFile
             const std::filesystem::path& path,
             const util::SecureString& password
         );
+
+        // Tries a key cached for this vault (path, salt and KDF settings)
+        // before prompting and running the KDF. A successful unlock caches
+        // the derived key for `cache.ttl`; a stale cached key is revoked.
+        static util::Expected<VaultSession, VaultFileError> load (
+            const std::filesystem::path& path,
+            const PasswordPrompt& prompt,
+            const KeyCacheOptions& cache
+        );
         
+        // --- Inspect Header ---
+        // Reads only the header; no password needed. Lets tools size buffers
+        // from the entry-count and payload-length hints. Loading ignores the
+        // entry count: the payload carries its own, which is authenticated.
+        static util::Expected<VaultHeader, VaultFileError> inspect (
+            const std::filesystem::path& path
+        );
+
+        // --- Migrate Vault ---
+        // Rewrites a v1 vault in the current format. No-op if already current.
+        // Not streamed: a v1 payload is one AEAD message that cannot be
+        // authenticated until all of it is in memory, so the vault is
+        // loaded whole and saved through the ordinary atomic path.
+        static util::Expected<void, VaultFileError> migrate (
+            const std::filesystem::path& path,
+            const util::SecureString& password
+        );
+
         // --- Save Vault ---
+        // Always writes the current format, upgrading v1 files in place
+        static util::Expected<void, VaultFileError> save (
+            const std::filesystem::path& path,
+            const Vault& vault,
+            const crypto::ByteBuffer& key
+       );
+
+        // As above, but serialises into `plaintext` and seals into
+        // `scratch` instead of fresh buffers, so repeated saves reuse two
+        // locked allocations. `plaintext` is wiped before returning.
+        static util::Expected<void, VaultFileError> save (
+            const std::filesystem::path& path,
+            const Vault& vault,
+            std::span<const uint8_t> key,
+            crypto::SecureBuffer& plaintext,
+            crypto::SecureBuffer& scratch
+       );
+
+        // Saves a sharded vault: the dirty shards are written under new
+        // versions, then the manifest naming them replaces the vault file.
+        // Writes nothing if no shard is dirty.
         static util::Expected<void, VaultFileError> save (
             const std::filesystem::path& path,
             const Vault& vault,
-            const crypto::ByteBuffer key
+            std::span<const uint8_t> key,
+            VaultShards& shards,
+            crypto::SecureBuffer& plaintext,
+            crypto::SecureBuffer& scratch
        );
 };
 }
@@ -11,8 +11,10 @@ enum class VaultFileError
     FileAlreadyExists,
     InvalidFormat,
     UnsupportedVersion,
+    UnsupportedCipher,
     CryptoError,
     IOError,
+    Cancelled,
 };
 
 inline std::string to_string(VaultFileError error)
@@ -27,10 +29,14 @@ inline std::string to_string(VaultFileError error)
                 return "Invalid file format";
             case VaultFileError::UnsupportedVersion: 
                 return "Unsupported file version";
+            case VaultFileError::UnsupportedCipher:
+                return "Cipher suite not supported on this host";
             case VaultFileError::CryptoError:        
                 return "Cryptographic error";
             case VaultFileError::IOError:            
                 return "I/O error";
+            case VaultFileError::Cancelled:
+                return "Unlock cancelled";
             default: 
                 throw std::invalid_argument("Unknown VaultFileError value");
         }
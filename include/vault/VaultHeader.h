@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "crypto/ChunkedAead.h"
+#include "crypto/CipherSuite.h"
+#include "crypto/CryptoConstants.h"
+#include "crypto/CryptoTypes.h"
+#include "util/Expected.h"
+
+namespace vault { enum class VaultFileError; }
+
+namespace vault
+{
+
+// --- Header constants ---
+constexpr uint32_t VAULT_MAGIC = 0x5641554C;
+constexpr uint8_t VAULT_VERSION_1 = 1;
+constexpr uint8_t VAULT_VERSION = 2;
+constexpr uint8_t KDF_TYPE_ARGON2ID = 1;
+
+// --- Header flags ---
+// Payload is sealed with ChunkedAead in chunk_size pieces
+constexpr uint8_t VAULT_FLAG_CHUNKED = 0x01;
+// Payload is TLV entry records (see EntryRecord.h), which carry stats and
+// times themselves; without it the payload is the fixed three-string layout.
+// 0x02 and 0x04 are unassigned.
+constexpr uint8_t VAULT_FLAG_RECORDS = 0x08;
+// Payload is a shard manifest and the entries live in shard files beside
+// the vault (see VaultShards.h)
+constexpr uint8_t VAULT_FLAG_SHARDED = 0x10;
+constexpr uint8_t VAULT_KNOWN_FLAGS =
+    VAULT_FLAG_CHUNKED | VAULT_FLAG_RECORDS | VAULT_FLAG_SHARDED;
+
+// Vaults at or below this size are sealed as one AEAD message
+constexpr std::size_t VAULT_CHUNKING_THRESHOLD = crypto::DEFAULT_CHUNK_SIZE;
+constexpr uint32_t VAULT_MAX_CHUNK_SIZE = uint32_t{1} << 26;
+
+// Large enough for the public nonce of any AEAD we may support; unused
+// trailing bytes are zero.
+constexpr std::size_t VAULT_NONCE_FIELD_SIZE = 32;
+
+// Upper bounds on header-supplied KDF costs, so a crafted header cannot make
+// load() allocate or spin without limit.
+constexpr uint32_t VAULT_MAX_ARGON_MEM_KIB = crypto_pwhash_MEMLIMIT_SENSITIVE / 1024;
+constexpr uint32_t VAULT_MAX_ARGON_ITERS = crypto_pwhash_OPSLIMIT_SENSITIVE;
+
+// v1: host-endian packed struct, kept for reading only
+constexpr std::size_t VAULT_V1_HEADER_SIZE =
+      sizeof(uint32_t) // magic
+    + sizeof(uint8_t)  // version
+    + sizeof(uint8_t)  // kdf_type
+    + sizeof(uint16_t) // reserved
+    + sizeof(uint32_t) // argon_mem_kib
+    + sizeof(uint32_t) // argon_iters
+    + sizeof(uint32_t) // argon_parallelism
+    + crypto_pwhash_SALTBYTES
+    + crypto_aead_xchacha20poly1305_ietf_NPUBBYTES;
+
+// v2: every multi-byte field is little-endian
+constexpr std::size_t VAULT_HEADER_SIZE =
+      sizeof(uint32_t) // magic
+    + sizeof(uint8_t)  // version
+    + sizeof(uint8_t)  // kdf_id
+    + sizeof(uint8_t)  // cipher_id
+    + sizeof(uint8_t)  // flags
+    + sizeof(uint32_t) // argon_mem_kib
+    + sizeof(uint32_t) // argon_iters
+    + sizeof(uint32_t) // argon_parallelism
+    + sizeof(uint32_t) // entry_count
+    + sizeof(uint64_t) // payload_length
+    + sizeof(uint32_t) // chunk_size (0 unless chunked)
+    + crypto_pwhash_SALTBYTES
+    + VAULT_NONCE_FIELD_SIZE;
+
+using HeaderBytes = std::array<uint8_t, VAULT_HEADER_SIZE>;
+
+// Decoded, in-memory form of either header version
+struct VaultHeader
+{
+    uint8_t  version = VAULT_VERSION;
+    uint8_t  kdf_id = KDF_TYPE_ARGON2ID;
+    crypto::CipherSuite cipher = crypto::CipherSuite::XChaCha20Poly1305;
+    uint8_t  flags = 0;
+
+    crypto::KdfParams kdf = crypto::DEFAULT_KDF_PARAMS;
+
+    // Hints so readers can size buffers before decrypting. v1 has neither;
+    // its payload length comes from the file size instead. entry_count is
+    // for VaultFile::inspect only; a load sizes the table from the count
+    // inside the payload.
+    uint32_t entry_count = 0;
+    uint64_t payload_length = 0;
+
+    // Plaintext bytes per chunk when VAULT_FLAG_CHUNKED is set, else 0
+    uint32_t chunk_size = 0;
+
+    std::array<uint8_t, crypto::SALT_SIZE> salt{};
+    std::array<uint8_t, VAULT_NONCE_FIELD_SIZE> nonce{};
+
+    std::span<const uint8_t> salt_view () const noexcept
+    {
+        return salt;
+    }
+
+    std::span<const uint8_t> nonce_view () const noexcept
+    {
+        return std::span<const uint8_t>(nonce).first(crypto::nonce_size(cipher));
+    }
+
+    std::span<uint8_t> nonce_span () noexcept
+    {
+        return std::span<uint8_t>(nonce).first(crypto::nonce_size(cipher));
+    }
+
+    bool chunked () const noexcept
+    {
+        return (flags & VAULT_FLAG_CHUNKED) != 0;
+    }
+
+    bool sharded () const noexcept
+    {
+        return (flags & VAULT_FLAG_SHARDED) != 0;
+    }
+
+    // Bytes occupied on disk by this header's version
+    std::size_t encoded_size () const noexcept
+    {
+        return version == VAULT_VERSION_1 ? VAULT_V1_HEADER_SIZE : VAULT_HEADER_SIZE;
+    }
+};
+
+// Always encodes the current (v2) layout
+HeaderBytes encode_header (const VaultHeader& header) noexcept;
+
+// Parses a v1 or v2 header from the start of `bytes`. Trailing bytes are
+// ignored; use encoded_size() on the result to find the payload.
+util::Expected<VaultHeader, VaultFileError> decode_header (
+    std::span<const uint8_t> bytes
+);
+
+} // namespace vault
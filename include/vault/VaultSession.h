@@ -1,10 +1,17 @@
 #pragma once
 
 #include "crypto/CryptoTypes.h"
+#include "crypto/SecureBuffer.h"
 #include "util/Expected.h"
 #include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
 #include <utility>
+#include "vault/AttachmentStore.h"
+#include "vault/BackupStore.h"
 #include "vault/Vault.h"
+#include "vault/VaultShards.h"
 #include "vault/Entry.h"
 
 namespace vault { enum class VaultError; }
@@ -19,11 +26,15 @@ class VaultSession
         VaultSession(
             Vault vault,
             crypto::ByteBuffer key,
-            std::filesystem::path path
+            std::filesystem::path path,
+            crypto::SecureBuffer scratch = {},
+            std::optional<VaultShards> shards = std::nullopt
         ) : 
         vault_(std::move(vault)),
         key_(std::move(key)),
-        path_(std::move(path))
+        path_(std::move(path)),
+        scratch_(std::move(scratch)),
+        shards_(std::move(shards))
         {}
 
         ~VaultSession();
@@ -36,16 +47,69 @@ class VaultSession
 
         // vault::Vault functions
         bool is_empty() const;
-        const std::vector<Entry>& entries () const noexcept;
-        util::Expected<void, VaultError> add_entry (Entry entry);
-        util::Expected<void, VaultError> remove_entry (size_t index);
+        const EntryTable& entries () const noexcept;
+        EntryId id_at (size_t index) const noexcept;
+        std::optional<size_t> index_of (EntryId id) const noexcept;
+        util::Expected<EntryId, VaultError> add_entry (Entry entry);
+        util::Expected<void, VaultError> update_entry (EntryId id, Entry updated);
+        util::Expected<void, VaultError> set_field (EntryId id, EntryField field, util::SecureString value);
+        util::Expected<void, VaultError> remove_entry (EntryId id);
+        bool has_entry (std::string_view name) const noexcept;
+        std::optional<EntryId> find_entry (std::string_view name) const noexcept;
+        std::vector<util::SecureString> complete_name (std::string_view prefix, size_t limit) const;
+        util::Expected<void, VaultError> record_access (EntryId id);
+        std::vector<size_t> frecent () const;
+        util::Expected<void, VaultError> add_tag (EntryId id, std::string_view tag);
+        util::Expected<void, VaultError> remove_tag (EntryId id, std::string_view tag);
+        std::vector<size_t> tagged (std::span<const std::string_view> tags) const;
+        util::Expected<void, VaultError> attach (EntryId id, std::string_view name, const Blob& blob);
+        util::Expected<void, VaultError> detach (EntryId id, std::string_view name);
 
+        // The vault's attachment store, opened on first use so that
+        // unlocking never touches it. Blobs put here are attached with
+        // attach() and read back on demand with get().
+        AttachmentStore& attachments ();
+
+        // Deletes stored blobs that no entry and no backup snapshot refers
+        // to any more. Best run after save(), so a blob detached but not yet
+        // saved away survives a crash.
+        util::Expected<size_t, VaultFileError> prune_attachments ();
+
+        // The vault's backup store, opened on first use like attachments()
+        BackupStore& backups ();
+
+        // Snapshots the vault as it is in memory, saved or not, stamped
+        // with the current time
+        util::Expected<BackupStore::Snapshot, VaultFileError> back_up ();
+
+        // A sharded vault writes only the shards whose entries changed
+        // since the last save, and nothing at all if none did
         util::Expected<void, VaultFileError> save();
 
+        bool is_sharded () const noexcept
+        {
+            return shards_.has_value();
+        }
+
+        // Wipes the entries and the keys in place, as the destructor does.
+        // The session is unusable afterwards.
+        void secure_clear ();
+
     private:
+        // Marks the shard holding `id` for the next save, if sharded
+        void touch (EntryId id) noexcept;
+
         Vault vault_;
         crypto::ByteBuffer key_;
         std::filesystem::path path_;
+        // Serialised and sealed vault, both reused by every save() so the
+        // hot path stops allocating
+        crypto::SecureBuffer plaintext_;
+        crypto::SecureBuffer scratch_;
+        // Placement and dirty shards of a sharded vault
+        std::optional<VaultShards> shards_;
+        std::optional<AttachmentStore> attachments_;
+        std::optional<BackupStore> backups_;
 };
 
 }
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "crypto/CryptoTypes.h"
+#include "crypto/SecureBuffer.h"
+#include "util/Expected.h"
+#include "vault/EntryId.h"
+
+namespace vault { enum class VaultFileError; }
+
+namespace vault
+{
+
+constexpr uint32_t VAULT_MAX_SHARDS = 1024;
+constexpr size_t SHARD_DIGEST_SIZE = 32;
+
+// --- Sharded layout ---
+// A sharded vault keeps its entries in `count` shard files under a
+// directory beside the vault file, each nonce || AEAD(records payload) with
+// the vault's salt, the shard's index and its version as associated data.
+// The vault file itself keeps its usual header, and its sealed payload is
+// the manifest: per shard, the version and entry count last written and a
+// BLAKE2b digest of the shard file. Loading opens only the files the
+// manifest names and refuses any whose digest differs, so an old shard
+// cannot be rolled back in and shards cannot be mixed between saves. (An
+// old manifest together with its own old shards is a consistent earlier
+// vault and cannot be told apart locally.)
+//
+// Entries are placed by a keyed hash of their name when added and stay in
+// that shard for life. Changing an entry marks its shard dirty, and a save
+// rewrites only dirty shards, each under a new version, before replacing
+// the manifest; the old versions are deleted afterwards, so a crash at any
+// point leaves a manifest whose shards all exist.
+class VaultShards
+{
+    public:
+        // One shard as the manifest records it. Version 0 has never been
+        // written: it has no file and no entries.
+        struct Shard
+        {
+            uint64_t version = 0;
+            uint32_t entry_count = 0;
+            std::array<uint8_t, SHARD_DIGEST_SIZE> digest{};
+        };
+
+        // `vault_key` is the vault's KEY_SIZE-byte key, from which the
+        // placement hash key is derived
+        VaultShards (uint32_t count, std::span<const uint8_t> vault_key);
+
+        // Where the shard files of the vault at `vault_path` live
+        static std::filesystem::path directory (const std::filesystem::path& vault_path);
+
+        static std::filesystem::path file (
+            const std::filesystem::path& vault_path,
+            uint32_t shard,
+            uint64_t version
+        );
+
+        uint32_t count () const noexcept
+        {
+            return static_cast<uint32_t>(shards_.size());
+        }
+
+        const Shard& operator[] (uint32_t shard) const noexcept { return shards_[shard]; }
+        Shard& operator[] (uint32_t shard) noexcept { return shards_[shard]; }
+
+        // The shard a new entry named `name` belongs in
+        uint32_t home_of (std::string_view name) const noexcept;
+
+        void place (EntryId id, uint32_t shard);
+
+        // Forgets `id`, which must have been placed, and marks its shard
+        // dirty
+        void remove (EntryId id) noexcept;
+
+        uint32_t shard_of (EntryId id) const noexcept
+        {
+            return by_slot_[id.slot()].shard;
+        }
+
+        // The entries placed in `shard`, in no particular order, so a save
+        // finds a dirty shard's rows without walking the whole vault
+        std::span<const EntryId> members (uint32_t shard) const noexcept
+        {
+            return members_[shard];
+        }
+
+        // Marks the shard holding `id`, which must have been placed
+        void mark_dirty (EntryId id) noexcept
+        {
+            dirty_[shard_of(id)] = true;
+        }
+
+        bool dirty (uint32_t shard) const noexcept
+        {
+            return dirty_[shard];
+        }
+
+        bool any_dirty () const noexcept;
+        void clear_dirty () noexcept;
+
+        // varint count, then per shard a varint version, a varint entry
+        // count and the digest
+        crypto::ByteBuffer encode_manifest () const;
+
+        static util::Expected<VaultShards, VaultFileError> decode_manifest (
+            std::span<const uint8_t> manifest,
+            std::span<const uint8_t> vault_key
+        );
+
+    private:
+        struct Placement
+        {
+            uint32_t shard = 0;
+            uint32_t position = 0;  // in members_[shard]
+        };
+
+        std::vector<Shard> shards_;
+        // Placement of each EntryId slot; a reused slot is placed afresh
+        std::vector<Placement> by_slot_;
+        std::vector<std::vector<EntryId>> members_;
+        std::vector<bool> dirty_;
+        crypto::SecureBuffer placement_key_;
+};
+
+} // namespace vault
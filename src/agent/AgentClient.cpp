@@ -0,0 +1,208 @@
+#include "agent/AgentClient.h"
+#include "util/ByteOrder.h"
+
+#include <array>
+#include <cerrno>
+#include <iterator>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <utility>
+
+namespace agent
+{
+
+namespace
+{
+
+util::SecureString copy_of (const util::SecureString& str)
+{
+    return util::SecureString(std::string_view(str.c_str(), str.size()));
+}
+
+util::Expected<void, AgentError> check_status (uint8_t code)
+{
+    switch (static_cast<Status>(code))
+    {
+        case Status::Ok:
+        case Status::More:
+            return {};
+        case Status::NotFound:
+            return AgentError::EntryNotFound;
+        case Status::Duplicate:
+            return AgentError::DuplicateEntry;
+        case Status::SaveFailed:
+            return AgentError::SaveFailed;
+        case Status::BadRequest:
+            break;
+    }
+    return AgentError::ProtocolError;
+}
+
+} // unnamed namespace
+
+util::Expected<AgentClient, AgentError> AgentClient::connect (
+    const std::filesystem::path& socket_path
+)
+{
+    auto addr = socket_address(socket_path);
+    if (!addr)
+    {
+        return addr.error();
+    }
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return AgentError::SocketError;
+    }
+
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr.value()), sizeof(sockaddr_un)) != 0)
+    {
+        const int err = errno;
+        ::close(fd);
+        return err == ENOENT || err == ECONNREFUSED
+            ? AgentError::NotRunning
+            : AgentError::SocketError;
+    }
+
+    // Never hand a master-password-protected secret to another user's agent
+    ucred cred{};
+    socklen_t len = sizeof(cred);
+    if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0 || cred.uid != ::geteuid())
+    {
+        ::close(fd);
+        return AgentError::PermissionDenied;
+    }
+
+    return AgentClient(fd);
+}
+
+AgentClient::AgentClient (AgentClient&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1))
+    , buffer_(std::move(other.buffer_))
+{}
+
+AgentClient::~AgentClient ()
+{
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+    }
+}
+
+util::Expected<vault::Entry, AgentError> AgentClient::get (const util::SecureString& name)
+{
+    Message message;
+    message.code = static_cast<uint8_t>(Command::Get);
+    message.fields.push_back(copy_of(name));
+
+    auto response = request(message);
+    if (!response)
+    {
+        return response.error();
+    }
+
+    auto& fields = response.value().fields;
+    if (fields.size() != 3)
+    {
+        return AgentError::ProtocolError;
+    }
+    return vault::Entry(std::move(fields[0]), std::move(fields[1]), std::move(fields[2]));
+}
+
+util::Expected<std::vector<util::SecureString>, AgentError> AgentClient::list ()
+{
+    // One page per frame, each asking for the names after the last
+    std::vector<util::SecureString> names;
+    for (;;)
+    {
+        std::array<uint8_t, sizeof(uint32_t)> first{};
+        util::store(static_cast<uint32_t>(names.size()), std::span<uint8_t, sizeof(uint32_t)>(first));
+
+        Message message;
+        message.code = static_cast<uint8_t>(Command::List);
+        message.fields.emplace_back(std::string_view(reinterpret_cast<const char*>(first.data()), first.size()));
+
+        auto response = request(message);
+        if (!response)
+        {
+            return response.error();
+        }
+        auto& page = response.value().fields;
+        const bool more = response.value().code == static_cast<uint8_t>(Status::More);
+        if (more && page.empty())
+        {
+            return AgentError::ProtocolError;
+        }
+        names.insert(names.end(), std::make_move_iterator(page.begin()), std::make_move_iterator(page.end()));
+        if (!more)
+        {
+            return names;
+        }
+    }
+}
+
+util::Expected<void, AgentError> AgentClient::add (const vault::Entry& entry)
+{
+    Message message;
+    message.code = static_cast<uint8_t>(Command::Add);
+    message.fields.push_back(copy_of(entry.name));
+    message.fields.push_back(copy_of(entry.username));
+    message.fields.push_back(copy_of(entry.secret));
+
+    auto response = request(message);
+    if (!response)
+    {
+        return response.error();
+    }
+    return {};
+}
+
+util::Expected<void, AgentError> AgentClient::lock ()
+{
+    Message message;
+    message.code = static_cast<uint8_t>(Command::Lock);
+
+    auto response = request(message);
+    if (!response)
+    {
+        return response.error();
+    }
+    return {};
+}
+
+util::Expected<Message, AgentError> AgentClient::request (const Message& message)
+{
+    encode_message(message, buffer_);
+    auto sent = write_frame(fd_, buffer_);
+    buffer_.clear();
+    if (!sent)
+    {
+        return sent.error();
+    }
+
+    auto received = read_frame(fd_, buffer_);
+    if (!received)
+    {
+        buffer_.clear();
+        return received.error();
+    }
+
+    auto response = decode_message(buffer_);
+    buffer_.clear();
+    if (!response)
+    {
+        return response.error();
+    }
+
+    auto status = check_status(response.value().code);
+    if (!status)
+    {
+        return status.error();
+    }
+    return response;
+}
+
+} // namespace agent
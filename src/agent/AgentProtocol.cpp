@@ -0,0 +1,234 @@
+#include "agent/AgentProtocol.h"
+#include "util/ByteOrder.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <poll.h>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace agent
+{
+
+namespace
+{
+
+constexpr std::size_t LENGTH_SIZE = sizeof(uint32_t);
+
+// Smallest field on the wire: an empty string's length prefix
+constexpr std::size_t MIN_FIELD_SIZE = LENGTH_SIZE;
+
+void put_u32 (uint32_t value, uint8_t*& cursor)
+{
+    util::store(value, std::span<uint8_t, sizeof(uint32_t)>(cursor, sizeof(uint32_t)));
+    cursor += sizeof(uint32_t);
+}
+
+// Waits for `events` on `fd`, giving up at `deadline`
+util::Expected<void, AgentError> wait_for (int fd, short events, FrameDeadline deadline)
+{
+    int timeout = -1;
+    if (deadline != NO_DEADLINE)
+    {
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()
+        );
+        if (left.count() <= 0)
+        {
+            return AgentError::TimedOut;
+        }
+        timeout = static_cast<int>(std::min<std::chrono::milliseconds::rep>(
+            left.count(),
+            std::numeric_limits<int>::max()
+        ));
+    }
+
+    pollfd pfd{ fd, events, 0 };
+    const int ready = ::poll(&pfd, 1, timeout);
+    if (ready < 0 && errno != EINTR)
+    {
+        return AgentError::ConnectionClosed;
+    }
+    if (ready == 0)
+    {
+        return AgentError::TimedOut;
+    }
+    return {};
+}
+
+bool would_block ()
+{
+    return errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+util::Expected<void, AgentError> read_exact (
+    int fd,
+    std::span<uint8_t> out,
+    FrameDeadline deadline
+)
+{
+    while (!out.empty())
+    {
+        const ssize_t got = ::recv(fd, out.data(), out.size(), MSG_DONTWAIT);
+        if (got < 0 && would_block())
+        {
+            auto ready = wait_for(fd, POLLIN, deadline);
+            if (!ready)
+            {
+                return ready.error();
+            }
+            continue;
+        }
+        if (got <= 0)
+        {
+            return AgentError::ConnectionClosed;
+        }
+        out = out.subspan(static_cast<std::size_t>(got));
+    }
+    return {};
+}
+
+} // unnamed namespace
+
+void encode_message (const Message& message, crypto::SecureBuffer& out)
+{
+    std::size_t body_size = sizeof(uint8_t) + LENGTH_SIZE;
+    for (const auto& field : message.fields)
+    {
+        body_size += LENGTH_SIZE + field.size();
+    }
+
+    out.resize(LENGTH_SIZE + body_size);
+    uint8_t* cursor = out.data();
+
+    put_u32(static_cast<uint32_t>(body_size), cursor);
+    *cursor++ = message.code;
+    put_u32(static_cast<uint32_t>(message.fields.size()), cursor);
+
+    for (const auto& field : message.fields)
+    {
+        put_u32(static_cast<uint32_t>(field.size()), cursor);
+        std::copy(field.data(), field.data() + field.size(), cursor);
+        cursor += field.size();
+    }
+}
+
+util::Expected<Message, AgentError> decode_message (std::span<const uint8_t> body)
+{
+    util::ByteReader reader(body);
+
+    Message message;
+    uint32_t count = 0;
+    if (!reader.read(message.code) || !reader.read(count) ||
+        count > reader.remaining() / MIN_FIELD_SIZE)
+    {
+        return AgentError::ProtocolError;
+    }
+
+    message.fields.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t len = 0;
+        std::span<const uint8_t> bytes;
+        if (!reader.read(len) || !reader.read_bytes(len, bytes))
+        {
+            return AgentError::ProtocolError;
+        }
+
+        message.fields.emplace_back(std::string_view(
+            reinterpret_cast<const char*>(bytes.data()),
+            bytes.size()
+        ));
+    }
+
+    if (!reader.at_end())
+    {
+        return AgentError::ProtocolError;
+    }
+    return message;
+}
+
+util::Expected<void, AgentError> write_frame (
+    int fd,
+    std::span<const uint8_t> frame,
+    FrameDeadline deadline
+)
+{
+    while (!frame.empty())
+    {
+        const ssize_t sent = ::send(fd, frame.data(), frame.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0 && would_block())
+        {
+            auto ready = wait_for(fd, POLLOUT, deadline);
+            if (!ready)
+            {
+                return ready.error();
+            }
+            continue;
+        }
+        if (sent <= 0)
+        {
+            return AgentError::ConnectionClosed;
+        }
+        frame = frame.subspan(static_cast<std::size_t>(sent));
+    }
+    return {};
+}
+
+util::Expected<void, AgentError> read_frame (
+    int fd,
+    crypto::SecureBuffer& body,
+    FrameDeadline deadline
+)
+{
+    std::array<uint8_t, LENGTH_SIZE> prefix{};
+    auto header = read_exact(fd, prefix, deadline);
+    if (!header)
+    {
+        return header.error();
+    }
+
+    const uint32_t length = util::load<uint32_t>(std::span<const uint8_t, LENGTH_SIZE>(prefix));
+    if (length > MAX_FRAME_SIZE)
+    {
+        return AgentError::ProtocolError;
+    }
+
+    body.resize(length);
+    return read_exact(fd, body, deadline);
+}
+
+std::filesystem::path default_socket_path ()
+{
+    if (const char* explicit_path = std::getenv("VAULT_AGENT_SOCK"); explicit_path && *explicit_path)
+    {
+        return explicit_path;
+    }
+    if (const char* runtime_dir = std::getenv("XDG_RUNTIME_DIR"); runtime_dir && *runtime_dir)
+    {
+        return std::filesystem::path(runtime_dir) / "vault-agent.sock";
+    }
+    return std::filesystem::path("/tmp") / ("vault-agent-" + std::to_string(::getuid())) / "agent.sock";
+}
+
+util::Expected<sockaddr_un, AgentError> socket_address (const std::filesystem::path& path)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+
+    const std::string& native = path.native();
+    if (native.empty() || native.size() >= sizeof(addr.sun_path))
+    {
+        return AgentError::SocketError;
+    }
+    std::memcpy(addr.sun_path, native.c_str(), native.size() + 1);
+    return addr;
+}
+
+} // namespace agent
@@ -0,0 +1,449 @@
+#include "agent/AgentServer.h"
+#include "util/ByteOrder.h"
+#include "vault/Entry.h"
+#include "vault/VaultError.h"
+#include "vault/VaultFileError.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <poll.h>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace agent
+{
+
+namespace
+{
+
+// Longest a connected client may take to send a request frame or to
+// take its response, before it is dropped. run() is single-threaded, so
+// this bounds how far one client can push back the idle lock.
+constexpr std::chrono::milliseconds CLIENT_FRAME_TIMEOUT{1000};
+
+Message status_only (Status status)
+{
+    Message message;
+    message.code = static_cast<uint8_t>(status);
+    return message;
+}
+
+// A u32 field, as List's first index is sent
+bool parse_index (const util::SecureString& field, size_t& index)
+{
+    if (field.size() != sizeof(uint32_t))
+    {
+        return false;
+    }
+    const auto* bytes = reinterpret_cast<const uint8_t*>(field.c_str());
+    index = util::load<uint32_t>(std::span<const uint8_t, sizeof(uint32_t)>(bytes, sizeof(uint32_t)));
+    return true;
+}
+
+// The socket's directory must not let another user swap the socket out.
+// A missing directory is created owner-only; an existing one is checked
+// without following symlinks, so a name planted by someone else fails.
+bool directory_is_private (const std::filesystem::path& dir)
+{
+    const char* path = dir.empty() ? "." : dir.c_str();
+    if (::mkdir(path, 0700) != 0 && errno != EEXIST)
+    {
+        return false;
+    }
+
+    struct stat st{};
+    if (::lstat(path, &st) != 0 || !S_ISDIR(st.st_mode))
+    {
+        return false;
+    }
+
+    const bool trusted_owner = st.st_uid == ::geteuid() || st.st_uid == 0;
+    const bool others_can_write = (st.st_mode & (S_IWGRP | S_IWOTH)) != 0;
+
+    return trusted_owner && !others_can_write;
+}
+
+bool peer_is_same_user (int fd)
+{
+    ucred cred{};
+    socklen_t len = sizeof(cred);
+    if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0)
+    {
+        return false;
+    }
+    return cred.uid == ::geteuid();
+}
+
+// Removes a socket left behind by an agent that is no longer running.
+// Anything else at the path is left alone.
+util::Expected<void, AgentError> clear_stale_socket (
+    const std::filesystem::path& path,
+    const sockaddr_un& addr
+)
+{
+    struct stat st{};
+    if (::lstat(path.c_str(), &st) != 0)
+    {
+        return errno == ENOENT
+            ? util::Expected<void, AgentError>{}
+            : util::Expected<void, AgentError>{AgentError::SocketError};
+    }
+    if (!S_ISSOCK(st.st_mode) || st.st_uid != ::geteuid())
+    {
+        return AgentError::PermissionDenied;
+    }
+
+    const int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe < 0)
+    {
+        return AgentError::SocketError;
+    }
+    const bool live = ::connect(probe, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+    ::close(probe);
+
+    if (live)
+    {
+        return AgentError::AlreadyRunning;
+    }
+    if (::unlink(path.c_str()) != 0)
+    {
+        return AgentError::SocketError;
+    }
+    return {};
+}
+
+} // unnamed namespace
+
+void AgentServer::harden_process () noexcept
+{
+    ::prctl(PR_SET_DUMPABLE, 0, 0, 0, 0);
+
+    const rlimit no_core{0, 0};
+    ::setrlimit(RLIMIT_CORE, &no_core);
+
+    // With a finite limit MCL_FUTURE would make later allocations fail
+    // once it is reached, so only lock everything when it is unlimited
+    rlimit memlock{};
+    if (::getrlimit(RLIMIT_MEMLOCK, &memlock) == 0 && memlock.rlim_cur == RLIM_INFINITY)
+    {
+        ::mlockall(MCL_CURRENT | MCL_FUTURE);
+    }
+}
+
+util::Expected<AgentServer, AgentError> AgentServer::listen (
+    std::filesystem::path socket_path,
+    vault::VaultSession session,
+    std::chrono::milliseconds idle_timeout
+)
+{
+    auto addr = socket_address(socket_path);
+    if (!addr)
+    {
+        return addr.error();
+    }
+
+    if (!directory_is_private(socket_path.parent_path()))
+    {
+        return AgentError::PermissionDenied;
+    }
+
+    auto cleared = clear_stale_socket(socket_path, addr.value());
+    if (!cleared)
+    {
+        return cleared.error();
+    }
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return AgentError::SocketError;
+    }
+
+    // Created owner-only from the start, so there is no window in which
+    // another user could connect
+    const mode_t old_mask = ::umask(0177);
+    const int bound = ::bind(fd, reinterpret_cast<const sockaddr*>(&addr.value()), sizeof(sockaddr_un));
+    ::umask(old_mask);
+
+    if (bound != 0 || ::listen(fd, SOMAXCONN) != 0)
+    {
+        ::close(fd);
+        return AgentError::SocketError;
+    }
+
+    return AgentServer(fd, std::move(socket_path), std::move(session), idle_timeout);
+}
+
+AgentServer::AgentServer (
+    int listen_fd,
+    std::filesystem::path socket_path,
+    vault::VaultSession session,
+    std::chrono::milliseconds idle_timeout
+)
+    : listen_fd_(listen_fd)
+    , socket_path_(std::move(socket_path))
+    , session_(std::move(session))
+    , idle_timeout_(idle_timeout)
+{}
+
+AgentServer::AgentServer (AgentServer&& other) noexcept
+    : listen_fd_(std::exchange(other.listen_fd_, -1))
+    , socket_path_(std::move(other.socket_path_))
+    , session_(std::move(other.session_))
+    , idle_timeout_(other.idle_timeout_)
+    , access_unsaved_(std::exchange(other.access_unsaved_, false))
+    , clients_(std::move(other.clients_))
+    , request_buffer_(std::move(other.request_buffer_))
+    , response_buffer_(std::move(other.response_buffer_))
+{
+    other.session_.reset();
+    other.clients_.clear();
+}
+
+AgentServer::~AgentServer ()
+{
+    lock();
+
+    for (int fd : clients_)
+    {
+        ::close(fd);
+    }
+
+    if (listen_fd_ >= 0)
+    {
+        ::close(listen_fd_);
+        ::unlink(socket_path_.c_str());
+    }
+}
+
+util::Expected<void, AgentError> AgentServer::run ()
+{
+    using clock = std::chrono::steady_clock;
+    auto last_request = clock::now();
+
+    std::vector<pollfd> fds;
+    while (session_)
+    {
+        const auto idle = std::chrono::duration_cast<std::chrono::milliseconds>(
+            clock::now() - last_request
+        );
+        if (idle >= idle_timeout_)
+        {
+            lock();
+            break;
+        }
+
+        fds.clear();
+        fds.push_back({ listen_fd_, POLLIN, 0 });
+        for (int fd : clients_)
+        {
+            fds.push_back({ fd, POLLIN, 0 });
+        }
+
+        // poll takes an int of milliseconds; a long --idle must not wrap
+        const auto remaining = static_cast<int>(std::min<std::chrono::milliseconds::rep>(
+            (idle_timeout_ - idle).count(),
+            std::numeric_limits<int>::max()
+        ));
+        const int ready = ::poll(fds.data(), fds.size(), remaining);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            lock();
+            return AgentError::SocketError;
+        }
+
+        // Serve existing clients before accepting, since accepting changes clients_
+        for (std::size_t i = 1; i < fds.size() && session_; ++i)
+        {
+            if ((fds[i].revents & (POLLIN | POLLHUP | POLLERR)) == 0)
+            {
+                continue;
+            }
+
+            if (serve_client(fds[i].fd))
+            {
+                last_request = clock::now();
+            }
+            else
+            {
+                ::close(fds[i].fd);
+                clients_.erase(std::find(clients_.begin(), clients_.end(), fds[i].fd));
+            }
+        }
+
+        if (session_ && (fds[0].revents & POLLIN))
+        {
+            accept_client();
+        }
+    }
+
+    return {};
+}
+
+void AgentServer::accept_client ()
+{
+    const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    if (!peer_is_same_user(fd))
+    {
+        ::close(fd);
+        return;
+    }
+
+    clients_.push_back(fd);
+}
+
+bool AgentServer::serve_client (int fd)
+{
+    // Kept well under the idle timeout, which a stalled frame would overrun
+    const auto frame_timeout = std::min(CLIENT_FRAME_TIMEOUT, idle_timeout_ / 4);
+
+    auto received = read_frame(fd, request_buffer_, std::chrono::steady_clock::now() + frame_timeout);
+    if (!received)
+    {
+        request_buffer_.clear();
+        return false;
+    }
+
+    auto request = decode_message(request_buffer_);
+    request_buffer_.clear();
+
+    const Message response = request
+        ? handle(std::move(request.value()))
+        : status_only(Status::BadRequest);
+
+    encode_message(response, response_buffer_);
+    auto sent = write_frame(fd, response_buffer_, std::chrono::steady_clock::now() + frame_timeout);
+    response_buffer_.clear();
+
+    return static_cast<bool>(sent);
+}
+
+Message AgentServer::handle (Message request)
+{
+    auto& fields = request.fields;
+
+    switch (static_cast<Command>(request.code))
+    {
+        case Command::Get:
+        {
+            if (fields.size() != 1)
+            {
+                break;
+            }
+
+            const auto id = session_->find_entry(std::string_view(fields[0].c_str(), fields[0].size()));
+            if (!id)
+            {
+                return status_only(Status::NotFound);
+            }
+
+            // A fetch through the agent is a use like any other; it reaches
+            // disk with the next save, or when the agent locks
+            if (session_->record_access(*id))
+            {
+                access_unsaved_ = true;
+            }
+            const auto& entries = session_->entries();
+            const size_t index = *session_->index_of(*id);
+            Message response = status_only(Status::Ok);
+            response.fields.emplace_back(entries.name(index));
+            response.fields.emplace_back(entries.username(index));
+            response.fields.emplace_back(entries.secret(index));
+            return response;
+        }
+        case Command::List:
+        {
+            // Optional field: the index of the first name wanted
+            size_t first = 0;
+            if (fields.size() > 1 || (fields.size() == 1 && !parse_index(fields[0], first)))
+            {
+                break;
+            }
+
+            // As many names as fit in one frame; More tells the client to
+            // ask again from where this page ends
+            const auto& names = session_->entries().names();
+            Message response = status_only(Status::Ok);
+            size_t body_size = MESSAGE_HEADER_SIZE;
+            for (size_t i = first; i < names.size(); ++i)
+            {
+                const size_t field_size = FIELD_HEADER_SIZE + names[i].size();
+                if (body_size + field_size > MAX_FRAME_SIZE)
+                {
+                    // A name that cannot fit even alone would stall the client
+                    if (response.fields.empty())
+                    {
+                        return status_only(Status::BadRequest);
+                    }
+                    response.code = static_cast<uint8_t>(Status::More);
+                    break;
+                }
+                body_size += field_size;
+                response.fields.emplace_back(names[i]);
+            }
+            return response;
+        }
+        case Command::Add:
+        {
+            if (fields.size() != 3)
+            {
+                break;
+            }
+
+            auto added = session_->add_entry(vault::Entry(
+                std::move(fields[0]),
+                std::move(fields[1]),
+                std::move(fields[2])
+            ));
+            if (!added)
+            {
+                return status_only(Status::Duplicate);
+            }
+
+            // Keep memory and disk in step: an entry that failed to save is dropped
+            if (!session_->save())
+            {
+                session_->remove_entry(added.value());
+                return status_only(Status::SaveFailed);
+            }
+            access_unsaved_ = false;
+            return status_only(Status::Ok);
+        }
+        case Command::Lock:
+            lock();
+            return status_only(Status::Ok);
+    }
+
+    return status_only(Status::BadRequest);
+}
+
+void AgentServer::lock ()
+{
+    // Best effort: a failed save loses only usage counts, and locking
+    // must happen regardless
+    if (session_ && access_unsaved_)
+    {
+        session_->save();
+    }
+    access_unsaved_ = false;
+    session_.reset();
+}
+
+} // namespace agent
@@ -16,41 +16,66 @@
 #include <chrono>
 #include <filesystem>
 #include <memory>
+#include <optional>
 #include <random>
+#include <string_view>
 
 namespace app
 {
 
-Application::Application(std::string vault_path)
+namespace
+{
+
+// Completions offered while typing an entry name
+constexpr size_t NAME_HINTS = 5;
+
+// Completions and duplicate warnings come from the vault's name trie
+ui::NameHinter name_hinter(const vault::VaultSession& session)
+{
+    return [&session](std::string_view typed)
+    {
+        return ui::NameHints{
+            session.complete_name(typed, NAME_HINTS),
+            session.has_entry(typed)
+        };
+    };
+}
+
+} // unnamed namespace
+
+Application::Application(
+    std::string vault_path,
+    std::unique_ptr<ui::UserInterface> ui
+)
     : vault_path_(std::move(vault_path))
+    , ui_(ui ? std::move(ui) : std::make_unique<ui::TerminalUI>())
 {}
 
 void Application::run(Application& app)
 {
     crypto::CryptoContext::init();
-    ui_.initialize();
-    ui_.display_logo();
+    ui_->display_logo();
     
     current_state_ = std::make_unique<BootstrapState>();
     if (auto next = current_state_->on_enter(*this))
     {
-        ui_.show_message("Existing vault found");
+        ui_->show_message("Existing vault found");
         current_state_ = std::move(next);
     }
     else 
     {
-        ui_.show_message("No vault found. Please create a vault to continue");
+        ui_->show_message("No vault found. Please create a vault to continue");
     }
 
     while (running_)
     {
         auto options = current_state_->menu_options();
 
-        Action action = ui_.prompt_action(options);
+        Action action = ui_->prompt_action(options);
 
         if (!current_state_->allows(action))
         {
-            ui_.show_error("Action not allowed in current state");
+            ui_->show_error("Action not allowed in current state");
             continue;
         }
 
@@ -76,6 +101,9 @@ bool Application::handle_action(Action action)
         case Action::RemoveEntry:
             result = handle_remove_entry();
             break;
+        case Action::EditEntry:
+            result = handle_edit_entry();
+            break;
         case Action::ListEntries:
             result = handle_list_entries();
             break;
@@ -115,39 +143,54 @@ void Application::change_state(std::unique_ptr<State> new_state)
 
 bool Application::handle_create_vault()
 {
-    auto password = ui_.prompt_master_password();
+    auto password = ui_->prompt_master_password();
 
-    ui_.display_loading();
+    ui_->display_loading();
     auto result = vault::VaultFile::create_new(
         vault_path_,
         std::move(password.value())
     );
-    ui_.wipe_loading();
+    ui_->wipe_loading();
 
     if (!result)
     {
-        ui_.show_error(vault::to_string(result.error()));
+        ui_->show_error(vault::to_string(result.error()));
         return false;
     }
 
-    ui_.show_message("Vault created successfully");
+    ui_->show_message("Vault created successfully");
     return true;
 }
 
 bool Application::handle_unlock()
 {
-    auto password = ui_.prompt_master_password();
-    ui_.display_loading();
-    auto loaded = vault::VaultFile::load(vault_path_, std::move(password.value()));
-    ui_.wipe_loading();
+    // With VAULT_KEY_CACHE_TTL set, a key cached by an earlier unlock in
+    // this session skips both the prompt and the KDF
+    auto prompt = [this]() -> std::optional<util::SecureString>
+    {
+        auto password = ui_->prompt_master_password();
+        if (!password)
+        {
+            return std::nullopt;
+        }
+        ui_->display_loading();
+        return std::move(password.value());
+    };
+
+    auto loaded = vault::VaultFile::load(
+        vault_path_,
+        prompt,
+        vault::KeyCacheOptions::from_environment()
+    );
+    ui_->wipe_loading();
     if (!loaded)
     {
-        ui_.show_error(vault::to_string(loaded.error()));
+        ui_->show_error(vault::to_string(loaded.error()));
         return false;
     }
 
     session_.emplace(std::move(loaded.value()));
-    ui_.show_message("Vault Unlocked");
+    ui_->show_message("Vault Unlocked");
     return true;
 }
 
@@ -204,14 +247,14 @@ bool Application::handle_add_entry()
 {
     if (!session_)
     {
-        ui_.show_error("Vault not unlocked");
+        ui_->show_error("Vault not unlocked");
         return false;
     }
 
-    auto name = ui_.prompt_input("Name");
-    auto username = ui_.prompt_input("Username/Email");
-    bool generate_password = ui_.generate_password();
-    auto password = generate_password ? handle_generate_password() : ui_.prompt_input("Password");
+    auto name = ui_->prompt_input("Name", name_hinter(*session_));
+    auto username = ui_->prompt_input("Username/Email");
+    bool generate_password = ui_->generate_password();
+    auto password = generate_password ? handle_generate_password() : ui_->prompt_input("Password");
     if (!name || !username || !password)
     {
         return false;
@@ -226,11 +269,11 @@ bool Application::handle_add_entry()
     auto result = session_->add_entry(std::move(new_entry));
     if (!result)
     {
-        ui_.show_error(vault::to_string(static_cast<vault::VaultError>(result.error())));
+        ui_->show_error(vault::to_string(static_cast<vault::VaultError>(result.error())));
         return false;
     }
 
-    ui_.show_message("Entry added successfully");
+    ui_->show_message("Entry added successfully");
     return true;
 }
 
@@ -238,24 +281,76 @@ bool Application::handle_remove_entry()
 {
     if (!session_)
     {
-        ui_.show_error("Vault not unlocked");
+        ui_->show_error("Vault not unlocked");
+        return false;
+    }
+
+    auto index = ui_->remove_entry(session_->entries());
+    if (!index || index.value() >= session_->entries().size())
+    {
+        return false;
+    }
+
+    auto result = session_->remove_entry(session_->id_at(index.value()));
+    if (!result)
+    {
+        ui_->show_error(vault::to_string(result.error()));
+        return false;
+    }
+
+    ui_->show_message("Entry successfully deleted");
+    return true;
+}
+
+bool Application::handle_edit_entry()
+{
+    if (!session_)
+    {
+        ui_->show_error("Vault not unlocked");
+        return false;
+    }
+
+    auto index = ui_->select_entry(session_->entries());
+    if (!index || index.value() >= session_->entries().size())
+    {
+        return false;
+    }
+    // The id, not the index, is held across the prompts below
+    const vault::EntryId id = session_->id_at(index.value());
+
+    auto field = ui_->select_field(session_->entries()[index.value()]);
+    if (!field)
+    {
         return false;
     }
 
-    auto index = ui_.remove_entry(session_->entries());
-    if (!index)
+    // Only the chosen field is asked for and replaced
+    auto value = [&]() -> util::Expected<util::SecureString, std::string>
+    {
+        switch (field.value())
+        {
+            case vault::EntryField::Name:
+                return ui_->prompt_input("Name", name_hinter(*session_));
+            case vault::EntryField::Username:
+                return ui_->prompt_input("Username/Email");
+            case vault::EntryField::Secret:
+            default:
+                return ui_->generate_password() ? handle_generate_password() : ui_->prompt_input("Password");
+        }
+    }();
+    if (!value)
     {
         return false;
     }
 
-    auto result = session_->remove_entry(index.value());
+    auto result = session_->set_field(id, field.value(), std::move(value.value()));
     if (!result)
     {
-        ui_.show_error(vault::to_string(result.error()));
+        ui_->show_error(vault::to_string(result.error()));
         return false;
     }
 
-    ui_.show_message("Entry successfully deleted");
+    ui_->show_message("Entry updated successfully");
     return true;
 }
 
@@ -263,17 +358,20 @@ bool Application::handle_list_entries()
 {
     if (!session_)
     {
-        ui_.show_error("Vault not unlocked");
+        ui_->show_error("Vault not unlocked");
         return false;
     }
 
     if(session_->entries().size() < 1)
     {
-        ui_.show_message("No entries");
+        ui_->show_message("No entries");
         return false;
     }
 
-    ui_.list_entries(session_->entries());
+    for (const size_t index : ui_->list_entries(session_->entries(), session_->frecent()))
+    {
+        session_->record_access(session_->id_at(index));
+    }
     return true;
 }
 
@@ -281,20 +379,20 @@ bool Application::handle_save_only()
 {
     if (!session_)
     {
-        ui_.show_error("Vault not unlocked");
+        ui_->show_error("Vault not unlocked");
         return false;
     }
 
-    ui_.display_loading();
+    ui_->display_loading();
     auto result = session_->save();
-    ui_.wipe_loading();
+    ui_->wipe_loading();
     if (!result)
     {
-        ui_.show_error(vault::to_string(result.error()));
+        ui_->show_error(vault::to_string(result.error()));
         return false;
     }
 
-    ui_.show_message("Vault Saved");
+    ui_->show_message("Vault Saved");
     return true;
 }
 
@@ -302,27 +400,27 @@ bool Application::handle_save_and_close()
 {
     if (!session_)
     {
-        ui_.show_error("Vault not unlocked");
+        ui_->show_error("Vault not unlocked");
         return false;
     }
 
-    ui_.display_loading();
+    ui_->display_loading();
     auto result = session_->save();
-    ui_.wipe_loading();
+    ui_->wipe_loading();
     if (!result)
     {
-        ui_.show_error(vault::to_string(result.error()));
+        ui_->show_error(vault::to_string(result.error()));
         return false;
     }
 
     session_.reset();
-    ui_.show_message("Vault Saved and Closed");
+    ui_->show_message("Vault Saved and Closed");
     return true;
 }
 
 bool Application::handle_quit()
 {
-    ui_.show_message("Quitting");
+    ui_->show_message("Quitting");
 
     session_.reset();
     running_ = false;
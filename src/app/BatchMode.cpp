@@ -0,0 +1,386 @@
+#include "app/BatchMode.h"
+#include "crypto/SecureBuffer.h"
+#include "util/Json.h"
+#include "util/SecureString.h"
+#include "vault/Entry.h"
+#include "vault/VaultError.h"
+#include "vault/VaultFileError.h"
+#include "vault/VaultSession.h"
+
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <sodium/utils.h>
+
+namespace app
+{
+
+namespace
+{
+
+// Initial room for a command line; longer ones grow the locked buffer
+constexpr size_t LINE_RESERVE = 4096;
+
+// Everything in a "get" result besides the escaped values: keys, quotes,
+// commas, brackets and a tag separator per tag at worst
+constexpr size_t RESULT_OVERHEAD = 128;
+
+std::string_view view (const util::SecureString& s) noexcept
+{
+    return std::string_view(s.c_str(), s.size());
+}
+
+util::SecureString copy_of (const util::SecureString& s)
+{
+    return util::SecureString(view(s));
+}
+
+// "a,b" -> { "a", "b" }; tags are not secret, so plain strings are fine
+std::vector<std::string_view> split_tags (std::string_view list)
+{
+    std::vector<std::string_view> tags;
+    while (!list.empty())
+    {
+        const size_t comma = list.find(',');
+        tags.push_back(list.substr(0, comma));
+        if (comma == std::string_view::npos)
+        {
+            break;
+        }
+        list.remove_prefix(comma + 1);
+    }
+    return tags;
+}
+
+void wipe (std::string& s) noexcept
+{
+    sodium_memzero(s.data(), s.size());
+    s.clear();
+}
+
+// Reads one line, without its newline, into locked memory that wipes what
+// it leaves behind whenever it grows. False at the end of the input.
+bool read_line (std::istream& in, crypto::SecureBuffer& line)
+{
+    line.clear();
+    std::streambuf* buffer = in.rdbuf();
+    for (;;)
+    {
+        const auto c = buffer->sbumpc();
+        if (c == std::char_traits<char>::eof())
+        {
+            in.setstate(std::ios::eofbit);
+            return line.size() > 0;
+        }
+        if (c == '\n')
+        {
+            return true;
+        }
+        line.resize(line.size() + 1);
+        line.data()[line.size() - 1] = static_cast<uint8_t>(c);
+    }
+}
+
+// Writes the opening of a result object, echoing the request's "id"
+void begin_result (std::string& out, const util::JsonObject* request, bool ok)
+{
+    out += '{';
+    if (request)
+    {
+        if (const auto* id = request->find("id"))
+        {
+            out += "\"id\":";
+            util::append_json_string(out, view(*id));
+            out += ',';
+        }
+    }
+    out += ok ? "\"ok\":true" : "\"ok\":false";
+}
+
+void fail (std::string& out, const util::JsonObject* request, const std::string& error)
+{
+    begin_result(out, request, false);
+    out += ",\"error\":";
+    util::append_json_string(out, error);
+    out += '}';
+}
+
+void succeed (std::string& out, const util::JsonObject& request)
+{
+    begin_result(out, &request, true);
+    out += '}';
+}
+
+} // unnamed namespace
+
+void BatchMode::execute (std::string_view line, std::string& out)
+{
+    auto parsed = util::JsonObject::parse(line);
+    if (!parsed)
+    {
+        fail(out, nullptr, util::to_string(parsed.error()));
+        return;
+    }
+
+    const auto& request = parsed.value();
+    const auto* op = request.find("op");
+    if (!op)
+    {
+        fail(out, &request, "Missing \"op\"");
+        return;
+    }
+
+    const std::string_view command = view(*op);
+    const auto* name = request.find("name");
+
+    if (command == "list")
+    {
+        begin_result(out, &request, true);
+        out += ",\"names\":[";
+        const auto& names = session_.entries().names();
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            if (i > 0)
+            {
+                out += ',';
+            }
+            util::append_json_string(out, names[i]);
+        }
+        out += "]}";
+        return;
+    }
+
+    // tagged: names of the entries carrying every tag in "tags"
+    if (command == "tagged")
+    {
+        const auto* tags = request.find("tags");
+        if (!tags)
+        {
+            fail(out, &request, "Missing \"tags\"");
+            return;
+        }
+
+        begin_result(out, &request, true);
+        out += ",\"names\":[";
+        const auto indices = session_.tagged(split_tags(view(*tags)));
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            if (i > 0)
+            {
+                out += ',';
+            }
+            util::append_json_string(out, session_.entries().name(indices[i]));
+        }
+        out += "]}";
+        return;
+    }
+
+    if (command == "save")
+    {
+        auto saved = session_.save();
+        if (!saved)
+        {
+            fail(out, &request, vault::to_string(saved.error()));
+            return;
+        }
+        dirty_ = false;
+        succeed(out, request);
+        return;
+    }
+
+    if (command == "add")
+    {
+        const auto* username = request.find("username");
+        const auto* secret = request.find("secret");
+        if (!name || !username || !secret)
+        {
+            fail(out, &request, "\"add\" needs \"name\", \"username\" and \"secret\"");
+            return;
+        }
+
+        vault::Entry entry(copy_of(*name), copy_of(*username), copy_of(*secret));
+        if (const auto* tags = request.find("tags"))
+        {
+            for (const std::string_view tag : split_tags(view(*tags)))
+            {
+                entry.tags.emplace_back(tag);
+            }
+        }
+
+        auto added = session_.add_entry(std::move(entry));
+        if (!added)
+        {
+            fail(out, &request, vault::to_string(added.error()));
+            return;
+        }
+        dirty_ = true;
+        succeed(out, request);
+        return;
+    }
+
+    if (command != "get" && command != "remove" && command != "update" &&
+        command != "tag" && command != "untag")
+    {
+        fail(out, &request, "Unknown \"op\"");
+        return;
+    }
+
+    if (!name)
+    {
+        fail(out, &request, "Missing \"name\"");
+        return;
+    }
+
+    const auto found = session_.find_entry(view(*name));
+    if (!found)
+    {
+        fail(out, &request, vault::to_string(vault::VaultError::EntryNotFound));
+        return;
+    }
+    const vault::EntryId id = *found;
+
+    if (command == "get")
+    {
+        // Usage alone does not make the batch dirty; it is saved with the
+        // next change
+        session_.record_access(id);
+        const vault::EntryView entry = session_.entries()[*session_.index_of(id)];
+
+        // Room for every field escaped at worst (\u00XX, six bytes a byte),
+        // so `out` never reallocates and frees a copy once secrets are in it
+        size_t worst = entry.name.size() + entry.username.size() + entry.secret.size() + entry.tags.size();
+        if (const auto* request_id = request.find("id"))
+        {
+            worst += request_id->size();
+        }
+        out.reserve(out.size() + RESULT_OVERHEAD + 6 * worst);
+
+        begin_result(out, &request, true);
+        out += ",\"name\":";
+        util::append_json_string(out, entry.name);
+        out += ",\"username\":";
+        util::append_json_string(out, entry.username);
+        out += ",\"secret\":";
+        util::append_json_string(out, entry.secret);
+        if (!entry.tags.empty())
+        {
+            out += ",\"tags\":[";
+            bool first = true;
+            vault::for_each_tag(entry.tags, [&](std::string_view tag)
+            {
+                out += first ? "" : ",";
+                first = false;
+                util::append_json_string(out, tag);
+            });
+            out += ']';
+        }
+        out += '}';
+        return;
+    }
+
+    if (command == "remove")
+    {
+        session_.remove_entry(id);
+        dirty_ = true;
+        succeed(out, request);
+        return;
+    }
+
+    if (command == "tag" || command == "untag")
+    {
+        const auto* tag = request.find("tag");
+        if (!tag)
+        {
+            fail(out, &request, "Missing \"tag\"");
+            return;
+        }
+
+        auto tagged = command == "tag"
+            ? session_.add_tag(id, view(*tag))
+            : session_.remove_tag(id, view(*tag));
+        if (!tagged)
+        {
+            fail(out, &request, vault::to_string(tagged.error()));
+            return;
+        }
+        dirty_ = true;
+        succeed(out, request);
+        return;
+    }
+
+    // update: only the fields given are replaced, in place. The name goes
+    // first since it is the only one that can be refused.
+    const std::pair<const char*, vault::EntryField> fields[] = {
+        { "new_name", vault::EntryField::Name },
+        { "username", vault::EntryField::Username },
+        { "secret",   vault::EntryField::Secret }
+    };
+    for (const auto& [key, field] : fields)
+    {
+        const auto* value = request.find(key);
+        if (!value)
+        {
+            continue;
+        }
+
+        auto updated = session_.set_field(id, field, copy_of(*value));
+        if (!updated)
+        {
+            fail(out, &request, vault::to_string(updated.error()));
+            return;
+        }
+        dirty_ = true;
+    }
+    succeed(out, request);
+}
+
+util::Expected<void, vault::VaultFileError> BatchMode::finish ()
+{
+    if (!dirty_)
+    {
+        return {};
+    }
+
+    auto saved = session_.save();
+    if (saved)
+    {
+        dirty_ = false;
+    }
+    return saved;
+}
+
+util::Expected<void, vault::VaultFileError> BatchMode::run (
+    std::istream& in,
+    std::ostream& out
+)
+{
+    crypto::SecureBuffer line;
+    line.reserve(LINE_RESERVE);
+    std::string result;
+
+    while (read_line(in, line))
+    {
+        const std::string_view text(reinterpret_cast<const char*>(line.data()), line.size());
+        if (text.find_first_not_of(" \t\r") == std::string_view::npos)
+        {
+            continue;
+        }
+
+        execute(text, result);
+        result += '\n';
+        out << result;
+        out.flush();
+
+        wipe(result);
+    }
+    line.clear();
+
+    return finish();
+}
+
+} // namespace app
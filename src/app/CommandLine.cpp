@@ -0,0 +1,320 @@
+#include "app/CommandLine.h"
+#include "app/BatchMode.h"
+#include "agent/AgentClient.h"
+#include "agent/AgentError.h"
+#include "agent/AgentProtocol.h"
+#include "agent/AgentServer.h"
+#include "crypto/CryptoContext.h"
+#include "crypto/SecureBuffer.h"
+#include "util/Expected.h"
+#include "util/SecureString.h"
+#include "vault/BackupStore.h"
+#include "vault/Entry.h"
+#include "vault/VaultFile.h"
+#include "vault/VaultFileError.h"
+#include "vault/VaultSession.h"
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string_view>
+#include <termios.h>
+#include <unistd.h>
+
+namespace app
+{
+
+namespace
+{
+
+constexpr int EXIT_USAGE = 2;
+
+// Room for any password typed by hand without regrowing
+constexpr std::size_t SECRET_LINE_RESERVE = 1024;
+
+// Reads one line from `in` without echoing it when `in` is a terminal
+util::SecureString read_secret (const char* prompt, std::FILE* in = stdin)
+{
+    const int fd = ::fileno(in);
+    const bool tty = ::isatty(fd);
+    termios saved{};
+    if (tty)
+    {
+        std::fprintf(stderr, "%s", prompt);
+        ::tcgetattr(fd, &saved);
+        termios quiet = saved;
+        quiet.c_lflag &= ~static_cast<tcflag_t>(ECHO);
+        ::tcsetattr(fd, TCSAFLUSH, &quiet);
+    }
+
+    // Locked memory that wipes what it leaves behind when it grows, so a
+    // long secret leaves no copies on the heap
+    crypto::SecureBuffer line;
+    line.reserve(SECRET_LINE_RESERVE);
+    for (int c; (c = std::fgetc(in)) != EOF && c != '\n';)
+    {
+        line.resize(line.size() + 1);
+        line.data()[line.size() - 1] = static_cast<uint8_t>(c);
+    }
+
+    if (tty)
+    {
+        ::tcsetattr(fd, TCSAFLUSH, &saved);
+        std::fprintf(stderr, "\n");
+    }
+
+    return util::SecureString(std::string_view(reinterpret_cast<const char*>(line.data()), line.size()));
+}
+
+int report (agent::AgentError error)
+{
+    std::fprintf(stderr, "vault: %s\n", agent::to_string(error).c_str());
+    return EXIT_FAILURE;
+}
+
+int run_agent (int argc, char** argv, const std::string& vault_path)
+{
+    std::chrono::seconds idle = agent::DEFAULT_IDLE_TIMEOUT;
+    if (argc == 4 && std::string_view(argv[2]) == "--idle")
+    {
+        // Whole positive seconds only: 0 or garbage would lock at once
+        const std::string_view text(argv[3]);
+        uint32_t seconds = 0;
+        const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), seconds);
+        if (ec != std::errc{} || end != text.data() + text.size() || seconds == 0)
+        {
+            return EXIT_USAGE;
+        }
+        idle = std::chrono::seconds(seconds);
+    }
+    else if (argc != 2)
+    {
+        return EXIT_USAGE;
+    }
+
+    agent::AgentServer::harden_process();
+
+    auto session = vault::VaultFile::load(
+        vault_path,
+        []() -> std::optional<util::SecureString>
+        {
+            return read_secret("Master password: ");
+        },
+        vault::KeyCacheOptions::from_environment()
+    );
+    if (!session)
+    {
+        std::fprintf(stderr, "vault: %s\n", vault::to_string(session.error()).c_str());
+        return EXIT_FAILURE;
+    }
+
+    const auto socket_path = agent::default_socket_path();
+    auto server = agent::AgentServer::listen(socket_path, std::move(session.value()), idle);
+    if (!server)
+    {
+        return report(server.error());
+    }
+
+    std::printf("VAULT_AGENT_SOCK=%s; export VAULT_AGENT_SOCK;\n", socket_path.c_str());
+    std::fflush(stdout);
+
+    auto served = server.value().run();
+    return served ? EXIT_SUCCESS : report(served.error());
+}
+
+// For subcommands whose stdin may not be the terminal: the password comes
+// from --password-fd or the controlling terminal. nullopt on bad usage.
+std::optional<util::Expected<vault::VaultSession, vault::VaultFileError>> unlock_from_fd (
+    int argc,
+    char** argv,
+    const std::string& vault_path
+)
+{
+    std::FILE* password_source = nullptr;
+    if (argc == 4 && std::string_view(argv[2]) == "--password-fd")
+    {
+        password_source = ::fdopen(std::atoi(argv[3]), "r");
+    }
+    else if (argc == 2)
+    {
+        password_source = std::fopen("/dev/tty", "r");
+    }
+    else
+    {
+        return std::nullopt;
+    }
+
+    auto session = vault::VaultFile::load(
+        vault_path,
+        [password_source]() -> std::optional<util::SecureString>
+        {
+            if (!password_source)
+            {
+                return std::nullopt;
+            }
+            return read_secret("Master password: ", password_source);
+        },
+        vault::KeyCacheOptions::from_environment()
+    );
+    if (password_source)
+    {
+        std::fclose(password_source);
+    }
+    return session;
+}
+
+// stdin carries the commands
+int run_batch (int argc, char** argv, const std::string& vault_path)
+{
+    auto unlocked = unlock_from_fd(argc, argv, vault_path);
+    if (!unlocked)
+    {
+        return EXIT_USAGE;
+    }
+    auto& session = *unlocked;
+    if (!session)
+    {
+        std::fprintf(stderr, "vault: %s\n", vault::to_string(session.error()).c_str());
+        return EXIT_FAILURE;
+    }
+
+    BatchMode batch(session.value());
+    auto finished = batch.run(std::cin, std::cout);
+    if (!finished)
+    {
+        std::fprintf(stderr, "vault: %s\n", vault::to_string(finished.error()).c_str());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+// Meant for cron: snapshots the vault, then prunes with the default policy
+int run_backup (int argc, char** argv, const std::string& vault_path)
+{
+    auto unlocked = unlock_from_fd(argc, argv, vault_path);
+    if (!unlocked)
+    {
+        return EXIT_USAGE;
+    }
+    auto& session = *unlocked;
+    if (!session)
+    {
+        std::fprintf(stderr, "vault: %s\n", vault::to_string(session.error()).c_str());
+        return EXIT_FAILURE;
+    }
+
+    auto snapshot = session.value().back_up();
+    if (!snapshot)
+    {
+        std::fprintf(stderr, "vault: %s\n", vault::to_string(snapshot.error()).c_str());
+        return EXIT_FAILURE;
+    }
+    auto pruned = session.value().backups().prune(vault::RetentionPolicy{});
+    if (!pruned)
+    {
+        std::fprintf(stderr, "vault: %s\n", vault::to_string(pruned.error()).c_str());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+int run_client (int argc, char** argv)
+{
+    const std::string_view command = argv[1];
+    const bool known = (command == "get" && argc == 3)
+        || (command == "list" && argc == 2)
+        || (command == "add" && argc == 4)
+        || (command == "lock" && argc == 2);
+    if (!known)
+    {
+        return EXIT_USAGE;
+    }
+
+    auto client = agent::AgentClient::connect();
+    if (!client)
+    {
+        return report(client.error());
+    }
+
+    if (command == "get" && argc == 3)
+    {
+        auto entry = client.value().get(util::SecureString(argv[2]));
+        if (!entry)
+        {
+            return report(entry.error());
+        }
+        std::printf("%s\n", entry.value().secret.c_str());
+        return EXIT_SUCCESS;
+    }
+
+    if (command == "list" && argc == 2)
+    {
+        auto names = client.value().list();
+        if (!names)
+        {
+            return report(names.error());
+        }
+        for (const auto& name : names.value())
+        {
+            std::printf("%s\n", name.c_str());
+        }
+        return EXIT_SUCCESS;
+    }
+
+    if (command == "add" && argc == 4)
+    {
+        vault::Entry entry{
+            util::SecureString{argv[2]},
+            util::SecureString{argv[3]},
+            read_secret("Secret: ")
+        };
+        auto added = client.value().add(entry);
+        return added ? EXIT_SUCCESS : report(added.error());
+    }
+
+    if (command == "lock" && argc == 2)
+    {
+        auto locked = client.value().lock();
+        return locked ? EXIT_SUCCESS : report(locked.error());
+    }
+
+    return EXIT_USAGE;
+}
+
+} // unnamed namespace
+
+std::optional<int> run_command_line (
+    int argc,
+    char** argv,
+    const std::string& vault_path
+)
+{
+    if (argc < 2)
+    {
+        return std::nullopt;
+    }
+
+    if (!crypto::CryptoContext::init())
+    {
+        std::fprintf(stderr, "vault: failed to initialise libsodium\n");
+        return EXIT_FAILURE;
+    }
+
+    const std::string_view command = argv[1];
+    const int code = command == "agent" ? run_agent(argc, argv, vault_path)
+        : command == "batch" ? run_batch(argc, argv, vault_path)
+        : command == "backup" ? run_backup(argc, argv, vault_path)
+        : run_client(argc, argv);
+
+    if (code == EXIT_USAGE)
+    {
+        std::fprintf(stderr, "usage: vault [agent [--idle SECONDS] | batch [--password-fd FD] | backup [--password-fd FD] | get NAME | list | add NAME USERNAME | lock]\n");
+    }
+    return code;
+}
+
+} // namespace app
@@ -12,6 +12,7 @@ std::vector<MenuOption> UnlockedState::menu_options () const
     {
         { Action::AddEntry, "ADD NEW ENTRY" },
         { Action::ListEntries, "LIST ENTRIES" },
+        { Action::EditEntry, "EDIT ENTRY" },
         { Action::RemoveEntry, "REMOVE ENTRY" },
         { Action::Save, "SAVE" },
         { Action::SaveAndClose, "SAVE AND CLOSE VAULT" }
@@ -29,6 +30,7 @@ bool UnlockedState::allows (Action action) const noexcept
     {
         case Action::ListEntries:
         case Action::AddEntry:
+        case Action::EditEntry:
         case Action::RemoveEntry:
         case Action::Save:
         case Action::SaveAndClose:
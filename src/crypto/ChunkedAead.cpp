@@ -0,0 +1,308 @@
+#include "crypto/ChunkedAead.h"
+#include "crypto/VaultCrypto.h"
+#include "util/ByteOrder.h"
+#include "util/ThreadPool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <span>
+
+namespace crypto
+{
+
+namespace
+{
+
+// Largest public nonce of any supported suite (AEGIS-256)
+constexpr std::size_t MAX_NONCE_SIZE = 32;
+
+// Bytes of the nonce that carry the chunk counter and final flag
+constexpr std::size_t COUNTER_SIZE = sizeof(uint64_t);
+
+using NonceBuffer = std::array<uint8_t, MAX_NONCE_SIZE>;
+
+std::span<const uint8_t> chunk_nonce (
+    std::span<const uint8_t> base,
+    std::size_t index,
+    bool final,
+    NonceBuffer& buffer
+) noexcept
+{
+    std::copy(base.begin(), base.end(), buffer.begin());
+
+    const auto tail = std::span<uint8_t>(buffer)
+        .subspan(base.size() - COUNTER_SIZE)
+        .first<COUNTER_SIZE>();
+    const uint64_t counter = (static_cast<uint64_t>(index) << 1) | (final ? 1 : 0);
+    util::store(util::load<uint64_t>(tail) ^ counter, tail);
+
+    return { buffer.data(), base.size() };
+}
+
+bool overlaps (std::span<const uint8_t> a, std::span<const uint8_t> b) noexcept
+{
+    if (a.empty() || b.empty())
+    {
+        return false;
+    }
+    return a.data() < b.data() + b.size() && b.data() < a.data() + a.size();
+}
+
+util::Expected<void, CryptoError> check_parameters (
+    CipherSuite suite,
+    std::span<const uint8_t> nonce,
+    std::size_t chunk_size
+) noexcept
+{
+    if (!is_available(suite))
+    {
+        return CryptoError::UnsupportedCipher;
+    }
+    if (nonce.size() != nonce_size(suite) || nonce.size() < COUNTER_SIZE)
+    {
+        return CryptoError::InvalidNonce;
+    }
+    if (chunk_size == 0)
+    {
+        return CryptoError::EncryptionFailed;
+    }
+    return {};
+}
+
+} // unnamed namespace
+
+std::size_t ChunkedAead::chunk_count (
+    std::size_t plaintext_size,
+    std::size_t chunk_size
+) noexcept
+{
+    if (plaintext_size == 0)
+    {
+        return 1;
+    }
+    return (plaintext_size + chunk_size - 1) / chunk_size;
+}
+
+std::size_t ChunkedAead::ciphertext_size (
+    CipherSuite suite,
+    std::size_t plaintext_size,
+    std::size_t chunk_size
+) noexcept
+{
+    return plaintext_size + chunk_count(plaintext_size, chunk_size) * tag_size(suite);
+}
+
+util::Expected<std::size_t, CryptoError> ChunkedAead::plaintext_size (
+    CipherSuite suite,
+    std::size_t ciphertext_size,
+    std::size_t chunk_size
+) noexcept
+{
+    const std::size_t tag = tag_size(suite);
+    if (chunk_size == 0)
+    {
+        return CryptoError::DecryptionFailed;
+    }
+
+    const std::size_t full_chunks = ciphertext_size / (chunk_size + tag);
+    const std::size_t remainder = ciphertext_size % (chunk_size + tag);
+
+    std::size_t total = full_chunks * chunk_size;
+    if (remainder != 0 || full_chunks == 0)
+    {
+        if (remainder < tag)
+        {
+            return CryptoError::DecryptionFailed;
+        }
+        total += remainder - tag;
+    }
+
+    // A trailing tag-sized remainder after whole chunks maps back to the
+    // same plaintext length as no remainder at all; only seal's own
+    // lengths are accepted, so extended ciphertexts cannot pass
+    if (ChunkedAead::ciphertext_size(suite, total, chunk_size) != ciphertext_size)
+    {
+        return CryptoError::DecryptionFailed;
+    }
+    return total;
+}
+
+util::Expected<void, CryptoError> ChunkedAead::seal (
+    CipherSuite suite,
+    std::span<const uint8_t> key,
+    std::span<const uint8_t> nonce,
+    std::span<const uint8_t> plaintext,
+    std::span<uint8_t> out,
+    std::size_t chunk_size,
+    std::span<const uint8_t> aad
+)
+{
+    auto valid = check_parameters(suite, nonce, chunk_size);
+    if (!valid)
+    {
+        return valid.error();
+    }
+
+    const std::size_t tag = tag_size(suite);
+    const std::size_t count = chunk_count(plaintext.size(), chunk_size);
+    if (out.size() < ciphertext_size(suite, plaintext.size(), chunk_size) ||
+        overlaps(plaintext, out))
+    {
+        return CryptoError::EncryptionFailed;
+    }
+
+    std::atomic<bool> failed{false};
+    std::atomic<CryptoError> error{CryptoError::EncryptionFailed};
+
+    util::ThreadPool::shared().parallel_for(count, [&](std::size_t i)
+    {
+        const std::size_t offset = i * chunk_size;
+        const std::size_t len = std::min(chunk_size, plaintext.size() - offset);
+
+        NonceBuffer buffer;
+        auto sealed = VaultCrypto::encrypt_into(
+            suite,
+            key,
+            chunk_nonce(nonce, i, i + 1 == count, buffer),
+            plaintext.subspan(offset, len),
+            out.subspan(i * (chunk_size + tag), len + tag),
+            aad
+        );
+        if (!sealed)
+        {
+            error.store(sealed.error());
+            failed.store(true);
+        }
+    });
+
+    if (failed.load())
+    {
+        return error.load();
+    }
+    return {};
+}
+
+util::Expected<std::size_t, CryptoError> ChunkedAead::open (
+    CipherSuite suite,
+    std::span<const uint8_t> key,
+    std::span<const uint8_t> nonce,
+    std::span<const uint8_t> ciphertext,
+    std::span<uint8_t> out,
+    std::size_t chunk_size,
+    std::span<const uint8_t> aad
+)
+{
+    auto valid = check_parameters(suite, nonce, chunk_size);
+    if (!valid)
+    {
+        return valid.error();
+    }
+
+    auto total = plaintext_size(suite, ciphertext.size(), chunk_size);
+    if (!total)
+    {
+        return total.error();
+    }
+    if (out.size() < total.value() || overlaps(ciphertext, out))
+    {
+        return CryptoError::DecryptionFailed;
+    }
+
+    const std::size_t tag = tag_size(suite);
+    const std::size_t count = chunk_count(total.value(), chunk_size);
+    std::atomic<bool> failed{false};
+
+    util::ThreadPool::shared().parallel_for(count, [&](std::size_t i)
+    {
+        const std::size_t offset = i * chunk_size;
+        const std::size_t len = std::min(chunk_size, total.value() - offset);
+
+        NonceBuffer buffer;
+        auto opened = VaultCrypto::decrypt_into(
+            suite,
+            key,
+            chunk_nonce(nonce, i, i + 1 == count, buffer),
+            ciphertext.subspan(i * (chunk_size + tag), len + tag),
+            out.subspan(offset, len),
+            aad
+        );
+        if (!opened)
+        {
+            failed.store(true);
+        }
+    });
+
+    if (failed.load())
+    {
+        std::fill(out.begin(), out.begin() + total.value(), 0);
+        return CryptoError::DecryptionFailed;
+    }
+    return total.value();
+}
+
+util::Expected<std::size_t, CryptoError> ChunkedAead::open_in_place (
+    CipherSuite suite,
+    std::span<const uint8_t> key,
+    std::span<const uint8_t> nonce,
+    std::span<uint8_t> data,
+    std::size_t chunk_size,
+    std::span<const uint8_t> aad
+)
+{
+    auto valid = check_parameters(suite, nonce, chunk_size);
+    if (!valid)
+    {
+        return valid.error();
+    }
+
+    auto total = plaintext_size(suite, data.size(), chunk_size);
+    if (!total)
+    {
+        return total.error();
+    }
+
+    const std::size_t tag = tag_size(suite);
+    const std::size_t count = chunk_count(total.value(), chunk_size);
+    std::atomic<bool> failed{false};
+
+    // Each chunk decrypts over its own ciphertext, so chunks stay disjoint
+    util::ThreadPool::shared().parallel_for(count, [&](std::size_t i)
+    {
+        const std::size_t len = std::min(chunk_size, total.value() - i * chunk_size);
+        auto chunk = data.subspan(i * (chunk_size + tag), len + tag);
+
+        NonceBuffer buffer;
+        auto opened = VaultCrypto::decrypt_into(
+            suite,
+            key,
+            chunk_nonce(nonce, i, i + 1 == count, buffer),
+            chunk,
+            chunk,
+            aad
+        );
+        if (!opened)
+        {
+            failed.store(true);
+        }
+    });
+
+    if (failed.load())
+    {
+        std::fill(data.begin(), data.end(), 0);
+        return CryptoError::DecryptionFailed;
+    }
+
+    // Close the gaps the tags leave; destinations are always at or before
+    // their sources, so a forward copy is safe
+    for (std::size_t i = 1; i < count; ++i)
+    {
+        const std::size_t len = std::min(chunk_size, total.value() - i * chunk_size);
+        const auto source = data.begin() + i * (chunk_size + tag);
+        std::copy(source, source + len, data.begin() + i * chunk_size);
+    }
+    return total.value();
+}
+
+} // namespace crypto
@@ -0,0 +1,99 @@
+#include "crypto/CipherSuite.h"
+
+#include <sodium.h>
+
+namespace crypto
+{
+
+bool is_known_cipher_suite (std::uint8_t id) noexcept
+{
+    switch (static_cast<CipherSuite>(id))
+    {
+        case CipherSuite::XChaCha20Poly1305:
+        case CipherSuite::Aes256Gcm:
+        case CipherSuite::Aegis256:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool is_available (CipherSuite suite) noexcept
+{
+    switch (suite)
+    {
+        case CipherSuite::XChaCha20Poly1305:
+            return true;
+        case CipherSuite::Aes256Gcm:
+            // Checks for AES-NI + PCLMUL (or ARMv8 crypto) at runtime
+            return crypto_aead_aes256gcm_is_available() == 1;
+        case CipherSuite::Aegis256:
+#ifdef crypto_aead_aegis256_KEYBYTES
+            return true;
+#else
+            return false;
+#endif
+        default:
+            return false;
+    }
+}
+
+CipherSuite select_cipher_suite () noexcept
+{
+#ifdef crypto_aead_aegis256_KEYBYTES
+    // AEGIS has a portable fallback, so only prefer it where it is fast; it
+    // also keeps the vault readable on hosts without hardware AES.
+    if (sodium_runtime_has_aesni() || sodium_runtime_has_armcrypto())
+    {
+        return CipherSuite::Aegis256;
+    }
+#endif
+    return CipherSuite::XChaCha20Poly1305;
+}
+
+std::size_t key_size (CipherSuite suite) noexcept
+{
+    switch (suite)
+    {
+        case CipherSuite::Aes256Gcm:
+            return crypto_aead_aes256gcm_KEYBYTES;
+#ifdef crypto_aead_aegis256_KEYBYTES
+        case CipherSuite::Aegis256:
+            return crypto_aead_aegis256_KEYBYTES;
+#endif
+        default:
+            return crypto_aead_xchacha20poly1305_ietf_KEYBYTES;
+    }
+}
+
+std::size_t nonce_size (CipherSuite suite) noexcept
+{
+    switch (suite)
+    {
+        case CipherSuite::Aes256Gcm:
+            return crypto_aead_aes256gcm_NPUBBYTES;
+#ifdef crypto_aead_aegis256_KEYBYTES
+        case CipherSuite::Aegis256:
+            return crypto_aead_aegis256_NPUBBYTES;
+#endif
+        default:
+            return crypto_aead_xchacha20poly1305_ietf_NPUBBYTES;
+    }
+}
+
+std::size_t tag_size (CipherSuite suite) noexcept
+{
+    switch (suite)
+    {
+        case CipherSuite::Aes256Gcm:
+            return crypto_aead_aes256gcm_ABYTES;
+#ifdef crypto_aead_aegis256_KEYBYTES
+        case CipherSuite::Aegis256:
+            return crypto_aead_aegis256_ABYTES;
+#endif
+        default:
+            return crypto_aead_xchacha20poly1305_ietf_ABYTES;
+    }
+}
+
+} // namespace crypto
@@ -0,0 +1,122 @@
+#include "crypto/KeyringCache.h"
+#include "crypto/CryptoContext.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <linux/keyctl.h>
+#include <sodium/utils.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace crypto
+{
+
+namespace
+{
+
+// Key type for opaque blobs that userspace may read back
+constexpr const char* KEY_TYPE = "user";
+
+// Possessor may view, read, write, search and set attributes (but not link
+// the key elsewhere). The owning user and everyone else get nothing.
+constexpr unsigned long KEY_PERMISSIONS = 0x2f000000;
+
+// Cached keys are 32 bytes today; leave room for a wider suite
+constexpr std::size_t MAX_CACHED_KEY_SIZE = 64;
+
+long keyctl (int operation, unsigned long a, unsigned long b = 0, unsigned long c = 0)
+{
+    return ::syscall(SYS_keyctl, operation, a, b, c, 0);
+}
+
+long search (const std::string& description)
+{
+    return ::syscall(
+        SYS_keyctl,
+        KEYCTL_SEARCH,
+        KEY_SPEC_SESSION_KEYRING,
+        KEY_TYPE,
+        description.c_str(),
+        0
+    );
+}
+
+} // unnamed namespace
+
+util::Expected<void, CryptoError> KeyringCache::store (
+    const std::string& description,
+    std::span<const uint8_t> key,
+    std::chrono::seconds ttl
+)
+{
+    if (key.empty() || key.size() > MAX_CACHED_KEY_SIZE || ttl.count() <= 0)
+    {
+        return CryptoError::KeyringError;
+    }
+
+    const long serial = ::syscall(
+        SYS_add_key,
+        KEY_TYPE,
+        description.c_str(),
+        key.data(),
+        key.size(),
+        KEY_SPEC_SESSION_KEYRING
+    );
+    if (serial < 0)
+    {
+        return CryptoError::KeyringError;
+    }
+
+    if (keyctl(KEYCTL_SETPERM, serial, KEY_PERMISSIONS) != 0 ||
+        keyctl(KEYCTL_SET_TIMEOUT, serial, static_cast<unsigned long>(ttl.count())) != 0)
+    {
+        // Never leave a key behind without its restrictions
+        keyctl(KEYCTL_INVALIDATE, serial);
+        return CryptoError::KeyringError;
+    }
+
+    return {};
+}
+
+util::Expected<ByteBuffer, CryptoError> KeyringCache::fetch (
+    const std::string& description
+)
+{
+    const long serial = search(description);
+    if (serial < 0)
+    {
+        return errno == ENOSYS ? CryptoError::KeyringError : CryptoError::KeyNotCached;
+    }
+
+    ByteBuffer key(MAX_CACHED_KEY_SIZE);
+    const long length = keyctl(
+        KEYCTL_READ,
+        serial,
+        reinterpret_cast<unsigned long>(key.data()),
+        key.size()
+    );
+    if (length <= 0 || static_cast<std::size_t>(length) > key.size())
+    {
+        CryptoContext::secure_zero(key);
+        // The key may have expired between the search and the read
+        return length < 0 && (errno == EKEYEXPIRED || errno == EKEYREVOKED)
+            ? CryptoError::KeyNotCached
+            : CryptoError::KeyringError;
+    }
+
+    // Wipe the unused tail before shrinking over it
+    sodium_memzero(key.data() + length, key.size() - static_cast<std::size_t>(length));
+    key.resize(static_cast<std::size_t>(length));
+    return key;
+}
+
+void KeyringCache::revoke (const std::string& description) noexcept
+{
+    const long serial = search(description);
+    if (serial >= 0)
+    {
+        keyctl(KEYCTL_INVALIDATE, serial);
+    }
+}
+
+} // namespace crypto
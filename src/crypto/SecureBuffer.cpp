@@ -0,0 +1,88 @@
+#include "crypto/SecureBuffer.h"
+
+#include <algorithm>
+#include <new>
+#include <sodium.h>
+#include <utility>
+
+namespace crypto
+{
+
+SecureBuffer::SecureBuffer (std::size_t size)
+{
+    resize(size);
+}
+
+SecureBuffer::SecureBuffer (SecureBuffer&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr))
+    , size_(std::exchange(other.size_, 0))
+    , capacity_(std::exchange(other.capacity_, 0))
+{}
+
+SecureBuffer& SecureBuffer::operator= (SecureBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        capacity_ = std::exchange(other.capacity_, 0);
+    }
+    return *this;
+}
+
+SecureBuffer::~SecureBuffer ()
+{
+    release();
+}
+
+void SecureBuffer::reserve (std::size_t capacity)
+{
+    if (capacity <= capacity_)
+    {
+        return;
+    }
+
+    // Grow geometrically so a slowly growing vault regrows rarely
+    const std::size_t new_capacity = std::max(capacity, capacity_ + capacity_ / 2);
+    auto* grown = static_cast<std::uint8_t*>(sodium_malloc(new_capacity));
+    if (!grown)
+    {
+        throw std::bad_alloc();
+    }
+
+    std::copy(data_, data_ + size_, grown);
+    const std::size_t size = size_;
+    release(); // sodium_free wipes the old region
+    data_ = grown;
+    size_ = size;
+    capacity_ = new_capacity;
+}
+
+void SecureBuffer::resize (std::size_t size)
+{
+    reserve(size);
+    size_ = size;
+}
+
+void SecureBuffer::clear () noexcept
+{
+    if (data_)
+    {
+        sodium_memzero(data_, capacity_);
+    }
+    size_ = 0;
+}
+
+void SecureBuffer::release () noexcept
+{
+    if (data_)
+    {
+        sodium_free(data_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    capacity_ = 0;
+}
+
+} // namespace crypto
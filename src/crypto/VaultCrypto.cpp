@@ -1,3 +1,4 @@
+#include "crypto/CipherSuite.h"
 #include "crypto/CryptoConstants.h"
 #include "crypto/VaultCrypto.h"
 #include "crypto/CryptoTypes.h"
@@ -9,10 +10,151 @@
 
 namespace crypto 
 {
+
+namespace
+{
+
+// Every libsodium AEAD shares these signatures, so a suite is just a pair
+// of function pointers.
+using AeadEncryptFn = int (*)(
+    unsigned char*, unsigned long long*,
+    const unsigned char*, unsigned long long,
+    const unsigned char*, unsigned long long,
+    const unsigned char*, const unsigned char*, const unsigned char*
+);
+
+using AeadDecryptFn = int (*)(
+    unsigned char*, unsigned long long*, unsigned char*,
+    const unsigned char*, unsigned long long,
+    const unsigned char*, unsigned long long,
+    const unsigned char*, const unsigned char*
+);
+
+using AeadEncryptDetachedFn = int (*)(
+    unsigned char*, unsigned char*, unsigned long long*,
+    const unsigned char*, unsigned long long,
+    const unsigned char*, unsigned long long,
+    const unsigned char*, const unsigned char*, const unsigned char*
+);
+
+using AeadDecryptDetachedFn = int (*)(
+    unsigned char*, unsigned char*,
+    const unsigned char*, unsigned long long,
+    const unsigned char*,
+    const unsigned char*, unsigned long long,
+    const unsigned char*, const unsigned char*
+);
+
+struct AeadBackend
+{
+    AeadEncryptFn encrypt;
+    AeadDecryptFn decrypt;
+    AeadEncryptDetachedFn encrypt_detached;
+    AeadDecryptDetachedFn decrypt_detached;
+};
+
+constexpr AeadBackend XCHACHA20POLY1305_BACKEND {
+    crypto_aead_xchacha20poly1305_ietf_encrypt,
+    crypto_aead_xchacha20poly1305_ietf_decrypt,
+    crypto_aead_xchacha20poly1305_ietf_encrypt_detached,
+    crypto_aead_xchacha20poly1305_ietf_decrypt_detached
+};
+
+constexpr AeadBackend AES256GCM_BACKEND {
+    crypto_aead_aes256gcm_encrypt,
+    crypto_aead_aes256gcm_decrypt,
+    crypto_aead_aes256gcm_encrypt_detached,
+    crypto_aead_aes256gcm_decrypt_detached
+};
+
+#ifdef crypto_aead_aegis256_KEYBYTES
+constexpr AeadBackend AEGIS256_BACKEND {
+    crypto_aead_aegis256_encrypt,
+    crypto_aead_aegis256_decrypt,
+    crypto_aead_aegis256_encrypt_detached,
+    crypto_aead_aegis256_decrypt_detached
+};
+#endif
+
+// nullptr if the suite is unknown or cannot run on this host
+const AeadBackend* backend_for (CipherSuite suite) noexcept
+{
+    if (!is_available(suite))
+    {
+        return nullptr;
+    }
+
+    switch (suite)
+    {
+        case CipherSuite::XChaCha20Poly1305:
+            return &XCHACHA20POLY1305_BACKEND;
+        case CipherSuite::Aes256Gcm:
+            return &AES256GCM_BACKEND;
+#ifdef crypto_aead_aegis256_KEYBYTES
+        case CipherSuite::Aegis256:
+            return &AEGIS256_BACKEND;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+// Same memory (in place) or disjoint is fine; partial overlap is not
+bool overlaps_partially (
+    std::span<const uint8_t> in,
+    std::span<const uint8_t> out
+) noexcept
+{
+    if (in.empty() || out.empty() || in.data() == out.data())
+    {
+        return false;
+    }
+    const auto* in_end = in.data() + in.size();
+    const auto* out_end = out.data() + out.size();
+    return in.data() < out_end && out.data() < in_end;
+}
+
+// Shared argument checks for every AEAD entry point
+util::Expected<const AeadBackend*, CryptoError> check_arguments (
+    CipherSuite suite,
+    std::span<const uint8_t> key,
+    std::span<const uint8_t> nonce
+) noexcept
+{
+    const auto* backend = backend_for(suite);
+    if (!backend)
+    {
+        return CryptoError::UnsupportedCipher;
+    }
+
+    if (key.size() != key_size(suite))
+    {
+        return CryptoError::InvalidKey;
+    }
+
+    if (nonce.size() != nonce_size(suite))
+    {
+        return CryptoError::InvalidNonce;
+    }
+
+    return backend;
+}
+
+} // unnamed namespace
+
 util::Expected<ByteBuffer, CryptoError> VaultCrypto::derive_key (
     const util::SecureString& password,
     std::span<const uint8_t> salt
 ) 
+{
+    return derive_key(password, salt, DEFAULT_KDF_PARAMS);
+}
+
+util::Expected<ByteBuffer, CryptoError> VaultCrypto::derive_key (
+    const util::SecureString& password,
+    std::span<const uint8_t> salt,
+    const KdfParams& params
+)
 {
     // Validate salt size
     if (salt.size() != SALT_SIZE) 
@@ -23,6 +165,12 @@ util::Expected<ByteBuffer, CryptoError> VaultCrypto::derive_key (
     // Prepare output buffer
     ByteBuffer derived_key(crypto::KEY_SIZE);
     
+    // libsodium's Argon2id is single-lane
+    if (params.parallelism != 1)
+    {
+        return CryptoError::KeyDerivationFailed;
+    }
+
     // Perform key derivation
     int result = crypto_pwhash(
         derived_key.data(),                   // output buffer
@@ -30,10 +178,8 @@ util::Expected<ByteBuffer, CryptoError> VaultCrypto::derive_key (
         reinterpret_cast<const char*>(password.data()),  // password
         password.size(),                      // password length
         salt.data(),                          // salt
-        // crypto_pwhash_OPSLIMIT_SENSITIVE,     // computational cost
-        // crypto_pwhash_MEMLIMIT_SENSITIVE,     // memory cost
-        crypto_pwhash_OPSLIMIT_MODERATE,
-        crypto_pwhash_MEMLIMIT_MODERATE,
+        params.iters,                         // computational cost
+        static_cast<size_t>(params.mem_kib) * 1024, // memory cost
         crypto_pwhash_ALG_ARGON2ID13          // algorithm (Argon2id v1.3)
     );
     
@@ -48,92 +194,252 @@ util::Expected<ByteBuffer, CryptoError> VaultCrypto::derive_key (
 
 util::Expected<ByteBuffer, CryptoError> VaultCrypto::encrypt (
     const ByteBuffer& key,
-    const ByteBuffer& nonce,
-    const ByteBuffer& plaintext
+    std::span<const uint8_t> nonce,
+    const ByteBuffer& plaintext,
+    std::span<const uint8_t> aad
 )
 {
-    if (key.size() != crypto_aead_xchacha20poly1305_ietf_KEYBYTES)
+    return encrypt(CipherSuite::XChaCha20Poly1305, key, nonce, plaintext, aad);
+}
+
+util::Expected<ByteBuffer, CryptoError> VaultCrypto::encrypt (
+    CipherSuite suite,
+    const ByteBuffer& key,
+    std::span<const uint8_t> nonce,
+    std::span<const uint8_t> plaintext,
+    std::span<const uint8_t> aad
+)
+{
+    ByteBuffer output(
+        plaintext.size() + 
+        tag_size(suite)
+    );
+
+    auto written = encrypt_into(suite, key, nonce, plaintext, output, aad);
+    if (!written)
     {
-        return CryptoError::InvalidKey;
+        return written.error();
+    }
+    if (written.value() != output.size())
+    {
+        output.resize(written.value());
+    }
+    return output; 
+}
+
+util::Expected<ByteBuffer, CryptoError> VaultCrypto::decrypt (
+    const ByteBuffer& key,
+    std::span<const uint8_t> nonce,
+    std::span<const uint8_t> ciphertext,
+    std::span<const uint8_t> aad
+)
+{
+    return decrypt(CipherSuite::XChaCha20Poly1305, key, nonce, ciphertext, aad);
+}
+
+util::Expected<ByteBuffer, CryptoError> VaultCrypto::decrypt (
+    CipherSuite suite,
+    const ByteBuffer& key,
+    std::span<const uint8_t> nonce,
+    std::span<const uint8_t> ciphertext,
+    std::span<const uint8_t> aad
+)
+{
+    if (ciphertext.size() < tag_size(suite)) 
+    {
+        return CryptoError::DecryptionFailed;
     }
 
     ByteBuffer output(
-        plaintext.size() + 
-        crypto_aead_xchacha20poly1305_ietf_ABYTES
+        ciphertext.size() - tag_size(suite)
     );
 
+    auto written = decrypt_into(suite, key, nonce, ciphertext, output, aad);
+    if (!written)
+    {
+        return written.error();
+    }
+    if (written.value() != output.size()) 
+    {
+        output.resize(written.value());
+    }
+    return output; 
+}
+
+util::Expected<std::size_t, CryptoError> VaultCrypto::encrypt_into (
+    CipherSuite suite,
+    std::span<const uint8_t> key,
+    std::span<const uint8_t> nonce,
+    std::span<const uint8_t> plaintext,
+    std::span<uint8_t> out,
+    std::span<const uint8_t> aad
+)
+{
+    auto backend = check_arguments(suite, key, nonce);
+    if (!backend)
+    {
+        return backend.error();
+    }
+
+    if (out.size() < plaintext.size() + tag_size(suite) ||
+        overlaps_partially(plaintext, out))
+    {
+        return CryptoError::EncryptionFailed;
+    }
+
     unsigned long long ciphertext_len = 0;
 
-    int rc = crypto_aead_xchacha20poly1305_ietf_encrypt(
-        output.data(),                // output buffer
+    int rc = backend.value()->encrypt(
+        out.data(),                   // output buffer (may be the plaintext)
         &ciphertext_len,         // output size counter
         plaintext.data(),             // plaintext to encrypt
         plaintext.size(),          // plaintext size
-        nullptr,                     // additional authenticated data (not using)
-        0,                        // additional authenticated data length
-        nullptr,                   // Secret nonce - for XChaCha20-Poly1305 this should always be NULL
+        aad.data(),                  // additional authenticated data
+        aad.size(),               // additional authenticated data length
+        nullptr,                   // Secret nonce - unused by every libsodium AEAD, always NULL
         nonce.data(),              // Our nonce
         key.data()                    // Our key
     );
 
     if (rc != 0)
     {
-        sodium_memzero(output.data(), output.size());
+        sodium_memzero(out.data(), out.size());
         return CryptoError::EncryptionFailed;
     }
-    if (ciphertext_len != output.size())
-    {
-        output.resize(ciphertext_len);
-    }
-    return output; 
+    return static_cast<std::size_t>(ciphertext_len);
 }
 
-util::Expected<ByteBuffer, CryptoError> VaultCrypto::decrypt (
-    const ByteBuffer& key,
+util::Expected<std::size_t, CryptoError> VaultCrypto::decrypt_into (
+    CipherSuite suite,
+    std::span<const uint8_t> key,
     std::span<const uint8_t> nonce,
-    const ByteBuffer& ciphertext
+    std::span<const uint8_t> ciphertext,
+    std::span<uint8_t> out,
+    std::span<const uint8_t> aad
 )
 {
-    if (key.size() != KEY_SIZE)
+    auto backend = check_arguments(suite, key, nonce);
+    if (!backend)
     {
-        return CryptoError::InvalidKey;
+        return backend.error();
     }
 
-    if (ciphertext.size() < crypto::TAG_SIZE) 
+    if (ciphertext.size() < tag_size(suite) ||
+        out.size() < ciphertext.size() - tag_size(suite) ||
+        overlaps_partially(ciphertext, out))
     {
         return CryptoError::DecryptionFailed;
     }
 
-    ByteBuffer output(
-        ciphertext.size() - crypto::TAG_SIZE
-    );
-
     unsigned long long plaintext_len = 0;
 
-    int rc = crypto_aead_xchacha20poly1305_ietf_decrypt(
-        output.data(),
+    int rc = backend.value()->decrypt(
+        out.data(),
         &plaintext_len,
         nullptr,
         ciphertext.data(),
         ciphertext.size(),
-        nullptr, 
-        0,
+        aad.data(),
+        aad.size(),
         nonce.data(),
         key.data()
     );
 
     if (rc != 0)
     {
-        sodium_memzero(output.data(), output.size());
+        sodium_memzero(out.data(), ciphertext.size() - tag_size(suite));
         return CryptoError::DecryptionFailed;
     }
+    return static_cast<std::size_t>(plaintext_len);
+}
 
-    
-    if (plaintext_len != output.size()) 
+util::Expected<void, CryptoError> VaultCrypto::encrypt_detached (
+    CipherSuite suite,
+    std::span<const uint8_t> key,
+    std::span<const uint8_t> nonce,
+    std::span<const uint8_t> plaintext,
+    std::span<uint8_t> out,
+    std::span<uint8_t> tag,
+    std::span<const uint8_t> aad
+)
+{
+    auto backend = check_arguments(suite, key, nonce);
+    if (!backend)
     {
-        output.resize(plaintext_len);
+        return backend.error();
     }
-    return output; 
+
+    if (out.size() < plaintext.size() ||
+        tag.size() != tag_size(suite) ||
+        overlaps_partially(plaintext, out))
+    {
+        return CryptoError::EncryptionFailed;
+    }
+
+    unsigned long long tag_len = 0;
+
+    int rc = backend.value()->encrypt_detached(
+        out.data(),
+        tag.data(),
+        &tag_len,
+        plaintext.data(),
+        plaintext.size(),
+        aad.data(),
+        aad.size(),
+        nullptr,
+        nonce.data(),
+        key.data()
+    );
+
+    if (rc != 0)
+    {
+        sodium_memzero(out.data(), out.size());
+        return CryptoError::EncryptionFailed;
+    }
+    return {};
+}
+
+util::Expected<void, CryptoError> VaultCrypto::decrypt_detached (
+    CipherSuite suite,
+    std::span<const uint8_t> key,
+    std::span<const uint8_t> nonce,
+    std::span<const uint8_t> ciphertext,
+    std::span<const uint8_t> tag,
+    std::span<uint8_t> out,
+    std::span<const uint8_t> aad
+)
+{
+    auto backend = check_arguments(suite, key, nonce);
+    if (!backend)
+    {
+        return backend.error();
+    }
+
+    if (out.size() < ciphertext.size() ||
+        tag.size() != tag_size(suite) ||
+        overlaps_partially(ciphertext, out))
+    {
+        return CryptoError::DecryptionFailed;
+    }
+
+    int rc = backend.value()->decrypt_detached(
+        out.data(),
+        nullptr,
+        ciphertext.data(),
+        ciphertext.size(),
+        tag.data(),
+        aad.data(),
+        aad.size(),
+        nonce.data(),
+        key.data()
+    );
+
+    if (rc != 0)
+    {
+        sodium_memzero(out.data(), ciphertext.size());
+        return CryptoError::DecryptionFailed;
+    }
+    return {};
 }
 
 } // namespace crypto
@@ -1,8 +1,16 @@
 #include "app/Application.h"
+#include "app/CommandLine.h"
 
-int main (void)
+int main (int argc, char** argv)
 {
-    app::Application app("vault.dat");
+    const std::string vault_path = "vault.dat";
+
+    if (auto code = app::run_command_line(argc, argv, vault_path))
+    {
+        return *code;
+    }
+
+    app::Application app(vault_path);
     app.run(app);
 
     return 0;
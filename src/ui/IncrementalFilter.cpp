@@ -0,0 +1,40 @@
+#include "ui/IncrementalFilter.h"
+
+namespace ui
+{
+
+IncrementalFilter::IncrementalFilter(const vault::EntryTable& entries)
+    : search_(entries)
+{
+    levels_.push_back(search_.find(""));
+}
+
+void IncrementalFilter::push(char c)
+{
+    query_.push_back(c);
+
+    // Anything matching the longer query matched the shorter one, so only
+    // the previous survivors need checking
+    auto next = levels_.size() == 1
+        ? search_.find(query_)
+        : search_.find(query_, levels_.back());
+    levels_.push_back(std::move(next));
+}
+
+void IncrementalFilter::pop()
+{
+    if (query_.empty())
+    {
+        return;
+    }
+    query_.pop_back();
+    levels_.pop_back();
+}
+
+void IncrementalFilter::clear()
+{
+    query_.clear();
+    levels_.resize(1);
+}
+
+}
@@ -0,0 +1,98 @@
+#include "ui/ListViewport.h"
+
+#include <algorithm>
+
+namespace ui
+{
+
+ListViewport::ListViewport(size_t rows, size_t height) noexcept
+    : rows_(rows)
+    , height_(std::max<size_t>(height, 1))
+{}
+
+size_t ListViewport::bottom() const noexcept
+{
+    return std::min(rows_, top_ + height_);
+}
+
+size_t ListViewport::max_top() const noexcept
+{
+    return rows_ > height_ ? rows_ - height_ : 0;
+}
+
+ListViewport::Redraw ListViewport::move_to(size_t row, size_t top) noexcept
+{
+    if (rows_ == 0)
+    {
+        return Redraw::None;
+    }
+
+    row = std::min(row, rows_ - 1);
+    top = std::min(top, max_top());
+
+    // Keep the selection on screen
+    if (row < top)
+    {
+        top = row;
+    }
+    else if (row >= top + height_)
+    {
+        top = row - height_ + 1;
+    }
+
+    const bool scrolled = top != top_;
+    const bool moved = row != selected_;
+
+    previous_ = selected_;
+    selected_ = row;
+    top_ = top;
+
+    if (scrolled)
+    {
+        return Redraw::Window;
+    }
+    return moved ? Redraw::Selection : Redraw::None;
+}
+
+ListViewport::Redraw ListViewport::up() noexcept
+{
+    return selected_ == 0 ? Redraw::None : move_to(selected_ - 1, top_);
+}
+
+ListViewport::Redraw ListViewport::down() noexcept
+{
+    return move_to(selected_ + 1, top_);
+}
+
+ListViewport::Redraw ListViewport::page_up() noexcept
+{
+    return move_to(
+        selected_ - std::min(selected_, height_),
+        top_ - std::min(top_, height_)
+    );
+}
+
+ListViewport::Redraw ListViewport::page_down() noexcept
+{
+    return move_to(selected_ + height_, top_ + height_);
+}
+
+ListViewport::Redraw ListViewport::home() noexcept
+{
+    return move_to(0, 0);
+}
+
+ListViewport::Redraw ListViewport::end() noexcept
+{
+    return move_to(rows_ == 0 ? 0 : rows_ - 1, max_top());
+}
+
+void ListViewport::reset(size_t rows) noexcept
+{
+    rows_ = rows;
+    top_ = 0;
+    selected_ = 0;
+    previous_ = 0;
+}
+
+}
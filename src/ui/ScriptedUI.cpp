@@ -0,0 +1,199 @@
+#include "ui/ScriptedUI.h"
+
+#include <algorithm>
+
+namespace ui
+{
+
+namespace
+{
+
+const std::string SCRIPT_EXHAUSTED = "Script exhausted";
+
+} // unnamed namespace
+
+ScriptedUI& ScriptedUI::then_action(app::Action action)
+{
+    actions_.push_back(action);
+    return *this;
+}
+
+ScriptedUI& ScriptedUI::then_password(std::string_view password)
+{
+    passwords_.emplace_back(password);
+    return *this;
+}
+
+ScriptedUI& ScriptedUI::then_input(std::string_view input)
+{
+    inputs_.emplace_back(input);
+    return *this;
+}
+
+ScriptedUI& ScriptedUI::then_generate(bool generate)
+{
+    generate_.push_back(generate);
+    return *this;
+}
+
+ScriptedUI& ScriptedUI::then_remove(size_t index)
+{
+    removals_.push_back(index);
+    return *this;
+}
+
+ScriptedUI& ScriptedUI::then_edit(size_t index, vault::EntryField field)
+{
+    edits_.emplace_back(index, field);
+    return *this;
+}
+
+ScriptedUI& ScriptedUI::then_open(size_t index)
+{
+    opens_.push_back(index);
+    return *this;
+}
+
+void ScriptedUI::show_message(const std::string& message)
+{
+    messages_.push_back(message);
+}
+
+void ScriptedUI::show_error(const std::string& error)
+{
+    errors_.push_back(error);
+}
+
+app::Action ScriptedUI::prompt_action(const std::vector<app::MenuOption>& options)
+{
+    std::vector<app::Action> menu;
+    menu.reserve(options.size());
+    for (const auto& option : options)
+    {
+        menu.push_back(option.action);
+    }
+    menus_.push_back(std::move(menu));
+
+    if (actions_.empty())
+    {
+        const auto& offered = menus_.back();
+        if (offered.empty() ||
+            std::find(offered.begin(), offered.end(), app::Action::Quit) != offered.end())
+        {
+            return app::Action::Quit;
+        }
+        return offered.back();
+    }
+    const app::Action action = actions_.front();
+    actions_.pop_front();
+    return action;
+}
+
+std::vector<size_t> ScriptedUI::list_entries(
+    const vault::EntryTable& entries,
+    const std::vector<size_t>& pinned)
+{
+    listed_.clear();
+    listed_.reserve(entries.size());
+    auto list = [&](size_t index)
+    {
+        listed_.emplace_back(entries.name(index));
+    };
+
+    for (const size_t index : pinned)
+    {
+        list(index);
+    }
+    for (size_t index = 0; index < entries.size(); ++index)
+    {
+        if (std::find(pinned.begin(), pinned.end(), index) == pinned.end())
+        {
+            list(index);
+        }
+    }
+
+    std::vector<size_t> opened;
+    opened.swap(opens_);
+    return opened;
+}
+
+util::Expected<util::SecureString, std::string> ScriptedUI::prompt_master_password()
+{
+    if (passwords_.empty())
+    {
+        return SCRIPT_EXHAUSTED;
+    }
+    util::SecureString password = std::move(passwords_.front());
+    passwords_.pop_front();
+    return password;
+}
+
+util::Expected<util::SecureString, std::string> ScriptedUI::prompt_input(std::string)
+{
+    if (inputs_.empty())
+    {
+        return SCRIPT_EXHAUSTED;
+    }
+    util::SecureString input = std::move(inputs_.front());
+    inputs_.pop_front();
+    return input;
+}
+
+util::Expected<util::SecureString, std::string> ScriptedUI::prompt_input(
+    std::string prompt,
+    const NameHinter& hints)
+{
+    auto input = prompt_input(std::move(prompt));
+    if (input && hints)
+    {
+        last_hints_ = hints(std::string_view(input.value().c_str(), input.value().size()));
+    }
+    return input;
+}
+
+bool ScriptedUI::generate_password()
+{
+    if (generate_.empty())
+    {
+        return false;
+    }
+    const bool generate = generate_.front();
+    generate_.pop_front();
+    return generate;
+}
+
+void ScriptedUI::display_entry(const vault::EntryView&)
+{}
+
+util::Expected<size_t, char> ScriptedUI::remove_entry(const vault::EntryTable&)
+{
+    if (removals_.empty())
+    {
+        return 'l';
+    }
+    const size_t index = removals_.front();
+    removals_.pop_front();
+    return index;
+}
+
+util::Expected<size_t, char> ScriptedUI::select_entry(const vault::EntryTable&)
+{
+    if (edits_.empty())
+    {
+        return 'l';
+    }
+    return edits_.front().first;
+}
+
+util::Expected<vault::EntryField, char> ScriptedUI::select_field(const vault::EntryView&)
+{
+    if (edits_.empty())
+    {
+        return 'l';
+    }
+    const vault::EntryField field = edits_.front().second;
+    edits_.pop_front();
+    return field;
+}
+
+}
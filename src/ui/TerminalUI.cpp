@@ -1,13 +1,22 @@
 #include "ui/TerminalUI.h"
+#include "ui/IncrementalFilter.h"
+#include "ui/ListViewport.h"
 #include "app/Action.h"
 #include "app/State.h"
 #include "util/Expected.h"
 #include "util/SecureString.h"
+#include "vault/FuzzyMatcher.h"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstddef>
+#include <functional>
+#include <iterator>
 #include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <ncurses.h>
 #include <thread>
 #include <vector>
@@ -342,7 +351,7 @@ app::Action TerminalUI::prompt_action(
     delwin(menu_win);
 }
 
-void TerminalUI::display_entry(const vault::Entry& entry)
+void TerminalUI::display_entry(const vault::EntryView& entry)
 {
     const int win_height = message_content_height_;
     const int win_width = COLS / 3;
@@ -384,13 +393,13 @@ void TerminalUI::display_entry(const vault::Entry& entry)
     box(entry_name, 0, 0);
     mvwprintw(entry_name, 0, 1, "%s", "Name");
     wattron(entry_name, A_BOLD | A_BLINK);
-    mvwprintw(entry_name, 1, 1, "%s", entry.name.c_str());
+    mvwprintw(entry_name, 1, 1, "%.*s", static_cast<int>(entry.name.size()), entry.name.data());
     wattroff(entry_name, A_BOLD | A_BLINK);
 
     box(entry_username, 0, 0);
     mvwprintw(entry_username, 0, 1, "%s", "Username/Email");
     wattron(entry_username, A_BOLD);
-    mvwprintw(entry_username, 1, 1, "%s", entry.username.c_str());
+    mvwprintw(entry_username, 1, 1, "%.*s", static_cast<int>(entry.username.size()), entry.username.data());
     wattroff(entry_username, A_BOLD);
     
     box(entry_secret, 0, 0);
@@ -470,7 +479,7 @@ void TerminalUI::display_entry(const vault::Entry& entry)
                 werase(entry_secret);
                 box(entry_secret, 0, 0);
                 mvwprintw(entry_secret, 0, 1, "%s", "Password");
-                mvwprintw(entry_secret, 1, 1, "%s", entry.secret.c_str());
+                mvwprintw(entry_secret, 1, 1, "%.*s", static_cast<int>(entry.secret.size()), entry.secret.data());
                 wrefresh(entry_secret);
                 show_message("Press ANY key to continue");
 
@@ -506,10 +515,10 @@ void TerminalUI::display_entry(const vault::Entry& entry)
                     return false;
                 };
             
-                if (copy_to_clipboard(entry.secret.c_str()))
+                if (copy_to_clipboard(std::string(entry.secret)))
                 {
                     show_message("Password copied to clipboard (for 30 seconds)");
-                    std::thread([secret = entry.secret.c_str()]() {
+                    std::thread([]() {
                         std::this_thread::sleep_for(std::chrono::seconds(30));
                         const char* cmds[] = {
                             "xclip -selection clipboard 2>/dev/null",
@@ -554,13 +563,17 @@ void TerminalUI::display_entry(const vault::Entry& entry)
     delwin(menu);
 }
 
-bool check_remove_entry(int dyn_content_start_row_, int message_content_height_) 
+// Small menu in the right column; returns the index of the chosen option
+size_t pick_option(
+    const char* title,
+    const std::vector<std::string>& options,
+    int dyn_content_start_row_)
 {
   const int win_width = COLS / 3;
   const int content_start = dyn_content_start_row_;
   
   WINDOW* menu = newwin(
-      4,
+      static_cast<int>(options.size()) + 2,
       win_width,
       content_start,
       win_width * 2 
@@ -568,7 +581,6 @@ bool check_remove_entry(int dyn_content_start_row_, int message_content_height_)
 
   keypad(menu, true);
   int selected = 0;
-  std::vector<std::string> options = { "REMOVE ENTRY", "CANCEL" };
 
   auto render = [&]()
   {
@@ -609,7 +621,7 @@ bool check_remove_entry(int dyn_content_start_row_, int message_content_height_)
               );
           }
     }
-      mvwprintw(menu, 0, 1, "%s", "Delete Entry?");
+      mvwprintw(menu, 0, 1, "%s", title);
       wrefresh(menu);
   };
 
@@ -633,238 +645,347 @@ bool check_remove_entry(int dyn_content_start_row_, int message_content_height_)
           werase(menu);
           wrefresh(menu);
           delwin(menu);
-          return selected == 0;
+          return static_cast<size_t>(selected);
       }
 
       render();
   }
 }
 
-util::Expected<size_t, char> TerminalUI::remove_entry(const std::vector<vault::Entry>& entries)
+bool check_remove_entry(int dyn_content_start_row_)
 {
-    if (entries.empty()) return 'l';
+    return pick_option("Delete Entry?", { "REMOVE ENTRY", "CANCEL" }, dyn_content_start_row_) == 0;
+}
 
-    const int num_entries = static_cast<int>(entries.size()) + 1;
-    const int content_start = dyn_content_start_row_;
-    const int viewport_top = content_start;
-    const int viewport_left = COLS / 3;
-    const int viewport_bottom = LINES - 1;
-    const int viewport_right = COLS - 1;
-    const int viewport_height = viewport_bottom - viewport_top + 1;
+// Fuzzy fallback results shown when a search has no substring matches
+constexpr size_t FUZZY_RESULTS = 200;
 
-    WINDOW* pad = newpad(num_entries + 2, COLS / 3);
-    if (!pad) return 'l';
+// Completions listed under a hinted prompt_input
+constexpr int NAME_HINTS = 5;
 
-    keypad(pad, TRUE); 
+// Vault order, then each sorted order in turn
+std::optional<vault::EntryOrder> next_order(std::optional<vault::EntryOrder> order)
+{
+    if (!order)
+    {
+        return vault::EntryOrder::Name;
+    }
+    switch (*order)
+    {
+        case vault::EntryOrder::Name:     return vault::EntryOrder::Username;
+        case vault::EntryOrder::Username: return vault::EntryOrder::Modified;
+        case vault::EntryOrder::Modified: break;
+    }
+    return std::nullopt;
+}
 
-    size_t selected = 0; 
-    int pad_scroll = 0; 
+const char* order_title(std::optional<vault::EntryOrder> order)
+{
+    if (!order)
+    {
+        return "Entries (type to search)";
+    }
+    switch (*order)
+    {
+        case vault::EntryOrder::Name:     return "Entries by name";
+        case vault::EntryOrder::Username: return "Entries by username";
+        case vault::EntryOrder::Modified: return "Entries by last change";
+    }
+    return "Entries";
+}
 
-    auto render = [&]()
+size_t TerminalUI::pick_entry(
+    const vault::EntryTable& entries,
+    const std::vector<size_t>& pinned,
+    const std::function<bool(size_t)>& choose)
+{
+    const int viewport_top = dyn_content_start_row_;
+    const int viewport_left = COLS / 3;
+    const int win_width = COLS / 3;
+    // Sized for the whole vault so filtering never resizes the window; one
+    // extra row for BACK
+    const int win_height = static_cast<int>(
+        std::min<size_t>(LINES - viewport_top, entries.size() + 3)
+    );
+
+    WINDOW* win = newwin(win_height, win_width, viewport_top, viewport_left);
+    if (!win)
+    {
+        return entries.size();
+    }
+    keypad(win, TRUE);
+
+    // Rows shown are every entry with the pinned ones first, in vault order
+    // or the order TAB picked, the filter's substring matches, or ranked
+    // fuzzy matches when there are none, then BACK
+    IncrementalFilter filter(entries);
+    std::vector<size_t> ranked;
+    bool fuzzy = false;
+
+    // Cycled by TAB; none means vault order
+    std::optional<vault::EntryOrder> order;
+    std::vector<size_t> unfiltered;
+    std::vector<bool> is_pinned(entries.size(), false);
+    for (const size_t index : pinned)
+    {
+        is_pinned[index] = true;
+    }
+
+    // The table caches each order, so only the first TAB to it sorts
+    auto arrange = [&]()
     {
-        werase(pad);
-        box(pad, 0, 0);
-        for (int i = 0; i < num_entries; ++i)
+        unfiltered.assign(pinned.begin(), pinned.end());
+        unfiltered.reserve(entries.size());
+        auto add = [&](size_t index)
         {
-            if (i < entries.size())
+            if (!is_pinned[index])
             {
-                const auto& name = entries[i].name;
-                const char* name_str = reinterpret_cast<const char*>(name.data());
-                const int   name_len = static_cast<int>(name.size());
-
-                if (i == selected)
-                {
-                    wattron(pad, A_REVERSE); 
-                    
-                    mvwhline(pad, 1 + i, 1, ' ', COLS/3 - 2);
-                    mvwprintw(pad, 1 + i, 2, "%s", entries[i].name.c_str());
-                    
-                    wattroff(pad, A_REVERSE);
-                }
-                else 
-                {
-                  mvwprintw(pad, 1 + i, 1, "%s", entries[i].name.c_str());
-                }
+                unfiltered.push_back(index);
             }
-            else 
+        };
+        if (order)
+        {
+            for (const uint32_t row : entries.sorted_rows(*order))
             {
-                if (i == selected)
-                {
-                    wattron(pad, A_REVERSE);
-                }
-
-                mvwhline(pad, 1 + i, 1, ' ', COLS/3 - 2);
-                mvwprintw(pad, 1 + i, COLS/6 - 2, "BACK");
-
-                if (i == selected)
-                {
-                    wattroff(pad, A_REVERSE);
-                }
+                add(row);
             }
         }
+        else
+        {
+            for (size_t index = 0; index < entries.size(); ++index)
+            {
+                add(index);
+            }
+        }
+    };
+    arrange();
 
-        mvwprintw(pad, 0, 1, "%s", "Entries");
-        prefresh(pad, pad_scroll, 0, viewport_top, viewport_left, viewport_bottom, viewport_right);
+    auto shown = [&]() -> const std::vector<size_t>&
+    {
+        if (fuzzy)
+        {
+            return ranked;
+        }
+        return filter.query().empty() ? unfiltered : filter.matches();
     };
 
-    render();
+    ListViewport view(shown().size() + 1, static_cast<size_t>(std::max(win_height - 2, 1)));
 
-    while (true)
+    auto entry_at = [&](size_t row)
     {
-        int ch = wgetch(pad);
+        return row < shown().size() ? shown()[row] : entries.size();
+    };
 
-        if (ch == KEY_UP && selected > 0)
-        {
-            --selected;
-            if (selected < pad_scroll)
-                --pad_scroll;
-        }
-        else if (ch == KEY_DOWN && selected < num_entries - 1)
-        {
-            ++selected;
-            if (selected >= pad_scroll + viewport_height)
-                ++pad_scroll;
-        }
-        else if (ch == '\n' || ch == KEY_ENTER)
+    auto refilter = [&]()
+    {
+        ranked.clear();
+        fuzzy = !filter.query().empty() && filter.matches().empty();
+        if (fuzzy)
         {
-            if (selected == num_entries - 1)
+            for (const auto& match : vault::FuzzyMatcher(filter.query()).top(entries.names(), FUZZY_RESULTS))
             {
-                werase(pad);
-                wrefresh(pad);
-                delwin(pad);
-                return 'l';
-            }
-            else
-            {
-                auto check = check_remove_entry(dyn_content_start_row_, message_content_height_);
-                werase(pad);
-                wrefresh(pad);
-                delwin(pad);
-                if (check)
-                {
-                    return selected;
-                }
-                else 
-                {
-                    return 'l';
-                }
+                ranked.push_back(match.index);
             }
         }
+        view.reset(shown().size() + 1);
+    };
 
-        render();
-    }
+    auto draw_row = [&](size_t row)
+    {
+        if (row < view.top() || row >= view.bottom())
+        {
+            return;
+        }
 
-    delwin(pad);
-}
+        const int y = 1 + static_cast<int>(row - view.top());
+        const bool highlighted = row == view.selected();
+        if (highlighted)
+        {
+            wattron(win, A_REVERSE);
+        }
 
-void TerminalUI::list_entries(const std::vector<vault::Entry>& entries)
-{
-    if (entries.empty()) return;
+        mvwhline(win, y, 1, ' ', win_width - 2);
+        const size_t index = entry_at(row);
+        if (index < entries.size())
+        {
+            const int x = highlighted ? 2 : 1;
+            const std::string_view name = entries.name(index);
+            mvwaddnstr(win, y, x, name.data(), std::min(static_cast<int>(name.size()), win_width - x - 1));
+        }
+        else
+        {
+            mvwprintw(win, y, win_width / 2 - 2, "BACK");
+        }
 
-    const int num_entries = static_cast<int>(entries.size()) + 1;
-    const int content_start = dyn_content_start_row_;
-    const int viewport_top = content_start;
-    const int viewport_left = COLS / 3;
-    const int viewport_bottom = LINES - 1;
-    const int viewport_right = COLS - 1;
-    const int viewport_height = viewport_bottom - viewport_top + 1;
+        if (highlighted)
+        {
+            wattroff(win, A_REVERSE);
+        }
+    };
 
-    WINDOW* pad = newpad(num_entries + 2, COLS / 3);
-    if (!pad) 
+    // Only the visible rows are ever touched, so cost is bounded by the
+    // window height rather than the entry count
+    auto draw_window = [&]()
     {
-        return;
-    }
-
-    keypad(pad, TRUE); 
+        for (size_t row = view.top(); row < view.bottom(); ++row)
+        {
+            draw_row(row);
+        }
+        for (int y = 1 + static_cast<int>(view.bottom() - view.top()); y < win_height - 1; ++y)
+        {
+            mvwhline(win, y, 1, ' ', win_width - 2);
+        }
+        box(win, 0, 0);
+        if (filter.query().empty())
+        {
+            mvwprintw(win, 0, 1, "%s", order_title(order));
+        }
+        else
+        {
+            mvwprintw(win, 0, 1, fuzzy ? "Fuzzy: " : "Search: ");
+            waddnstr(win, filter.query().c_str(), win_width - 11);
+        }
+        wrefresh(win);
+    };
 
-    int selected   = 0; 
-    int pad_scroll = 0; 
+    draw_window();
 
-    auto render = [&]()
+    while (true)
     {
-        werase(pad);
-        box(pad, 0, 0);
-        for (int i = 0; i < num_entries; ++i)
-        {
-            if (i < entries.size())
-            {
-                const auto& name = entries[i].name;
-                const char* name_str = reinterpret_cast<const char*>(name.data());
-                const int   name_len = static_cast<int>(name.size());
+        const int ch = wgetch(win);
 
-                if (i == selected)
+        ListViewport::Redraw redraw = ListViewport::Redraw::None;
+        switch (ch)
+        {
+            case KEY_UP:    redraw = view.up();        break;
+            case KEY_DOWN:  redraw = view.down();      break;
+            case KEY_PPAGE: redraw = view.page_up();   break;
+            case KEY_NPAGE: redraw = view.page_down(); break;
+            case KEY_HOME:  redraw = view.home();      break;
+            case KEY_END:   redraw = view.end();       break;
+            case '\t':
+                if (filter.query().empty())
                 {
-                    wattron(pad, A_REVERSE); 
-                    
-                    mvwhline(pad, i + 1, 1, ' ', COLS/3 - 2);
-                    mvwprintw(pad, i + 1, 2, "%s", entries[i].name.c_str());
-                    
-                    wattroff(pad, A_REVERSE);
+                    order = next_order(order);
+                    arrange();
+                    view.reset(shown().size() + 1);
+                    redraw = ListViewport::Redraw::Window;
                 }
-                else 
+                break;
+            case KEY_BACKSPACE:
+            case 127:
+            case '\b':
+                if (!filter.query().empty())
                 {
-                  mvwprintw(pad, i + 1, 1, "%s", entries[i].name.c_str());
+                    filter.pop();
+                    refilter();
+                    redraw = ListViewport::Redraw::Window;
                 }
-            }
-            else 
+                break;
+            case '\n':
+            case KEY_ENTER:
             {
-                if (i == selected)
+                const size_t index = entry_at(view.selected());
+                if (index == entries.size() || choose(index))
                 {
-                    wattron(pad, A_REVERSE);
+                    werase(win);
+                    wrefresh(win);
+                    delwin(win);
+                    return index;
                 }
-
-                mvwhline(pad, i + 1, 1, ' ', COLS/3 - 2);
-                mvwprintw(pad, i + 1, COLS/6 - 2, "BACK");
-
-                if (i == selected)
+                // Whatever `choose` drew may have covered the list
+                touchwin(win);
+                wrefresh(win);
+                break;
+            }
+            default:
+                if (ch >= 32 && ch < 127)
                 {
-                    wattroff(pad, A_REVERSE);
+                    filter.push(static_cast<char>(ch));
+                    refilter();
+                    redraw = ListViewport::Redraw::Window;
                 }
-            }
+                break;
         }
 
-        mvwprintw(pad, 0, 1, "%s", "Entries");
-        prefresh(pad, pad_scroll, 0, viewport_top, viewport_left, viewport_bottom, viewport_right);
-    };
-
-    render();
-
-    while (true)
-    {
-        int ch = wgetch(pad);
-
-        if (ch == KEY_UP && selected > 0)
+        if (redraw == ListViewport::Redraw::Window)
         {
-            --selected;
-            if (selected < pad_scroll)
-                --pad_scroll;
+            draw_window();
         }
-        else if (ch == KEY_DOWN && selected < num_entries - 1)
+        else if (redraw == ListViewport::Redraw::Selection)
         {
-            ++selected;
-            if (selected >= pad_scroll + viewport_height)
-                ++pad_scroll;
-        }
-        else if (ch == '\n' || ch == KEY_ENTER)
-        {
-            if (selected == num_entries - 1)
-            {
-                werase(pad);
-                wrefresh(pad);
-                delwin(pad);
-                return;
-            }
-            else
-            {
-                // List specific entry
-                display_entry(entries[selected]);
-            }
+            draw_row(view.previous());
+            draw_row(view.selected());
+            wrefresh(win);
         }
+    }
+}
 
-        render();
+util::Expected<size_t, char> TerminalUI::remove_entry(const vault::EntryTable& entries)
+{
+    if (entries.empty()) return 'l';
+
+    bool confirmed = false;
+    const size_t chosen = pick_entry(entries, {}, [&](size_t)
+    {
+        // Any answer closes the list; only REMOVE ENTRY removes
+        confirmed = check_remove_entry(dyn_content_start_row_);
+        return true;
+    });
+
+    if (chosen == entries.size() || !confirmed)
+    {
+        return 'l';
     }
+    return chosen;
+}
+
+util::Expected<size_t, char> TerminalUI::select_entry(const vault::EntryTable& entries)
+{
+    if (entries.empty()) return 'l';
 
-    delwin(pad);
+    const size_t chosen = pick_entry(entries, {}, [](size_t) { return true; });
+    if (chosen == entries.size())
+    {
+        return 'l';
+    }
+    return chosen;
+}
+
+util::Expected<vault::EntryField, char> TerminalUI::select_field(const vault::EntryView&)
+{
+    constexpr vault::EntryField fields[] = {
+        vault::EntryField::Name,
+        vault::EntryField::Username,
+        vault::EntryField::Secret
+    };
+
+    const size_t chosen = pick_option(
+        "Edit which field?",
+        { "NAME", "USERNAME/EMAIL", "PASSWORD", "CANCEL" },
+        dyn_content_start_row_
+    );
+    if (chosen >= std::size(fields))
+    {
+        return 'l';
+    }
+    return fields[chosen];
+}
+
+std::vector<size_t> TerminalUI::list_entries(
+    const vault::EntryTable& entries,
+    const std::vector<size_t>& pinned)
+{
+    std::vector<size_t> opened;
+    if (entries.empty()) return opened;
+
+    pick_entry(entries, pinned, [&](size_t index)
+    {
+        display_entry(entries[index]);
+        opened.push_back(index);
+        return false;
+    });
+    return opened;
 }
 
 util::Expected<util::SecureString, std::string> TerminalUI::prompt_master_password ()
@@ -921,6 +1042,13 @@ util::Expected<util::SecureString, std::string> TerminalUI::prompt_master_passwo
 }
 
 util::Expected<util::SecureString, std::string> TerminalUI::prompt_input (std::string prompt)
+{
+    return prompt_input(std::move(prompt), NameHinter{});
+}
+
+util::Expected<util::SecureString, std::string> TerminalUI::prompt_input (
+    std::string prompt,
+    const NameHinter& hints)
 {
     const int win_height = message_content_height_;
     const int win_width = COLS / 3;
@@ -931,6 +1059,11 @@ util::Expected<util::SecureString, std::string> TerminalUI::prompt_input (std::s
     {
         return std::string("");
     }
+
+    // Hints sit under the input: a warning line, then the completions
+    WINDOW* hint_win = hints
+        ? newwin(NAME_HINTS + 1, win_width, content_start + win_height, win_width)
+        : nullptr;
     
     keypad(prompt_input_win, TRUE);
     box(prompt_input_win, 0, 0);
@@ -943,6 +1076,38 @@ util::Expected<util::SecureString, std::string> TerminalUI::prompt_input (std::s
     const int input_col_start = 1;
     int ch;
 
+    NameHints current;
+    auto show_hints = [&]()
+    {
+        if (!hint_win)
+        {
+            return;
+        }
+        current = hints(std::string_view(buf.data(), buf.size()));
+
+        werase(hint_win);
+        if (current.taken)
+        {
+            wattron(hint_win, COLOR_PAIR(8) | A_BOLD);
+            mvwprintw(hint_win, 0, 1, "%s", "Name already exists");
+            wattroff(hint_win, COLOR_PAIR(8) | A_BOLD);
+        }
+        const int shown = std::min(static_cast<int>(current.completions.size()), NAME_HINTS);
+        for (int i = 0; i < shown; ++i)
+        {
+            mvwaddnstr(hint_win, 1 + i, 1, current.completions[i].c_str(), win_width - 2);
+        }
+        wrefresh(hint_win);
+    };
+
+    auto redraw_input = [&]()
+    {
+        mvwhline(prompt_input_win, 1, input_col_start, ' ', win_width - 2);
+        mvwaddnstr(prompt_input_win, 1, input_col_start, buf.data(), static_cast<int>(buf.size()));
+    };
+
+    show_hints();
+
     while ((ch = wgetch(prompt_input_win)) != '\n' && ch != KEY_ENTER)
     {
         if ((ch == KEY_BACKSPACE || ch == 127 || ch == '\b') && !buf.empty())
@@ -951,20 +1116,38 @@ util::Expected<util::SecureString, std::string> TerminalUI::prompt_input (std::s
             const int cursor_x = input_col_start + static_cast<int>(buf.size());
             mvwaddch(prompt_input_win, 1, cursor_x, ' ');
         }
+        else if (ch == '\t' && !current.completions.empty())
+        {
+            const auto& completion = current.completions.front();
+            sodium_memzero(buf.data(), buf.capacity());
+            buf.assign(completion.c_str(), completion.c_str() + completion.size());
+            redraw_input();
+        }
         else if (ch >= 32 && ch < 127) 
         {
             buf.push_back(static_cast<char>(ch));
             const int cursor_x = input_col_start + static_cast<int>(buf.size()) - 1;
             mvwaddch(prompt_input_win, 1, cursor_x, static_cast<char>(ch));
         }
+        else
+        {
+            continue;
+        }
 
         wrefresh(prompt_input_win);
+        show_hints();
     }
 
     util::SecureString result(std::string_view(buf.data(), buf.size()));
 
     sodium_memzero(buf.data(), buf.capacity());
 
+    if (hint_win)
+    {
+        werase(hint_win);
+        wrefresh(hint_win);
+        delwin(hint_win);
+    }
     werase(prompt_input_win);
     wrefresh(prompt_input_win);
     delwin(prompt_input_win);
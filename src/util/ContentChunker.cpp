@@ -0,0 +1,86 @@
+#include "util/ContentChunker.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+namespace util
+{
+
+namespace
+{
+
+// One pseudo-random word per byte value. The table is fixed, so the same
+// data is cut the same way by every build.
+constexpr std::array<uint64_t, 256> make_gear () noexcept
+{
+    std::array<uint64_t, 256> gear{};
+    uint64_t state = 0x9e3779b97f4a7c15;
+    for (uint64_t& word : gear)
+    {
+        // splitmix64
+        state += 0x9e3779b97f4a7c15;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        word = z ^ (z >> 31);
+    }
+    return gear;
+}
+
+constexpr std::array<uint64_t, 256> GEAR = make_gear();
+
+// The top `bits` bits; shifting left moves older bytes out of the top, so
+// these are the bits most recent bytes have mixed into
+constexpr uint64_t top_bits (unsigned bits) noexcept
+{
+    return ~uint64_t{0} << (64 - bits);
+}
+
+} // unnamed namespace
+
+ContentChunker::ContentChunker (size_t min_size, size_t average, size_t max_size) noexcept
+    : min_size_(min_size)
+    , average_(average)
+    , max_size_(max_size)
+{
+    // A cut matches log2(average) bits on average; two more or two fewer
+    // either side of it, as FastCDC's second normalisation level does
+    const auto bits = static_cast<unsigned>(std::countr_zero(average));
+    strict_mask_ = top_bits(bits + 2);
+    loose_mask_ = top_bits(bits - 2);
+}
+
+size_t ContentChunker::cut (std::span<const uint8_t> data) const noexcept
+{
+    if (data.size() <= min_size_)
+    {
+        return data.size();
+    }
+
+    const size_t end = std::min(data.size(), max_size_);
+    const size_t normal = std::min(end, average_);
+
+    // Bytes before min_size_ can never end a chunk, so hashing starts there
+    uint64_t hash = 0;
+    size_t i = min_size_;
+    for (; i < normal; ++i)
+    {
+        hash = (hash << 1) + GEAR[data[i]];
+        if ((hash & strict_mask_) == 0)
+        {
+            return i + 1;
+        }
+    }
+    for (; i < end; ++i)
+    {
+        hash = (hash << 1) + GEAR[data[i]];
+        if ((hash & loose_mask_) == 0)
+        {
+            return i + 1;
+        }
+    }
+    return end;
+}
+
+} // namespace util
@@ -0,0 +1,49 @@
+#include "util/FileUtil.h"
+
+#include <fstream>
+#include <system_error>
+
+namespace util
+{
+
+bool write_file_atomic (
+    const std::filesystem::path& path,
+    std::span<const uint8_t> contents
+)
+{
+    std::filesystem::path tmp_path = path;
+    tmp_path += ".tmp";
+
+    {
+        std::ofstream output(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!output)
+        {
+            return false;
+        }
+
+        output.write(
+            reinterpret_cast<const char*>(contents.data()),
+            static_cast<std::streamsize>(contents.size())
+        );
+        output.flush();
+
+        if (!output)
+        {
+            std::error_code ec;
+            std::filesystem::remove(tmp_path, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace util
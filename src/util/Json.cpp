@@ -0,0 +1,293 @@
+#include "util/Json.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <sodium/utils.h>
+
+namespace util
+{
+
+namespace
+{
+
+class Parser
+{
+    public:
+        explicit Parser (std::string_view text) : text_(text) {}
+
+        void skip_whitespace () noexcept
+        {
+            while (pos_ < text_.size() &&
+                   (text_[pos_] == ' ' || text_[pos_] == '\t' ||
+                    text_[pos_] == '\r' || text_[pos_] == '\n'))
+            {
+                ++pos_;
+            }
+        }
+
+        bool consume (char c) noexcept
+        {
+            skip_whitespace();
+            if (pos_ < text_.size() && text_[pos_] == c)
+            {
+                ++pos_;
+                return true;
+            }
+            return false;
+        }
+
+        bool peek (char c) noexcept
+        {
+            skip_whitespace();
+            return pos_ < text_.size() && text_[pos_] == c;
+        }
+
+        bool at_end () noexcept
+        {
+            skip_whitespace();
+            return pos_ == text_.size();
+        }
+
+        // Decodes a quoted string into `out`, expanding escapes to UTF-8
+        bool string (std::vector<char>& out)
+        {
+            if (!consume('"'))
+            {
+                return false;
+            }
+
+            while (pos_ < text_.size())
+            {
+                const char c = text_[pos_++];
+                if (c == '"')
+                {
+                    return true;
+                }
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    return false;
+                }
+                if (c != '\\')
+                {
+                    out.push_back(c);
+                    continue;
+                }
+
+                if (pos_ == text_.size())
+                {
+                    return false;
+                }
+                switch (text_[pos_++])
+                {
+                    case '"':  out.push_back('"');  break;
+                    case '\\': out.push_back('\\'); break;
+                    case '/':  out.push_back('/');  break;
+                    case 'b':  out.push_back('\b'); break;
+                    case 'f':  out.push_back('\f'); break;
+                    case 'n':  out.push_back('\n'); break;
+                    case 'r':  out.push_back('\r'); break;
+                    case 't':  out.push_back('\t'); break;
+                    case 'u':
+                        if (!unicode_escape(out))
+                        {
+                            return false;
+                        }
+                        break;
+                    default:
+                        return false;
+                }
+            }
+            return false;
+        }
+
+    private:
+        bool hex4 (uint32_t& value) noexcept
+        {
+            if (text_.size() - pos_ < 4)
+            {
+                return false;
+            }
+            value = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                const char c = text_[pos_++];
+                value <<= 4;
+                if (c >= '0' && c <= '9')      value |= static_cast<uint32_t>(c - '0');
+                else if (c >= 'a' && c <= 'f') value |= static_cast<uint32_t>(c - 'a' + 10);
+                else if (c >= 'A' && c <= 'F') value |= static_cast<uint32_t>(c - 'A' + 10);
+                else return false;
+            }
+            return true;
+        }
+
+        bool unicode_escape (std::vector<char>& out)
+        {
+            uint32_t code = 0;
+            if (!hex4(code))
+            {
+                return false;
+            }
+
+            // Characters outside the BMP arrive as a surrogate pair
+            if (code >= 0xD800 && code <= 0xDBFF)
+            {
+                uint32_t low = 0;
+                if (text_.substr(pos_, 2) != "\\u")
+                {
+                    return false;
+                }
+                pos_ += 2;
+                if (!hex4(low) || low < 0xDC00 || low > 0xDFFF)
+                {
+                    return false;
+                }
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            }
+            else if (code >= 0xDC00 && code <= 0xDFFF)
+            {
+                return false;
+            }
+
+            if (code < 0x80)
+            {
+                out.push_back(static_cast<char>(code));
+            }
+            else if (code < 0x800)
+            {
+                out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            }
+            else if (code < 0x10000)
+            {
+                out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            }
+            else
+            {
+                out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            }
+            return true;
+        }
+
+        std::string_view text_;
+        std::size_t pos_ = 0;
+};
+
+} // unnamed namespace
+
+Expected<JsonObject, JsonError> JsonObject::parse (std::string_view text)
+{
+    Parser parser(text);
+    JsonObject object;
+
+    if (!parser.consume('{'))
+    {
+        return JsonError::Syntax;
+    }
+
+    // No decoded string is longer than the text it came from, so the buffer
+    // never reallocates and leaves no unwiped copy of a value behind
+    std::vector<char> buffer;
+    buffer.reserve(text.size());
+    auto wipe = [&buffer]()
+    {
+        sodium_memzero(buffer.data(), buffer.size());
+        buffer.clear();
+    };
+
+    if (!parser.consume('}'))
+    {
+        do
+        {
+            if (!parser.string(buffer))
+            {
+                wipe();
+                return JsonError::Syntax;
+            }
+            std::string key(buffer.begin(), buffer.end());
+            wipe();
+
+            if (!parser.consume(':'))
+            {
+                return JsonError::Syntax;
+            }
+            if (!parser.peek('"'))
+            {
+                return JsonError::UnsupportedValue;
+            }
+            if (!parser.string(buffer))
+            {
+                wipe();
+                return JsonError::Syntax;
+            }
+            SecureString value(std::string_view(buffer.data(), buffer.size()));
+            wipe();
+
+            if (object.find(key))
+            {
+                return JsonError::DuplicateKey;
+            }
+            object.fields_.emplace_back(std::move(key), std::move(value));
+        }
+        while (parser.consume(','));
+
+        if (!parser.consume('}'))
+        {
+            return JsonError::Syntax;
+        }
+    }
+
+    if (!parser.at_end())
+    {
+        return JsonError::Syntax;
+    }
+    return object;
+}
+
+const SecureString* JsonObject::find (std::string_view key) const noexcept
+{
+    for (const auto& [name, value] : fields_)
+    {
+        if (name == key)
+        {
+            return &value;
+        }
+    }
+    return nullptr;
+}
+
+void append_json_string (std::string& out, std::string_view value)
+{
+    out.push_back('"');
+    for (const char c : value)
+    {
+        switch (c)
+        {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b";  break;
+            case '\f': out += "\\f";  break;
+            case '\n': out += "\\n";  break;
+            case '\r': out += "\\r";  break;
+            case '\t': out += "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escaped[7];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                    out += escaped;
+                }
+                else
+                {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+}
+
+} // namespace util
@@ -0,0 +1,244 @@
+#include "util/ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace util
+{
+
+namespace
+{
+
+// Lets submit() from inside a task push onto the submitting worker's deque
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local std::size_t current_worker = 0;
+
+// State shared between a parallel_for caller and its helper tasks. Helpers
+// may start after the caller has returned, so it outlives the call.
+struct ParallelForState
+{
+    std::size_t count = 0;
+    const std::function<void(std::size_t)>* body = nullptr;
+
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> running{0};
+
+    std::mutex mutex;
+    std::condition_variable done;
+
+    void drain ()
+    {
+        for (std::size_t i; (i = next.fetch_add(1)) < count;)
+        {
+            (*body)(i);
+        }
+    }
+};
+
+} // unnamed namespace
+
+ThreadPool::ThreadPool (std::size_t workers)
+{
+    if (workers == 0)
+    {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    workers_.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i)
+    {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (std::size_t i = 0; i < workers; ++i)
+    {
+        workers_[i]->thread = std::thread(&ThreadPool::run_worker, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool ()
+{
+    {
+        std::lock_guard lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    sleep_cv_.notify_all();
+
+    for (auto& worker : workers_)
+    {
+        worker->thread.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared ()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::enqueue (Task task)
+{
+    const std::size_t index = current_pool == this
+        ? current_worker
+        : next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+
+    {
+        std::lock_guard lock(workers_[index]->mutex);
+        workers_[index]->queue.push_back(std::move(task));
+    }
+
+    // Counted under the sleep mutex so a worker about to wait cannot miss it
+    {
+        std::lock_guard lock(sleep_mutex_);
+        pending_.fetch_add(1);
+    }
+    sleep_cv_.notify_one();
+}
+
+ThreadPool::Task ThreadPool::pop_local (std::size_t index)
+{
+    Worker& worker = *workers_[index];
+    std::lock_guard lock(worker.mutex);
+    if (worker.queue.empty())
+    {
+        return {};
+    }
+
+    Task task = std::move(worker.queue.back());
+    worker.queue.pop_back();
+    return task;
+}
+
+ThreadPool::Task ThreadPool::steal (std::size_t thief)
+{
+    for (std::size_t offset = 1; offset < workers_.size(); ++offset)
+    {
+        Worker& victim = *workers_[(thief + offset) % workers_.size()];
+        std::unique_lock lock(victim.mutex, std::try_to_lock);
+        if (!lock || victim.queue.empty())
+        {
+            continue;
+        }
+
+        Task task = std::move(victim.queue.front());
+        victim.queue.pop_front();
+        return task;
+    }
+    return {};
+}
+
+void ThreadPool::run_worker (std::size_t index)
+{
+    current_pool = this;
+    current_worker = index;
+    Worker& self = *workers_[index];
+
+    while (true)
+    {
+        bool stolen = false;
+        Task task = pop_local(index);
+        if (!task)
+        {
+            task = steal(index);
+            stolen = static_cast<bool>(task);
+        }
+
+        if (task)
+        {
+            pending_.fetch_sub(1);
+            if (task.run())
+            {
+                self.executed.fetch_add(1, std::memory_order_relaxed);
+                if (stolen)
+                {
+                    self.stolen.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            else
+            {
+                self.cancelled.fetch_add(1, std::memory_order_relaxed);
+            }
+            continue;
+        }
+
+        std::unique_lock lock(sleep_mutex_);
+        if (stopping_ && pending_.load() == 0)
+        {
+            return;
+        }
+
+        // A steal can miss a task behind a contended lock, so never sleep
+        // while anything is still queued
+        sleep_cv_.wait(lock, [this]
+        {
+            return stopping_ || pending_.load() > 0;
+        });
+    }
+}
+
+void ThreadPool::parallel_for (
+    std::size_t count,
+    const std::function<void(std::size_t)>& body
+)
+{
+    const std::size_t helpers = std::min(workers_.size(), count) - (count > 0 ? 1 : 0);
+    if (helpers == 0)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            body(i);
+        }
+        return;
+    }
+
+    auto state = std::make_shared<ParallelForState>();
+    state->count = count;
+    state->body = &body;
+
+    for (std::size_t h = 0; h < helpers; ++h)
+    {
+        enqueue(Task([state]()
+        {
+            // Register before claiming work, so the caller waits for any
+            // helper that gets an index
+            state->running.fetch_add(1);
+            state->drain();
+            if (state->running.fetch_sub(1) == 1)
+            {
+                std::lock_guard lock(state->mutex);
+                state->done.notify_all();
+            }
+            return true;
+        }));
+    }
+
+    state->drain();
+
+    std::unique_lock lock(state->mutex);
+    state->done.wait(lock, [&state]
+    {
+        return state->running.load() == 0;
+    });
+}
+
+std::vector<WorkerStats> ThreadPool::stats () const
+{
+    std::vector<WorkerStats> out;
+    out.reserve(workers_.size());
+
+    for (const auto& worker : workers_)
+    {
+        out.push_back({
+            worker->executed.load(std::memory_order_relaxed),
+            worker->stolen.load(std::memory_order_relaxed),
+            worker->cancelled.load(std::memory_order_relaxed)
+        });
+    }
+    return out;
+}
+
+} // namespace util
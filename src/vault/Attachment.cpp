@@ -0,0 +1,74 @@
+#include "vault/Attachment.h"
+#include "util/ByteOrder.h"
+#include "vault/EntryRecord.h"
+
+#include <cstring>
+#include <span>
+
+namespace vault
+{
+
+namespace
+{
+
+std::span<const uint8_t> bytes_of (std::string_view s) noexcept
+{
+    return { reinterpret_cast<const uint8_t*>(s.data()), s.size() };
+}
+
+} // unnamed namespace
+
+std::string encode_attachment (std::string_view name, const Blob& blob)
+{
+    std::array<uint8_t, util::MAX_VARINT_SIZE> size;
+    const size_t size_len = util::store_varint(blob.size, std::span(size));
+
+    std::string value;
+    value.reserve(BLOB_ID_SIZE + size_len + name.size());
+    value.append(reinterpret_cast<const char*>(blob.id.data()), blob.id.size());
+    value.append(reinterpret_cast<const char*>(size.data()), size_len);
+    value.append(name);
+    return value;
+}
+
+std::optional<AttachmentView> decode_attachment (std::string_view value) noexcept
+{
+    util::ByteReader reader(bytes_of(value));
+    std::span<const uint8_t> id;
+    AttachmentView out;
+    if (!reader.read_bytes(BLOB_ID_SIZE, id) || !reader.read_varint(out.blob.size))
+    {
+        return std::nullopt;
+    }
+    std::memcpy(out.blob.id.data(), id.data(), id.size());
+    out.name = value.substr(reader.offset());
+    if (out.name.empty())
+    {
+        return std::nullopt;
+    }
+    return out;
+}
+
+bool next_attachment (std::string_view& fields, AttachmentView& out) noexcept
+{
+    RecordReader reader(bytes_of(fields));
+    uint64_t type;
+    std::span<const uint8_t> value;
+    if (!reader.next(type, value))
+    {
+        return false;
+    }
+
+    const auto decoded = decode_attachment(
+        { reinterpret_cast<const char*>(value.data()), value.size() }
+    );
+    if (!decoded)
+    {
+        return false;
+    }
+    out = *decoded;
+    fields.remove_prefix(reader.raw().size());
+    return true;
+}
+
+} // namespace vault
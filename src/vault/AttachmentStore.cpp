@@ -0,0 +1,156 @@
+#include "vault/AttachmentStore.h"
+#include "crypto/CryptoTypes.h"
+#include "util/ByteOrder.h"
+#include "vault/VaultFileError.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace vault
+{
+
+namespace
+{
+
+// The store's keys are derived under a context of exactly crypto_kdf_CONTEXTBYTES
+constexpr char KDF_CONTEXT[] = "vaultatt";
+
+} // unnamed namespace
+
+AttachmentStore::AttachmentStore (
+    std::filesystem::path root,
+    std::span<const uint8_t> vault_key
+)
+    : objects_(std::move(root), vault_key, KDF_CONTEXT)
+{}
+
+std::filesystem::path AttachmentStore::beside (const std::filesystem::path& vault_path)
+{
+    std::filesystem::path root = vault_path;
+    root += ".attachments";
+    return root;
+}
+
+util::Expected<Blob, VaultFileError> AttachmentStore::put (std::span<const uint8_t> data)
+{
+    const size_t chunk_count = (data.size() + ATTACHMENT_CHUNK_SIZE - 1) / ATTACHMENT_CHUNK_SIZE;
+
+    crypto::ByteBuffer manifest(util::MAX_VARINT_SIZE + chunk_count * BLOB_ID_SIZE);
+    size_t manifest_size = util::store_varint(
+        data.size(),
+        std::span(manifest).first<util::MAX_VARINT_SIZE>()
+    );
+
+    crypto::SecureBuffer scratch;
+    for (size_t offset = 0; offset < data.size(); offset += ATTACHMENT_CHUNK_SIZE)
+    {
+        const auto chunk = data.subspan(offset, std::min(ATTACHMENT_CHUNK_SIZE, data.size() - offset));
+        const BlobId id = objects_.address(ObjectKind::Chunk, chunk);
+        auto written = objects_.write(ObjectKind::Chunk, id, chunk, scratch);
+        if (!written)
+        {
+            return written.error();
+        }
+        std::memcpy(manifest.data() + manifest_size, id.data(), id.size());
+        manifest_size += id.size();
+    }
+
+    const auto listing = std::span<const uint8_t>(manifest).first(manifest_size);
+    Blob blob{ objects_.address(ObjectKind::Manifest, listing), data.size() };
+    auto written = objects_.write(ObjectKind::Manifest, blob.id, listing, scratch);
+    if (!written)
+    {
+        return written.error();
+    }
+    return blob;
+}
+
+util::Expected<crypto::SecureBuffer, VaultFileError> AttachmentStore::get (const Blob& blob) const
+{
+    auto manifest = read_manifest(blob.id);
+    if (!manifest)
+    {
+        return manifest.error();
+    }
+    if (manifest.value().size != blob.size)
+    {
+        return VaultFileError::CryptoError;
+    }
+
+    crypto::SecureBuffer out(static_cast<size_t>(blob.size));
+    crypto::SecureBuffer buffer;
+    size_t offset = 0;
+    for (const BlobId& id : manifest.value().chunks)
+    {
+        auto chunk = objects_.open(ObjectKind::Chunk, id, buffer);
+        if (!chunk)
+        {
+            return chunk.error();
+        }
+        // Every chunk but the last is full, so the sizes must line up
+        const size_t expected = std::min(ATTACHMENT_CHUNK_SIZE, out.size() - offset);
+        if (chunk.value().size() != expected)
+        {
+            return VaultFileError::CryptoError;
+        }
+        std::memcpy(out.data() + offset, chunk.value().data(), expected);
+        offset += expected;
+    }
+    return out;
+}
+
+util::Expected<size_t, VaultFileError> AttachmentStore::prune (std::span<const BlobId> live)
+{
+    // A manifest that cannot be read leaves its chunks unknown, so nothing
+    // is deleted rather than risk deleting them
+    std::vector<BlobId> reachable(live.begin(), live.end());
+    for (const BlobId& id : live)
+    {
+        if (!contains(id))
+        {
+            continue;
+        }
+        auto manifest = read_manifest(id);
+        if (!manifest)
+        {
+            return manifest.error();
+        }
+        reachable.insert(reachable.end(), manifest.value().chunks.begin(), manifest.value().chunks.end());
+    }
+    std::sort(reachable.begin(), reachable.end());
+    return objects_.sweep(reachable);
+}
+
+util::Expected<AttachmentStore::Manifest, VaultFileError> AttachmentStore::read_manifest (
+    const BlobId& id
+) const
+{
+    crypto::SecureBuffer buffer;
+    auto opened = objects_.open(ObjectKind::Manifest, id, buffer);
+    if (!opened)
+    {
+        return opened.error();
+    }
+
+    util::ByteReader reader(opened.value());
+    Manifest manifest{};
+    if (!reader.read_varint(manifest.size) ||
+        reader.remaining() % BLOB_ID_SIZE != 0 ||
+        reader.remaining() / BLOB_ID_SIZE !=
+            (manifest.size + ATTACHMENT_CHUNK_SIZE - 1) / ATTACHMENT_CHUNK_SIZE)
+    {
+        return VaultFileError::InvalidFormat;
+    }
+
+    manifest.chunks.resize(reader.remaining() / BLOB_ID_SIZE);
+    for (BlobId& chunk : manifest.chunks)
+    {
+        std::span<const uint8_t> bytes;
+        reader.read_bytes(BLOB_ID_SIZE, bytes);
+        std::copy(bytes.begin(), bytes.end(), chunk.begin());
+    }
+    return manifest;
+}
+
+} // namespace vault
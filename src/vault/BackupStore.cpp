@@ -0,0 +1,354 @@
+#include "vault/BackupStore.h"
+#include "crypto/CryptoTypes.h"
+#include "util/ByteOrder.h"
+#include "vault/VaultFileError.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace vault
+{
+
+namespace
+{
+
+// The store's keys are derived under a context of exactly crypto_kdf_CONTEXTBYTES
+constexpr char KDF_CONTEXT[] = "vaultbkp";
+
+// Digits of a snapshot file's time: enough for any int64_t, so names sort
+// in time order
+constexpr size_t TAKEN_DIGITS = 20;
+
+constexpr int64_t HOUR = 60 * 60;
+constexpr int64_t DAY = 24 * HOUR;
+
+std::string snapshot_name (const BackupStore::Snapshot& snapshot)
+{
+    std::array<char, TAKEN_DIGITS + 1> taken{};
+    std::snprintf(taken.data(), taken.size(), "%020" PRId64, snapshot.taken);
+    return std::string(taken.data(), TAKEN_DIGITS) + "-" + to_hex(snapshot.id);
+}
+
+std::optional<BackupStore::Snapshot> parse_snapshot_name (std::string_view name)
+{
+    if (name.size() <= TAKEN_DIGITS || name[TAKEN_DIGITS] != '-')
+    {
+        return std::nullopt;
+    }
+    BackupStore::Snapshot snapshot;
+    const char* end = name.data() + TAKEN_DIGITS;
+    const auto parsed = std::from_chars(name.data(), end, snapshot.taken);
+    if (parsed.ec != std::errc{} || parsed.ptr != end ||
+        !from_hex(name.substr(TAKEN_DIGITS + 1), snapshot.id))
+    {
+        return std::nullopt;
+    }
+    return snapshot;
+}
+
+} // unnamed namespace
+
+BackupStore::BackupStore (
+    std::filesystem::path root,
+    std::span<const uint8_t> vault_key
+)
+    : root_(std::move(root))
+    , chunks_(root_ / "chunks", vault_key, KDF_CONTEXT)
+    , chunker_(BACKUP_MIN_CHUNK_SIZE, BACKUP_AVERAGE_CHUNK_SIZE, BACKUP_MAX_CHUNK_SIZE)
+{}
+
+std::filesystem::path BackupStore::beside (const std::filesystem::path& vault_path)
+{
+    std::filesystem::path root = vault_path;
+    root += ".backups";
+    return root;
+}
+
+util::Expected<BackupStore::Snapshot, VaultFileError> BackupStore::snapshot (
+    std::span<const uint8_t> payload,
+    int64_t taken
+)
+{
+    if (taken < 0)
+    {
+        return VaultFileError::InvalidFormat;
+    }
+
+    std::vector<std::span<const uint8_t>> pieces;
+    chunker_.split(payload, [&pieces](std::span<const uint8_t> chunk)
+    {
+        pieces.push_back(chunk);
+    });
+
+    crypto::ByteBuffer manifest(
+        3 * util::MAX_VARINT_SIZE +
+        pieces.size() * (util::MAX_VARINT_SIZE + BLOB_ID_SIZE)
+    );
+    size_t used = 0;
+    const auto put_varint = [&](uint64_t value)
+    {
+        used += util::store_varint(value, std::span(manifest).subspan(used).first<util::MAX_VARINT_SIZE>());
+    };
+    put_varint(static_cast<uint64_t>(taken));
+    put_varint(payload.size());
+    put_varint(pieces.size());
+
+    crypto::SecureBuffer scratch;
+    for (const auto chunk : pieces)
+    {
+        const BlobId id = chunks_.address(ObjectKind::Chunk, chunk);
+        auto written = chunks_.write(ObjectKind::Chunk, id, chunk, scratch);
+        if (!written)
+        {
+            return written.error();
+        }
+        put_varint(chunk.size());
+        std::memcpy(manifest.data() + used, id.data(), id.size());
+        used += id.size();
+    }
+
+    // The manifest goes last, so a snapshot that lists a chunk always has it
+    const auto listing = std::span<const uint8_t>(manifest).first(used);
+    const Snapshot snapshot{ chunks_.address(ObjectKind::Snapshot, listing), taken };
+    const auto path = snapshot_path(snapshot);
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec))
+    {
+        auto sealed = chunks_.seal_to(path, ObjectKind::Snapshot, snapshot.id, listing, scratch);
+        if (!sealed)
+        {
+            return sealed.error();
+        }
+    }
+    return snapshot;
+}
+
+util::Expected<std::vector<BackupStore::Snapshot>, VaultFileError> BackupStore::list () const
+{
+    std::vector<Snapshot> snapshots;
+    std::error_code ec;
+    const auto dir = root_ / "snapshots";
+    if (!std::filesystem::exists(dir, ec))
+    {
+        return snapshots;
+    }
+
+    // Anything else there, such as an interrupted write's temp file, is
+    // not a snapshot
+    for (const auto& item : std::filesystem::directory_iterator(dir, ec))
+    {
+        if (!item.is_regular_file())
+        {
+            continue;
+        }
+        if (auto snapshot = parse_snapshot_name(item.path().filename().string()))
+        {
+            snapshots.push_back(*snapshot);
+        }
+    }
+    if (ec)
+    {
+        return VaultFileError::IOError;
+    }
+
+    std::sort(snapshots.begin(), snapshots.end(), [](const Snapshot& a, const Snapshot& b)
+    {
+        return a.taken != b.taken ? a.taken < b.taken : a.id < b.id;
+    });
+    return snapshots;
+}
+
+util::Expected<crypto::SecureBuffer, VaultFileError> BackupStore::restore (const Snapshot& snapshot) const
+{
+    auto manifest = read_manifest(snapshot);
+    if (!manifest)
+    {
+        return manifest.error();
+    }
+
+    crypto::SecureBuffer out(static_cast<size_t>(manifest.value().size));
+    crypto::SecureBuffer buffer;
+    size_t offset = 0;
+    for (size_t i = 0; i < manifest.value().chunks.size(); ++i)
+    {
+        auto chunk = chunks_.open(ObjectKind::Chunk, manifest.value().chunks[i], buffer);
+        if (!chunk)
+        {
+            return chunk.error();
+        }
+        if (chunk.value().size() != manifest.value().lengths[i])
+        {
+            return VaultFileError::CryptoError;
+        }
+        std::memcpy(out.data() + offset, chunk.value().data(), chunk.value().size());
+        offset += chunk.value().size();
+    }
+    return out;
+}
+
+util::Expected<size_t, VaultFileError> BackupStore::prune (const RetentionPolicy& policy)
+{
+    auto snapshots = list();
+    if (!snapshots)
+    {
+        return snapshots.error();
+    }
+    const auto keep = retained(snapshots.value(), policy);
+
+    // As with attachments, a kept manifest that cannot be read leaves its
+    // chunks unknown, so nothing is deleted
+    std::vector<BlobId> reachable;
+    for (size_t i = 0; i < snapshots.value().size(); ++i)
+    {
+        if (!keep[i])
+        {
+            continue;
+        }
+        auto manifest = read_manifest(snapshots.value()[i]);
+        if (!manifest)
+        {
+            return manifest.error();
+        }
+        reachable.insert(reachable.end(), manifest.value().chunks.begin(), manifest.value().chunks.end());
+    }
+    std::sort(reachable.begin(), reachable.end());
+
+    size_t removed = 0;
+    std::error_code ec;
+    for (size_t i = 0; i < snapshots.value().size(); ++i)
+    {
+        if (keep[i])
+        {
+            continue;
+        }
+        if (std::filesystem::remove(snapshot_path(snapshots.value()[i]), ec))
+        {
+            ++removed;
+        }
+        else if (ec)
+        {
+            return VaultFileError::IOError;
+        }
+    }
+
+    auto swept = chunks_.sweep(reachable);
+    if (!swept)
+    {
+        return swept.error();
+    }
+    return removed;
+}
+
+std::filesystem::path BackupStore::snapshot_path (const Snapshot& snapshot) const
+{
+    return root_ / "snapshots" / snapshot_name(snapshot);
+}
+
+util::Expected<BackupStore::Manifest, VaultFileError> BackupStore::read_manifest (
+    const Snapshot& snapshot
+) const
+{
+    crypto::SecureBuffer buffer;
+    auto opened = chunks_.open_from(snapshot_path(snapshot), ObjectKind::Snapshot, snapshot.id, buffer);
+    if (!opened)
+    {
+        return opened.error();
+    }
+
+    util::ByteReader reader(opened.value());
+    uint64_t taken;
+    uint64_t count;
+    Manifest manifest{};
+    if (!reader.read_varint(taken) ||
+        !reader.read_varint(manifest.size) ||
+        !reader.read_varint(count) ||
+        count > reader.remaining() / (1 + BLOB_ID_SIZE))
+    {
+        return VaultFileError::InvalidFormat;
+    }
+    // Renaming a snapshot to dodge or confuse retention is caught here
+    if (taken != static_cast<uint64_t>(snapshot.taken))
+    {
+        return VaultFileError::CryptoError;
+    }
+
+    manifest.chunks.resize(static_cast<size_t>(count));
+    manifest.lengths.resize(static_cast<size_t>(count));
+    uint64_t total = 0;
+    for (size_t i = 0; i < manifest.chunks.size(); ++i)
+    {
+        uint64_t length;
+        std::span<const uint8_t> id;
+        if (!reader.read_varint(length) ||
+            length == 0 ||
+            length > BACKUP_MAX_CHUNK_SIZE ||
+            !reader.read_bytes(BLOB_ID_SIZE, id))
+        {
+            return VaultFileError::InvalidFormat;
+        }
+        manifest.lengths[i] = static_cast<uint32_t>(length);
+        std::copy(id.begin(), id.end(), manifest.chunks[i].begin());
+        total += length;
+    }
+    if (!reader.at_end() || total != manifest.size)
+    {
+        return VaultFileError::InvalidFormat;
+    }
+    return manifest;
+}
+
+std::vector<bool> retained (
+    std::span<const BackupStore::Snapshot> snapshots,
+    const RetentionPolicy& policy
+)
+{
+    struct Rule
+    {
+        int64_t period;
+        size_t count;
+        size_t kept = 0;
+        std::optional<int64_t> last_bucket;
+    };
+    std::array<Rule, 4> rules{{
+        { HOUR, policy.hourly, 0, std::nullopt },
+        { DAY, policy.daily, 0, std::nullopt },
+        { 7 * DAY, policy.weekly, 0, std::nullopt },
+        { 30 * DAY, policy.monthly, 0, std::nullopt },
+    }};
+
+    // Newest first, so the first snapshot seen in a period is its newest
+    std::vector<bool> keep(snapshots.size(), false);
+    for (size_t rank = 0; rank < snapshots.size(); ++rank)
+    {
+        const size_t i = snapshots.size() - 1 - rank;
+        if (rank < policy.last)
+        {
+            keep[i] = true;
+        }
+        for (Rule& rule : rules)
+        {
+            const int64_t bucket = snapshots[i].taken / rule.period;
+            if (rule.last_bucket == bucket)
+            {
+                continue;
+            }
+            rule.last_bucket = bucket;
+            if (rule.kept < rule.count)
+            {
+                keep[i] = true;
+                ++rule.kept;
+            }
+        }
+    }
+    return keep;
+}
+
+} // namespace vault
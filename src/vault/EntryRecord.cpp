@@ -0,0 +1,107 @@
+#include "vault/EntryRecord.h"
+#include "util/ByteOrder.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace vault
+{
+
+size_t RecordWriter::size (RecordField field, std::string_view value) noexcept
+{
+    return util::varint_size(static_cast<uint64_t>(field)) +
+        util::varint_size(value.size()) +
+        value.size();
+}
+
+size_t RecordWriter::size (RecordField field, uint64_t value) noexcept
+{
+    return util::varint_size(static_cast<uint64_t>(field)) + 1 + util::varint_size(value);
+}
+
+void RecordWriter::varint (uint64_t value)
+{
+    std::array<uint8_t, util::MAX_VARINT_SIZE> bytes;
+    const size_t len = util::store_varint(value, std::span(bytes));
+    put(bytes.data(), len);
+}
+
+void RecordWriter::field (RecordField field, std::string_view value)
+{
+    varint(static_cast<uint64_t>(field));
+    varint(value.size());
+    raw(value);
+}
+
+void RecordWriter::field (RecordField field, uint64_t value)
+{
+    varint(static_cast<uint64_t>(field));
+    varint(util::varint_size(value));
+    varint(value);
+}
+
+void RecordWriter::raw (std::string_view fields)
+{
+    put(reinterpret_cast<const uint8_t*>(fields.data()), fields.size());
+}
+
+void RecordWriter::flush ()
+{
+    if (sink_ && used_ > 0)
+    {
+        (*sink_)(out_.first(used_));
+        flushed_ += used_;
+        used_ = 0;
+    }
+}
+
+void RecordWriter::put (const uint8_t* bytes, size_t len)
+{
+    while (len > 0)
+    {
+        if (used_ == out_.size())
+        {
+            if (!sink_)
+            {
+                return;
+            }
+            flush();
+        }
+        const size_t n = std::min(len, out_.size() - used_);
+        std::memcpy(out_.data() + used_, bytes, n);
+        used_ += n;
+        bytes += n;
+        len -= n;
+    }
+}
+
+bool RecordReader::next (uint64_t& type, std::span<const uint8_t>& value) noexcept
+{
+    if (failed_ || offset_ == record_.size())
+    {
+        return false;
+    }
+
+    util::ByteReader reader(record_.subspan(offset_));
+    uint64_t len;
+    if (!reader.read_varint(type) ||
+        !reader.read_varint(len) ||
+        !reader.read_bytes(len, value))
+    {
+        failed_ = true;
+        return false;
+    }
+
+    raw_ = record_.subspan(offset_, reader.offset());
+    offset_ += reader.offset();
+    return true;
+}
+
+bool RecordReader::integer (std::span<const uint8_t> value, uint64_t& out) noexcept
+{
+    util::ByteReader reader(value);
+    return reader.read_varint(out) && reader.at_end();
+}
+
+} // namespace vault
@@ -0,0 +1,317 @@
+#include "vault/EntrySearch.h"
+#include "vault/EntryTable.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define VAULT_SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace vault
+{
+
+namespace
+{
+
+uint8_t fold (uint8_t c) noexcept
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<uint8_t>(c - 'A' + 'a') : c;
+}
+
+std::string fold (std::string_view text)
+{
+    std::string folded(text);
+    for (char& c : folded)
+    {
+        c = static_cast<char>(fold(static_cast<uint8_t>(c)));
+    }
+    return folded;
+}
+
+// Kernels share one contract: the offset of the first occurrence of
+// needle[0, k) in text[0, n), or n if there is none. k >= 1.
+
+size_t find_scalar (const uint8_t* text, size_t n, const uint8_t* needle, size_t k) noexcept
+{
+    if (k > n)
+    {
+        return n;
+    }
+
+    const uint8_t* const last = text + (n - k);
+    for (const uint8_t* p = text; p <= last; ++p)
+    {
+        p = static_cast<const uint8_t*>(std::memchr(p, needle[0], static_cast<size_t>(last - p) + 1));
+        if (!p)
+        {
+            return n;
+        }
+        if (std::memcmp(p + 1, needle + 1, k - 1) == 0)
+        {
+            return static_cast<size_t>(p - text);
+        }
+    }
+    return n;
+}
+
+#if VAULT_SEARCH_X86
+
+// Positions whose first and last bytes both match are verified with
+// memcmp; the rest are rejected 16 at a time. The scalar kernel finishes
+// off the tail where the last-byte load would overrun.
+size_t find_sse2 (const uint8_t* text, size_t n, const uint8_t* needle, size_t k) noexcept
+{
+    if (k > n)
+    {
+        return n;
+    }
+
+    const __m128i first = _mm_set1_epi8(static_cast<char>(needle[0]));
+    const __m128i last = _mm_set1_epi8(static_cast<char>(needle[k - 1]));
+
+    size_t i = 0;
+    for (; i + k - 1 + 16 <= n; i += 16)
+    {
+        const __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        const __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + k - 1));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(
+            _mm_cmpeq_epi8(block_first, first),
+            _mm_cmpeq_epi8(block_last, last)
+        )));
+
+        while (mask != 0)
+        {
+            const size_t position = i + static_cast<size_t>(__builtin_ctz(mask));
+            if (k <= 2 || std::memcmp(text + position + 1, needle + 1, k - 2) == 0)
+            {
+                return position;
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    return i + find_scalar(text + i, n - i, needle, k);
+}
+
+__attribute__((target("avx2")))
+size_t find_avx2 (const uint8_t* text, size_t n, const uint8_t* needle, size_t k) noexcept
+{
+    if (k > n)
+    {
+        return n;
+    }
+
+    const __m256i first = _mm256_set1_epi8(static_cast<char>(needle[0]));
+    const __m256i last = _mm256_set1_epi8(static_cast<char>(needle[k - 1]));
+
+    size_t i = 0;
+    for (; i + k - 1 + 32 <= n; i += 32)
+    {
+        const __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+        const __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + k - 1));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(
+            _mm256_cmpeq_epi8(block_first, first),
+            _mm256_cmpeq_epi8(block_last, last)
+        )));
+
+        while (mask != 0)
+        {
+            const size_t position = i + static_cast<size_t>(__builtin_ctz(mask));
+            if (k <= 2 || std::memcmp(text + position + 1, needle + 1, k - 2) == 0)
+            {
+                return position;
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    return i + find_sse2(text + i, n - i, needle, k);
+}
+
+#endif // VAULT_SEARCH_X86
+
+} // unnamed namespace
+
+bool is_available (SearchKernel kernel) noexcept
+{
+    switch (kernel)
+    {
+        case SearchKernel::Scalar:
+            return true;
+#if VAULT_SEARCH_X86
+        case SearchKernel::Sse2:
+            return true;
+        case SearchKernel::Avx2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+SearchKernel select_search_kernel () noexcept
+{
+    if (is_available(SearchKernel::Avx2))
+    {
+        return SearchKernel::Avx2;
+    }
+    if (is_available(SearchKernel::Sse2))
+    {
+        return SearchKernel::Sse2;
+    }
+    return SearchKernel::Scalar;
+}
+
+EntrySearch::EntrySearch (const EntryTable& entries, SearchKernel kernel)
+    : kernel_(is_available(kernel) ? kernel : SearchKernel::Scalar)
+{
+    // Only the name and username columns are read; secrets stay untouched
+    const StringColumn& names = entries.names();
+    const StringColumn& usernames = entries.usernames();
+    text_.resize(names.bytes() + usernames.bytes() + 2 * entries.size());
+    offsets_.reserve(entries.size() + 1);
+    offsets_.push_back(0);
+
+    uint8_t* out = text_.data();
+    auto pack = [&out](std::string_view field)
+    {
+        for (const char c : field)
+        {
+            *out++ = fold(static_cast<uint8_t>(c));
+        }
+        *out++ = '\0';
+    };
+
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        pack(names[i]);
+        pack(usernames[i]);
+        offsets_.push_back(static_cast<uint32_t>(out - text_.data()));
+    }
+}
+
+size_t EntrySearch::scan (size_t begin, size_t end, std::string_view needle) const noexcept
+{
+    const uint8_t* text = text_.data() + begin;
+    const size_t n = end - begin;
+    const auto* pattern = reinterpret_cast<const uint8_t*>(needle.data());
+    const size_t k = needle.size();
+
+    size_t found = n;
+    switch (kernel_)
+    {
+#if VAULT_SEARCH_X86
+        case SearchKernel::Avx2:
+            found = find_avx2(text, n, pattern, k);
+            break;
+        case SearchKernel::Sse2:
+            found = find_sse2(text, n, pattern, k);
+            break;
+#endif
+        default:
+            found = find_scalar(text, n, pattern, k);
+            break;
+    }
+    return begin + found;
+}
+
+void EntrySearch::scan_entries (
+    size_t first,
+    size_t last,
+    std::string_view folded,
+    std::vector<size_t>& matches
+) const
+{
+    // One pass over the run's text; after a hit, resume at the next entry
+    // so each entry is reported once. Hits arrive in order, so the owning
+    // entry is found by walking forward rather than searching the offsets.
+    const size_t end = offsets_[last];
+    size_t entry = first;
+    size_t position = offsets_[first];
+    while ((position = scan(position, end, folded)) < end)
+    {
+        while (offsets_[entry + 1] <= position)
+        {
+            ++entry;
+        }
+        matches.push_back(entry);
+        position = offsets_[++entry];
+    }
+}
+
+std::vector<size_t> EntrySearch::find (std::string_view needle) const
+{
+    std::vector<size_t> matches;
+    if (needle.empty())
+    {
+        matches.resize(size());
+        for (size_t i = 0; i < matches.size(); ++i)
+        {
+            matches[i] = i;
+        }
+        return matches;
+    }
+
+    scan_entries(0, size(), fold(needle), matches);
+    return matches;
+}
+
+std::vector<size_t> EntrySearch::find (
+    std::string_view needle,
+    std::span<const size_t> candidates
+) const
+{
+    if (needle.empty())
+    {
+        return { candidates.begin(), candidates.end() };
+    }
+
+    // Only the candidates' text is read. Consecutive candidates sit next
+    // to each other in the packed buffer, so each run of them is one
+    // streaming scan rather than one short scan per entry.
+    const std::string folded = fold(needle);
+    std::vector<size_t> matches;
+    for (size_t i = 0; i < candidates.size();)
+    {
+        size_t j = i + 1;
+        while (j < candidates.size() && candidates[j] == candidates[j - 1] + 1)
+        {
+            ++j;
+        }
+        scan_entries(candidates[i], candidates[j - 1] + 1, folded, matches);
+        i = j;
+    }
+    return matches;
+}
+
+std::vector<size_t> EntrySearch::find_naive (
+    const EntryTable& entries,
+    std::string_view needle
+)
+{
+    auto contains = [needle](std::string_view haystack)
+    {
+        return std::search(
+            haystack.begin(), haystack.end(),
+            needle.begin(), needle.end(),
+            [](char a, char b)
+            {
+                return fold(static_cast<uint8_t>(a)) == fold(static_cast<uint8_t>(b));
+            }
+        ) != haystack.end();
+    };
+
+    std::vector<size_t> matches;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        if (contains(entries.name(i)) || contains(entries.username(i)))
+        {
+            matches.push_back(i);
+        }
+    }
+    return matches;
+}
+
+} // namespace vault
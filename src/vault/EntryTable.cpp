@@ -0,0 +1,376 @@
+#include "vault/EntryTable.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <sodium/utils.h>
+#include <utility>
+
+namespace vault
+{
+
+namespace
+{
+
+// Below this much garbage a column is never worth compacting
+constexpr size_t MIN_COMPACT_BYTES = 4096;
+
+constexpr unsigned bit (EntryOrder order) noexcept
+{
+    return 1u << static_cast<unsigned>(order);
+}
+
+constexpr unsigned ALL_ORDERS =
+    bit(EntryOrder::Name) | bit(EntryOrder::Username) | bit(EntryOrder::Modified);
+
+// Orders whose comparison reads `field`. Every order falls back to the
+// name, so renaming moves a row in all of them.
+constexpr unsigned orders_reading (EntryField field) noexcept
+{
+    switch (field)
+    {
+        case EntryField::Name:     return ALL_ORDERS;
+        case EntryField::Username: return bit(EntryOrder::Username);
+        case EntryField::Secret:   return 0;
+    }
+    return 0;
+}
+
+unsigned char fold (char c) noexcept
+{
+    const auto u = static_cast<unsigned char>(c);
+    return u >= 'A' && u <= 'Z' ? static_cast<unsigned char>(u + ('a' - 'A')) : u;
+}
+
+// Case-insensitive for ASCII, with byte order breaking ties
+int compare_folded (std::string_view a, std::string_view b) noexcept
+{
+    const size_t common = std::min(a.size(), b.size());
+    for (size_t i = 0; i < common; ++i)
+    {
+        const unsigned char ca = fold(a[i]);
+        const unsigned char cb = fold(b[i]);
+        if (ca != cb)
+        {
+            return ca < cb ? -1 : 1;
+        }
+    }
+    if (a.size() != b.size())
+    {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    return a.compare(b);
+}
+
+} // unnamed namespace
+
+void StringColumn::reserve (size_t rows, size_t bytes)
+{
+    spans_.reserve(rows);
+    bytes_.reserve(bytes);
+}
+
+StringColumn::Span StringColumn::append (std::string_view value)
+{
+    const size_t offset = bytes_.size();
+    if (!value.empty())
+    {
+        bytes_.resize(offset + value.size());
+        std::memcpy(bytes_.data() + offset, value.data(), value.size());
+    }
+    return { static_cast<uint32_t>(offset), static_cast<uint32_t>(value.size()) };
+}
+
+void StringColumn::push_back (std::string_view value)
+{
+    spans_.push_back(append(value));
+}
+
+void StringColumn::set (size_t row, std::string_view value)
+{
+    Span& span = spans_[row];
+    if (value.size() <= span.length)
+    {
+        if (!value.empty())
+        {
+            std::memcpy(bytes_.data() + span.offset, value.data(), value.size());
+        }
+        retire({ span.offset + static_cast<uint32_t>(value.size()),
+                 span.length - static_cast<uint32_t>(value.size()) });
+        span.length = static_cast<uint32_t>(value.size());
+        return;
+    }
+
+    const Span old = span;
+    const Span grown = append(value);
+    spans_[row] = grown;
+    retire(old);
+    compact_if_sparse();
+}
+
+void StringColumn::swap_remove (size_t row)
+{
+    const Span removed = spans_[row];
+    spans_[row] = spans_.back();
+    spans_.pop_back();
+    retire(removed);
+    compact_if_sparse();
+}
+
+void StringColumn::clear () noexcept
+{
+    bytes_.clear();
+    spans_.clear();
+    dead_ = 0;
+}
+
+void StringColumn::retire (Span span) noexcept
+{
+    if (span.length == 0)
+    {
+        return;
+    }
+    sodium_memzero(bytes_.data() + span.offset, span.length);
+
+    // Bytes at the very end can simply be dropped
+    if (span.offset + span.length == bytes_.size())
+    {
+        bytes_.resize(span.offset);
+        return;
+    }
+    dead_ += span.length;
+}
+
+void StringColumn::compact_if_sparse ()
+{
+    if (dead_ < MIN_COMPACT_BYTES || dead_ < bytes())
+    {
+        return;
+    }
+
+    // Rows are repacked in row order, so scans run front to back again
+    crypto::SecureBuffer packed;
+    packed.reserve(bytes() + bytes() / 2);
+    for (Span& span : spans_)
+    {
+        const size_t offset = packed.size();
+        if (span.length > 0)
+        {
+            packed.resize(offset + span.length);
+            std::memcpy(packed.data() + offset, bytes_.data() + span.offset, span.length);
+        }
+        span.offset = static_cast<uint32_t>(offset);
+    }
+
+    // The old buffer is wiped as it is freed
+    bytes_ = std::move(packed);
+    dead_ = 0;
+}
+
+void EntryTable::reserve (
+    size_t rows,
+    const std::array<size_t, ENTRY_STRING_FIELD_COUNT>& bytes
+)
+{
+    for (size_t i = 0; i < ENTRY_STRING_FIELD_COUNT; ++i)
+    {
+        strings_[i].reserve(rows, bytes[i]);
+    }
+    access_.reserve(rows);
+    created_.reserve(rows);
+    modified_.reserve(rows);
+    tags_.reserve(rows, 0);
+    attachments_.reserve(rows, 0);
+    unknown_.reserve(rows, 0);
+}
+
+void EntryTable::push_back (
+    const EntryStrings& strings,
+    AccessStats access,
+    int64_t modified
+)
+{
+    for (size_t i = 0; i < ENTRY_STRING_FIELD_COUNT; ++i)
+    {
+        strings_[i].push_back(strings[i]);
+    }
+    access_.push_back(access);
+    created_.push_back(0);
+    modified_.push_back(modified);
+    tags_.push_back({});
+    attachments_.push_back({});
+    unknown_.push_back({});
+    link(static_cast<uint32_t>(size() - 1), ALL_ORDERS);
+}
+
+void EntryTable::set (size_t row, EntryField field, std::string_view value)
+{
+    const unsigned affected = orders_reading(field);
+    unlink(static_cast<uint32_t>(row), affected);
+    strings_[field_index(field)].set(row, value);
+    link(static_cast<uint32_t>(row), affected);
+}
+
+void EntryTable::touch (size_t row, int64_t modified)
+{
+    unlink(static_cast<uint32_t>(row), bit(EntryOrder::Modified));
+    modified_[row] = modified;
+    link(static_cast<uint32_t>(row), bit(EntryOrder::Modified));
+}
+
+void EntryTable::swap_remove (size_t row)
+{
+    // The last row is renumbered, which may move it among equal keys, so it
+    // is taken out and put back like an edit
+    const auto removed = static_cast<uint32_t>(row);
+    const auto last = static_cast<uint32_t>(size() - 1);
+    unlink(removed, ALL_ORDERS);
+    if (last != removed)
+    {
+        unlink(last, ALL_ORDERS);
+    }
+
+    for (auto& column : strings_)
+    {
+        column.swap_remove(row);
+    }
+    access_[row] = access_.back();
+    access_.pop_back();
+    created_[row] = created_.back();
+    created_.pop_back();
+    modified_[row] = modified_.back();
+    modified_.pop_back();
+    tags_.swap_remove(row);
+    attachments_.swap_remove(row);
+    unknown_.swap_remove(row);
+
+    if (last != removed)
+    {
+        link(removed, ALL_ORDERS);
+    }
+}
+
+void EntryTable::clear () noexcept
+{
+    for (auto& column : strings_)
+    {
+        column.clear();
+    }
+    access_.clear();
+    created_.clear();
+    modified_.clear();
+    tags_.clear();
+    attachments_.clear();
+    unknown_.clear();
+    for (auto& rows : orders_)
+    {
+        rows.clear();
+    }
+    ordered_.fill(false);
+}
+
+std::span<const uint32_t> EntryTable::sorted_rows (EntryOrder order) const
+{
+    const auto o = static_cast<size_t>(order);
+    std::vector<uint32_t>& rows = orders_[o];
+    if (!ordered_[o])
+    {
+        rows.resize(size());
+        std::iota(rows.begin(), rows.end(), 0u);
+        std::sort(rows.begin(), rows.end(), [this, order](uint32_t a, uint32_t b)
+        {
+            return before(order, a, b);
+        });
+        ordered_[o] = true;
+    }
+    return rows;
+}
+
+bool EntryTable::before (EntryOrder order, uint32_t a, uint32_t b) const noexcept
+{
+    int c = 0;
+    switch (order)
+    {
+        case EntryOrder::Name:
+            break;
+        case EntryOrder::Username:
+            c = compare_folded(username(a), username(b));
+            break;
+        case EntryOrder::Modified:
+            if (modified_[a] != modified_[b])
+            {
+                return modified_[a] > modified_[b];
+            }
+            break;
+    }
+    if (c == 0)
+    {
+        c = compare_folded(name(a), name(b));
+    }
+    return c != 0 ? c < 0 : a < b;
+}
+
+void EntryTable::unlink (uint32_t row, unsigned orders)
+{
+    for (size_t o = 0; o < ORDER_COUNT; ++o)
+    {
+        if (!ordered_[o] || (orders & (1u << o)) == 0)
+        {
+            continue;
+        }
+        // Orders are total, so the search lands on `row` itself
+        const auto order = static_cast<EntryOrder>(o);
+        auto& rows = orders_[o];
+        const auto it = std::lower_bound(rows.begin(), rows.end(), row, [this, order](uint32_t a, uint32_t b)
+        {
+            return before(order, a, b);
+        });
+        if (it != rows.end() && *it == row)
+        {
+            rows.erase(it);
+        }
+    }
+}
+
+void EntryTable::link (uint32_t row, unsigned orders)
+{
+    for (size_t o = 0; o < ORDER_COUNT; ++o)
+    {
+        if (!ordered_[o] || (orders & (1u << o)) == 0)
+        {
+            continue;
+        }
+        const auto order = static_cast<EntryOrder>(o);
+        auto& rows = orders_[o];
+        const auto it = std::lower_bound(rows.begin(), rows.end(), row, [this, order](uint32_t a, uint32_t b)
+        {
+            return before(order, a, b);
+        });
+        rows.insert(it, row);
+    }
+}
+
+bool EntryTable::operator== (const EntryTable& other) const noexcept
+{
+    if (size() != other.size())
+    {
+        return false;
+    }
+    for (size_t row = 0; row < size(); ++row)
+    {
+        for (size_t i = 0; i < ENTRY_STRING_FIELD_COUNT; ++i)
+        {
+            if (strings_[i][row] != other.strings_[i][row])
+            {
+                return false;
+            }
+        }
+        if (tags(row) != other.tags(row) || attachments(row) != other.attachments(row))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace vault
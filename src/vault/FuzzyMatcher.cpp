@@ -0,0 +1,303 @@
+#include "vault/FuzzyMatcher.h"
+#include "util/ThreadPool.h"
+#include "vault/EntryTable.h"
+
+#include <algorithm>
+#include <queue>
+
+namespace vault
+{
+
+namespace
+{
+
+// fzf's weights
+constexpr int SCORE_MATCH = 16;
+constexpr int SCORE_GAP_START = -3;
+constexpr int SCORE_GAP_EXTENSION = -1;
+constexpr int BONUS_BOUNDARY = SCORE_MATCH / 2;
+constexpr int BONUS_NON_WORD = SCORE_MATCH / 2;
+constexpr int BONUS_CAMEL_123 = BONUS_BOUNDARY + SCORE_GAP_EXTENSION;
+constexpr int BONUS_CONSECUTIVE = -(SCORE_GAP_START + SCORE_GAP_EXTENSION);
+constexpr int BONUS_FIRST_CHAR_MULTIPLIER = 2;
+
+// Vaults smaller than this are scored on the calling thread
+constexpr size_t PARALLEL_THRESHOLD = 32 * 1024;
+constexpr size_t CHUNK_SIZE = 8 * 1024;
+
+enum class CharClass
+{
+    NonWord,
+    Lower,
+    Upper,
+    Number
+};
+
+CharClass classify (char c) noexcept
+{
+    if (c >= 'a' && c <= 'z') return CharClass::Lower;
+    if (c >= 'A' && c <= 'Z') return CharClass::Upper;
+    if (c >= '0' && c <= '9') return CharClass::Number;
+    // Treat UTF-8 continuation and lead bytes as letters
+    if (static_cast<unsigned char>(c) >= 0x80) return CharClass::Lower;
+    return CharClass::NonWord;
+}
+
+char fold (char c) noexcept
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+int bonus_at (std::string_view text, size_t i) noexcept
+{
+    const CharClass previous = i == 0 ? CharClass::NonWord : classify(text[i - 1]);
+    const CharClass current = classify(text[i]);
+
+    if (previous == CharClass::NonWord && current != CharClass::NonWord)
+    {
+        return BONUS_BOUNDARY;
+    }
+    if ((previous == CharClass::Lower && current == CharClass::Upper) ||
+        (previous != CharClass::Number && current == CharClass::Number))
+    {
+        return BONUS_CAMEL_123;
+    }
+    if (current == CharClass::NonWord)
+    {
+        return BONUS_NON_WORD;
+    }
+    return 0;
+}
+
+// fzf's v1 algorithm: the first forward occurrence of the subsequence,
+// shrunk from the right by a backward pass, then scored
+std::optional<int> score_term (std::string_view text, std::string_view term) noexcept
+{
+    size_t t = 0;
+    size_t end = 0;
+    for (size_t i = 0; i < text.size() && t < term.size(); ++i)
+    {
+        if (fold(text[i]) == term[t])
+        {
+            if (++t == term.size())
+            {
+                end = i + 1;
+            }
+        }
+    }
+    if (t < term.size())
+    {
+        return std::nullopt;
+    }
+
+    size_t start = end;
+    for (size_t remaining = term.size(); remaining > 0; )
+    {
+        --start;
+        if (fold(text[start]) == term[remaining - 1])
+        {
+            --remaining;
+        }
+    }
+
+    int score = 0;
+    int first_bonus = 0;
+    int consecutive = 0;
+    bool in_gap = false;
+    t = 0;
+    for (size_t i = start; i < end; ++i)
+    {
+        if (t < term.size() && fold(text[i]) == term[t])
+        {
+            int bonus = bonus_at(text, i);
+            if (consecutive == 0)
+            {
+                first_bonus = bonus;
+            }
+            else
+            {
+                // A run keeps the best boundary bonus it started with
+                if (bonus >= BONUS_BOUNDARY && bonus > first_bonus)
+                {
+                    first_bonus = bonus;
+                }
+                bonus = std::max({ bonus, first_bonus, BONUS_CONSECUTIVE });
+            }
+
+            score += SCORE_MATCH + (t == 0 ? bonus * BONUS_FIRST_CHAR_MULTIPLIER : bonus);
+            in_gap = false;
+            ++consecutive;
+            ++t;
+        }
+        else
+        {
+            score += in_gap ? SCORE_GAP_EXTENSION : SCORE_GAP_START;
+            in_gap = true;
+            consecutive = 0;
+            first_bonus = 0;
+        }
+    }
+    return score;
+}
+
+struct Ranked
+{
+    FuzzyMatch match;
+    size_t length;
+};
+
+// True if `a` ranks above `b`
+bool better (const Ranked& a, const Ranked& b) noexcept
+{
+    if (a.match.score != b.match.score) return a.match.score > b.match.score;
+    if (a.length != b.length) return a.length < b.length;
+    return a.match.index < b.match.index;
+}
+
+// Bounded heap with the worst kept match on top, so each candidate costs
+// O(log limit)
+class TopK
+{
+    public:
+        explicit TopK (size_t limit) : limit_(limit) {}
+
+        void offer (const Ranked& candidate)
+        {
+            if (heap_.size() < limit_)
+            {
+                heap_.push(candidate);
+            }
+            else if (better(candidate, heap_.top()))
+            {
+                heap_.pop();
+                heap_.push(candidate);
+            }
+        }
+
+        void drain_into (std::vector<Ranked>& out)
+        {
+            while (!heap_.empty())
+            {
+                out.push_back(heap_.top());
+                heap_.pop();
+            }
+        }
+
+    private:
+        // Orders better matches first, which puts the worst on top
+        struct WorstOnTop
+        {
+            bool operator() (const Ranked& a, const Ranked& b) const noexcept
+            {
+                return better(a, b);
+            }
+        };
+
+        size_t limit_;
+        std::priority_queue<Ranked, std::vector<Ranked>, WorstOnTop> heap_;
+};
+
+} // unnamed namespace
+
+FuzzyMatcher::FuzzyMatcher (std::string_view pattern)
+{
+    size_t i = 0;
+    while (i < pattern.size())
+    {
+        while (i < pattern.size() && pattern[i] == ' ')
+        {
+            ++i;
+        }
+        std::string term;
+        while (i < pattern.size() && pattern[i] != ' ')
+        {
+            term.push_back(fold(pattern[i++]));
+        }
+        if (!term.empty())
+        {
+            terms_.push_back(std::move(term));
+        }
+    }
+}
+
+std::optional<int> FuzzyMatcher::score (std::string_view text) const noexcept
+{
+    int total = 0;
+    for (const auto& term : terms_)
+    {
+        const auto term_score = score_term(text, term);
+        if (!term_score)
+        {
+            return std::nullopt;
+        }
+        total += *term_score;
+    }
+    return total;
+}
+
+std::vector<FuzzyMatch> FuzzyMatcher::top (
+    const StringColumn& names,
+    size_t limit
+) const
+{
+    if (limit == 0)
+    {
+        return {};
+    }
+
+    auto scan = [&](size_t begin, size_t end, TopK& best)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const std::string_view text = names[i];
+            if (const auto s = score(text))
+            {
+                best.offer({ { i, *s }, text.size() });
+            }
+        }
+    };
+
+    std::vector<Ranked> kept;
+    if (names.size() < PARALLEL_THRESHOLD)
+    {
+        TopK best(limit);
+        scan(0, names.size(), best);
+        best.drain_into(kept);
+    }
+    else
+    {
+        // Each chunk keeps its own top `limit`; the overall best are among
+        // their union
+        const size_t chunks = (names.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        std::vector<std::vector<Ranked>> partial(chunks);
+        util::ThreadPool::shared().parallel_for(chunks, [&](size_t chunk)
+        {
+            TopK best(limit);
+            scan(chunk * CHUNK_SIZE, std::min(names.size(), (chunk + 1) * CHUNK_SIZE), best);
+            best.drain_into(partial[chunk]);
+        });
+
+        TopK best(limit);
+        for (const auto& chunk : partial)
+        {
+            for (const auto& candidate : chunk)
+            {
+                best.offer(candidate);
+            }
+        }
+        best.drain_into(kept);
+    }
+
+    // Only `limit` survivors are left to order
+    std::sort(kept.begin(), kept.end(), better);
+
+    std::vector<FuzzyMatch> matches;
+    matches.reserve(kept.size());
+    for (const auto& ranked : kept)
+    {
+        matches.push_back(ranked.match);
+    }
+    return matches;
+}
+
+} // namespace vault
@@ -0,0 +1,261 @@
+#include "vault/NameTrie.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace vault
+{
+
+NameTrie::NameTrie ()
+{
+    // Node 0 is the root
+    nodes_.resize(sizeof(Node));
+    store(0, Node{});
+}
+
+NameTrie::Node NameTrie::load (uint32_t index) const noexcept
+{
+    Node node;
+    std::memcpy(&node, nodes_.data() + size_t{index} * sizeof(Node), sizeof(Node));
+    return node;
+}
+
+void NameTrie::store (uint32_t index, const Node& node) noexcept
+{
+    std::memcpy(nodes_.data() + size_t{index} * sizeof(Node), &node, sizeof(Node));
+}
+
+uint32_t NameTrie::allocate (uint8_t byte)
+{
+    uint32_t index = free_;
+    if (index != NONE)
+    {
+        free_ = load(index).sibling;
+    }
+    else
+    {
+        index = static_cast<uint32_t>(nodes_.size() / sizeof(Node));
+        nodes_.resize(nodes_.size() + sizeof(Node));
+    }
+
+    Node node;
+    node.byte = byte;
+    store(index, node);
+    return index;
+}
+
+void NameTrie::release (uint32_t index) noexcept
+{
+    Node node;
+    node.sibling = free_;
+    store(index, node);
+    free_ = index;
+}
+
+uint32_t NameTrie::child_of (uint32_t parent, uint8_t byte) const noexcept
+{
+    for (uint32_t child = load(parent).child; child != NONE; )
+    {
+        const Node node = load(child);
+        if (node.byte == byte)
+        {
+            return child;
+        }
+        if (node.byte > byte)
+        {
+            break;
+        }
+        child = node.sibling;
+    }
+    return NONE;
+}
+
+uint32_t NameTrie::find (std::string_view key) const noexcept
+{
+    uint32_t current = 0;
+    for (size_t i = 0; i < key.size() && current != NONE; ++i)
+    {
+        current = child_of(current, static_cast<uint8_t>(key[i]));
+    }
+    return current;
+}
+
+void NameTrie::insert (std::string_view name, uint32_t value)
+{
+    uint32_t current = 0;
+    for (const char c : name)
+    {
+        const auto byte = static_cast<uint8_t>(c);
+
+        // Walk the sorted siblings to the insertion point
+        uint32_t previous = NONE;
+        uint32_t child = load(current).child;
+        while (child != NONE && load(child).byte < byte)
+        {
+            previous = child;
+            child = load(child).sibling;
+        }
+
+        if (child == NONE || load(child).byte != byte)
+        {
+            const uint32_t added = allocate(byte);
+            Node node = load(added);
+            node.sibling = child;
+            store(added, node);
+
+            if (previous == NONE)
+            {
+                Node parent = load(current);
+                parent.child = added;
+                store(current, parent);
+            }
+            else
+            {
+                Node before = load(previous);
+                before.sibling = added;
+                store(previous, before);
+            }
+            child = added;
+        }
+        current = child;
+    }
+
+    Node last = load(current);
+    if (last.value == NONE)
+    {
+        ++names_;
+    }
+    last.value = value;
+    store(current, last);
+}
+
+void NameTrie::erase (std::string_view name)
+{
+    // Remember the path so empty nodes can be unlinked bottom-up
+    std::vector<uint32_t> path;
+    path.reserve(name.size() + 1);
+    path.push_back(0);
+    for (const char c : name)
+    {
+        const uint32_t next = child_of(path.back(), static_cast<uint8_t>(c));
+        if (next == NONE)
+        {
+            return;
+        }
+        path.push_back(next);
+    }
+
+    Node last = load(path.back());
+    if (last.value == NONE)
+    {
+        return;
+    }
+    last.value = NONE;
+    store(path.back(), last);
+    --names_;
+
+    for (size_t depth = path.size() - 1; depth > 0; --depth)
+    {
+        const uint32_t index = path[depth];
+        const Node node = load(index);
+        if (node.value != NONE || node.child != NONE)
+        {
+            break;
+        }
+
+        // Unlink from the parent's child list
+        const uint32_t parent_index = path[depth - 1];
+        Node parent = load(parent_index);
+        if (parent.child == index)
+        {
+            parent.child = node.sibling;
+            store(parent_index, parent);
+        }
+        else
+        {
+            uint32_t before = parent.child;
+            while (load(before).sibling != index)
+            {
+                before = load(before).sibling;
+            }
+            Node previous = load(before);
+            previous.sibling = node.sibling;
+            store(before, previous);
+        }
+        release(index);
+    }
+}
+
+std::optional<uint32_t> NameTrie::value_of (std::string_view name) const noexcept
+{
+    const uint32_t index = find(name);
+    if (index == NONE)
+    {
+        return std::nullopt;
+    }
+    const uint32_t value = load(index).value;
+    return value != NONE ? std::optional<uint32_t>(value) : std::nullopt;
+}
+
+std::vector<util::SecureString> NameTrie::complete (
+    std::string_view prefix,
+    size_t limit
+) const
+{
+    std::vector<util::SecureString> completions;
+    const uint32_t start = find(prefix);
+    if (start == NONE || limit == 0)
+    {
+        return completions;
+    }
+
+    // Depth-first in byte order. `key` holds the current name; each stack
+    // frame is a node plus the key length to restore before visiting it.
+    // The key is locked memory, wiped wherever it grows away from.
+    crypto::SecureBuffer key;
+    key.resize(prefix.size());
+    std::memcpy(key.data(), prefix.data(), prefix.size());
+    std::vector<std::pair<uint32_t, size_t>> stack;
+    stack.emplace_back(start, key.size());
+    bool root = true;
+
+    while (!stack.empty() && completions.size() < limit)
+    {
+        const auto [index, depth] = stack.back();
+        stack.pop_back();
+
+        const Node node = load(index);
+        key.resize(root ? depth : depth + 1);
+        if (!root)
+        {
+            key.data()[depth] = node.byte;
+        }
+        root = false;
+
+        if (node.value != NONE)
+        {
+            completions.emplace_back(std::string_view(reinterpret_cast<const char*>(key.data()), key.size()));
+        }
+
+        // Push children in reverse so the smallest byte is visited first
+        const size_t mark = stack.size();
+        for (uint32_t child = node.child; child != NONE; child = load(child).sibling)
+        {
+            stack.emplace_back(child, key.size());
+        }
+        std::reverse(stack.begin() + static_cast<std::ptrdiff_t>(mark), stack.end());
+    }
+
+    return completions;
+}
+
+void NameTrie::clear () noexcept
+{
+    nodes_.clear();
+    nodes_.resize(sizeof(Node));
+    store(0, Node{});
+    free_ = NONE;
+    names_ = 0;
+}
+
+} // namespace vault
@@ -0,0 +1,245 @@
+#include "vault/ObjectStore.h"
+#include "crypto/CipherSuite.h"
+#include "crypto/VaultCrypto.h"
+#include "util/FileUtil.h"
+#include "vault/VaultFileError.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <sodium.h>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace vault
+{
+
+namespace
+{
+
+// Objects are sealed with XChaCha20-Poly1305 whatever the vault's suite:
+// every object takes a fresh random nonce, which its 24 bytes make safe
+constexpr crypto::CipherSuite OBJECT_SUITE = crypto::CipherSuite::XChaCha20Poly1305;
+constexpr size_t OBJECT_NONCE_SIZE = crypto_aead_xchacha20poly1305_ietf_NPUBBYTES;
+constexpr size_t OBJECT_TAG_SIZE = crypto_aead_xchacha20poly1305_ietf_ABYTES;
+
+constexpr uint64_t NAMING_SUBKEY = 1;
+constexpr uint64_t SEALING_SUBKEY = 2;
+
+constexpr size_t HEX_ID_SIZE = 2 * BLOB_ID_SIZE;
+
+crypto::SecureBuffer derive_subkey (
+    std::span<const uint8_t> key,
+    uint64_t subkey,
+    const char* context
+)
+{
+    crypto::SecureBuffer out(crypto_kdf_KEYBYTES);
+    crypto_kdf_derive_from_key(out.data(), out.size(), subkey, context, key.data());
+    return out;
+}
+
+std::array<uint8_t, 1 + BLOB_ID_SIZE> object_aad (ObjectKind kind, const BlobId& id) noexcept
+{
+    std::array<uint8_t, 1 + BLOB_ID_SIZE> aad;
+    aad[0] = static_cast<uint8_t>(kind);
+    std::copy(id.begin(), id.end(), aad.begin() + 1);
+    return aad;
+}
+
+} // unnamed namespace
+
+std::string to_hex (const BlobId& id)
+{
+    std::array<char, HEX_ID_SIZE + 1> hex{};
+    sodium_bin2hex(hex.data(), hex.size(), id.data(), id.size());
+    return std::string(hex.data(), HEX_ID_SIZE);
+}
+
+bool from_hex (std::string_view hex, BlobId& id) noexcept
+{
+    size_t len = 0;
+    return hex.size() == HEX_ID_SIZE &&
+        sodium_hex2bin(id.data(), id.size(), hex.data(), hex.size(), nullptr, &len, nullptr) == 0 &&
+        len == id.size();
+}
+
+ObjectStore::ObjectStore (
+    std::filesystem::path root,
+    std::span<const uint8_t> vault_key,
+    const char* kdf_context
+)
+    : root_(std::move(root))
+    , naming_key_(derive_subkey(vault_key, NAMING_SUBKEY, kdf_context))
+    , sealing_key_(derive_subkey(vault_key, SEALING_SUBKEY, kdf_context))
+{}
+
+BlobId ObjectStore::address (ObjectKind kind, std::span<const uint8_t> plaintext) const noexcept
+{
+    const auto tag = static_cast<uint8_t>(kind);
+    BlobId id;
+    crypto_generichash_state state;
+    crypto_generichash_init(&state, naming_key_.data(), naming_key_.size(), id.size());
+    crypto_generichash_update(&state, &tag, 1);
+    crypto_generichash_update(&state, plaintext.data(), plaintext.size());
+    crypto_generichash_final(&state, id.data(), id.size());
+    return id;
+}
+
+std::filesystem::path ObjectStore::path_of (const BlobId& id) const
+{
+    const std::string hex = to_hex(id);
+    return root_ / hex.substr(0, 2) / hex;
+}
+
+bool ObjectStore::contains (const BlobId& id) const
+{
+    std::error_code ec;
+    return std::filesystem::is_regular_file(path_of(id), ec);
+}
+
+util::Expected<void, VaultFileError> ObjectStore::write (
+    ObjectKind kind,
+    const BlobId& id,
+    std::span<const uint8_t> plaintext,
+    crypto::SecureBuffer& scratch
+)
+{
+    if (contains(id))
+    {
+        return {};
+    }
+    return seal_to(path_of(id), kind, id, plaintext, scratch);
+}
+
+util::Expected<std::span<const uint8_t>, VaultFileError> ObjectStore::open (
+    ObjectKind kind,
+    const BlobId& id,
+    crypto::SecureBuffer& buffer
+) const
+{
+    return open_from(path_of(id), kind, id, buffer);
+}
+
+util::Expected<void, VaultFileError> ObjectStore::seal_to (
+    const std::filesystem::path& path,
+    ObjectKind kind,
+    const BlobId& id,
+    std::span<const uint8_t> plaintext,
+    crypto::SecureBuffer& scratch
+) const
+{
+    const auto aad = object_aad(kind, id);
+    scratch.resize(OBJECT_NONCE_SIZE + plaintext.size() + OBJECT_TAG_SIZE);
+    const auto nonce = scratch.span().first(OBJECT_NONCE_SIZE);
+    randombytes_buf(nonce.data(), nonce.size());
+    auto sealed = crypto::VaultCrypto::encrypt_into(
+        OBJECT_SUITE,
+        sealing_key_,
+        nonce,
+        plaintext,
+        scratch.span().subspan(OBJECT_NONCE_SIZE),
+        aad
+    );
+    if (!sealed)
+    {
+        return VaultFileError::CryptoError;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    if (ec || !util::write_file_atomic(path, scratch))
+    {
+        return VaultFileError::IOError;
+    }
+    return {};
+}
+
+util::Expected<std::span<const uint8_t>, VaultFileError> ObjectStore::open_from (
+    const std::filesystem::path& path,
+    ObjectKind kind,
+    const BlobId& id,
+    crypto::SecureBuffer& buffer
+) const
+{
+    std::error_code ec;
+    const auto file_size = std::filesystem::file_size(path, ec);
+    if (ec)
+    {
+        return VaultFileError::FileNotFound;
+    }
+    if (file_size < OBJECT_NONCE_SIZE + OBJECT_TAG_SIZE)
+    {
+        return VaultFileError::InvalidFormat;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    buffer.resize(static_cast<size_t>(file_size));
+    file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    if (!file)
+    {
+        return VaultFileError::IOError;
+    }
+
+    const auto aad = object_aad(kind, id);
+    const auto sealed = buffer.span().subspan(OBJECT_NONCE_SIZE);
+    auto opened = crypto::VaultCrypto::decrypt_into(
+        OBJECT_SUITE,
+        sealing_key_,
+        buffer.span().first(OBJECT_NONCE_SIZE),
+        sealed,
+        sealed,
+        aad
+    );
+    if (!opened)
+    {
+        return VaultFileError::CryptoError;
+    }
+    return std::span<const uint8_t>(sealed.first(opened.value()));
+}
+
+util::Expected<size_t, VaultFileError> ObjectStore::sweep (std::span<const BlobId> keep)
+{
+    std::error_code ec;
+    if (!std::filesystem::exists(root_, ec))
+    {
+        return size_t{0};
+    }
+
+    std::vector<std::filesystem::path> doomed;
+    for (const auto& item : std::filesystem::recursive_directory_iterator(root_, ec))
+    {
+        if (!item.is_regular_file())
+        {
+            continue;
+        }
+        BlobId id;
+        const bool object = from_hex(item.path().filename().string(), id);
+        if (!object || !std::binary_search(keep.begin(), keep.end(), id))
+        {
+            doomed.push_back(item.path());
+        }
+    }
+    if (ec)
+    {
+        return VaultFileError::IOError;
+    }
+
+    size_t removed = 0;
+    for (const auto& path : doomed)
+    {
+        if (std::filesystem::remove(path, ec))
+        {
+            ++removed;
+        }
+        else if (ec)
+        {
+            return VaultFileError::IOError;
+        }
+    }
+    return removed;
+}
+
+} // namespace vault
@@ -1,13 +1,23 @@
 #include "vault/Vault.h"
-#include "crypto/CryptoContext.h"
 #include "crypto/CryptoTypes.h"
 #include "util/Expected.h"
+#include "util/ByteOrder.h"
 #include "util/SecureString.h"
+#include "crypto/SecureBuffer.h"
+#include "vault/Attachment.h"
 #include "vault/Entry.h"
+#include "vault/EntryRecord.h"
 #include "vault/VaultError.h"
 #include "vault/VaultFileError.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
 #include <utility>
 
 
@@ -17,138 +27,1043 @@ namespace vault
 namespace
 {
 
-bool read_u32(
-    const crypto::ByteBuffer& data,
-    size_t& offset,
-    uint32_t& out
+// --- Fixed layout, read only for vaults saved before records ---
+// Smallest possible encoded entry: three empty length-prefixed strings
+constexpr size_t MIN_ENTRY_SIZE = 3 * sizeof(uint32_t);
+
+int64_t seconds_since_epoch (std::chrono::system_clock::time_point when) noexcept
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(when.time_since_epoch()).count();
+}
+
+bool read_string (
+    util::ByteReader& reader,
+    std::string_view& out
 )
 {
-    if (offset + sizeof(uint32_t) > data.size())
+    uint32_t len;
+    std::span<const uint8_t> bytes;
+    if (!reader.read(len) || !reader.read_bytes(len, bytes))
+    {
         return false;
+    }
 
-    std::memcpy(&out, data.data() + offset, sizeof(uint32_t));
-    offset += sizeof(uint32_t);
+    out = std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size());
     return true;
 }
 
-bool read_secure_string(
-    const crypto::ByteBuffer& data,
-    size_t& offset,
-    util::SecureString& out
-)
+std::string_view view (const util::SecureString& s) noexcept
 {
-    uint32_t len;
-    if (!read_u32(data, offset, len))
+    return std::string_view(s.c_str(), s.size());
+}
+
+std::string_view view (std::span<const uint8_t> bytes) noexcept
+{
+    return std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+bool valid_tag (std::string_view tag) noexcept
+{
+    return !tag.empty() && tag.find('\0') == std::string_view::npos;
+}
+
+// Sorts and dedups `tags` and joins them the way EntryTable keeps them.
+// False if any is invalid.
+bool join_tags (std::vector<std::string_view>& tags, std::string& out)
+{
+    if (!std::all_of(tags.begin(), tags.end(), valid_tag))
     {
         return false;
     }
+    std::sort(tags.begin(), tags.end());
+    tags.erase(std::unique(tags.begin(), tags.end()), tags.end());
 
-    if (offset + len > data.size())
+    out.clear();
+    for (const std::string_view tag : tags)
+    {
+        if (!out.empty())
+        {
+            out += '\0';
+        }
+        out += tag;
+    }
+    return true;
+}
+
+bool name_before (const AttachmentView& a, const AttachmentView& b) noexcept
+{
+    return a.name < b.name;
+}
+
+// Sorts `attachments` by name and joins them as Attachment fields, the way
+// EntryTable keeps them. False if a name is empty or repeated.
+bool join_attachments (std::vector<AttachmentView>& attachments, std::string& out)
+{
+    std::sort(attachments.begin(), attachments.end(), name_before);
+    const auto same_name = [](const AttachmentView& a, const AttachmentView& b)
+    {
+        return a.name == b.name;
+    };
+    if (std::adjacent_find(attachments.begin(), attachments.end(), same_name) != attachments.end())
     {
         return false;
     }
 
-    out.assign( 
-        reinterpret_cast<const char*>(data.data() + offset),
-        len
-    );
-    offset += len;
+    out.clear();
+    for (const AttachmentView& attachment : attachments)
+    {
+        if (attachment.name.empty())
+        {
+            return false;
+        }
+        const std::string value = encode_attachment(attachment.name, attachment.blob);
+        const size_t offset = out.size();
+        out.resize(offset + RecordWriter::size(RecordField::Attachment, value));
+        RecordWriter writer(std::span(reinterpret_cast<uint8_t*>(out.data()) + offset, out.size() - offset));
+        writer.field(RecordField::Attachment, value);
+    }
     return true;
 }
 
+EntryStrings strings_of (const Entry& entry) noexcept
+{
+    EntryStrings strings;
+    for (const auto& descriptor : ENTRY_STRING_FIELDS)
+    {
+        strings[field_index(descriptor.field)] = view(entry.*descriptor.member);
+    }
+    return strings;
+}
+
+bool id_before (EntryId a, EntryId b) noexcept
+{
+    return a.value() < b.value();
+}
+
+// Calls `visit` with every known field of row `row`, in the order written
+template <typename Visit>
+void for_each_field (const EntryTable& entries, size_t row, Visit&& visit)
+{
+    for (const auto& descriptor : ENTRY_STRING_FIELDS)
+    {
+        visit(descriptor.record, entries.column(descriptor.field)[row]);
+    }
+    if (entries.created(row) != 0)
+    {
+        visit(RecordField::Created, static_cast<uint64_t>(entries.created(row)));
+    }
+    if (entries.modified(row) != 0)
+    {
+        visit(RecordField::Modified, static_cast<uint64_t>(entries.modified(row)));
+    }
+    const AccessStats& stats = entries.access(row);
+    if (stats.count > 0)
+    {
+        visit(RecordField::AccessCount, static_cast<uint64_t>(stats.count));
+        visit(RecordField::LastAccess, static_cast<uint64_t>(stats.last_access));
+    }
+    for_each_tag(entries.tags(row), [&visit](std::string_view tag)
+    {
+        visit(RecordField::Tag, tag);
+    });
+}
+
+// Encoded length of row `row`'s record, not counting its length prefix.
+// Attachments are kept as encoded fields, so like unknown fields they are
+// counted and written as they stand.
+size_t record_size (const EntryTable& entries, size_t row) noexcept
+{
+    size_t size = entries.attachments(row).size() + entries.unknown_fields(row).size();
+    for_each_field(entries, row, [&size](RecordField field, auto value)
+    {
+        size += RecordWriter::size(field, value);
+    });
+    return size;
+}
+
+// Length of a payload holding `count` rows, the i-th being row_at(i)
+template <typename RowAt>
+size_t payload_size (const EntryTable& entries, size_t count, RowAt&& row_at) noexcept
+{
+    size_t total = util::varint_size(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const size_t size = record_size(entries, row_at(i));
+        total += util::varint_size(size) + size;
+    }
+    return total;
+}
+
+// Encodes a payload holding `count` rows, the i-th being row_at(i). Each
+// record's length is summed from its fields again just before it is
+// written, which is cheaper than keeping every length from the sizing pass.
+template <typename RowAt>
+void write_payload (const EntryTable& entries, RecordWriter& writer, size_t count, RowAt&& row_at)
+{
+    writer.varint(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const size_t row = row_at(i);
+        writer.varint(record_size(entries, row));
+        for_each_field(entries, row, [&writer](RecordField field, auto value)
+        {
+            writer.field(field, value);
+        });
+        writer.raw(entries.attachments(row));
+        writer.raw(entries.unknown_fields(row));
+    }
+}
+
+size_t same_row (size_t i) noexcept
+{
+    return i;
+}
+
+// log2 of an entry's frecency plus now / half-life, which is the same for
+// every entry: comparing keys compares scores at any moment
+double frecency_key (const AccessStats& stats) noexcept
+{
+    if (stats.count == 0)
+    {
+        return -std::numeric_limits<double>::infinity();
+    }
+    const double half_lives = static_cast<double>(stats.last_access) /
+        static_cast<double>(Vault::FRECENCY_HALF_LIFE.count());
+    return half_lives + std::log2(static_cast<double>(stats.count));
+}
+
 } // unnamed namespace
 
-util::Expected<void, VaultError> Vault::add_entry (Entry entry)
+std::optional<size_t> Vault::index_of (EntryId id) const noexcept
+{
+    if (id.slot() >= slots_.size())
+    {
+        return std::nullopt;
+    }
+    const Slot& slot = slots_[id.slot()];
+    if (slot.generation != id.generation())
+    {
+        return std::nullopt;
+    }
+    return slot.index;
+}
+
+std::optional<EntryId> Vault::find_entry (std::string_view name) const noexcept
+{
+    // The trie maps each name to its entry's slot
+    const auto slot = names_.value_of(name);
+    if (!slot)
+    {
+        return std::nullopt;
+    }
+    return EntryId(*slot, slots_[*slot].generation);
+}
+
+util::Expected<EntryId, VaultError> Vault::add_entry (
+    Entry entry,
+    std::chrono::system_clock::time_point when
+)
+{
+    std::vector<std::string_view> tags(entry.tags.begin(), entry.tags.end());
+    std::string joined;
+    if (!join_tags(tags, joined))
+    {
+        return VaultError::InvalidTag;
+    }
+
+    std::vector<AttachmentView> attachments;
+    attachments.reserve(entry.attachments.size());
+    for (const Attachment& attachment : entry.attachments)
+    {
+        attachments.push_back({ attachment.name, attachment.blob });
+    }
+    std::string attached;
+    if (!join_attachments(attachments, attached))
+    {
+        return VaultError::InvalidAttachment;
+    }
+
+    // The strings are copied into the columns; `entry` wipes its own as it
+    // goes out of scope
+    const int64_t now = seconds_since_epoch(when);
+    return insert(strings_of(entry), Metadata{ entry.access, now, now, joined, attached, {} });
+}
+
+util::Expected<EntryId, VaultError> Vault::insert (
+    const EntryStrings& strings,
+    const Metadata& meta
+)
 {
-    for (const auto& e : entries_)
+    const std::string_view name = strings[field_index(EntryField::Name)];
+    if (names_.contains(name))
     {
-        if (e.name == entry.name)
+        return VaultError::DuplicateEntry;
+    }
+
+    uint32_t slot = free_slot_;
+    if (slot != NO_SLOT)
+    {
+        free_slot_ = slots_[slot].index;
+    }
+    else
+    {
+        slot = static_cast<uint32_t>(slots_.size());
+        slots_.push_back(Slot{ 0, 1 });
+    }
+    slots_[slot].index = static_cast<uint32_t>(entries_.size());
+    const EntryId id(slot, slots_[slot].generation);
+
+    names_.insert(name, slot);
+    entries_.push_back(strings, meta.access, meta.modified);
+    ids_.push_back(id);
+
+    const size_t row = entries_.size() - 1;
+    entries_.set_created(row, meta.created);
+    if (!meta.tags.empty())
+    {
+        entries_.set_tags(row, meta.tags);
+        for_each_tag(meta.tags, [this, id](std::string_view tag)
+        {
+            index_tag(tag, id);
+        });
+    }
+    if (!meta.attachments.empty())
+    {
+        entries_.set_attachments(row, meta.attachments);
+    }
+    if (!meta.unknown_fields.empty())
+    {
+        entries_.set_unknown_fields(row, meta.unknown_fields);
+    }
+
+    if (meta.access.count > 0)
+    {
+        rank(id);
+    }
+    return id;
+}
+
+util::Expected<void, VaultError> Vault::update_entry (
+    EntryId id,
+    Entry updated,
+    std::chrono::system_clock::time_point when
+)
+{
+    const auto index = index_of(id);
+    if (!index)
+    {
+        return VaultError::EntryNotFound;
+    }
+
+    const std::string_view old_name = entries_.name(*index);
+    const std::string_view new_name = view(updated.name);
+    if (old_name != new_name)
+    {
+        if (names_.contains(new_name))
         {
             return VaultError::DuplicateEntry;
         }
+        names_.erase(old_name);
+        names_.insert(new_name, id.slot());
+    }
+
+    // An edit is not a use, so the access stats stay as they are
+    for (const auto& descriptor : ENTRY_STRING_FIELDS)
+    {
+        entries_.set(*index, descriptor.field, view(updated.*descriptor.member));
     }
-    entries_.push_back(std::move(entry));
+    entries_.touch(*index, seconds_since_epoch(when));
     return {};
 }
 
-util::Expected<void, VaultError> Vault::remove_entry(
-    size_t index
+util::Expected<void, VaultError> Vault::set_field (
+    EntryId id,
+    EntryField field,
+    util::SecureString value,
+    std::chrono::system_clock::time_point when
 )
 {
-    if (index >= entries_.size())
+    const auto index = index_of(id);
+    if (!index)
     {
         return VaultError::EntryNotFound;
     }
 
-    entries_.erase(entries_.begin() + index);
+    if (field == EntryField::Name)
+    {
+        const std::string_view old_name = entries_.name(*index);
+        if (old_name == view(value))
+        {
+            return {};
+        }
+        if (names_.contains(view(value)))
+        {
+            return VaultError::DuplicateEntry;
+        }
+        names_.erase(old_name);
+        names_.insert(view(value), id.slot());
+    }
+
+    // Bytes the old value no longer needs are wiped by the column
+    entries_.set(*index, field, view(value));
+    entries_.touch(*index, seconds_since_epoch(when));
     return {};
 }
 
-crypto::ByteBuffer Vault::serialise() const
+util::Expected<void, VaultError> Vault::remove_entry (EntryId id)
 {
-    crypto::ByteBuffer out;
+    const auto found = index_of(id);
+    if (!found)
+    {
+        return VaultError::EntryNotFound;
+    }
+    const size_t index = *found;
 
-    auto append_u32 = [&out](uint32_t v)
+    names_.erase(entries_.name(index));
+    for_each_tag(entries_.tags(index), [this, id](std::string_view tag)
     {
-        const uint8_t* p = reinterpret_cast<const uint8_t*>(&v);
-        out.insert(out.end(), p, p + sizeof(v));
-    };
+        unindex_tag(tag, id);
+    });
+
+    // The last entry fills the hole; the columns wipe the removed values
+    entries_.swap_remove(index);
+    ids_[index] = ids_.back();
+    ids_.pop_back();
+    if (index < ids_.size())
+    {
+        slots_[ids_[index].slot()].index = static_cast<uint32_t>(index);
+    }
+
+    // Tombstone the slot. One whose generation would wrap is retired
+    // instead, so an old id can never match it again.
+    Slot& slot = slots_[id.slot()];
+    if (++slot.generation != 0)
+    {
+        slot.index = free_slot_;
+        free_slot_ = id.slot();
+    }
+
+    // Only losing a ranked entry opens a place the rest must compete for
+    if (std::find(frecent_.begin(), frecent_.end(), id) != frecent_.end())
+    {
+        rebuild_frecent();
+    }
+    return {};
+}
+
+util::Expected<void, VaultError> Vault::record_access (
+    EntryId id,
+    std::chrono::system_clock::time_point when
+)
+{
+    const auto index = index_of(id);
+    if (!index)
+    {
+        return VaultError::EntryNotFound;
+    }
+
+    auto& stats = entries_.access(*index);
+    if (stats.count < std::numeric_limits<uint32_t>::max())
+    {
+        ++stats.count;
+    }
+    stats.last_access = std::max(stats.last_access, seconds_since_epoch(when));
+
+    rank(id);
+    return {};
+}
+
+std::vector<size_t> Vault::frecent () const
+{
+    std::vector<size_t> indices;
+    indices.reserve(frecent_.size());
+    for (const EntryId id : frecent_)
+    {
+        indices.push_back(slots_[id.slot()].index);
+    }
+    return indices;
+}
+
+util::Expected<void, VaultError> Vault::add_tag (
+    EntryId id,
+    std::string_view tag,
+    std::chrono::system_clock::time_point when
+)
+{
+    const auto index = index_of(id);
+    if (!index)
+    {
+        return VaultError::EntryNotFound;
+    }
+    if (!valid_tag(tag))
+    {
+        return VaultError::InvalidTag;
+    }
+
+    std::vector<std::string_view> tags;
+    bool present = false;
+    for_each_tag(entries_.tags(*index), [&](std::string_view existing)
+    {
+        present = present || existing == tag;
+        tags.push_back(existing);
+    });
+    if (present)
+    {
+        return {};
+    }
+
+    tags.push_back(tag);
+    std::string joined;
+    join_tags(tags, joined);
+    entries_.set_tags(*index, joined);
+    entries_.touch(*index, seconds_since_epoch(when));
+    index_tag(tag, id);
+    return {};
+}
+
+util::Expected<void, VaultError> Vault::remove_tag (
+    EntryId id,
+    std::string_view tag,
+    std::chrono::system_clock::time_point when
+)
+{
+    const auto index = index_of(id);
+    if (!index)
+    {
+        return VaultError::EntryNotFound;
+    }
 
-    auto append_string = [&out, &append_u32](const util::SecureString& s)
+    std::vector<std::string_view> tags;
+    bool present = false;
+    for_each_tag(entries_.tags(*index), [&](std::string_view existing)
     {
-        append_u32(static_cast<uint32_t>(s.size())); 
-        out.insert(out.end(), s.data(), s.data() + s.size()); 
+        if (existing == tag)
+        {
+            present = true;
+            return;
+        }
+        tags.push_back(existing);
+    });
+    if (!present)
+    {
+        return {};
+    }
+
+    // `tag` may point into the column, so the index goes first
+    unindex_tag(tag, id);
+    std::string joined;
+    join_tags(tags, joined);
+    entries_.set_tags(*index, joined);
+    entries_.touch(*index, seconds_since_epoch(when));
+    return {};
+}
+
+std::vector<size_t> Vault::tagged (std::span<const std::string_view> tags) const
+{
+    std::vector<const std::vector<EntryId>*> lists;
+    lists.reserve(tags.size());
+    for (const std::string_view tag : tags)
+    {
+        const auto it = tag_index_.find(tag);
+        if (it == tag_index_.end())
+        {
+            return {};
+        }
+        lists.push_back(&it->second);
+    }
+
+    std::vector<size_t> indices;
+    if (lists.empty())
+    {
+        return indices;
+    }
+
+    // Walk the shortest list and probe the rest, so the cost follows the
+    // rarest tag
+    std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b)
+    {
+        return a->size() < b->size();
+    });
+    for (const EntryId id : *lists.front())
+    {
+        const bool everywhere = std::all_of(lists.begin() + 1, lists.end(), [id](const auto* list)
+        {
+            return std::binary_search(list->begin(), list->end(), id, id_before);
+        });
+        if (everywhere)
+        {
+            indices.push_back(slots_[id.slot()].index);
+        }
+    }
+    std::sort(indices.begin(), indices.end());
+    return indices;
+}
+
+util::Expected<void, VaultError> Vault::attach (
+    EntryId id,
+    std::string_view name,
+    const Blob& blob,
+    std::chrono::system_clock::time_point when
+)
+{
+    const auto index = index_of(id);
+    if (!index)
+    {
+        return VaultError::EntryNotFound;
+    }
+    if (name.empty())
+    {
+        return VaultError::InvalidAttachment;
+    }
+
+    std::vector<AttachmentView> attachments{ { name, blob } };
+    for_each_attachment(entries_.attachments(*index), [&](const AttachmentView& existing)
+    {
+        if (existing.name != name)
+        {
+            attachments.push_back(existing);
+        }
+    });
+
+    std::string joined;
+    join_attachments(attachments, joined);
+    entries_.set_attachments(*index, joined);
+    entries_.touch(*index, seconds_since_epoch(when));
+    return {};
+}
+
+util::Expected<void, VaultError> Vault::detach (
+    EntryId id,
+    std::string_view name,
+    std::chrono::system_clock::time_point when
+)
+{
+    const auto index = index_of(id);
+    if (!index)
+    {
+        return VaultError::EntryNotFound;
+    }
+
+    std::vector<AttachmentView> attachments;
+    bool present = false;
+    for_each_attachment(entries_.attachments(*index), [&](const AttachmentView& existing)
+    {
+        if (existing.name == name)
+        {
+            present = true;
+            return;
+        }
+        attachments.push_back(existing);
+    });
+    if (!present)
+    {
+        return {};
+    }
+
+    std::string joined;
+    join_attachments(attachments, joined);
+    entries_.set_attachments(*index, joined);
+    entries_.touch(*index, seconds_since_epoch(when));
+    return {};
+}
+
+std::vector<BlobId> Vault::attached_blobs () const
+{
+    std::vector<BlobId> blobs;
+    for (size_t i = 0; i < entries_.size(); ++i)
+    {
+        for_each_attachment(entries_.attachments(i), [&blobs](const AttachmentView& attachment)
+        {
+            blobs.push_back(attachment.blob.id);
+        });
+    }
+    std::sort(blobs.begin(), blobs.end());
+    blobs.erase(std::unique(blobs.begin(), blobs.end()), blobs.end());
+    return blobs;
+}
+
+util::Expected<std::vector<BlobId>, VaultFileError> Vault::attached_blobs (
+    std::span<const uint8_t> payload
+)
+{
+    util::ByteReader reader(payload);
+
+    uint64_t count;
+    if (!reader.read_varint(count) || count > reader.remaining())
+    {
+        return VaultFileError::InvalidFormat;
+    }
+
+    std::vector<BlobId> blobs;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        uint64_t length;
+        std::span<const uint8_t> record;
+        if (!reader.read_varint(length) || !reader.read_bytes(length, record))
+        {
+            return VaultFileError::InvalidFormat;
+        }
+
+        RecordReader fields(record);
+        uint64_t type;
+        std::span<const uint8_t> value;
+        while (fields.next(type, value))
+        {
+            if (type != static_cast<uint64_t>(RecordField::Attachment))
+            {
+                continue;
+            }
+            const auto attachment = decode_attachment(view(value));
+            if (!attachment)
+            {
+                return VaultFileError::InvalidFormat;
+            }
+            blobs.push_back(attachment->blob.id);
+        }
+        if (fields.failed())
+        {
+            return VaultFileError::InvalidFormat;
+        }
+    }
+    if (!reader.at_end())
+    {
+        return VaultFileError::InvalidFormat;
+    }
+
+    std::sort(blobs.begin(), blobs.end());
+    blobs.erase(std::unique(blobs.begin(), blobs.end()), blobs.end());
+    return blobs;
+}
+
+void Vault::index_tag (std::string_view tag, EntryId id)
+{
+    auto it = tag_index_.find(tag);
+    if (it == tag_index_.end())
+    {
+        it = tag_index_.emplace(std::string(tag), std::vector<EntryId>{}).first;
+    }
+    auto& ids = it->second;
+    ids.insert(std::lower_bound(ids.begin(), ids.end(), id, id_before), id);
+}
+
+void Vault::unindex_tag (std::string_view tag, EntryId id)
+{
+    const auto it = tag_index_.find(tag);
+    if (it == tag_index_.end())
+    {
+        return;
+    }
+    auto& ids = it->second;
+    const auto pos = std::lower_bound(ids.begin(), ids.end(), id, id_before);
+    if (pos != ids.end() && *pos == id)
+    {
+        ids.erase(pos);
+    }
+    if (ids.empty())
+    {
+        tag_index_.erase(it);
+    }
+}
+
+void Vault::rank (EntryId id)
+{
+    // Best first; ties go to the lower slot so the order is stable
+    auto better = [this](EntryId a, EntryId b)
+    {
+        const double ka = frecency_key(entries_.access(slots_[a.slot()].index));
+        const double kb = frecency_key(entries_.access(slots_[b.slot()].index));
+        return ka != kb ? ka > kb : a.slot() < b.slot();
     };
 
-    // Entry count
-    append_u32(static_cast<uint32_t>(entries_.size()));
+    if (std::find(frecent_.begin(), frecent_.end(), id) == frecent_.end())
+    {
+        if (frecent_.size() < FRECENT_COUNT)
+        {
+            frecent_.push_back(id);
+        }
+        else if (better(id, frecent_.back()))
+        {
+            frecent_.back() = id;
+        }
+        else
+        {
+            return;
+        }
+    }
 
-    // Entries
-    for (const Entry& e : entries_)
+    // At most FRECENT_COUNT elements, all but one already in order
+    std::sort(frecent_.begin(), frecent_.end(), better);
+}
+
+void Vault::rebuild_frecent ()
+{
+    frecent_.clear();
+    for (size_t i = 0; i < entries_.size(); ++i)
     {
-        append_string(e.name); 
-        append_string(e.username); 
-        append_string(e.secret); 
+        if (entries_.access(i).count > 0)
+        {
+            rank(ids_[i]);
+        }
     }
+}
+
+size_t Vault::serialised_size () const noexcept
+{
+    return payload_size(entries_, entries_.size(), same_row);
+}
+
+void Vault::write_records (RecordWriter& writer) const
+{
+    write_payload(entries_, writer, entries_.size(), same_row);
+}
 
+crypto::SecureBuffer Vault::serialise () const
+{
+    crypto::SecureBuffer out;
+    serialise(out);
     return out;
 }
 
+void Vault::serialise (crypto::SecureBuffer& out) const
+{
+    // Sized exactly up front, so writing never reallocates
+    out.resize(serialised_size());
+    RecordWriter writer(out.span());
+    write_records(writer);
+}
+
+void Vault::serialise_rows (std::span<const uint32_t> rows, crypto::SecureBuffer& out) const
+{
+    const auto row_at = [rows](size_t i) -> size_t
+    {
+        return rows[i];
+    };
+    out.resize(payload_size(entries_, rows.size(), row_at));
+    RecordWriter writer(out.span());
+    write_payload(entries_, writer, rows.size(), row_at);
+}
+
+bool Vault::serialise_into (std::span<uint8_t> out) const
+{
+    if (out.size() < serialised_size())
+    {
+        return false;
+    }
+    RecordWriter writer(out);
+    write_records(writer);
+    return true;
+}
+
+void Vault::serialise_to (const RecordSink& sink, size_t block) const
+{
+    crypto::SecureBuffer staging;
+    staging.resize(std::max<size_t>(block, 1));
+    RecordWriter writer(staging.span(), &sink);
+    write_records(writer);
+    writer.flush();
+}
+
+util::Expected<Vault, VaultFileError> Vault::deserialise_records (
+    std::span<const uint8_t> data
+)
+{
+    util::ByteReader reader(data);
+
+    // Every record takes at least its length byte
+    uint64_t count;
+    if (!reader.read_varint(count) || count > reader.remaining())
+    {
+        return VaultFileError::InvalidFormat;
+    }
+    const size_t records_start = reader.offset();
+
+    // Sizing pass: checks the framing and totals each string column, so
+    // decoding fills buffers allocated once
+    std::array<size_t, ENTRY_STRING_FIELD_COUNT> column_bytes{};
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        uint64_t length;
+        std::span<const uint8_t> record;
+        if (!reader.read_varint(length) || !reader.read_bytes(length, record))
+        {
+            return VaultFileError::InvalidFormat;
+        }
+
+        RecordReader fields(record);
+        uint64_t type;
+        std::span<const uint8_t> value;
+        while (fields.next(type, value))
+        {
+            const auto* descriptor = type <= UINT32_MAX
+                ? string_field(static_cast<RecordField>(type))
+                : nullptr;
+            if (descriptor)
+            {
+                column_bytes[field_index(descriptor->field)] += value.size();
+            }
+        }
+        if (fields.failed())
+        {
+            return VaultFileError::InvalidFormat;
+        }
+    }
+    if (!reader.at_end())
+    {
+        return VaultFileError::InvalidFormat;
+    }
+
+    Vault vault;
+    vault.entries_.reserve(count, column_bytes);
+    vault.ids_.reserve(count);
+    vault.slots_.reserve(count);
+
+    // Reused across records; unknown fields may be as secret as known ones
+    std::vector<std::string_view> tags;
+    std::string joined;
+    std::vector<AttachmentView> attachments;
+    std::string attached;
+    crypto::SecureBuffer unknown;
+
+    util::ByteReader records(data.subspan(records_start));
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        uint64_t length = 0;
+        std::span<const uint8_t> record;
+        records.read_varint(length);
+        records.read_bytes(length, record);
+
+        EntryStrings strings{};
+        Metadata meta;
+        tags.clear();
+        attachments.clear();
+        unknown.clear();
+
+        RecordReader fields(record);
+        uint64_t type;
+        std::span<const uint8_t> value;
+        while (fields.next(type, value))
+        {
+            const auto field = type <= UINT32_MAX ? static_cast<RecordField>(type) : RecordField{};
+            if (const auto* descriptor = string_field(field))
+            {
+                strings[field_index(descriptor->field)] = view(value);
+                continue;
+            }
+
+            uint64_t number = 0;
+            switch (field)
+            {
+                case RecordField::Tag:
+                    tags.push_back(view(value));
+                    continue;
+                case RecordField::Attachment:
+                {
+                    const auto attachment = decode_attachment(view(value));
+                    if (!attachment)
+                    {
+                        return VaultFileError::InvalidFormat;
+                    }
+                    attachments.push_back(*attachment);
+                    continue;
+                }
+                case RecordField::Created:
+                case RecordField::Modified:
+                case RecordField::AccessCount:
+                case RecordField::LastAccess:
+                    if (!RecordReader::integer(value, number))
+                    {
+                        return VaultFileError::InvalidFormat;
+                    }
+                    break;
+                default:
+                {
+                    // Kept byte for byte so a later save writes it back
+                    const size_t offset = unknown.size();
+                    unknown.resize(offset + fields.raw().size());
+                    std::memcpy(unknown.data() + offset, fields.raw().data(), fields.raw().size());
+                    continue;
+                }
+            }
+
+            switch (field)
+            {
+                case RecordField::Created:
+                    meta.created = static_cast<int64_t>(number);
+                    break;
+                case RecordField::Modified:
+                    meta.modified = static_cast<int64_t>(number);
+                    break;
+                case RecordField::AccessCount:
+                    meta.access.count = static_cast<uint32_t>(
+                        std::min<uint64_t>(number, std::numeric_limits<uint32_t>::max())
+                    );
+                    break;
+                default:
+                    meta.access.last_access = static_cast<int64_t>(number);
+                    break;
+            }
+        }
+        if (!join_tags(tags, joined) || !join_attachments(attachments, attached))
+        {
+            return VaultFileError::InvalidFormat;
+        }
+
+        meta.tags = joined;
+        meta.attachments = attached;
+        meta.unknown_fields = view(std::span<const uint8_t>(unknown.data(), unknown.size()));
+        if (!vault.insert(strings, meta))
+        {
+            return VaultFileError::InvalidFormat;
+        }
+    }
+
+    return vault;
+}
+
 util::Expected<Vault, VaultFileError> Vault::deserialise(
-    const crypto::ByteBuffer& data
+    std::span<const uint8_t> data,
+    std::endian byte_order,
+    uint8_t flags
 )
 {
+    if ((flags & VAULT_FLAG_RECORDS) != 0)
+    {
+        return deserialise_records(data);
+    }
+
     Vault vault;
-    size_t offset = 0;
+    util::ByteReader reader(data, byte_order);
 
     uint32_t count;
-    if (!read_u32(data, offset, count))
+    if (!reader.read(count) || count > reader.remaining() / MIN_ENTRY_SIZE)
     {
         return VaultFileError::InvalidFormat;
     }
+    vault.entries_.reserve(count);
+    vault.ids_.reserve(count);
+    vault.slots_.reserve(count);
 
+    // Fields go straight from the payload into the columns
     for (uint32_t i = 0; i < count; ++i)
     {
-        util::SecureString name{""};
-        util::SecureString username{""};
-        util::SecureString secret{""};
-
-        if (!read_secure_string(data, offset, name) || 
-            !read_secure_string(data, offset, username) || 
-            !read_secure_string(data, offset, secret)) 
+        // The fixed layout has exactly these three, in this order
+        EntryStrings strings{};
+        if (!read_string(reader, strings[field_index(EntryField::Name)]) ||
+            !read_string(reader, strings[field_index(EntryField::Username)]) ||
+            !read_string(reader, strings[field_index(EntryField::Secret)]))
         {
             return VaultFileError::InvalidFormat;
         }
 
-        vault.add_entry(Entry{
-            std::move(name),
-            std::move(username),
-            std::move(secret)
-        });
+        // A name twice is corruption, not something to drop silently
+        if (!vault.insert(strings, {}))
+        {
+            return VaultFileError::InvalidFormat;
+        }
     }
 
     // Extra trailing garbage = corruption
-    if (offset != data.size())
+    if (!reader.at_end())
     {
         return VaultFileError::InvalidFormat;
     }
@@ -158,13 +1073,13 @@ util::Expected<Vault, VaultFileError> Vault::deserialise(
 
 void Vault::secure_clear ()
 {
-    for (auto& entry : entries_)
-    {
-        crypto::CryptoContext::secure_zero(entry.name);
-        crypto::CryptoContext::secure_zero(entry.username);
-        crypto::CryptoContext::secure_zero(entry.secret);
-    }
     entries_.clear();
+    ids_.clear();
+    slots_.clear();
+    free_slot_ = NO_SLOT;
+    names_.clear();
+    frecent_.clear();
+    tag_index_.clear();
 }
 
 }
@@ -1,283 +1,857 @@
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cstdint>
-#include <cstring>
+#include <cstdlib>
 #include <fstream>
-#include <iterator>
+#include <optional>
 #include <sodium.h>
-#include <sodium/crypto_aead_xchacha20poly1305.h>
 #include <span>
+#include <string>
+#include <system_error>
 #include <vector>
 
+#include "crypto/ChunkedAead.h"
 #include "crypto/CryptoConstants.h"
 #include "crypto/CryptoContext.h"
 #include "crypto/CryptoTypes.h"
+#include "crypto/KeyringCache.h"
+#include "crypto/SecureBuffer.h"
 #include "vault/VaultFile.h"
 #include "crypto/VaultCrypto.h"
+#include "util/ByteOrder.h"
 #include "util/Expected.h"
+#include "util/FileUtil.h"
 #include "util/SecureString.h"
+#include "vault/Entry.h"
 #include "vault/VaultFileError.h"
+#include "vault/VaultHeader.h"
 #include "vault/VaultSession.h"
+#include "vault/VaultShards.h"
 
-#pragma pack(push, 1)
-struct VaultHeader
+namespace vault
 {
-    VaultHeader() {};
-    // TODO: (NOTE) Header fields are stored in host endianness (v1 format) - this is something
-    // we will have to address ultimately.
-    uint32_t magic;
-    uint8_t  version;
-    uint8_t  kdf_type;
-    uint16_t reserved;
 
-    uint32_t argon_mem_kib;
-    uint32_t argon_iters;
-    uint32_t argon_parallelism;
+namespace
+{
+    // Reads just enough of the file to decode its header
+    util::Expected<VaultHeader, VaultFileError> read_header (
+        const std::filesystem::path& path
+    )
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return VaultFileError::IOError;
+        }
+
+        HeaderBytes bytes{};
+        file.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+        const auto got = static_cast<std::size_t>(file.gcount());
 
-    uint8_t  salt[crypto_pwhash_SALTBYTES];
-    uint8_t  nonce[crypto_aead_xchacha20poly1305_ietf_NPUBBYTES];
+        return decode_header(std::span<const uint8_t>(bytes).first(got));
+    }
 
-    std::span<const uint8_t> salt_view() const noexcept
+    // Fills in the payload hints and a fresh nonce, then writes the encoded
+    // header followed by the sealed `plaintext` into `out`. The header
+    // doubles as associated data. `out` keeps its capacity, so a reused
+    // buffer does not reallocate once it has grown to the vault's size.
+    // `flags` are the layout flags; chunking is decided here.
+    util::Expected<void, VaultFileError> seal_payload (
+        VaultHeader& header,
+        std::span<const uint8_t> plaintext,
+        uint8_t flags,
+        uint32_t entry_count,
+        std::span<const uint8_t> key,
+        crypto::SecureBuffer& out
+    )
     {
-        return { salt, crypto_pwhash_SALTBYTES };
+        // Large vaults are split so every core can seal a share of them
+        const bool chunked = plaintext.size() > VAULT_CHUNKING_THRESHOLD;
+        header.version = VAULT_VERSION;
+        header.flags = (chunked ? VAULT_FLAG_CHUNKED : 0) | flags;
+        header.chunk_size = chunked ? static_cast<uint32_t>(crypto::DEFAULT_CHUNK_SIZE) : 0;
+        header.entry_count = entry_count;
+        header.payload_length = chunked
+            ? crypto::ChunkedAead::ciphertext_size(
+                  header.cipher,
+                  plaintext.size(),
+                  header.chunk_size
+              )
+            : plaintext.size() + crypto::tag_size(header.cipher);
+        header.nonce.fill(0);
+        randombytes_buf(header.nonce_span().data(), header.nonce_span().size());
+
+        const HeaderBytes header_bytes = encode_header(header);
+        out.resize(header_bytes.size() + header.payload_length);
+        std::copy(header_bytes.begin(), header_bytes.end(), out.data());
+
+        const auto payload = out.span().subspan(header_bytes.size());
+        std::optional<crypto::CryptoError> failure;
+        if (chunked)
+        {
+            auto sealed = crypto::ChunkedAead::seal(
+                header.cipher,
+                key,
+                header.nonce_view(),
+                plaintext,
+                payload,
+                header.chunk_size,
+                header_bytes
+            );
+            if (!sealed)
+            {
+                failure = sealed.error();
+            }
+        }
+        else
+        {
+            auto sealed = crypto::VaultCrypto::encrypt_into(
+                header.cipher,
+                key,
+                header.nonce_view(),
+                plaintext,
+                payload,
+                header_bytes
+            );
+            if (!sealed)
+            {
+                failure = sealed.error();
+            }
+        }
+        if (failure)
+        {
+            out.resize(0);
+            return *failure == crypto::CryptoError::UnsupportedCipher
+                ? VaultFileError::UnsupportedCipher
+                : VaultFileError::CryptoError;
+        }
+
+        return {};
     }
 
-    std::span<const uint8_t> nonce_view() const noexcept
+    // `plaintext` is locked staging for the serialised vault, wiped once
+    // sealed but keeping its allocation, so a caller that passes the same
+    // buffer to every save serialises without allocating
+    util::Expected<void, VaultFileError> seal (
+        VaultHeader& header,
+        const Vault& vault,
+        std::span<const uint8_t> key,
+        crypto::SecureBuffer& plaintext,
+        crypto::SecureBuffer& out
+    )
     {
-        return { nonce, crypto_aead_xchacha20poly1305_ietf_NPUBBYTES };
+        vault.serialise(plaintext);
+        auto sealed = seal_payload(
+            header,
+            plaintext,
+            VAULT_FLAG_RECORDS,
+            static_cast<uint32_t>(vault.entries().size()),
+            key,
+            out
+        );
+        plaintext.clear();
+        return sealed;
     }
-};
-#pragma pack(pop)
 
+    // A vault file read into one locked buffer, with its header decoded in
+    // place and the payload checked against it
+    struct VaultFileContents
+    {
+        crypto::SecureBuffer contents;
+        VaultHeader header;
+    };
 
-static_assert(sizeof(VaultHeader) == vault::VAULT_HEADER_SIZE, "VaultHeader size mismatch");
+    util::Expected<VaultFileContents, VaultFileError> read_vault_file (
+        const std::filesystem::path& path
+    )
+    {
+        std::error_code ec;
+        const auto file_size = std::filesystem::file_size(path, ec);
+        if (ec)
+        {
+            return VaultFileError::IOError;
+        }
 
-namespace vault 
-{
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return VaultFileError::IOError;
+        }
 
-namespace 
-{
-    util::Expected<VaultHeader, VaultFileError> read_and_validate_header(
-        std::istream& file
+        // The whole file lands in one locked buffer, is decrypted in place,
+        // and the buffer then moves into the session for every later save
+        crypto::SecureBuffer contents(file_size);
+        file.read(reinterpret_cast<char*>(contents.data()), contents.size());
+        if (!file)
+        {
+            return VaultFileError::IOError;
+        }
+
+        auto header = decode_header(contents.span());
+        if (!header)
+        {
+            return header.error();
+        }
+
+        // e.g. an AES-256-GCM vault opened on a CPU without AES instructions
+        if (!crypto::is_available(header.value().cipher))
+        {
+            return VaultFileError::UnsupportedCipher;
+        }
+
+        // v2 records its payload length; anything else is truncation or garbage
+        const std::size_t payload_size = contents.size() - header.value().encoded_size();
+        if (payload_size == 0 ||
+            (header.value().version != VAULT_VERSION_1 &&
+             payload_size != header.value().payload_length))
+        {
+            return VaultFileError::InvalidFormat;
+        }
+
+        return VaultFileContents{ std::move(contents), header.value() };
+    }
+
+    // Associated data of a shard file: the vault's salt, the shard's index
+    // and its version, so no shard passes for another vault's, another
+    // index's or another save's
+    using ShardAad = std::array<uint8_t, crypto::SALT_SIZE + sizeof(uint32_t) + sizeof(uint64_t)>;
+
+    ShardAad shard_aad (const VaultHeader& header, uint32_t shard, uint64_t version) noexcept
+    {
+        ShardAad aad{};
+        std::copy(header.salt.begin(), header.salt.end(), aad.begin());
+        util::store(shard, std::span(aad).subspan<crypto::SALT_SIZE, sizeof(uint32_t)>());
+        util::store(version, std::span(aad).subspan<crypto::SALT_SIZE + sizeof(uint32_t), sizeof(uint64_t)>());
+        return aad;
+    }
+
+    std::array<uint8_t, SHARD_DIGEST_SIZE> shard_digest (std::span<const uint8_t> file) noexcept
+    {
+        std::array<uint8_t, SHARD_DIGEST_SIZE> digest;
+        crypto_generichash(digest.data(), digest.size(), file.data(), file.size(), nullptr, 0);
+        return digest;
+    }
+
+    // Reads every shard the manifest names, checks each against its digest
+    // and decrypts them into one records payload in shard order, then
+    // places each loaded entry in the shard it came from
+    util::Expected<Vault, VaultFileError> open_shards (
+        const std::filesystem::path& path,
+        const VaultHeader& header,
+        VaultShards& shards,
+        std::span<const uint8_t> key
     )
     {
-        VaultHeader header;
-        file.read(reinterpret_cast<char*>(&header), sizeof(header));
-        if (!file)
+        const std::size_t nonce_size = crypto::nonce_size(header.cipher);
+        uint64_t total = 0;
+        std::size_t bytes = 0;
+        for (uint32_t s = 0; s < shards.count(); ++s)
+        {
+            total += shards[s].entry_count;
+            if (shards[s].version == 0)
+            {
+                if (shards[s].entry_count != 0)
+                {
+                    return VaultFileError::InvalidFormat;
+                }
+                continue;
+            }
+            std::error_code ec;
+            bytes += std::filesystem::file_size(VaultShards::file(path, s, shards[s].version), ec);
+            if (ec)
+            {
+                return VaultFileError::FileNotFound;
+            }
+        }
+
+        crypto::SecureBuffer records;
+        records.reserve(util::MAX_VARINT_SIZE + bytes);
+        records.resize(util::MAX_VARINT_SIZE);
+        records.resize(util::store_varint(total, records.span().first<util::MAX_VARINT_SIZE>()));
+
+        crypto::SecureBuffer buffer;
+        for (uint32_t s = 0; s < shards.count(); ++s)
+        {
+            const VaultShards::Shard& shard = shards[s];
+            if (shard.version == 0)
+            {
+                continue;
+            }
+
+            const auto file_path = VaultShards::file(path, s, shard.version);
+            std::error_code ec;
+            const auto file_size = std::filesystem::file_size(file_path, ec);
+            std::ifstream file(file_path, std::ios::binary);
+            if (ec || !file || file_size < nonce_size + crypto::tag_size(header.cipher))
+            {
+                return VaultFileError::IOError;
+            }
+            buffer.resize(file_size);
+            file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+            if (!file)
+            {
+                return VaultFileError::IOError;
+            }
+            if (shard_digest(buffer) != shard.digest)
+            {
+                return VaultFileError::CryptoError;
+            }
+
+            const auto aad = shard_aad(header, s, shard.version);
+            const auto sealed = buffer.span().subspan(nonce_size);
+            auto opened = crypto::VaultCrypto::decrypt_into(
+                header.cipher,
+                key,
+                buffer.span().first(nonce_size),
+                sealed,
+                sealed,
+                aad
+            );
+            if (!opened)
+            {
+                return VaultFileError::CryptoError;
+            }
+
+            // Each shard is a records payload of its own; its records are
+            // appended after checking its count against the manifest's
+            util::ByteReader reader(sealed.first(opened.value()));
+            uint64_t count;
+            if (!reader.read_varint(count) || count != shard.entry_count)
+            {
+                return VaultFileError::InvalidFormat;
+            }
+            const auto body = sealed.subspan(reader.offset(), opened.value() - reader.offset());
+            const std::size_t offset = records.size();
+            records.resize(offset + body.size());
+            std::copy(body.begin(), body.end(), records.data() + offset);
+        }
+        buffer.clear();
+
+        auto vault = Vault::deserialise(records);
+        if (!vault || vault.value().entries().size() != total)
         {
             return VaultFileError::InvalidFormat;
         }
 
-        // Check  versions and header information
-        if (header.magic != VAULT_MAGIC || header.kdf_type != KDF_TYPE_ARGON2ID)
+        std::size_t row = 0;
+        for (uint32_t s = 0; s < shards.count(); ++s)
+        {
+            for (uint32_t i = 0; i < shards[s].entry_count; ++i)
+            {
+                shards.place(vault.value().id_at(row++), s);
+            }
+        }
+        return vault;
+    }
+
+    // Decrypts the payload in place with `key` and hands both to a session.
+    // The key is wiped if anything fails.
+    util::Expected<VaultSession, VaultFileError> unseal (
+        const std::filesystem::path& path,
+        VaultFileContents file,
+        crypto::ByteBuffer key
+    )
+    {
+        const VaultHeader& header = file.header;
+        const bool legacy = header.version == VAULT_VERSION_1;
+        const std::size_t header_size = header.encoded_size();
+        const std::span<const uint8_t> header_bytes = file.contents.span().first(header_size);
+        const std::span<uint8_t> payload = file.contents.span().subspan(header_size);
+
+        // Decrypt blob in place; v1 did not authenticate its header
+        const auto aad = legacy ? std::span<const uint8_t>{} : header_bytes;
+        auto plaintext_len = header.chunked()
+            ? crypto::ChunkedAead::open_in_place(
+                  header.cipher,
+                  key,
+                  header.nonce_view(),
+                  payload,
+                  header.chunk_size,
+                  aad
+              )
+            : crypto::VaultCrypto::decrypt_into(
+                  header.cipher,
+                  key,
+                  header.nonce_view(),
+                  payload,
+                  payload,
+                  aad
+              );
+        if (!plaintext_len)
         {
+            crypto::CryptoContext::secure_zero(key);
+            return VaultFileError::CryptoError;
+        }
+
+        const auto plaintext = payload.first(plaintext_len.value());
+        if (header.sharded())
+        {
+            auto shards = VaultShards::decode_manifest(plaintext, key);
+            file.contents.clear();
+            auto vault = shards
+                ? open_shards(path, header, shards.value(), key)
+                : util::Expected<Vault, VaultFileError>(shards.error());
+            if (!vault)
+            {
+                crypto::CryptoContext::secure_zero(key);
+                return vault.error();
+            }
+
+            return VaultSession(
+                std::move(vault.value()),
+                std::move(key),
+                path,
+                std::move(file.contents),
+                std::move(shards.value())
+            );
+        }
+
+        auto vault = Vault::deserialise(
+            plaintext,
+            legacy ? std::endian::native : std::endian::little,
+            header.flags
+        );
+        file.contents.clear();
+        if (!vault)
+        {
+            crypto::CryptoContext::secure_zero(key);
             return VaultFileError::InvalidFormat;
         }
 
-        if (header.version != VAULT_VERSION)
+        return VaultSession(
+            std::move(vault.value()),
+            std::move(key),
+            path,
+            std::move(file.contents)
+        );
+    }
+
+    // Keyring description for a vault's derived key. Everything that feeds
+    // the KDF is hashed in, so a changed salt or cost never reuses a key;
+    // hashing also keeps the vault path out of `keyctl show`.
+    std::string key_cache_description (
+        const std::filesystem::path& path,
+        const VaultHeader& header
+    )
+    {
+        std::error_code ec;
+        const std::string canonical = std::filesystem::weakly_canonical(path, ec).native();
+        const std::string& identity = ec ? path.native() : canonical;
+
+        std::array<uint8_t, 3 * sizeof(uint32_t) + 1> params{};
+        util::store(header.kdf.mem_kib, std::span(params).subspan<0, 4>());
+        util::store(header.kdf.iters, std::span(params).subspan<4, 4>());
+        util::store(header.kdf.parallelism, std::span(params).subspan<8, 4>());
+        params[12] = static_cast<uint8_t>(header.cipher);
+
+        std::array<uint8_t, 16> digest{};
+        crypto_generichash_state state;
+        crypto_generichash_init(&state, nullptr, 0, digest.size());
+        crypto_generichash_update(&state, reinterpret_cast<const uint8_t*>(identity.data()), identity.size());
+        crypto_generichash_update(&state, header.salt.data(), header.salt.size());
+        crypto_generichash_update(&state, params.data(), params.size());
+        crypto_generichash_final(&state, digest.data(), digest.size());
+
+        std::array<char, 2 * 16 + 1> hex{};
+        sodium_bin2hex(hex.data(), hex.size(), digest.data(), digest.size());
+        return std::string("vault:") + hex.data();
+    }
+
+    // A failed or interrupted write never leaves a truncated vault behind
+    util::Expected<void, VaultFileError> write_vault_file (
+        const std::filesystem::path& path,
+        std::span<const uint8_t> contents
+    )
+    {
+        if (!util::write_file_atomic(path, contents))
         {
-            return VaultFileError::UnsupportedVersion;
+            return VaultFileError::IOError;
         }
+        return {};
+    }
 
-        return header;
+    // Writes a new, empty vault; `shard_count` of 0 gives the single-file
+    // layout
+    util::Expected<void, VaultFileError> create_vault (
+        const std::filesystem::path& path,
+        const util::SecureString& password,
+        crypto::CipherSuite suite,
+        uint32_t shard_count
+    )
+    {
+        if (std::filesystem::exists(path))
+        {
+            return VaultFileError::FileAlreadyExists;
+        }
+
+        if (!crypto::is_available(suite))
+        {
+            return VaultFileError::UnsupportedCipher;
+        }
+
+        // Generate Salt
+        VaultHeader header;
+        header.cipher = suite;
+        randombytes_buf(header.salt.data(), header.salt.size());
+
+        // Generate key
+        auto key = crypto::VaultCrypto::derive_key(password, header.salt_view(), header.kdf);
+        if (!key)
+        {
+            return VaultFileError::CryptoError;
+        }
+
+        // Serialise empty entries, or a manifest of empty shards
+        crypto::SecureBuffer plaintext;
+        crypto::SecureBuffer contents;
+        auto sealed = shard_count == 0
+            ? seal(header, Vault{}, key.value(), plaintext, contents)
+            : seal_payload(
+                  header,
+                  VaultShards(shard_count, key.value()).encode_manifest(),
+                  VAULT_FLAG_RECORDS | VAULT_FLAG_SHARDED,
+                  0,
+                  key.value(),
+                  contents
+              );
+        crypto::CryptoContext::secure_zero(key.value());
+        if (!sealed)
+        {
+            return sealed.error();
+        }
+
+        return write_vault_file(path, contents);
     }
 }
 
 // Note that CryptoContext::init() must be called by app before this runs
 util::Expected<void, VaultFileError> VaultFile::create_new (
     const std::filesystem::path& path,
-    const util::SecureString& password
+    const util::SecureString& password,
+    crypto::CipherSuite suite
 )
 {
-    if (std::filesystem::exists(path))
+    return create_vault(path, password, suite, 0);
+}
+
+util::Expected<void, VaultFileError> VaultFile::create_sharded (
+    const std::filesystem::path& path,
+    const util::SecureString& password,
+    uint32_t shard_count,
+    crypto::CipherSuite suite
+)
+{
+    if (shard_count == 0 || shard_count > VAULT_MAX_SHARDS)
     {
-    	return VaultFileError::FileAlreadyExists;
+        return VaultFileError::InvalidFormat;
     }
+    return create_vault(path, password, suite, shard_count);
+}
 
-    // Generate Salt
-    crypto::ByteBuffer salt(crypto::SALT_SIZE);
-    crypto::CryptoContext::random_bytes(salt);
+util::Expected<VaultSession, VaultFileError> VaultFile::load (
+    const std::filesystem::path& path,
+    const util::SecureString& password
+)
+{
+    auto file = read_vault_file(path);
+    if (!file)
+    {
+        return file.error();
+    }
 
-    // Generate key
-    auto key = crypto::VaultCrypto::derive_key(password, salt);
+    auto key = crypto::VaultCrypto::derive_key(
+        password,
+        file.value().header.salt_view(),
+        file.value().header.kdf
+    );
     if (!key)
     {
         return VaultFileError::CryptoError;
     }
 
-    // Create file
-    std::ofstream file(path, std::ios::binary);
+    return unseal(path, std::move(file.value()), std::move(key.value()));
+}
+
+util::Expected<VaultSession, VaultFileError> VaultFile::load (
+    const std::filesystem::path& path,
+    const PasswordPrompt& prompt,
+    const KeyCacheOptions& cache
+)
+{
+    auto file = read_vault_file(path);
     if (!file)
     {
-	    return VaultFileError::IOError;
+        return file.error();
     }
 
-    // Create nonce
-    crypto::ByteBuffer nonce(crypto::NONCE_SIZE);
-    crypto::CryptoContext::random_bytes(nonce);
+    const std::string description = key_cache_description(path, file.value().header);
 
-    // Serialise empty entries
-    Vault vault;
-    auto plaintext = vault.serialise();
-    auto encrypted = crypto::VaultCrypto::encrypt(key.value(), nonce, plaintext);
-    crypto::CryptoContext::secure_zero(key.value());
-    crypto::CryptoContext::secure_zero(plaintext);
-    if (!encrypted)
+    if (cache.enabled)
     {
-        return VaultFileError::CryptoError;
+        if (auto cached = crypto::KeyringCache::fetch(description))
+        {
+            auto session = unseal(path, std::move(file.value()), std::move(cached.value()));
+            if (session || session.error() != VaultFileError::CryptoError)
+            {
+                return session;
+            }
+
+            // The vault was re-keyed or replaced since the key was cached;
+            // decryption wiped the buffer, so read the file again
+            crypto::KeyringCache::revoke(description);
+            file = read_vault_file(path);
+            if (!file)
+            {
+                return file.error();
+            }
+        }
     }
 
-    VaultHeader header{};
-    header.magic = VAULT_MAGIC;
-    header.version = VAULT_VERSION;
-    header.kdf_type = KDF_TYPE_ARGON2ID;
-    header.reserved = 0;
-
-    header.argon_mem_kib = crypto::ARGON_MEM_KIB;
-    header.argon_iters = crypto::ARGON_ITERS;
-    header.argon_parallelism = crypto::ARGON_PARALLELISM;
-
-    std::memcpy(header.salt, salt.data(), salt.size());
-    std::memcpy(header.nonce, nonce.data(), nonce.size());
-    crypto::CryptoContext::secure_zero(salt);
-    crypto::CryptoContext::secure_zero(nonce);
+    auto password = prompt();
+    if (!password)
+    {
+        return VaultFileError::Cancelled;
+    }
 
-    file.write(
-        reinterpret_cast<const char*>(&header),
-        sizeof(header)
-    );
-    
-    file.write(
-        reinterpret_cast<const char*>(encrypted.value().data()),
-        encrypted.value().size()
+    auto key = crypto::VaultCrypto::derive_key(
+        password.value(),
+        file.value().header.salt_view(),
+        file.value().header.kdf
     );
+    crypto::CryptoContext::secure_zero(password.value());
+    if (!key)
+    {
+        return VaultFileError::CryptoError;
+    }
 
-    if (!file)
+    // Only a key that actually opened the vault is worth caching
+    crypto::ByteBuffer to_cache = cache.enabled ? key.value() : crypto::ByteBuffer{};
+    auto session = unseal(path, std::move(file.value()), std::move(key.value()));
+    if (session && cache.enabled)
     {
-        return VaultFileError::IOError;
+        crypto::KeyringCache::store(description, to_cache, cache.ttl);
     }
+    crypto::CryptoContext::secure_zero(to_cache);
 
-    file.close();
+    return session;
+}
 
-    return {};
+KeyCacheOptions KeyCacheOptions::from_environment ()
+{
+    KeyCacheOptions options;
+    if (const char* ttl = std::getenv("VAULT_KEY_CACHE_TTL"))
+    {
+        const long seconds = std::strtol(ttl, nullptr, 10);
+        if (seconds > 0)
+        {
+            options.enabled = true;
+            options.ttl = std::chrono::seconds(seconds);
+        }
+    }
+    return options;
 }
 
-util::Expected<VaultSession, VaultFileError> VaultFile::load (
+util::Expected<VaultHeader, VaultFileError> VaultFile::inspect (
+    const std::filesystem::path& path
+)
+{
+    return read_header(path);
+}
+
+util::Expected<void, VaultFileError> VaultFile::migrate (
     const std::filesystem::path& path,
     const util::SecureString& password
 )
 {
-    // Read file
-    std::ifstream file(path, std::ios::binary);
-    if (!file)
-    {
-        return VaultFileError::IOError;
-    }
-
-    // Get header
-    auto header = read_and_validate_header(file);
+    auto header = read_header(path);
     if (!header)
     {
-        return header.error(); 
+        return header.error();
     }
 
-    // Derive key
-    // TODO: Currently not read Argon2 params... this is something we will utilately have to 
-    // address.
-    auto key = crypto::VaultCrypto::derive_key(password, header.value().salt);
-    if (!key)
+    if (header.value().version == VAULT_VERSION)
     {
-        return VaultFileError::CryptoError;
+        return {};
     }
 
-    // Decrypt blob
-    crypto::ByteBuffer payload(
-       (std::istreambuf_iterator<char>(file)),
-       std::istreambuf_iterator<char>()
-    );
-    if (payload.empty())
+    auto session = load(path, password);
+    if (!session)
     {
-        return VaultFileError::InvalidFormat;
+        return session.error();
     }
-    auto plaintext = crypto::VaultCrypto::decrypt(key.value(), header.value().nonce, payload);
-    crypto::CryptoContext::secure_zero(payload);
-    if (!plaintext)
+
+    return session.value().save();
+}
+
+util::Expected<void, VaultFileError> vault::VaultFile::save (
+    const std::filesystem::path& path,
+    const Vault& vault,
+    const crypto::ByteBuffer& key
+)
+{
+    crypto::SecureBuffer plaintext;
+    crypto::SecureBuffer scratch;
+    return save(path, vault, key, plaintext, scratch);
+}
+
+util::Expected<void, VaultFileError> vault::VaultFile::save (
+    const std::filesystem::path& path,
+    const Vault& vault,
+    std::span<const uint8_t> key,
+    crypto::SecureBuffer& plaintext,
+    crypto::SecureBuffer& scratch
+)
+{
+    // Read header; salt, KDF costs and cipher carry over
+    auto header = read_header(path);
+    if (!header)
     {
-        crypto::CryptoContext::secure_zero(key.value());
-        return VaultFileError::CryptoError;
+        return header.error();
     }
 
-    auto vault = Vault::deserialise(plaintext.value());
-    crypto::CryptoContext::secure_zero(plaintext.value());
-    if (!vault) 
+    auto sealed = seal(header.value(), vault, key, plaintext, scratch);
+    if (!sealed)
     {
-        crypto::CryptoContext::secure_zero(key.value());
-        crypto::CryptoContext::secure_zero(plaintext.value()); 
-        return VaultFileError::InvalidFormat;
+        return sealed.error();
     }
 
-    return VaultSession(
-        std::move(vault.value()),
-        std::move(key.value()),
-        path
-    );
+    auto written = write_vault_file(path, scratch);
+    scratch.resize(0);
+    return written;
 }
 
-
 util::Expected<void, VaultFileError> vault::VaultFile::save (
     const std::filesystem::path& path,
     const Vault& vault,
-    const crypto::ByteBuffer key
+    std::span<const uint8_t> key,
+    VaultShards& shards,
+    crypto::SecureBuffer& plaintext,
+    crypto::SecureBuffer& scratch
 )
 {
-    std::ifstream file(path, std::ios::binary);
-    if (!file)
+    if (!shards.any_dirty())
     {
-        return VaultFileError::IOError;
+        return {};
     }
-    
-    // Read header
-    auto header = read_and_validate_header(file);
+
+    auto header = read_header(path);
     if (!header)
     {
         return header.error();
     }
-
-    // Generate new nonce
-    crypto::ByteBuffer nonce(crypto_aead_xchacha20poly1305_ietf_NPUBBYTES);
-    crypto::CryptoContext::random_bytes(nonce);
-
-    // Copy new nonce to header
-    std::memcpy(header.value().nonce, nonce.data(), nonce.size());
-
-    auto plaintext = vault.serialise();
-    auto encrypted = crypto::VaultCrypto::encrypt(key, nonce, plaintext);
-    crypto::CryptoContext::secure_zero(nonce);
-    crypto::CryptoContext::secure_zero(plaintext);
-    if (!encrypted)
+    if (!header.value().sharded())
     {
-        return VaultFileError::CryptoError;
+        return VaultFileError::InvalidFormat;
     }
-    
-    std::ofstream output(path, std::ios::binary | std::ios::trunc);
-    if (!output)
+
+    std::error_code ec;
+    std::filesystem::create_directories(VaultShards::directory(path), ec);
+    if (ec)
     {
         return VaultFileError::IOError;
     }
 
-    output.write(
-        reinterpret_cast<const char*>(&header.value()),
-        sizeof(VaultHeader)
-    );
-    
-    output.write(
-        reinterpret_cast<const char*>(encrypted.value().data()),
-        encrypted.value().size()
-    );
+    // Each dirty shard goes to a new file under its next version. The
+    // manifest still names the old ones until it is replaced, so a failure
+    // anywhere before that leaves the vault as it was.
+    const auto cipher = header.value().cipher;
+    const std::size_t nonce_size = crypto::nonce_size(cipher);
+    std::vector<VaultShards::Shard> previous(shards.count());
+    std::vector<uint32_t> rewritten;
+    const auto abandon = [&](VaultFileError error) -> VaultFileError
+    {
+        std::error_code ignored;
+        for (const uint32_t s : rewritten)
+        {
+            std::filesystem::remove(VaultShards::file(path, s, shards[s].version), ignored);
+            shards[s] = previous[s];
+        }
+        plaintext.clear();
+        scratch.resize(0);
+        return error;
+    };
 
-    if (!output)
+    std::vector<uint32_t> rows;
+    for (uint32_t s = 0; s < shards.count(); ++s)
     {
-        return VaultFileError::IOError;
+        if (!shards.dirty(s))
+        {
+            continue;
+        }
+
+        // Only a dirty shard's own entries are looked up; the rest of the
+        // vault is never visited
+        rows.clear();
+        for (const EntryId id : shards.members(s))
+        {
+            const auto row = vault.index_of(id);
+            if (!row)
+            {
+                return abandon(VaultFileError::InvalidFormat);
+            }
+            rows.push_back(static_cast<uint32_t>(*row));
+        }
+        std::sort(rows.begin(), rows.end());
+
+        previous[s] = shards[s];
+        rewritten.push_back(s);
+        VaultShards::Shard& shard = shards[s];
+        ++shard.version;
+        shard.entry_count = static_cast<uint32_t>(rows.size());
+
+        vault.serialise_rows(rows, plaintext);
+        scratch.resize(nonce_size + plaintext.size() + crypto::tag_size(cipher));
+        randombytes_buf(scratch.data(), nonce_size);
+        const auto aad = shard_aad(header.value(), s, shard.version);
+        auto sealed = crypto::VaultCrypto::encrypt_into(
+            cipher,
+            key,
+            scratch.span().first(nonce_size),
+            plaintext,
+            scratch.span().subspan(nonce_size),
+            aad
+        );
+        if (!sealed)
+        {
+            return abandon(VaultFileError::CryptoError);
+        }
+        shard.digest = shard_digest(scratch);
+        if (!util::write_file_atomic(VaultShards::file(path, s, shard.version), scratch))
+        {
+            return abandon(VaultFileError::IOError);
+        }
+    }
+    plaintext.clear();
+
+    auto sealed = seal_payload(
+        header.value(),
+        shards.encode_manifest(),
+        VAULT_FLAG_RECORDS | VAULT_FLAG_SHARDED,
+        static_cast<uint32_t>(vault.entries().size()),
+        key,
+        scratch
+    );
+    if (!sealed)
+    {
+        return abandon(sealed.error());
+    }
+    auto written = write_vault_file(path, scratch);
+    if (!written)
+    {
+        return abandon(written.error());
     }
 
-    return {};    
+    // Only now are the old versions unreferenced
+    for (const uint32_t s : rewritten)
+    {
+        if (previous[s].version != 0)
+        {
+            std::filesystem::remove(VaultShards::file(path, s, previous[s].version), ec);
+        }
+    }
+    shards.clear_dirty();
+    scratch.resize(0);
+    return {};
 }
 } // namespace vault
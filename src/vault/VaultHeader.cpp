@@ -0,0 +1,182 @@
+#include "vault/VaultHeader.h"
+#include "util/ByteOrder.h"
+#include "util/Expected.h"
+#include "vault/VaultFileError.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <span>
+
+namespace vault
+{
+
+namespace
+{
+
+// Offset of the version byte, identical in every header version
+constexpr std::size_t VERSION_OFFSET = sizeof(uint32_t);
+
+util::Expected<VaultHeader, VaultFileError> decode_v1 (
+    std::span<const uint8_t> bytes
+)
+{
+    // v1 was written as a packed struct in host byte order
+    util::ByteReader reader(bytes.first(VAULT_V1_HEADER_SIZE), std::endian::native);
+
+    uint32_t magic = 0;
+    uint16_t reserved = 0;
+    crypto::KdfParams recorded{};
+    VaultHeader header;
+    std::span<const uint8_t> salt;
+    std::span<const uint8_t> nonce;
+
+    const bool read = reader.read(magic) &&
+        reader.read(header.version) &&
+        reader.read(header.kdf_id) &&
+        reader.read(reserved) &&
+        reader.read(recorded.mem_kib) &&
+        reader.read(recorded.iters) &&
+        reader.read(recorded.parallelism) &&
+        reader.read_bytes(crypto::SALT_SIZE, salt) &&
+        reader.read_bytes(crypto::NONCE_SIZE, nonce);
+
+    if (!read || magic != VAULT_MAGIC || header.kdf_id != KDF_TYPE_ARGON2ID)
+    {
+        return VaultFileError::InvalidFormat;
+    }
+
+    // v1 keys were always derived with the defaults, whatever was recorded
+    header.cipher = crypto::CipherSuite::XChaCha20Poly1305;
+    header.kdf = crypto::DEFAULT_KDF_PARAMS;
+    std::copy(salt.begin(), salt.end(), header.salt.begin());
+    std::copy(nonce.begin(), nonce.end(), header.nonce.begin());
+
+    return header;
+}
+
+util::Expected<VaultHeader, VaultFileError> decode_v2 (
+    std::span<const uint8_t> bytes
+)
+{
+    util::ByteReader reader(bytes.first(VAULT_HEADER_SIZE));
+
+    uint32_t magic = 0;
+    uint8_t cipher_id = 0;
+    VaultHeader header;
+    std::span<const uint8_t> salt;
+    std::span<const uint8_t> nonce;
+
+    const bool read = reader.read(magic) &&
+        reader.read(header.version) &&
+        reader.read(header.kdf_id) &&
+        reader.read(cipher_id) &&
+        reader.read(header.flags) &&
+        reader.read(header.kdf.mem_kib) &&
+        reader.read(header.kdf.iters) &&
+        reader.read(header.kdf.parallelism) &&
+        reader.read(header.entry_count) &&
+        reader.read(header.payload_length) &&
+        reader.read(header.chunk_size) &&
+        reader.read_bytes(crypto::SALT_SIZE, salt) &&
+        reader.read_bytes(VAULT_NONCE_FIELD_SIZE, nonce);
+
+    if (!read || magic != VAULT_MAGIC || header.kdf_id != KDF_TYPE_ARGON2ID)
+    {
+        return VaultFileError::InvalidFormat;
+    }
+
+    // Unknown ciphers or feature flags come from a newer writer
+    if (!crypto::is_known_cipher_suite(cipher_id) ||
+        (header.flags & ~VAULT_KNOWN_FLAGS) != 0)
+    {
+        return VaultFileError::UnsupportedVersion;
+    }
+    header.cipher = static_cast<crypto::CipherSuite>(cipher_id);
+
+    // libsodium's Argon2id runs one lane, so no other parallelism can be
+    // derived; refuse it here rather than after the password prompt
+    if (header.kdf.mem_kib > VAULT_MAX_ARGON_MEM_KIB ||
+        header.kdf.iters > VAULT_MAX_ARGON_ITERS ||
+        header.kdf.parallelism != 1 ||
+        header.payload_length < crypto::tag_size(header.cipher))
+    {
+        return VaultFileError::InvalidFormat;
+    }
+
+    // A chunk size is meaningful only, and required, for chunked payloads
+    if (header.chunked()
+            ? header.chunk_size == 0 || header.chunk_size > VAULT_MAX_CHUNK_SIZE
+            : header.chunk_size != 0)
+    {
+        return VaultFileError::InvalidFormat;
+    }
+
+    std::copy(salt.begin(), salt.end(), header.salt.begin());
+    std::copy(nonce.begin(), nonce.end(), header.nonce.begin());
+
+    return header;
+}
+
+} // unnamed namespace
+
+HeaderBytes encode_header (const VaultHeader& header) noexcept
+{
+    HeaderBytes out{};
+    std::span<uint8_t> cursor(out);
+
+    auto put = [&cursor](auto value)
+    {
+        constexpr std::size_t n = sizeof(value);
+        util::store(value, cursor.template first<n>());
+        cursor = cursor.subspan(n);
+    };
+
+    put(VAULT_MAGIC);
+    put(VAULT_VERSION);
+    put(header.kdf_id);
+    put(static_cast<uint8_t>(header.cipher));
+    put(header.flags);
+    put(header.kdf.mem_kib);
+    put(header.kdf.iters);
+    put(header.kdf.parallelism);
+    put(header.entry_count);
+    put(header.payload_length);
+    put(header.chunk_size);
+
+    std::copy(header.salt.begin(), header.salt.end(), cursor.begin());
+    cursor = cursor.subspan(header.salt.size());
+    std::copy(header.nonce.begin(), header.nonce.end(), cursor.begin());
+
+    return out;
+}
+
+util::Expected<VaultHeader, VaultFileError> decode_header (
+    std::span<const uint8_t> bytes
+)
+{
+    if (bytes.size() <= VERSION_OFFSET)
+    {
+        return VaultFileError::InvalidFormat;
+    }
+
+    switch (bytes[VERSION_OFFSET])
+    {
+        case VAULT_VERSION_1:
+            if (bytes.size() < VAULT_V1_HEADER_SIZE)
+            {
+                return VaultFileError::InvalidFormat;
+            }
+            return decode_v1(bytes);
+        case VAULT_VERSION:
+            if (bytes.size() < VAULT_HEADER_SIZE)
+            {
+                return VaultFileError::InvalidFormat;
+            }
+            return decode_v2(bytes);
+        default:
+            return VaultFileError::UnsupportedVersion;
+    }
+}
+
+} // namespace vault
@@ -2,17 +2,28 @@
 #include "util/Expected.h"
 #include "vault/VaultError.h"
 #include "vault/VaultFile.h"
+#include <algorithm>
+#include <chrono>
 #include <sys/types.h>
 #include <utility>
+#include <vector>
 #include "vault/VaultSession.h"
 
 namespace vault 
 {
 
 VaultSession::~VaultSession()
+{
+    secure_clear();
+}
+
+void VaultSession::secure_clear ()
 {
     vault_.secure_clear();
     crypto::CryptoContext::secure_zero(key_);
+    shards_.reset();
+    attachments_.reset();
+    backups_.reset();
 }
 
 bool VaultSession::is_empty() const
@@ -20,24 +31,216 @@ bool VaultSession::is_empty() const
     return vault_.entries().empty();
 }
 
-const std::vector<Entry>& VaultSession::entries () const noexcept
+const EntryTable& VaultSession::entries () const noexcept
 {
     return vault_.entries();
 }
 
-util::Expected<void, VaultError> VaultSession::add_entry (Entry entry)
+EntryId VaultSession::id_at (size_t index) const noexcept
+{
+    return vault_.id_at(index);
+}
+
+std::optional<size_t> VaultSession::index_of (EntryId id) const noexcept
+{
+    return vault_.index_of(id);
+}
+
+void VaultSession::touch (EntryId id) noexcept
+{
+    if (shards_)
+    {
+        shards_->mark_dirty(id);
+    }
+}
+
+util::Expected<EntryId, VaultError> VaultSession::add_entry (Entry entry)
+{
+    const uint32_t home = shards_
+        ? shards_->home_of(std::string_view(entry.name.c_str(), entry.name.size()))
+        : 0;
+    auto added = vault_.add_entry(std::move(entry));
+    if (added && shards_)
+    {
+        shards_->place(added.value(), home);
+        shards_->mark_dirty(added.value());
+    }
+    return added;
+}
+
+util::Expected<void, VaultError> VaultSession::update_entry (EntryId id, Entry updated)
+{
+    auto result = vault_.update_entry(id, std::move(updated));
+    if (result)
+    {
+        touch(id);
+    }
+    return result;
+}
+
+util::Expected<void, VaultError> VaultSession::set_field (EntryId id, EntryField field, util::SecureString value)
+{
+    auto result = vault_.set_field(id, field, std::move(value));
+    if (result)
+    {
+        touch(id);
+    }
+    return result;
+}
+
+util::Expected<void, VaultError> VaultSession::remove_entry(EntryId id)
+{
+    auto result = vault_.remove_entry(id);
+    if (result && shards_)
+    {
+        shards_->remove(id);
+    }
+    return result;
+}
+
+bool VaultSession::has_entry (std::string_view name) const noexcept
+{
+    return vault_.has_entry(name);
+}
+
+std::optional<EntryId> VaultSession::find_entry (std::string_view name) const noexcept
+{
+    return vault_.find_entry(name);
+}
+
+std::vector<util::SecureString> VaultSession::complete_name (std::string_view prefix, size_t limit) const
+{
+    return vault_.complete_name(prefix, limit);
+}
+
+util::Expected<void, VaultError> VaultSession::record_access (EntryId id)
+{
+    auto result = vault_.record_access(id);
+    if (result)
+    {
+        touch(id);
+    }
+    return result;
+}
+
+std::vector<size_t> VaultSession::frecent () const
+{
+    return vault_.frecent();
+}
+
+util::Expected<void, VaultError> VaultSession::add_tag (EntryId id, std::string_view tag)
+{
+    auto result = vault_.add_tag(id, tag);
+    if (result)
+    {
+        touch(id);
+    }
+    return result;
+}
+
+util::Expected<void, VaultError> VaultSession::remove_tag (EntryId id, std::string_view tag)
+{
+    auto result = vault_.remove_tag(id, tag);
+    if (result)
+    {
+        touch(id);
+    }
+    return result;
+}
+
+std::vector<size_t> VaultSession::tagged (std::span<const std::string_view> tags) const
+{
+    return vault_.tagged(tags);
+}
+
+util::Expected<void, VaultError> VaultSession::attach (EntryId id, std::string_view name, const Blob& blob)
+{
+    auto result = vault_.attach(id, name, blob);
+    if (result)
+    {
+        touch(id);
+    }
+    return result;
+}
+
+util::Expected<void, VaultError> VaultSession::detach (EntryId id, std::string_view name)
+{
+    auto result = vault_.detach(id, name);
+    if (result)
+    {
+        touch(id);
+    }
+    return result;
+}
+
+AttachmentStore& VaultSession::attachments ()
+{
+    if (!attachments_)
+    {
+        attachments_.emplace(AttachmentStore::beside(path_), key_);
+    }
+    return *attachments_;
+}
+
+util::Expected<size_t, VaultFileError> VaultSession::prune_attachments ()
+{
+    std::vector<BlobId> live = vault_.attached_blobs();
+
+    // A snapshot restores attachment references, not blobs, so every blob a
+    // snapshot still refers to stays. One that cannot be read leaves its
+    // blobs unknown, and nothing is deleted.
+    auto snapshots = backups().list();
+    if (!snapshots)
+    {
+        return snapshots.error();
+    }
+    for (const BackupStore::Snapshot& snapshot : snapshots.value())
+    {
+        auto payload = backups().restore(snapshot);
+        if (!payload)
+        {
+            return payload.error();
+        }
+        // Only the attachment fields are read; the snapshot is never
+        // loaded as a vault
+        auto blobs = Vault::attached_blobs(payload.value());
+        if (!blobs)
+        {
+            return blobs.error();
+        }
+        live.insert(live.end(), blobs.value().begin(), blobs.value().end());
+    }
+    std::sort(live.begin(), live.end());
+    live.erase(std::unique(live.begin(), live.end()), live.end());
+
+    return attachments().prune(live);
+}
+
+BackupStore& VaultSession::backups ()
 {
-    return vault_.add_entry(std::move(entry));
+    if (!backups_)
+    {
+        backups_.emplace(BackupStore::beside(path_), key_);
+    }
+    return *backups_;
 }
 
-util::Expected<void, VaultError> VaultSession::remove_entry(size_t index)
+util::Expected<BackupStore::Snapshot, VaultFileError> VaultSession::back_up ()
 {
-    return vault_.remove_entry(index);
+    const auto taken = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    );
+    const crypto::SecureBuffer payload = vault_.serialise();
+    return backups().snapshot(payload, taken.count());
 }
 
 util::Expected<void, VaultFileError> VaultSession::save()
 {
-    return vault::VaultFile::save(path_, vault_, key_);
+    if (shards_)
+    {
+        return vault::VaultFile::save(path_, vault_, key_, *shards_, plaintext_, scratch_);
+    }
+    return vault::VaultFile::save(path_, vault_, key_, plaintext_, scratch_);
 }
 
 }
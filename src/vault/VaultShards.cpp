@@ -0,0 +1,160 @@
+#include "vault/VaultShards.h"
+#include "util/ByteOrder.h"
+#include "vault/VaultFileError.h"
+
+#include <algorithm>
+#include <array>
+#include <sodium.h>
+#include <string>
+#include <utility>
+
+namespace vault
+{
+
+namespace
+{
+
+// Subkey of the vault key, under a context of exactly crypto_kdf_CONTEXTBYTES
+constexpr char KDF_CONTEXT[] = "vaultshd";
+constexpr uint64_t PLACEMENT_SUBKEY = 1;
+
+} // unnamed namespace
+
+VaultShards::VaultShards (uint32_t count, std::span<const uint8_t> vault_key)
+    : shards_(count)
+    , members_(count)
+    , dirty_(count, false)
+    , placement_key_(crypto_kdf_KEYBYTES)
+{
+    crypto_kdf_derive_from_key(
+        placement_key_.data(),
+        placement_key_.size(),
+        PLACEMENT_SUBKEY,
+        KDF_CONTEXT,
+        vault_key.data()
+    );
+}
+
+std::filesystem::path VaultShards::directory (const std::filesystem::path& vault_path)
+{
+    std::filesystem::path dir = vault_path;
+    dir += ".shards";
+    return dir;
+}
+
+std::filesystem::path VaultShards::file (
+    const std::filesystem::path& vault_path,
+    uint32_t shard,
+    uint64_t version
+)
+{
+    return directory(vault_path) / (std::to_string(shard) + "-" + std::to_string(version));
+}
+
+uint32_t VaultShards::home_of (std::string_view name) const noexcept
+{
+    // Keyed, so shard sizes say nothing about which names are stored
+    std::array<uint8_t, 16> digest;
+    crypto_generichash(
+        digest.data(),
+        digest.size(),
+        reinterpret_cast<const unsigned char*>(name.data()),
+        name.size(),
+        placement_key_.data(),
+        placement_key_.size()
+    );
+    const auto hash = util::load<uint64_t>(std::span<const uint8_t>(digest).first<sizeof(uint64_t)>());
+    return static_cast<uint32_t>(hash % shards_.size());
+}
+
+void VaultShards::place (EntryId id, uint32_t shard)
+{
+    if (id.slot() >= by_slot_.size())
+    {
+        by_slot_.resize(id.slot() + 1);
+    }
+    by_slot_[id.slot()] = Placement{ shard, static_cast<uint32_t>(members_[shard].size()) };
+    members_[shard].push_back(id);
+}
+
+void VaultShards::remove (EntryId id) noexcept
+{
+    // The last member takes the removed one's place
+    const Placement placement = by_slot_[id.slot()];
+    std::vector<EntryId>& members = members_[placement.shard];
+    const EntryId moved = members.back();
+    members[placement.position] = moved;
+    by_slot_[moved.slot()].position = placement.position;
+    members.pop_back();
+    dirty_[placement.shard] = true;
+}
+
+bool VaultShards::any_dirty () const noexcept
+{
+    return std::find(dirty_.begin(), dirty_.end(), true) != dirty_.end();
+}
+
+void VaultShards::clear_dirty () noexcept
+{
+    std::fill(dirty_.begin(), dirty_.end(), false);
+}
+
+crypto::ByteBuffer VaultShards::encode_manifest () const
+{
+    crypto::ByteBuffer out(
+        util::MAX_VARINT_SIZE +
+        shards_.size() * (2 * util::MAX_VARINT_SIZE + SHARD_DIGEST_SIZE)
+    );
+    size_t used = 0;
+    const auto put_varint = [&](uint64_t value)
+    {
+        used += util::store_varint(value, std::span(out).subspan(used).first<util::MAX_VARINT_SIZE>());
+    };
+
+    put_varint(shards_.size());
+    for (const Shard& shard : shards_)
+    {
+        put_varint(shard.version);
+        put_varint(shard.entry_count);
+        std::copy(shard.digest.begin(), shard.digest.end(), out.begin() + used);
+        used += shard.digest.size();
+    }
+    out.resize(used);
+    return out;
+}
+
+util::Expected<VaultShards, VaultFileError> VaultShards::decode_manifest (
+    std::span<const uint8_t> manifest,
+    std::span<const uint8_t> vault_key
+)
+{
+    util::ByteReader reader(manifest);
+    uint64_t count;
+    if (!reader.read_varint(count) || count == 0 || count > VAULT_MAX_SHARDS)
+    {
+        return VaultFileError::InvalidFormat;
+    }
+
+    VaultShards shards(static_cast<uint32_t>(count), vault_key);
+    for (Shard& shard : shards.shards_)
+    {
+        uint64_t entries;
+        std::span<const uint8_t> digest;
+        if (!reader.read_varint(shard.version) ||
+            !reader.read_varint(entries) ||
+            entries > UINT32_MAX ||
+            !reader.read_bytes(SHARD_DIGEST_SIZE, digest))
+        {
+            return VaultFileError::InvalidFormat;
+        }
+        shard.entry_count = static_cast<uint32_t>(entries);
+        std::copy(digest.begin(), digest.end(), shard.digest.begin());
+    }
+    if (!reader.at_end())
+    {
+        return VaultFileError::InvalidFormat;
+    }
+    return shards;
+}
+
+} // namespace vault
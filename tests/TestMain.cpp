@@ -0,0 +1,20 @@
+#define DOCTEST_CONFIG_IMPLEMENT
+#include <doctest/doctest.h>
+#include "crypto/CryptoContext.h"
+
+#include <cstdio>
+
+// Anything holding a SecureBuffer or SecureString allocates through
+// libsodium, so it is initialised once before any test runs, whichever
+// test runs first or alone
+int main (int argc, char** argv)
+{
+    if (!crypto::CryptoContext::init())
+    {
+        std::fprintf(stderr, "libsodium failed to initialise\n");
+        return 1;
+    }
+
+    doctest::Context context(argc, argv);
+    return context.run();
+}
@@ -0,0 +1,249 @@
+#include <doctest/doctest.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+#include "agent/AgentClient.h"
+#include "agent/AgentError.h"
+#include "agent/AgentProtocol.h"
+#include "agent/AgentServer.h"
+#include "crypto/CryptoContext.h"
+#include "crypto/SecureBuffer.h"
+#include "util/SecureString.h"
+#include "vault/Entry.h"
+#include "vault/VaultFile.h"
+#include "../vault/VaultTestFixture.h"
+
+namespace
+{
+    // The socket lives in its own 0700 directory, as the agent requires
+    std::filesystem::path private_directory ()
+    {
+        std::string pattern = (std::filesystem::temp_directory_path() / "vault_agent_XXXXXX").string();
+        REQUIRE(::mkdtemp(pattern.data()) != nullptr);
+        return pattern;
+    }
+
+    struct AgentFixture
+    {
+        VaultTestFixture vault;
+        std::filesystem::path socket_directory;
+        std::filesystem::path socket_path;
+
+        AgentFixture()
+            : socket_directory(private_directory())
+            , socket_path(socket_directory / "agent.sock")
+        {
+            REQUIRE(vault::VaultFile::create_new(vault.file_path, vault.password));
+        }
+
+        ~AgentFixture()
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(socket_directory, ec);
+        }
+
+        agent::AgentServer listen(std::chrono::milliseconds idle = agent::DEFAULT_IDLE_TIMEOUT)
+        {
+            auto session = vault::VaultFile::load(vault.file_path, vault.password);
+            REQUIRE(session);
+
+            auto server = agent::AgentServer::listen(socket_path, std::move(session.value()), idle);
+            REQUIRE(server);
+            return std::move(server.value());
+        }
+    };
+}
+
+TEST_CASE("Agent messages round trip through the wire format")
+{
+    REQUIRE(crypto::CryptoContext::init());
+
+    agent::Message message;
+    message.code = static_cast<uint8_t>(agent::Command::Add);
+    message.fields.emplace_back("Email");
+    message.fields.emplace_back("");
+    message.fields.emplace_back("HelloWorld123!");
+
+    crypto::SecureBuffer frame;
+    agent::encode_message(message, frame);
+
+    auto decoded = agent::decode_message(frame.span().subspan(sizeof(uint32_t)));
+    REQUIRE(decoded);
+    CHECK(decoded.value().code == message.code);
+    REQUIRE(decoded.value().fields.size() == 3);
+    CHECK(decoded.value().fields[1].size() == 0);
+    CHECK(decoded.value().fields[2] == util::SecureString("HelloWorld123!"));
+
+    // A field count larger than the body could hold is rejected up front
+    auto truncated = agent::decode_message(frame.span().subspan(sizeof(uint32_t), 6));
+    CHECK_FALSE(truncated);
+}
+
+TEST_CASE("Agent serves add, get and list, and persists additions")
+{
+    AgentFixture fixture;
+    auto server = fixture.listen();
+
+    struct stat st{};
+    REQUIRE(::stat(fixture.socket_path.c_str(), &st) == 0);
+    CHECK((st.st_mode & 0777) == 0600);
+
+    std::thread serving([&server] { CHECK(server.run()); });
+
+    {
+        auto client = agent::AgentClient::connect(fixture.socket_path);
+        REQUIRE(client);
+
+        REQUIRE(client.value().add(vault::Entry(
+            util::SecureString("Email"),
+            util::SecureString("john.doe@example.com"),
+            util::SecureString("HelloWorld123!")
+        )));
+
+        auto duplicate = client.value().add(vault::Entry(
+            util::SecureString("Email"),
+            util::SecureString("other"),
+            util::SecureString("other")
+        ));
+        CHECK(duplicate.error() == agent::AgentError::DuplicateEntry);
+
+        auto entry = client.value().get(util::SecureString("Email"));
+        REQUIRE(entry);
+        CHECK(entry.value().username == util::SecureString("john.doe@example.com"));
+        CHECK(entry.value().secret == util::SecureString("HelloWorld123!"));
+
+        auto missing = client.value().get(util::SecureString("Bank"));
+        CHECK(missing.error() == agent::AgentError::EntryNotFound);
+
+        auto names = client.value().list();
+        REQUIRE(names);
+        REQUIRE(names.value().size() == 1);
+        CHECK(names.value()[0] == util::SecureString("Email"));
+
+        REQUIRE(client.value().lock());
+    }
+
+    serving.join();
+    CHECK(server.is_locked());
+
+    // The agent saved the addition, so a fresh load sees it
+    auto reloaded = vault::VaultFile::load(fixture.vault.file_path, fixture.vault.password);
+    REQUIRE(reloaded);
+    CHECK(reloaded.value().entries().size() == 1);
+
+    // The Get came after the last save; locking wrote its access out
+    CHECK(reloaded.value().entries().access(0).count == 1);
+}
+
+TEST_CASE("Agent lists names beyond one frame's worth in pages")
+{
+    AgentFixture fixture;
+    {
+        auto session = vault::VaultFile::load(fixture.vault.file_path, fixture.vault.password);
+        REQUIRE(session);
+        for (size_t i = 0; i < 3000; ++i)
+        {
+            // 3000 names of 400 bytes: well over MAX_FRAME_SIZE together
+            std::string name = std::to_string(i);
+            name.resize(400, 'x');
+            REQUIRE(session.value().add_entry(vault::Entry(
+                util::SecureString(name),
+                util::SecureString(""),
+                util::SecureString("")
+            )));
+        }
+        REQUIRE(session.value().save());
+    }
+
+    auto server = fixture.listen();
+    std::thread serving([&server] { CHECK(server.run()); });
+    {
+        auto client = agent::AgentClient::connect(fixture.socket_path);
+        REQUIRE(client);
+
+        auto names = client.value().list();
+        REQUIRE(names);
+        REQUIRE(names.value().size() == 3000);
+        CHECK(std::string_view(names.value()[2999].c_str(), 4) == "2999");
+
+        auto entry = client.value().get(util::SecureString(names.value()[1234].c_str()));
+        REQUIRE(entry);
+        CHECK(entry.value().name == names.value()[1234]);
+
+        REQUIRE(client.value().lock());
+    }
+    serving.join();
+}
+
+TEST_CASE("Agent locks itself after the idle timeout")
+{
+    AgentFixture fixture;
+    auto server = fixture.listen(std::chrono::milliseconds(50));
+
+    const auto start = std::chrono::steady_clock::now();
+    REQUIRE(server.run());
+
+    CHECK(server.is_locked());
+    CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(50));
+}
+
+TEST_CASE("A client stalled mid-frame does not hold off the idle lock")
+{
+    AgentFixture fixture;
+    auto server = fixture.listen(std::chrono::milliseconds(200));
+
+    auto addr = agent::socket_address(fixture.socket_path);
+    REQUIRE(addr);
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    REQUIRE(fd >= 0);
+    REQUIRE(::connect(fd, reinterpret_cast<const sockaddr*>(&addr.value()), sizeof(sockaddr_un)) == 0);
+
+    // Half a length prefix, then nothing
+    const uint8_t partial[2] = { 0x10, 0x00 };
+    REQUIRE(::send(fd, partial, sizeof(partial), MSG_NOSIGNAL) == sizeof(partial));
+
+    const auto start = std::chrono::steady_clock::now();
+    REQUIRE(server.run());
+
+    CHECK(server.is_locked());
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(800));
+    ::close(fd);
+}
+
+TEST_CASE("Agent refuses a socket directory others can write to")
+{
+    AgentFixture fixture;
+    std::filesystem::permissions(fixture.socket_directory, std::filesystem::perms::all);
+
+    auto session = vault::VaultFile::load(fixture.vault.file_path, fixture.vault.password);
+    REQUIRE(session);
+    auto server = agent::AgentServer::listen(fixture.socket_path, std::move(session.value()));
+    CHECK(server.error() == agent::AgentError::PermissionDenied);
+}
+
+TEST_CASE("A second agent cannot take over a live socket")
+{
+    AgentFixture fixture;
+    auto first = fixture.listen();
+
+    auto session = vault::VaultFile::load(fixture.vault.file_path, fixture.vault.password);
+    REQUIRE(session);
+    auto second = agent::AgentServer::listen(fixture.socket_path, std::move(session.value()));
+    CHECK(second.error() == agent::AgentError::AlreadyRunning);
+}
+
+TEST_CASE("Connecting without a running agent reports NotRunning")
+{
+    AgentFixture fixture;
+    auto client = agent::AgentClient::connect(fixture.socket_path);
+    CHECK(client.error() == agent::AgentError::NotRunning);
+}
@@ -0,0 +1,147 @@
+#include <doctest/doctest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "app/Action.h"
+#include "app/Application.h"
+#include "ui/ScriptedUI.h"
+#include "vault/Entry.h"
+#include "vault/VaultFile.h"
+#include "vault/VaultFileError.h"
+#include "vault/VaultSession.h"
+#include "../vault/VaultTestFixture.h"
+
+TEST_CASE("Scripted workflow creates, fills and saves a vault")
+{
+    VaultTestFixture fixture;
+
+    auto script = std::make_unique<ui::ScriptedUI>();
+    auto& ui = *script;
+    script->then_action(app::Action::CreateVault).then_password(fixture.password.c_str())
+        .then_action(app::Action::Unlock).then_password(fixture.password.c_str())
+        .then_action(app::Action::AddEntry)
+            .then_input("Email").then_input("john.doe@example.com")
+            .then_generate(false).then_input("HelloWorld123!")
+        .then_action(app::Action::AddEntry)
+            .then_input("Bank").then_input("john").then_generate(true)
+        .then_action(app::Action::ListEntries)
+        .then_action(app::Action::SaveAndClose)
+        .then_action(app::Action::Quit);
+
+    app::Application app(fixture.file_path.string(), std::move(script));
+    app.run(app);
+
+    CHECK(ui.errors().empty());
+    CHECK(ui.listed() == std::vector<std::string>{ "Email", "Bank" });
+    CHECK(ui.messages().back() == "Quitting");
+
+    auto loaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(loaded);
+    REQUIRE(loaded.value().entries().size() == 2);
+    CHECK(loaded.value().entries()[0].secret == "HelloWorld123!");
+    CHECK(loaded.value().entries()[1].secret.size() == 32);
+}
+
+TEST_CASE("Scripted workflow reports refused actions and bad passwords")
+{
+    VaultTestFixture fixture;
+    REQUIRE(vault::VaultFile::create_new(fixture.file_path, fixture.password));
+
+    auto script = std::make_unique<ui::ScriptedUI>();
+    auto& ui = *script;
+    script->then_action(app::Action::AddEntry)
+        .then_action(app::Action::Unlock).then_password("wrong")
+        .then_action(app::Action::Unlock).then_password(fixture.password.c_str())
+        .then_action(app::Action::RemoveEntry);
+
+    app::Application app(fixture.file_path.string(), std::move(script));
+    app.run(app);
+
+    REQUIRE(ui.errors().size() == 2);
+    CHECK(ui.errors()[0] == "Action not allowed in current state");
+    CHECK(ui.errors()[1] == vault::to_string(vault::VaultFileError::CryptoError));
+
+    // Out of script while unlocked: Save and Close, then Quit from Locked
+    REQUIRE(ui.menus().size() == 6);
+    CHECK(ui.menus()[0] == std::vector<app::Action>{ app::Action::Unlock, app::Action::Quit });
+    CHECK(ui.menus()[4].back() == app::Action::SaveAndClose);
+}
+
+TEST_CASE("Scripted workflow gets name hints while adding an entry")
+{
+    VaultTestFixture fixture;
+    REQUIRE(vault::VaultFile::create_new(fixture.file_path, fixture.password));
+
+    auto script = std::make_unique<ui::ScriptedUI>();
+    auto& ui = *script;
+    script->then_action(app::Action::Unlock).then_password(fixture.password.c_str())
+        .then_action(app::Action::AddEntry)
+            .then_input("Email").then_input("john").then_generate(true)
+        .then_action(app::Action::AddEntry)
+            .then_input("Email").then_input("jane").then_generate(true);
+
+    app::Application app(fixture.file_path.string(), std::move(script));
+    app.run(app);
+
+    CHECK(ui.last_hints().taken);
+    REQUIRE(ui.last_hints().completions.size() == 1);
+    CHECK(ui.last_hints().completions[0] == util::SecureString("Email"));
+    CHECK(ui.errors() == std::vector<std::string>{ "Duplicate Entry" });
+}
+
+TEST_CASE("Scripted workflow lists the entries opened most first")
+{
+    VaultTestFixture fixture;
+    REQUIRE(vault::VaultFile::create_new(fixture.file_path, fixture.password));
+
+    auto script = std::make_unique<ui::ScriptedUI>();
+    auto& ui = *script;
+    script->then_action(app::Action::Unlock).then_password(fixture.password.c_str())
+        .then_action(app::Action::AddEntry)
+            .then_input("Email").then_input("john").then_generate(true)
+        .then_action(app::Action::AddEntry)
+            .then_input("Bank").then_input("john").then_generate(true)
+        .then_action(app::Action::AddEntry)
+            .then_input("Shop").then_input("john").then_generate(true)
+        .then_action(app::Action::ListEntries).then_open(2).then_open(1).then_open(2)
+        .then_action(app::Action::ListEntries);
+
+    app::Application app(fixture.file_path.string(), std::move(script));
+    app.run(app);
+
+    CHECK(ui.errors().empty());
+    CHECK(ui.listed() == std::vector<std::string>{ "Shop", "Bank", "Email" });
+}
+
+TEST_CASE("Scripted workflow edits one field of an entry")
+{
+    VaultTestFixture fixture;
+    REQUIRE(vault::VaultFile::create_new(fixture.file_path, fixture.password));
+
+    auto script = std::make_unique<ui::ScriptedUI>();
+    auto& ui = *script;
+    script->then_action(app::Action::Unlock).then_password(fixture.password.c_str())
+        .then_action(app::Action::AddEntry)
+            .then_input("Email").then_input("john").then_generate(false).then_input("old")
+        .then_action(app::Action::AddEntry)
+            .then_input("Bank").then_input("john").then_generate(true)
+        .then_action(app::Action::EditEntry)
+            .then_edit(0, vault::EntryField::Secret).then_generate(false).then_input("new")
+        .then_action(app::Action::EditEntry)
+            .then_edit(0, vault::EntryField::Name).then_input("Bank")
+        .then_action(app::Action::SaveAndClose);
+
+    app::Application app(fixture.file_path.string(), std::move(script));
+    app.run(app);
+
+    CHECK(ui.errors() == std::vector<std::string>{ "Duplicate Entry" });
+
+    auto reloaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(reloaded);
+    const auto& entries = reloaded.value().entries();
+    REQUIRE(entries.size() == 2);
+    CHECK(entries[0].name == "Email");
+    CHECK(entries[0].username == "john");
+    CHECK(entries[0].secret == "new");
+}
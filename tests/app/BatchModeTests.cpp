@@ -0,0 +1,115 @@
+#include <doctest/doctest.h>
+#include <sstream>
+#include <string>
+
+#include "app/BatchMode.h"
+#include "util/SecureString.h"
+#include "vault/VaultFile.h"
+#include "vault/VaultFileError.h"
+#include "vault/VaultSession.h"
+#include "../vault/VaultTestFixture.h"
+
+TEST_CASE("BatchMode runs a command stream and saves once at the end")
+{
+    VaultTestFixture fixture;
+    REQUIRE(vault::VaultFile::create_new(fixture.file_path, fixture.password));
+    auto session = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(session);
+
+    std::istringstream in(
+        R"({"op":"add","name":"mail","username":"me","secret":"s1"})" "\n"
+        R"({"op":"add","name":"bank","username":"you","secret":"s2"})" "\n"
+        "\n"
+        R"({"op":"add","name":"mail","username":"x","secret":"y"})" "\n"
+        R"({"id":"7","op":"update","name":"mail","secret":"s3"})" "\n"
+        R"({"op":"remove","name":"bank"})" "\n"
+        R"({"op":"get","name":"bank"})" "\n"
+        R"({"op":"list"})" "\n"
+        "not json\n"
+    );
+    std::ostringstream out;
+
+    app::BatchMode batch(session.value());
+    REQUIRE(batch.run(in, out));
+    CHECK_FALSE(batch.dirty());
+
+    CHECK(out.str() ==
+        "{\"ok\":true}\n"
+        "{\"ok\":true}\n"
+        "{\"ok\":false,\"error\":\"Duplicate Entry\"}\n"
+        "{\"id\":\"7\",\"ok\":true}\n"
+        "{\"ok\":true}\n"
+        "{\"ok\":false,\"error\":\"Entry not found\"}\n"
+        "{\"ok\":true,\"names\":[\"mail\"]}\n"
+        "{\"ok\":false,\"error\":\"Malformed JSON\"}\n"
+    );
+
+    auto reloaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(reloaded);
+    REQUIRE(reloaded.value().entries().size() == 1);
+
+    std::string result;
+    app::BatchMode check(reloaded.value());
+    check.execute(R"({"op":"get","name":"mail"})", result);
+    CHECK(result == R"({"ok":true,"name":"mail","username":"me","secret":"s3"})");
+}
+
+TEST_CASE("BatchMode leaves the file alone when nothing changed")
+{
+    VaultTestFixture fixture;
+    REQUIRE(vault::VaultFile::create_new(fixture.file_path, fixture.password));
+    auto session = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(session);
+
+    const auto written = std::filesystem::last_write_time(fixture.file_path);
+
+    std::istringstream in(R"({"op":"list"})" "\n" R"({"op":"frobnicate"})" "\n");
+    std::ostringstream out;
+    app::BatchMode batch(session.value());
+    REQUIRE(batch.run(in, out));
+
+    CHECK(out.str() == "{\"ok\":true,\"names\":[]}\n{\"ok\":false,\"error\":\"Unknown \\\"op\\\"\"}\n");
+    CHECK(std::filesystem::last_write_time(fixture.file_path) == written);
+}
+
+TEST_CASE("BatchMode tags entries and queries by tag")
+{
+    VaultTestFixture fixture;
+    REQUIRE(vault::VaultFile::create_new(fixture.file_path, fixture.password));
+    auto session = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(session);
+
+    std::istringstream in(
+        R"({"op":"add","name":"mail","username":"me","secret":"s1","tags":"work,personal"})" "\n"
+        R"({"op":"add","name":"bank","username":"me","secret":"s2","tags":"personal"})" "\n"
+        R"({"op":"tag","name":"bank","tag":"money"})" "\n"
+        R"({"op":"untag","name":"mail","tag":"work"})" "\n"
+        R"({"op":"tag","name":"mail","tag":""})" "\n"
+        R"({"op":"tagged","tags":"personal"})" "\n"
+        R"({"op":"tagged","tags":"money,personal"})" "\n"
+        R"({"op":"tagged","tags":"work"})" "\n"
+    );
+    std::ostringstream out;
+
+    app::BatchMode batch(session.value());
+    REQUIRE(batch.run(in, out));
+
+    CHECK(out.str() ==
+        "{\"ok\":true}\n"
+        "{\"ok\":true}\n"
+        "{\"ok\":true}\n"
+        "{\"ok\":true}\n"
+        "{\"ok\":false,\"error\":\"Tags must be non-empty and contain no NUL bytes\"}\n"
+        "{\"ok\":true,\"names\":[\"mail\",\"bank\"]}\n"
+        "{\"ok\":true,\"names\":[\"bank\"]}\n"
+        "{\"ok\":true,\"names\":[]}\n"
+    );
+
+    auto reloaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(reloaded);
+
+    std::string result;
+    app::BatchMode check(reloaded.value());
+    check.execute(R"({"op":"get","name":"bank"})", result);
+    CHECK(result == R"({"ok":true,"name":"bank","username":"me","secret":"s2","tags":["money","personal"]})");
+}
@@ -0,0 +1,140 @@
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "crypto/ChunkedAead.h"
+#include "crypto/CipherSuite.h"
+#include "crypto/CryptoContext.h"
+#include "crypto/CryptoTypes.h"
+
+namespace
+{
+    constexpr auto SUITE = crypto::CipherSuite::XChaCha20Poly1305;
+    constexpr std::size_t CHUNK = 64;
+
+    struct ChunkedFixture
+    {
+        crypto::ByteBuffer key = crypto::ByteBuffer(crypto::key_size(SUITE));
+        crypto::ByteBuffer nonce = crypto::ByteBuffer(crypto::nonce_size(SUITE));
+        crypto::ByteBuffer aad = { 'h', 'd', 'r' };
+
+        ChunkedFixture()
+        {
+            REQUIRE(crypto::CryptoContext::init());
+            crypto::CryptoContext::random_bytes(key);
+            crypto::CryptoContext::random_bytes(nonce);
+        }
+
+        crypto::ByteBuffer seal(const crypto::ByteBuffer& plaintext) const
+        {
+            crypto::ByteBuffer out(
+                crypto::ChunkedAead::ciphertext_size(SUITE, plaintext.size(), CHUNK)
+            );
+            REQUIRE(crypto::ChunkedAead::seal(SUITE, key, nonce, plaintext, out, CHUNK, aad));
+            return out;
+        }
+    };
+
+    crypto::ByteBuffer pattern(std::size_t size)
+    {
+        crypto::ByteBuffer bytes(size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            bytes[i] = static_cast<uint8_t>(i * 7);
+        }
+        return bytes;
+    }
+}
+
+TEST_CASE("ChunkedAead round trips payloads around chunk boundaries")
+{
+    ChunkedFixture fixture;
+
+    for (std::size_t size : { std::size_t{0}, std::size_t{1}, CHUNK - 1, CHUNK, CHUNK + 1, 10 * CHUNK + 3 })
+    {
+        const auto plaintext = pattern(size);
+        const auto sealed = fixture.seal(plaintext);
+
+        auto length = crypto::ChunkedAead::plaintext_size(SUITE, sealed.size(), CHUNK);
+        REQUIRE(length);
+        CHECK(length.value() == size);
+
+        crypto::ByteBuffer opened(size);
+        auto result = crypto::ChunkedAead::open(
+            SUITE, fixture.key, fixture.nonce, sealed, opened, CHUNK, fixture.aad
+        );
+        REQUIRE(result);
+        CHECK(result.value() == size);
+        CHECK(opened == plaintext);
+    }
+}
+
+TEST_CASE("ChunkedAead opens in place with the plaintext compacted to the front")
+{
+    ChunkedFixture fixture;
+    const auto plaintext = pattern(5 * CHUNK + 17);
+    auto data = fixture.seal(plaintext);
+
+    auto result = crypto::ChunkedAead::open_in_place(
+        SUITE, fixture.key, fixture.nonce, data, CHUNK, fixture.aad
+    );
+    REQUIRE(result);
+    REQUIRE(result.value() == plaintext.size());
+    CHECK(std::equal(plaintext.begin(), plaintext.end(), data.begin()));
+}
+
+TEST_CASE("ChunkedAead rejects reordered, truncated and extended ciphertexts")
+{
+    ChunkedFixture fixture;
+    const auto plaintext = pattern(4 * CHUNK);
+    const auto sealed = fixture.seal(plaintext);
+    const std::size_t stride = CHUNK + crypto::tag_size(SUITE);
+
+    auto fails = [&](const crypto::ByteBuffer& ciphertext)
+    {
+        crypto::ByteBuffer out(ciphertext.size());
+        return !crypto::ChunkedAead::open(
+            SUITE, fixture.key, fixture.nonce, ciphertext, out, CHUNK, fixture.aad
+        );
+    };
+
+    // Swap the first two chunks
+    auto reordered = sealed;
+    std::swap_ranges(
+        reordered.begin(),
+        reordered.begin() + stride,
+        reordered.begin() + stride
+    );
+    CHECK(fails(reordered));
+
+    // Drop the final chunk: the new last chunk is not flagged final
+    CHECK(fails(crypto::ByteBuffer(sealed.begin(), sealed.end() - stride)));
+
+    // Append a copy of a chunk after the final one
+    auto extended = sealed;
+    extended.insert(extended.end(), sealed.begin(), sealed.begin() + stride);
+    CHECK(fails(extended));
+
+    // Append a bare tag's worth of bytes, which whole-chunk arithmetic
+    // would otherwise read as an empty trailing remainder
+    auto tag_extended = sealed;
+    tag_extended.insert(tag_extended.end(), crypto::tag_size(SUITE), 0);
+    CHECK(fails(tag_extended));
+
+    // A length that no plaintext maps to
+    CHECK(fails(crypto::ByteBuffer(sealed.begin(), sealed.end() - stride + 3)));
+}
+
+TEST_CASE("ChunkedAead binds the associated data to every chunk")
+{
+    ChunkedFixture fixture;
+    const auto sealed = fixture.seal(pattern(3 * CHUNK));
+
+    const crypto::ByteBuffer other_aad = { 'h', 'd', 'R' };
+    crypto::ByteBuffer out(sealed.size());
+    CHECK_FALSE(crypto::ChunkedAead::open(
+        SUITE, fixture.key, fixture.nonce, sealed, out, CHUNK, other_aad
+    ));
+}
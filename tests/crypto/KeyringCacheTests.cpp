@@ -0,0 +1,61 @@
+#include <doctest/doctest.h>
+#include <chrono>
+#include <sodium.h>
+#include <string>
+#include <thread>
+
+#include "crypto/CryptoContext.h"
+#include "crypto/CryptoError.h"
+#include "crypto/CryptoTypes.h"
+#include "crypto/KeyringCache.h"
+
+namespace
+{
+    std::string unique_description()
+    {
+        return "vault-test:" + std::to_string(randombytes_random());
+    }
+}
+
+TEST_CASE("KeyringCache stores, fetches and revokes a key")
+{
+    REQUIRE(crypto::CryptoContext::init());
+    const auto description = unique_description();
+
+    crypto::ByteBuffer key(32);
+    crypto::CryptoContext::random_bytes(key);
+
+    auto stored = crypto::KeyringCache::store(description, key, std::chrono::seconds(60));
+    if (!stored)
+    {
+        // Keyrings can be disabled, e.g. by a container's seccomp policy
+        MESSAGE("kernel keyring unavailable; skipping");
+        return;
+    }
+
+    auto fetched = crypto::KeyringCache::fetch(description);
+    REQUIRE(fetched);
+    CHECK(fetched.value() == key);
+
+    crypto::KeyringCache::revoke(description);
+    auto revoked = crypto::KeyringCache::fetch(description);
+    CHECK(revoked.error() == crypto::CryptoError::KeyNotCached);
+}
+
+TEST_CASE("KeyringCache entries expire after their timeout")
+{
+    REQUIRE(crypto::CryptoContext::init());
+    const auto description = unique_description();
+
+    crypto::ByteBuffer key(32, 0x42);
+    if (!crypto::KeyringCache::store(description, key, std::chrono::seconds(1)))
+    {
+        MESSAGE("kernel keyring unavailable; skipping");
+        return;
+    }
+    REQUIRE(crypto::KeyringCache::fetch(description));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    auto expired = crypto::KeyringCache::fetch(description);
+    CHECK(expired.error() == crypto::CryptoError::KeyNotCached);
+}
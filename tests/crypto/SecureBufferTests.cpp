@@ -0,0 +1,56 @@
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <utility>
+
+#include "crypto/CryptoContext.h"
+#include "crypto/SecureBuffer.h"
+
+TEST_CASE("SecureBuffer keeps its allocation across resize and clear")
+{
+    REQUIRE(crypto::CryptoContext::init());
+
+    crypto::SecureBuffer buffer(1024);
+    REQUIRE(buffer.size() == 1024);
+    const auto* storage = buffer.data();
+    const auto capacity = buffer.capacity();
+
+    buffer.resize(16);
+    buffer.resize(1024);
+    buffer.clear();
+    buffer.resize(capacity);
+
+    CHECK(buffer.data() == storage);
+    CHECK(buffer.capacity() == capacity);
+}
+
+TEST_CASE("SecureBuffer clear wipes contents")
+{
+    REQUIRE(crypto::CryptoContext::init());
+
+    crypto::SecureBuffer buffer(32);
+    std::fill(buffer.data(), buffer.data() + buffer.size(), 0xAA);
+
+    buffer.clear();
+    CHECK(buffer.empty());
+
+    buffer.resize(32);
+    CHECK(std::all_of(buffer.data(), buffer.data() + buffer.size(), [](auto b)
+    {
+        return b == 0;
+    }));
+}
+
+TEST_CASE("SecureBuffer preserves contents when it grows and when moved")
+{
+    REQUIRE(crypto::CryptoContext::init());
+
+    crypto::SecureBuffer buffer(4);
+    std::fill(buffer.data(), buffer.data() + 4, 0x5A);
+    buffer.resize(4096);
+    CHECK(buffer.data()[3] == 0x5A);
+
+    crypto::SecureBuffer moved(std::move(buffer));
+    CHECK(moved.size() == 4096);
+    CHECK(moved.data()[0] == 0x5A);
+    CHECK(buffer.data() == nullptr);
+}
@@ -1,5 +1,7 @@
 #include <doctest/doctest.h>
 #include <sodium/crypto_aead_xchacha20poly1305.h>
+#include <algorithm>
+#include <span>
 
 #include "crypto/CryptoContext.h"
 #include "crypto/VaultCrypto.h"
@@ -101,3 +103,137 @@ TEST_CASE("Tampered ciphertext fails authentication")
 
     CHECK_FALSE(decrypted);
 }
+
+// --- Cipher suites ---
+static const crypto::CipherSuite ALL_SUITES[] = {
+    crypto::CipherSuite::XChaCha20Poly1305,
+    crypto::CipherSuite::Aes256Gcm,
+    crypto::CipherSuite::Aegis256
+};
+
+// Test 6: every suite this host supports round-trips
+TEST_CASE("Each available cipher suite round-trips with associated data")
+{
+    REQUIRE(crypto::CryptoContext::init());
+
+    crypto::ByteBuffer key(32, 0x01);
+    crypto::ByteBuffer plaintext = {'s', 'e', 'c', 'r', 'e', 't'};
+    crypto::ByteBuffer aad = {'h', 'd', 'r'};
+
+    for (auto suite : ALL_SUITES)
+    {
+        if (!crypto::is_available(suite))
+        {
+            continue;
+        }
+
+        crypto::ByteBuffer nonce(crypto::nonce_size(suite));
+        crypto::CryptoContext::random_bytes(nonce);
+
+        auto encrypted = crypto::VaultCrypto::encrypt(suite, key, nonce, plaintext, aad);
+        REQUIRE(encrypted);
+        CHECK(encrypted.value().size() == plaintext.size() + crypto::tag_size(suite));
+
+        auto decrypted = crypto::VaultCrypto::decrypt(suite, key, nonce, encrypted.value(), aad);
+        REQUIRE(decrypted);
+        CHECK(decrypted.value() == plaintext);
+
+        aad[0] ^= 0xFF;
+        CHECK_FALSE(crypto::VaultCrypto::decrypt(suite, key, nonce, encrypted.value(), aad));
+        aad[0] ^= 0xFF;
+    }
+}
+
+// Test 7: selection never picks something the host cannot run
+TEST_CASE("Selected cipher suite is available and unavailable ones are refused")
+{
+    REQUIRE(crypto::CryptoContext::init());
+    CHECK(crypto::is_available(crypto::select_cipher_suite()));
+    // AES-GCM needs hardware AES to open, so it is never the default
+    CHECK(crypto::select_cipher_suite() != crypto::CipherSuite::Aes256Gcm);
+
+    crypto::ByteBuffer key(32, 0x01);
+    crypto::ByteBuffer plaintext = {'x'};
+    for (auto suite : ALL_SUITES)
+    {
+        if (crypto::is_available(suite))
+        {
+            continue;
+        }
+        crypto::ByteBuffer nonce(crypto::nonce_size(suite));
+        auto encrypted = crypto::VaultCrypto::encrypt(suite, key, nonce, plaintext);
+        REQUIRE_FALSE(encrypted);
+        CHECK(encrypted.error() == crypto::CryptoError::UnsupportedCipher);
+    }
+}
+
+// --- Caller-provided buffers ---
+// Test 8: in-place encrypt/decrypt over one buffer
+TEST_CASE("In-place encrypt and decrypt reuse the caller's buffer")
+{
+    REQUIRE(crypto::CryptoContext::init());
+
+    const auto suite = crypto::CipherSuite::XChaCha20Poly1305;
+    crypto::ByteBuffer key(32, 0x07);
+    crypto::ByteBuffer nonce(crypto::nonce_size(suite));
+    crypto::CryptoContext::random_bytes(nonce);
+
+    const crypto::ByteBuffer original = {'h', 'e', 'l', 'l', 'o'};
+    crypto::ByteBuffer buffer(original.size() + crypto::tag_size(suite));
+    std::copy(original.begin(), original.end(), buffer.begin());
+    const auto* storage = buffer.data();
+
+    std::span<const uint8_t> plaintext(buffer.data(), original.size());
+    auto sealed = crypto::VaultCrypto::encrypt_into(suite, key, nonce, plaintext, buffer);
+    REQUIRE(sealed);
+    CHECK(sealed.value() == buffer.size());
+    CHECK_FALSE(std::equal(original.begin(), original.end(), buffer.begin()));
+
+    auto opened = crypto::VaultCrypto::decrypt_into(suite, key, nonce, buffer, buffer);
+    REQUIRE(opened);
+    CHECK(opened.value() == original.size());
+    CHECK(std::equal(original.begin(), original.end(), buffer.begin()));
+    CHECK(buffer.data() == storage);
+}
+
+// Test 9: detached tags
+TEST_CASE("Detached tag round-trips and detects tampering")
+{
+    REQUIRE(crypto::CryptoContext::init());
+
+    const auto suite = crypto::CipherSuite::XChaCha20Poly1305;
+    crypto::ByteBuffer key(32, 0x09);
+    crypto::ByteBuffer nonce(crypto::nonce_size(suite));
+    crypto::CryptoContext::random_bytes(nonce);
+
+    crypto::ByteBuffer data = {'s', 'e', 'c', 'r', 'e', 't'};
+    const crypto::ByteBuffer original = data;
+    crypto::ByteBuffer tag(crypto::tag_size(suite));
+
+    REQUIRE(crypto::VaultCrypto::encrypt_detached(suite, key, nonce, data, data, tag));
+    CHECK(data.size() == original.size());
+
+    crypto::ByteBuffer bad_tag = tag;
+    bad_tag[0] ^= 0xFF;
+    crypto::ByteBuffer scratch(data.size());
+    CHECK_FALSE(crypto::VaultCrypto::decrypt_detached(suite, key, nonce, data, bad_tag, scratch));
+
+    REQUIRE(crypto::VaultCrypto::decrypt_detached(suite, key, nonce, data, tag, data));
+    CHECK(data == original);
+}
+
+// Test 10: undersized or partially overlapping output is refused
+TEST_CASE("Caller buffers that are too small or partially overlap are rejected")
+{
+    const auto suite = crypto::CipherSuite::XChaCha20Poly1305;
+    crypto::ByteBuffer key(32, 0x01);
+    crypto::ByteBuffer nonce(crypto::nonce_size(suite), 0x02);
+    crypto::ByteBuffer buffer(64, 0x03);
+
+    std::span<const uint8_t> plaintext(buffer.data(), 16);
+    std::span<uint8_t> too_small(buffer.data() + 32, 16);
+    CHECK_FALSE(crypto::VaultCrypto::encrypt_into(suite, key, nonce, plaintext, too_small));
+
+    std::span<uint8_t> shifted(buffer.data() + 4, 32);
+    CHECK_FALSE(crypto::VaultCrypto::encrypt_into(suite, key, nonce, plaintext, shifted));
+}
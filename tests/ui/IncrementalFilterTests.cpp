@@ -0,0 +1,63 @@
+#include <doctest/doctest.h>
+#include <string>
+#include <vector>
+
+#include "ui/IncrementalFilter.h"
+#include "vault/EntryTable.h"
+
+namespace
+{
+
+vault::EntryTable make_entries(const std::vector<std::string>& names)
+{
+    vault::EntryTable entries;
+    for (const auto& name : names)
+    {
+        entries.push_back(name, "user", "secret");
+    }
+    return entries;
+}
+
+} // unnamed namespace
+
+TEST_CASE("IncrementalFilter narrows as characters are typed")
+{
+    const auto entries = make_entries({ "GitHub", "gitlab", "Mail", "bank" });
+    ui::IncrementalFilter filter(entries);
+
+    CHECK(filter.matches() == std::vector<size_t>{ 0, 1, 2, 3 });
+
+    filter.push('g');
+    CHECK(filter.matches() == std::vector<size_t>{ 0, 1 });
+    filter.push('I');
+    filter.push('t');
+    filter.push('h');
+    CHECK(filter.query() == "gIth");
+    CHECK(filter.matches() == std::vector<size_t>{ 0 });
+    filter.push('x');
+    CHECK(filter.matches().empty());
+}
+
+TEST_CASE("IncrementalFilter restores earlier results on backspace")
+{
+    const auto entries = make_entries({ "GitHub", "gitlab", "Mail", "bank" });
+    ui::IncrementalFilter filter(entries);
+
+    filter.push('a');
+    CHECK(filter.matches() == std::vector<size_t>{ 1, 2, 3 });
+    filter.push('n');
+    CHECK(filter.matches() == std::vector<size_t>{ 3 });
+
+    filter.pop();
+    CHECK(filter.query() == "a");
+    CHECK(filter.matches() == std::vector<size_t>{ 1, 2, 3 });
+
+    filter.pop();
+    filter.pop();
+    CHECK(filter.query().empty());
+    CHECK(filter.matches().size() == 4);
+
+    filter.push('m');
+    filter.clear();
+    CHECK(filter.matches().size() == 4);
+}
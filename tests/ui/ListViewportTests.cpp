@@ -0,0 +1,67 @@
+#include <doctest/doctest.h>
+
+#include "ui/ListViewport.h"
+
+using Redraw = ui::ListViewport::Redraw;
+
+TEST_CASE("ListViewport repaints only the selection until the window scrolls")
+{
+    ui::ListViewport view(100000, 10);
+
+    CHECK(view.up() == Redraw::None);
+    CHECK(view.down() == Redraw::Selection);
+    CHECK(view.previous() == 0);
+    CHECK(view.selected() == 1);
+
+    for (int i = 0; i < 8; ++i)
+    {
+        CHECK(view.down() == Redraw::Selection);
+    }
+    CHECK(view.selected() == 9);
+    CHECK(view.top() == 0);
+
+    CHECK(view.down() == Redraw::Window);
+    CHECK(view.top() == 1);
+    CHECK(view.bottom() == 11);
+}
+
+TEST_CASE("ListViewport pages and jumps to either end")
+{
+    ui::ListViewport view(100000, 10);
+
+    CHECK(view.page_down() == Redraw::Window);
+    CHECK(view.selected() == 10);
+    CHECK(view.top() == 10);
+
+    CHECK(view.end() == Redraw::Window);
+    CHECK(view.selected() == 99999);
+    CHECK(view.top() == 99990);
+    CHECK(view.down() == Redraw::None);
+    CHECK(view.page_down() == Redraw::None);
+
+    CHECK(view.page_up() == Redraw::Window);
+    CHECK(view.selected() == 99989);
+    CHECK(view.top() == 99980);
+
+    CHECK(view.home() == Redraw::Window);
+    CHECK(view.selected() == 0);
+    CHECK(view.top() == 0);
+    CHECK(view.page_up() == Redraw::None);
+}
+
+TEST_CASE("ListViewport handles lists shorter than the window")
+{
+    ui::ListViewport view(3, 10);
+
+    CHECK(view.page_down() == Redraw::Selection);
+    CHECK(view.selected() == 2);
+    CHECK(view.top() == 0);
+    CHECK(view.bottom() == 3);
+
+    view.reset(1);
+    CHECK(view.selected() == 0);
+    CHECK(view.end() == Redraw::None);
+
+    view.reset(0);
+    CHECK(view.down() == Redraw::None);
+}
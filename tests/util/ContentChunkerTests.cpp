@@ -0,0 +1,84 @@
+#include <doctest/doctest.h>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "util/ContentChunker.h"
+
+namespace
+{
+    std::vector<std::string> chunks_of(const util::ContentChunker& chunker, std::span<const uint8_t> data)
+    {
+        std::vector<std::string> chunks;
+        chunker.split(data, [&chunks](std::span<const uint8_t> chunk)
+        {
+            chunks.emplace_back(chunk.begin(), chunk.end());
+        });
+        return chunks;
+    }
+
+    // Seeded, so every run cuts the same data: how far a shift ripples
+    // depends on where the cuts happen to fall
+    std::vector<uint8_t> random_bytes(size_t size)
+    {
+        std::mt19937_64 rng(0x5eed);
+        std::vector<uint8_t> bytes(size);
+        for (auto& byte : bytes)
+        {
+            byte = static_cast<uint8_t>(rng());
+        }
+        return bytes;
+    }
+}
+
+TEST_CASE("ContentChunker covers the data in chunks within bounds")
+{
+    const util::ContentChunker chunker(256, 1024, 4096);
+    const auto data = random_bytes(256 * 1024);
+
+    const auto chunks = chunks_of(chunker, data);
+    size_t total = 0;
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        total += chunks[i].size();
+        CHECK(chunks[i].size() <= 4096);
+        if (i + 1 < chunks.size())
+        {
+            CHECK(chunks[i].size() > 256);
+        }
+    }
+    CHECK(total == data.size());
+
+    // Normalised cuts keep the count near size / average
+    CHECK(chunks.size() > 256 / 2);
+    CHECK(chunks.size() < 256 * 2);
+
+    // Cuts depend on the bytes alone
+    CHECK(chunks_of(chunker, data) == chunks);
+    CHECK(chunker.cut({}) == 0);
+}
+
+TEST_CASE("ContentChunker boundaries resynchronise after an insertion")
+{
+    const util::ContentChunker chunker(256, 1024, 4096);
+    const auto data = random_bytes(256 * 1024);
+    auto edited = data;
+    edited.insert(edited.begin() + 100000, 17, 0x5a);
+
+    const auto before = chunks_of(chunker, data);
+    const auto after = chunks_of(chunker, edited);
+    const std::set<std::string> known(before.begin(), before.end());
+
+    size_t fresh = 0;
+    for (const auto& chunk : after)
+    {
+        fresh += known.count(chunk) == 0 ? 1 : 0;
+    }
+    // Only the chunks around the edit differ
+    CHECK(fresh >= 1);
+    CHECK(fresh <= 3);
+}
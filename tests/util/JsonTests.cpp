@@ -0,0 +1,38 @@
+#include <doctest/doctest.h>
+#include <string>
+
+#include "util/Json.h"
+
+TEST_CASE("JsonObject parses string members and escapes")
+{
+    auto object = util::JsonObject::parse(
+        R"( {"op": "add", "name":"a\"b\\c", "secret":"é😀\n"} )"
+    );
+    REQUIRE(object);
+
+    const auto* op = object.value().find("op");
+    REQUIRE(op);
+    CHECK(std::string(op->c_str()) == "add");
+    CHECK(std::string(object.value().find("name")->c_str()) == "a\"b\\c");
+    CHECK(std::string(object.value().find("secret")->c_str()) == "\xc3\xa9\xf0\x9f\x98\x80\n");
+    CHECK(object.value().find("missing") == nullptr);
+
+    CHECK(util::JsonObject::parse("{}"));
+}
+
+TEST_CASE("JsonObject rejects malformed and unsupported input")
+{
+    CHECK(util::JsonObject::parse(R"({"op":"list")").error() == util::JsonError::Syntax);
+    CHECK(util::JsonObject::parse(R"({"op":"list"} x)").error() == util::JsonError::Syntax);
+    CHECK(util::JsonObject::parse(R"({"op":"\q"})").error() == util::JsonError::Syntax);
+    CHECK(util::JsonObject::parse(R"({"op":"\udc00"})").error() == util::JsonError::Syntax);
+    CHECK(util::JsonObject::parse(R"({"n":1})").error() == util::JsonError::UnsupportedValue);
+    CHECK(util::JsonObject::parse(R"({"a":"1","a":"2"})").error() == util::JsonError::DuplicateKey);
+}
+
+TEST_CASE("append_json_string escapes quotes and control characters")
+{
+    std::string out;
+    util::append_json_string(out, "say \"hi\"\\\x01\t");
+    CHECK(out == R"("say \"hi\"\\\u0001\t")");
+}
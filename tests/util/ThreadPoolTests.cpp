@@ -0,0 +1,141 @@
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "util/ThreadPool.h"
+
+namespace
+{
+    // Sum of one counter over every worker. A worker counts a task just
+    // after running it, so after its future is ready: this waits up to a
+    // second for the sum to reach `expected` before reporting it.
+    std::uint64_t settled_total(
+        const util::ThreadPool& pool,
+        std::uint64_t util::WorkerStats::* counter,
+        std::uint64_t expected)
+    {
+        std::uint64_t total = 0;
+        for (int attempt = 0; attempt < 1000; ++attempt)
+        {
+            total = 0;
+            for (const auto& worker : pool.stats())
+            {
+                total += worker.*counter;
+            }
+            if (total >= expected)
+            {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return total;
+    }
+}
+
+TEST_CASE("ThreadPool futures carry results and exceptions")
+{
+    util::ThreadPool pool(2);
+
+    auto answer = pool.submit([] { return 42; });
+    auto failure = pool.submit([]() -> int { throw std::runtime_error("boom"); });
+
+    CHECK(answer.get() == 42);
+    CHECK_THROWS_AS(failure.get(), std::runtime_error);
+}
+
+TEST_CASE("ThreadPool runs every submitted task and counts it")
+{
+    std::atomic<int> counter{0};
+    {
+        util::ThreadPool pool(4);
+        std::vector<std::future<void>> futures;
+        for (int i = 0; i < 1000; ++i)
+        {
+            futures.push_back(pool.submit([&counter] { counter.fetch_add(1); }));
+        }
+        for (auto& future : futures)
+        {
+            future.get();
+        }
+        CHECK(settled_total(pool, &util::WorkerStats::executed, 1000) == 1000);
+    }
+    CHECK(counter.load() == 1000);
+}
+
+TEST_CASE("ThreadPool drops tasks cancelled before they start")
+{
+    util::ThreadPool pool(1);
+    std::promise<void> release;
+    auto gate = release.get_future().share();
+
+    // Occupy the only worker so the next task stays queued
+    auto blocker = pool.submit([gate] { gate.wait(); });
+
+    util::CancellationToken token;
+    bool ran = false;
+    auto cancelled = pool.submit(token, [&ran] { ran = true; });
+    token.cancel();
+    release.set_value();
+
+    blocker.get();
+    CHECK_THROWS_AS(cancelled.get(), std::future_error);
+    CHECK_FALSE(ran);
+    CHECK(pool.stats()[0].cancelled == 1);
+}
+
+TEST_CASE("Idle workers steal tasks queued on a busy worker")
+{
+    util::ThreadPool pool(2);
+
+    // Tasks submitted from a worker land on its own deque; it then blocks
+    // on them, so only the other worker can run them
+    auto parent = pool.submit([&pool]
+    {
+        std::vector<std::future<int>> children;
+        for (int i = 0; i < 64; ++i)
+        {
+            children.push_back(pool.submit([i] { return i; }));
+        }
+
+        int sum = 0;
+        for (auto& child : children)
+        {
+            sum += child.get();
+        }
+        return sum;
+    });
+
+    CHECK(parent.get() == 64 * 63 / 2);
+
+    CHECK(settled_total(pool, &util::WorkerStats::stolen, 64) == 64);
+}
+
+TEST_CASE("parallel_for visits each index once, including when nested")
+{
+    util::ThreadPool pool(3);
+    std::vector<std::atomic<int>> hits(500);
+
+    pool.parallel_for(hits.size(), [&](std::size_t i)
+    {
+        hits[i].fetch_add(1);
+    });
+    CHECK(std::all_of(hits.begin(), hits.end(), [](const auto& h) { return h.load() == 1; }));
+
+    // Every worker running a parallel_for of its own must not deadlock
+    std::atomic<int> inner{0};
+    pool.parallel_for(8, [&](std::size_t)
+    {
+        pool.parallel_for(16, [&](std::size_t)
+        {
+            inner.fetch_add(1);
+        });
+    });
+    CHECK(inner.load() == 8 * 16);
+}
@@ -0,0 +1,225 @@
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sodium.h>
+
+#include "crypto/CryptoTypes.h"
+#include "crypto/SecureBuffer.h"
+#include "util/Expected.h"
+#include "util/SecureString.h"
+#include "vault/AttachmentStore.h"
+#include "vault/BackupStore.h"
+#include "vault/Entry.h"
+#include "vault/Vault.h"
+#include "vault/VaultFile.h"
+#include "vault/VaultFileError.h"
+#include "VaultTestFixture.h"
+#include "vault/VaultSession.h"
+
+namespace
+{
+
+crypto::ByteBuffer random_bytes (size_t size)
+{
+    crypto::ByteBuffer bytes(size);
+    randombytes_buf(bytes.data(), bytes.size());
+    return bytes;
+}
+
+bool same (const crypto::SecureBuffer& a, const crypto::ByteBuffer& b)
+{
+    return a.size() == b.size() && std::equal(b.begin(), b.end(), a.data());
+}
+
+} // unnamed namespace
+
+TEST_CASE("Attachments round-trip and are stored only once")
+{
+    VaultTestFixture fixture;
+    vault::AttachmentStore store(vault::AttachmentStore::beside(fixture.file_path), test_key());
+
+    // Two and a half chunks, plus an empty file
+    const auto data = random_bytes(vault::ATTACHMENT_CHUNK_SIZE * 5 / 2);
+    auto blob = store.put(data);
+    REQUIRE(blob);
+    CHECK(blob.value().size == data.size());
+    CHECK(store.contains(blob.value().id));
+    CHECK(file_count(store.root()) == 4);
+
+    auto read = store.get(blob.value());
+    REQUIRE(read);
+    CHECK(same(read.value(), data));
+
+    // The same bytes again write nothing and give the same id
+    auto again = store.put(data);
+    REQUIRE(again);
+    CHECK(again.value() == blob.value());
+    CHECK(file_count(store.root()) == 4);
+
+    // Sharing the first two chunks stores only the new tail and manifest
+    auto extended = data;
+    extended.resize(vault::ATTACHMENT_CHUNK_SIZE * 2 + 10, 0x07);
+    REQUIRE(store.put(extended));
+    CHECK(file_count(store.root()) == 6);
+
+    auto empty = store.put({});
+    REQUIRE(empty);
+    auto read_empty = store.get(empty.value());
+    REQUIRE(read_empty);
+    CHECK(read_empty.value().empty());
+}
+
+TEST_CASE("Attachments refuse tampering, the wrong key and a wrong size")
+{
+    VaultTestFixture fixture;
+    const auto root = vault::AttachmentStore::beside(fixture.file_path);
+    vault::AttachmentStore store(root, test_key());
+
+    auto blob = store.put(random_bytes(1000));
+    REQUIRE(blob);
+
+    vault::Blob wrong_size = blob.value();
+    wrong_size.size += 1;
+    auto resized = store.get(wrong_size);
+    REQUIRE_FALSE(resized);
+    CHECK(resized.error() == vault::VaultFileError::CryptoError);
+
+    crypto::ByteBuffer other_key = test_key();
+    other_key[0] ^= 1;
+    vault::AttachmentStore stranger(root, other_key);
+    CHECK_FALSE(stranger.get(blob.value()));
+
+    vault::Blob missing = blob.value();
+    missing.id[0] ^= 1;
+    auto lost = store.get(missing);
+    REQUIRE_FALSE(lost);
+    CHECK(lost.error() == vault::VaultFileError::FileNotFound);
+
+    // Flip one ciphertext byte in every object
+    for (const auto& item : std::filesystem::recursive_directory_iterator(root))
+    {
+        if (!item.is_regular_file())
+        {
+            continue;
+        }
+        std::fstream file(item.path(), std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(30);
+        const char byte = static_cast<char>(file.get() ^ 0x01);
+        file.seekp(30);
+        file.put(byte);
+    }
+    auto tampered = store.get(blob.value());
+    REQUIRE_FALSE(tampered);
+    CHECK(tampered.error() == vault::VaultFileError::CryptoError);
+}
+
+TEST_CASE("Session attachments survive a reload and pruning keeps only live blobs")
+{
+    VaultTestFixture fixture;
+    REQUIRE(vault::VaultFile::create_new(fixture.file_path, fixture.password));
+    const auto key_file = random_bytes(3000);
+    const auto old_file = random_bytes(vault::ATTACHMENT_CHUNK_SIZE + 1);
+
+    {
+        auto loaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+        REQUIRE(loaded);
+        vault::VaultSession& session = loaded.value();
+
+        auto id = session.add_entry(vault::Entry(
+            util::SecureString{"server"},
+            util::SecureString{"root"},
+            util::SecureString{"hunter2"}
+        ));
+        REQUIRE(id);
+
+        auto key_blob = session.attachments().put(key_file);
+        auto old_blob = session.attachments().put(old_file);
+        REQUIRE(key_blob);
+        REQUIRE(old_blob);
+        REQUIRE(session.attach(id.value(), "id_ed25519", key_blob.value()));
+        REQUIRE(session.attach(id.value(), "old.pem", old_blob.value()));
+        REQUIRE(session.detach(id.value(), "old.pem"));
+        REQUIRE(session.save());
+
+        // The old blob's manifest and both its chunks go
+        auto pruned = session.prune_attachments();
+        REQUIRE(pruned);
+        CHECK(pruned.value() == 3);
+    }
+
+    auto loaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(loaded);
+    vault::VaultSession& session = loaded.value();
+    REQUIRE(session.entries().size() == 1);
+
+    size_t count = 0;
+    vault::for_each_attachment(session.entries()[0].attachments, [&](const vault::AttachmentView& attachment)
+    {
+        ++count;
+        CHECK(attachment.name == "id_ed25519");
+        auto read = session.attachments().get(attachment.blob);
+        REQUIRE(read);
+        CHECK(same(read.value(), key_file));
+    });
+    CHECK(count == 1);
+}
+
+TEST_CASE("Pruning keeps the blobs a backup snapshot still refers to")
+{
+    VaultTestFixture fixture;
+    REQUIRE(vault::VaultFile::create_new(fixture.file_path, fixture.password));
+    const auto contents = random_bytes(vault::ATTACHMENT_CHUNK_SIZE + 1);
+
+    auto loaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(loaded);
+    vault::VaultSession& session = loaded.value();
+
+    auto id = session.add_entry(vault::Entry(
+        util::SecureString{"server"},
+        util::SecureString{"root"},
+        util::SecureString{"hunter2"}
+    ));
+    REQUIRE(id);
+    auto blob = session.attachments().put(contents);
+    REQUIRE(blob);
+    REQUIRE(session.attach(id.value(), "id_ed25519", blob.value()));
+
+    auto snapshot = session.back_up();
+    REQUIRE(snapshot);
+    REQUIRE(session.detach(id.value(), "id_ed25519"));
+    REQUIRE(session.save());
+
+    auto pruned = session.prune_attachments();
+    REQUIRE(pruned);
+    CHECK(pruned.value() == 0);
+
+    // The snapshot's vault can still open what it had attached
+    auto payload = session.backups().restore(snapshot.value());
+    REQUIRE(payload);
+    auto restored = vault::Vault::deserialise(payload.value());
+    REQUIRE(restored);
+    REQUIRE(restored.value().entries().size() == 1);
+
+    size_t count = 0;
+    vault::for_each_attachment(restored.value().entries()[0].attachments, [&](const vault::AttachmentView& attachment)
+    {
+        ++count;
+        auto read = session.attachments().get(attachment.blob);
+        REQUIRE(read);
+        CHECK(same(read.value(), contents));
+    });
+    CHECK(count == 1);
+
+    // Once no snapshot refers to it either, the blob goes
+    vault::RetentionPolicy none;
+    none.last = 0;
+    none.hourly = 0;
+    none.daily = 0;
+    none.weekly = 0;
+    none.monthly = 0;
+    REQUIRE(session.backups().prune(none));
+    pruned = session.prune_attachments();
+    REQUIRE(pruned);
+    CHECK(pruned.value() == 3);
+}
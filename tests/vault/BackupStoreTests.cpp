@@ -0,0 +1,218 @@
+#include <doctest/doctest.h>
+#include <filesystem>
+#include <fstream>
+#include <sodium.h>
+#include <string>
+#include <vector>
+
+#include "crypto/CryptoTypes.h"
+#include "util/Expected.h"
+#include "util/SecureString.h"
+#include "vault/BackupStore.h"
+#include "vault/Entry.h"
+#include "vault/Vault.h"
+#include "vault/VaultFile.h"
+#include "vault/VaultFileError.h"
+#include "VaultTestFixture.h"
+#include "vault/VaultSession.h"
+
+namespace
+{
+
+constexpr int64_t HOUR = 60 * 60;
+constexpr int64_t DAY = 24 * HOUR;
+
+vault::Vault make_vault (size_t entries)
+{
+    vault::Vault vault;
+    for (size_t i = 0; i < entries; ++i)
+    {
+        const std::string name = "entry-" + std::to_string(i);
+        REQUIRE(vault.add_entry(vault::Entry{
+            util::SecureString{name},
+            util::SecureString{"user" + std::to_string(i) + "@example.com"},
+            util::SecureString{"secret-" + std::to_string(i * 7919)}
+        }));
+    }
+    return vault;
+}
+
+} // unnamed namespace
+
+TEST_CASE("Backups restore each version and a new snapshot stores only changed chunks")
+{
+    VaultTestFixture fixture;
+    const auto root = vault::BackupStore::beside(fixture.file_path);
+    vault::BackupStore store(root, test_key());
+
+    auto vault = make_vault(5000);
+    const auto first_payload = vault.serialise();
+    auto first = store.snapshot(first_payload, 10 * DAY);
+    REQUIRE(first);
+    const size_t first_chunks = file_count(root / "chunks");
+    CHECK(first_chunks > 8);
+
+    const auto id = vault.id_at(2500);
+    REQUIRE(vault.set_field(id, vault::EntryField::Secret, util::SecureString{"rotated"}));
+    auto second = store.snapshot(vault.serialise(), 10 * DAY + HOUR);
+    REQUIRE(second);
+    CHECK_FALSE(second.value() == first.value());
+    CHECK(file_count(root / "chunks") - first_chunks <= 2);
+
+    // The same payload at the same time is the same snapshot
+    auto repeat = store.snapshot(first_payload, 10 * DAY);
+    REQUIRE(repeat);
+    CHECK(repeat.value() == first.value());
+
+    auto snapshots = store.list();
+    REQUIRE(snapshots);
+    REQUIRE(snapshots.value().size() == 2);
+    CHECK(snapshots.value()[0] == first.value());
+    CHECK(snapshots.value()[1] == second.value());
+
+    auto old_payload = store.restore(first.value());
+    REQUIRE(old_payload);
+    auto old_vault = vault::Vault::deserialise(old_payload.value());
+    REQUIRE(old_vault);
+    CHECK(old_vault.value().entries().size() == 5000);
+    CHECK(old_vault.value().entries().secret(2500) == "secret-" + std::to_string(2500 * 7919));
+
+    auto new_payload = store.restore(second.value());
+    REQUIRE(new_payload);
+    auto new_vault = vault::Vault::deserialise(new_payload.value());
+    REQUIRE(new_vault);
+    CHECK(new_vault.value().entries().secret(2500) == "rotated");
+}
+
+TEST_CASE("Retention keeps the newest snapshot of each recent period and prunes the rest")
+{
+    // Four snapshots an hour for three days
+    std::vector<vault::BackupStore::Snapshot> snapshots;
+    for (int64_t t = 100 * DAY; t < 103 * DAY; t += HOUR / 4)
+    {
+        snapshots.push_back({ {}, t });
+    }
+
+    vault::RetentionPolicy policy;
+    policy.last = 2;
+    policy.hourly = 6;
+    policy.daily = 3;
+    policy.weekly = 0;
+    policy.monthly = 0;
+    const auto keep = vault::retained(snapshots, policy);
+
+    // The last two, the last of each of the five hours before, and the last
+    // of each of the two days before
+    std::vector<int64_t> kept;
+    for (size_t i = 0; i < snapshots.size(); ++i)
+    {
+        if (keep[i])
+        {
+            kept.push_back(snapshots[i].taken);
+        }
+    }
+    const int64_t last = 103 * DAY - HOUR / 4;
+    const std::vector<int64_t> expected{
+        101 * DAY - HOUR / 4,
+        102 * DAY - HOUR / 4,
+        last - 5 * HOUR,
+        last - 4 * HOUR,
+        last - 3 * HOUR,
+        last - 2 * HOUR,
+        last - HOUR,
+        last - HOUR / 4,
+        last,
+    };
+    CHECK(kept == expected);
+
+    // Pruning drops the other snapshots and the chunks only they listed
+    VaultTestFixture fixture;
+    const auto root = vault::BackupStore::beside(fixture.file_path);
+    vault::BackupStore store(root, test_key());
+    auto vault = make_vault(3000);
+    const auto id = vault.id_at(1500);
+    for (int64_t t = 100 * DAY; t < 100 * DAY + 5 * HOUR; t += HOUR)
+    {
+        REQUIRE(vault.set_field(id, vault::EntryField::Secret, util::SecureString{std::to_string(t)}));
+        REQUIRE(store.snapshot(vault.serialise(), t));
+    }
+    const size_t chunks_before = file_count(root / "chunks");
+
+    vault::RetentionPolicy one;
+    one.hourly = 0;
+    one.daily = 0;
+    one.weekly = 0;
+    one.monthly = 0;
+    auto pruned = store.prune(one);
+    REQUIRE(pruned);
+    CHECK(pruned.value() == 4);
+    CHECK(file_count(root / "chunks") < chunks_before);
+
+    auto left = store.list();
+    REQUIRE(left);
+    REQUIRE(left.value().size() == 1);
+    auto payload = store.restore(left.value()[0]);
+    REQUIRE(payload);
+    CHECK(payload.value().size() == vault.serialise().size());
+}
+
+TEST_CASE("Backups refuse tampered chunks, renamed snapshots and the wrong key")
+{
+    VaultTestFixture fixture;
+    const auto root = vault::BackupStore::beside(fixture.file_path);
+    vault::BackupStore store(root, test_key());
+
+    auto snapshot = store.snapshot(make_vault(500).serialise(), 5 * DAY);
+    REQUIRE(snapshot);
+
+    crypto::ByteBuffer other_key = test_key();
+    other_key[0] ^= 1;
+    vault::BackupStore stranger(root, other_key);
+    CHECK_FALSE(stranger.restore(snapshot.value()));
+
+    // Moving a snapshot to another time is caught against its manifest
+    auto names = std::filesystem::directory_iterator(root / "snapshots");
+    const auto path = names->path();
+    auto moved_name = path.filename().string();
+    moved_name[10] = '1';
+    std::filesystem::rename(path, path.parent_path() / moved_name);
+    auto listed = store.list();
+    REQUIRE(listed);
+    REQUIRE(listed.value().size() == 1);
+    auto moved = store.restore(listed.value()[0]);
+    REQUIRE_FALSE(moved);
+    CHECK(moved.error() == vault::VaultFileError::CryptoError);
+    std::filesystem::rename(path.parent_path() / moved_name, path);
+
+    // Flip one ciphertext byte in every chunk
+    for (const auto& item : std::filesystem::recursive_directory_iterator(root / "chunks"))
+    {
+        if (!item.is_regular_file())
+        {
+            continue;
+        }
+        std::fstream file(item.path(), std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(30);
+        const char byte = static_cast<char>(file.get() ^ 0x01);
+        file.seekp(30);
+        file.put(byte);
+    }
+    auto tampered = store.restore(snapshot.value());
+    REQUIRE_FALSE(tampered);
+    CHECK(tampered.error() == vault::VaultFileError::CryptoError);
+
+    // A session snapshots its in-memory vault beside its own file
+    REQUIRE(vault::VaultFile::create_new(fixture.file_path, fixture.password));
+    auto loaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(loaded);
+    REQUIRE(loaded.value().add_entry(vault::Entry{
+        util::SecureString{"unsaved"}, util::SecureString{""}, util::SecureString{"x"}
+    }));
+    auto backed_up = loaded.value().back_up();
+    REQUIRE(backed_up);
+    auto restored = loaded.value().backups().restore(backed_up.value());
+    REQUIRE(restored);
+    auto restored_vault = vault::Vault::deserialise(restored.value());
+    REQUIRE(restored_vault);
+    CHECK(restored_vault.value().has_entry("unsaved"));
+}
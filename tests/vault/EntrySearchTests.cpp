@@ -0,0 +1,115 @@
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "vault/EntrySearch.h"
+#include "vault/EntryTable.h"
+
+namespace
+{
+
+const vault::SearchKernel KERNELS[] = {
+    vault::SearchKernel::Scalar,
+    vault::SearchKernel::Sse2,
+    vault::SearchKernel::Avx2
+};
+
+} // unnamed namespace
+
+TEST_CASE("EntrySearch matches names and usernames ignoring case")
+{
+    vault::EntryTable entries;
+    entries.push_back("GitHub Enterprise", "jane@corp.example", "secret");
+    entries.push_back("mail", "JOHN@EXAMPLE.COM", "secret");
+    entries.push_back("bank", "john", "secret");
+
+    for (const auto kernel : KERNELS)
+    {
+        if (!vault::is_available(kernel))
+        {
+            continue;
+        }
+        CAPTURE(vault::to_string(kernel));
+
+        const vault::EntrySearch search(entries, kernel);
+        CHECK(search.find("github") == std::vector<size_t>{ 0 });
+        CHECK(search.find("Example") == std::vector<size_t>{ 0, 1 });
+        CHECK(search.find("john") == std::vector<size_t>{ 1, 2 });
+        CHECK(search.find("X") == std::vector<size_t>{ 0, 1 });
+        CHECK(search.find("nope").empty());
+        CHECK(search.find("").size() == 3);
+
+        // Never across the name/username boundary
+        CHECK(search.find("bankjohn").empty());
+
+        const std::vector<size_t> candidates{ 0, 2 };
+        CHECK(search.find("john", candidates) == std::vector<size_t>{ 2 });
+    }
+}
+
+TEST_CASE("EntrySearch kernels agree with the naive search")
+{
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> letter('a', 'd');
+    std::uniform_int_distribution<int> length(0, 70);
+
+    auto random_text = [&](size_t size)
+    {
+        std::string text(size, ' ');
+        for (auto& c : text)
+        {
+            c = static_cast<char>(letter(rng));
+            if (rng() % 3 == 0)
+            {
+                c = static_cast<char>(c - 'a' + 'A');
+            }
+        }
+        return text;
+    };
+
+    vault::EntryTable entries;
+    for (int i = 0; i < 500; ++i)
+    {
+        const std::string name = random_text(length(rng));
+        entries.push_back(name, random_text(length(rng)), "secret");
+    }
+
+    for (const auto kernel : KERNELS)
+    {
+        if (!vault::is_available(kernel))
+        {
+            continue;
+        }
+        CAPTURE(vault::to_string(kernel));
+
+        // Runs of adjacent candidates with gaps between them, as a
+        // narrowed filter leaves
+        std::vector<size_t> candidates;
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            if (i % 7 < 4)
+            {
+                candidates.push_back(i);
+            }
+        }
+
+        const vault::EntrySearch search(entries, kernel);
+        for (size_t size = 1; size <= 40; ++size)
+        {
+            const std::string needle = random_text(size % 8 + 1);
+            const auto expected = vault::EntrySearch::find_naive(entries, needle);
+            CHECK(search.find(needle) == expected);
+
+            std::vector<size_t> narrowed;
+            std::set_intersection(
+                expected.begin(), expected.end(),
+                candidates.begin(), candidates.end(),
+                std::back_inserter(narrowed)
+            );
+            CHECK(search.find(needle, candidates) == narrowed);
+        }
+    }
+}
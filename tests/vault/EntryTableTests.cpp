@@ -0,0 +1,123 @@
+#include <doctest/doctest.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "vault/Entry.h"
+#include "vault/EntryTable.h"
+
+TEST_CASE("StringColumn overwrites in place and appends when a value grows")
+{
+    vault::StringColumn column;
+    column.push_back("alpha");
+    column.push_back("");
+    column.push_back("gamma");
+
+    column.set(0, "ab");
+    CHECK(column[0] == "ab");
+    CHECK(column.bytes() == 7);
+
+    column.set(1, "beta");
+    column.set(0, "a much longer value");
+    CHECK(column[0] == "a much longer value");
+    CHECK(column[1] == "beta");
+    CHECK(column[2] == "gamma");
+    CHECK(column.bytes() == 28);
+}
+
+TEST_CASE("StringColumn swap_remove moves the last row and compacts garbage")
+{
+    vault::StringColumn column;
+    const std::string big(8192, 'x');
+    column.push_back(big);
+    column.push_back("keep");
+    column.push_back("last");
+
+    column.swap_remove(0);
+    REQUIRE(column.size() == 2);
+    CHECK(column[0] == "last");
+    CHECK(column[1] == "keep");
+    CHECK(column.bytes() == 8);
+
+    column.swap_remove(1);
+    column.swap_remove(0);
+    CHECK(column.empty());
+    CHECK(column.bytes() == 0);
+}
+
+TEST_CASE("EntryTable keeps its columns in step")
+{
+    vault::EntryTable table;
+    table.push_back("Email", "john", "one", vault::AccessStats{ 3, 100 });
+    table.push_back("Bank", "jane", "two");
+
+    table.set(1, vault::EntryField::Secret, "rotated");
+    const vault::EntryView bank = table[1];
+    CHECK(bank.name == "Bank");
+    CHECK(bank.username == "jane");
+    CHECK(bank.secret == "rotated");
+
+    table.swap_remove(0);
+    REQUIRE(table.size() == 1);
+    CHECK(table.name(0) == "Bank");
+    CHECK(table.access(0).count == 0);
+
+    vault::EntryTable other;
+    other.push_back("Bank", "jane", "rotated", vault::AccessStats{ 9, 9 });
+    CHECK(table == other);
+
+    table.clear();
+    CHECK(table.empty());
+    CHECK_FALSE(table == other);
+}
+
+TEST_CASE("EntryTable sorted views stay sorted as the table changes")
+{
+    auto names_in = [](const vault::EntryTable& table, vault::EntryOrder order)
+    {
+        std::vector<std::string> out;
+        for (const vault::EntryView entry : table.sorted(order))
+        {
+            out.emplace_back(entry.name);
+        }
+        return out;
+    };
+
+    vault::EntryTable table;
+    table.push_back("github", "zoe", "", {}, 30);
+    table.push_back("Bank", "amy", "", {}, 10);
+    table.push_back("email", "Amy", "", {}, 20);
+
+    using Names = std::vector<std::string>;
+    CHECK(names_in(table, vault::EntryOrder::Name) == Names{ "Bank", "email", "github" });
+    CHECK(names_in(table, vault::EntryOrder::Username) == Names{ "email", "Bank", "github" });
+    CHECK(names_in(table, vault::EntryOrder::Modified) == Names{ "github", "email", "Bank" });
+
+    // Every mutation patches the built orders in place
+    table.push_back("Alpha", "bob", "", {}, 40);
+    table.set(2, vault::EntryField::Name, "zebra");
+    table.set(0, vault::EntryField::Username, "aaron");
+    table.touch(1, 50);
+    table.swap_remove(0);
+
+    CHECK(names_in(table, vault::EntryOrder::Name) == Names{ "Alpha", "Bank", "zebra" });
+    CHECK(names_in(table, vault::EntryOrder::Username) == Names{ "zebra", "Bank", "Alpha" });
+    CHECK(names_in(table, vault::EntryOrder::Modified) == Names{ "Bank", "Alpha", "zebra" });
+
+    // ...and match what a fresh sort gives
+    vault::EntryTable fresh;
+    for (size_t row = 0; row < table.size(); ++row)
+    {
+        fresh.push_back(table.name(row), table.username(row), "", {}, table.modified(row));
+    }
+    for (auto order : { vault::EntryOrder::Name, vault::EntryOrder::Username, vault::EntryOrder::Modified })
+    {
+        const auto patched = table.sorted_rows(order);
+        const auto sorted = fresh.sorted_rows(order);
+        CHECK(std::vector<uint32_t>(patched.begin(), patched.end()) ==
+              std::vector<uint32_t>(sorted.begin(), sorted.end()));
+    }
+
+    table.clear();
+    CHECK(table.sorted_rows(vault::EntryOrder::Name).empty());
+}
@@ -0,0 +1,98 @@
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "vault/EntryTable.h"
+#include "vault/FuzzyMatcher.h"
+
+namespace
+{
+
+vault::StringColumn make_names (const std::vector<std::string>& names)
+{
+    vault::StringColumn column;
+    for (const auto& name : names)
+    {
+        column.push_back(name);
+    }
+    return column;
+}
+
+} // unnamed namespace
+
+TEST_CASE("FuzzyMatcher requires every term as a subsequence")
+{
+    const vault::FuzzyMatcher matcher("gh ent");
+
+    CHECK(matcher.score("github-enterprise"));
+    CHECK(matcher.score("GitHub Enterprise"));
+    CHECK_FALSE(matcher.score("github"));
+    CHECK_FALSE(matcher.score("enterprise"));
+
+    CHECK(vault::FuzzyMatcher("   ").empty());
+    CHECK(vault::FuzzyMatcher("").score("anything") == 0);
+}
+
+TEST_CASE("FuzzyMatcher prefers boundaries and consecutive runs")
+{
+    const vault::FuzzyMatcher matcher("bank");
+
+    CHECK(*matcher.score("bank") > *matcher.score("b-a-n-k"));
+    CHECK(*matcher.score("my-bank") > *matcher.score("mybank"));
+    CHECK(*matcher.score("bank-of-x") > *matcher.score("bxaxnxk"));
+}
+
+TEST_CASE("FuzzyMatcher::top ranks the best entries first")
+{
+    const auto entries = make_names({
+        "gitlab-enterprise",
+        "github-enterprise",
+        "google",
+        "ghost-entry",
+        "GitHub Enterprise Server"
+    });
+
+    const auto top = vault::FuzzyMatcher("gh ent").top(entries, 2);
+    REQUIRE(top.size() == 2);
+    CHECK(top[0].score >= top[1].score);
+    CHECK(top[0].index == 3);
+
+    CHECK(vault::FuzzyMatcher("zzz").top(entries, 5).empty());
+    CHECK(vault::FuzzyMatcher("g").top(entries, 0).empty());
+}
+
+TEST_CASE("FuzzyMatcher::top across chunks matches a full sort")
+{
+    std::vector<std::string> names;
+    for (int i = 0; i < 50000; ++i)
+    {
+        names.push_back("host-" + std::to_string(i * 7919 % 50000) + ".example.com");
+    }
+    const auto entries = make_names(names);
+    const vault::FuzzyMatcher matcher("h12 ex");
+
+    std::vector<vault::FuzzyMatch> expected;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        if (auto s = matcher.score(names[i]))
+        {
+            expected.push_back({ i, *s });
+        }
+    }
+    std::sort(expected.begin(), expected.end(), [&](const auto& a, const auto& b)
+    {
+        if (a.score != b.score) return a.score > b.score;
+        if (names[a.index].size() != names[b.index].size()) return names[a.index].size() < names[b.index].size();
+        return a.index < b.index;
+    });
+    expected.resize(25);
+
+    const auto top = matcher.top(entries, 25);
+    REQUIRE(top.size() == 25);
+    for (size_t i = 0; i < top.size(); ++i)
+    {
+        CHECK(top[i].index == expected[i].index);
+        CHECK(top[i].score == expected[i].score);
+    }
+}
@@ -0,0 +1,68 @@
+#include <doctest/doctest.h>
+#include <string>
+#include <vector>
+
+#include "util/SecureString.h"
+#include "vault/NameTrie.h"
+
+namespace
+{
+
+std::vector<std::string> as_strings (const std::vector<util::SecureString>& names)
+{
+    std::vector<std::string> out;
+    for (const auto& name : names)
+    {
+        out.emplace_back(name.c_str(), name.size());
+    }
+    return out;
+}
+
+} // unnamed namespace
+
+TEST_CASE("NameTrie completes prefixes in byte order")
+{
+    vault::NameTrie trie;
+    for (const char* name : { "github", "gitlab", "git", "google", "bank", "GitHub" })
+    {
+        trie.insert(name);
+    }
+    trie.insert("git");
+
+    CHECK(trie.size() == 6);
+    CHECK(trie.contains("git"));
+    CHECK_FALSE(trie.contains("gi"));
+    CHECK_FALSE(trie.contains("gitx"));
+
+    CHECK(as_strings(trie.complete("gi", 10)) == std::vector<std::string>{ "git", "github", "gitlab" });
+    CHECK(as_strings(trie.complete("g", 2)) == std::vector<std::string>{ "git", "github" });
+    CHECK(as_strings(trie.complete("", 3)) == std::vector<std::string>{ "GitHub", "bank", "git" });
+    CHECK(trie.complete("x", 10).empty());
+    CHECK(trie.complete("g", 0).empty());
+}
+
+TEST_CASE("NameTrie erase prunes and recycles nodes")
+{
+    vault::NameTrie trie;
+    trie.insert("github");
+    trie.insert("git");
+
+    trie.erase("github");
+    CHECK_FALSE(trie.contains("github"));
+    CHECK(trie.contains("git"));
+    CHECK(as_strings(trie.complete("gi", 10)) == std::vector<std::string>{ "git" });
+
+    trie.erase("nope");
+    trie.erase("gi");
+    CHECK(trie.size() == 1);
+
+    trie.erase("git");
+    CHECK(trie.size() == 0);
+    CHECK(trie.complete("", 10).empty());
+
+    trie.insert("gitlab");
+    CHECK(as_strings(trie.complete("g", 10)) == std::vector<std::string>{ "gitlab" });
+
+    trie.clear();
+    CHECK_FALSE(trie.contains("gitlab"));
+}
@@ -1,8 +1,19 @@
 #include <doctest/doctest.h>
+#include <array>
+#include <chrono>
+#include <bit>
 #include <filesystem>
 #include <fstream>
+#include <optional>
 #include <sodium.h>
+#include <string>
+#include <string_view>
 
+#include "crypto/ChunkedAead.h"
+#include "crypto/CryptoConstants.h"
+#include "crypto/CryptoContext.h"
+#include "crypto/VaultCrypto.h"
+#include "util/ByteOrder.h"
 #include "util/Expected.h"
 #include "util/SecureString.h"
 #include "vault/VaultFile.h"
@@ -80,3 +91,214 @@ TEST_CASE("Corrupted file fails cleanly")
 
     CHECK_FALSE(result);
 }
+
+// Writes a vault the way the v1 code did: host-endian packed header and
+// payload, no associated data.
+static void write_v1_vault(const VaultTestFixture& fixture)
+{
+    crypto::ByteBuffer bytes;
+    auto append_u32 = [&bytes](uint32_t v)
+    {
+        std::array<uint8_t, sizeof(uint32_t)> raw;
+        util::store(v, std::span(raw), std::endian::native);
+        bytes.insert(bytes.end(), raw.begin(), raw.end());
+    };
+    auto append_string = [&](std::string_view s)
+    {
+        append_u32(static_cast<uint32_t>(s.size()));
+        bytes.insert(bytes.end(), s.begin(), s.end());
+    };
+
+    append_u32(1);
+    append_string("Email");
+    append_string("john.doe@example.com");
+    append_string("HelloWorld123!");
+
+    crypto::ByteBuffer salt(crypto::SALT_SIZE);
+    crypto::ByteBuffer nonce(crypto::NONCE_SIZE);
+    crypto::CryptoContext::random_bytes(salt);
+    crypto::CryptoContext::random_bytes(nonce);
+
+    auto key = crypto::VaultCrypto::derive_key(fixture.password, salt);
+    REQUIRE(key);
+    auto encrypted = crypto::VaultCrypto::encrypt(key.value(), nonce, bytes);
+    REQUIRE(encrypted);
+
+    bytes.clear();
+    append_u32(vault::VAULT_MAGIC);
+    bytes.push_back(vault::VAULT_VERSION_1);
+    bytes.push_back(vault::KDF_TYPE_ARGON2ID);
+    bytes.push_back(0);
+    bytes.push_back(0);
+    append_u32(crypto_pwhash_MEMLIMIT_INTERACTIVE / 1024);
+    append_u32(crypto_pwhash_OPSLIMIT_INTERACTIVE);
+    append_u32(1);
+    bytes.insert(bytes.end(), salt.begin(), salt.end());
+    bytes.insert(bytes.end(), nonce.begin(), nonce.end());
+    REQUIRE(bytes.size() == vault::VAULT_V1_HEADER_SIZE);
+    bytes.insert(bytes.end(), encrypted.value().begin(), encrypted.value().end());
+
+    std::ofstream file(fixture.file_path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    REQUIRE(file);
+}
+
+TEST_CASE("Legacy v1 vault loads and migrates to the current format")
+{
+    VaultTestFixture fixture;
+    write_v1_vault(fixture);
+
+    auto header = vault::VaultFile::inspect(fixture.file_path);
+    REQUIRE(header);
+    CHECK(header.value().version == vault::VAULT_VERSION_1);
+
+    auto loaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(loaded);
+    REQUIRE(loaded.value().entries().size() == 1);
+    CHECK(loaded.value().entries()[0].name == "Email");
+
+    REQUIRE(vault::VaultFile::migrate(fixture.file_path, fixture.password));
+
+    header = vault::VaultFile::inspect(fixture.file_path);
+    REQUIRE(header);
+    CHECK(header.value().version == vault::VAULT_VERSION);
+    CHECK(header.value().entry_count == 1);
+
+    auto reloaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(reloaded);
+    REQUIRE(reloaded.value().entries().size() == 1);
+    CHECK(reloaded.value().entries()[0].secret == "HelloWorld123!");
+}
+
+TEST_CASE("Tampering with the header fails authentication")
+{
+    VaultTestFixture fixture;
+    REQUIRE(vault::VaultFile::create_new(fixture.file_path, fixture.password));
+
+    // Flip a bit in the (otherwise unused) entry-count hint
+    {
+        std::fstream file(
+            fixture.file_path,
+            std::ios::in | std::ios::out | std::ios::binary
+        );
+        REQUIRE(file);
+        file.seekp(20);
+        char byte = 0x01;
+        file.write(&byte, 1);
+    }
+
+    auto result = vault::VaultFile::load(fixture.file_path, fixture.password);
+    CHECK_FALSE(result);
+}
+
+TEST_CASE("Vaults created with each available cipher suite reload")
+{
+    const crypto::CipherSuite suites[] = {
+        crypto::CipherSuite::XChaCha20Poly1305,
+        crypto::CipherSuite::Aes256Gcm,
+        crypto::CipherSuite::Aegis256
+    };
+
+    for (auto suite : suites)
+    {
+        VaultTestFixture fixture;
+        auto created = vault::VaultFile::create_new(fixture.file_path, fixture.password, suite);
+        if (!crypto::is_available(suite))
+        {
+            CHECK(created.error() == vault::VaultFileError::UnsupportedCipher);
+            continue;
+        }
+        REQUIRE(created);
+
+        auto header = vault::VaultFile::inspect(fixture.file_path);
+        REQUIRE(header);
+        CHECK(header.value().cipher == suite);
+
+        auto loaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+        REQUIRE(loaded);
+        CHECK(loaded.value().is_empty());
+    }
+}
+
+TEST_CASE("Vaults larger than one chunk are sealed in chunks and reload")
+{
+    VaultTestFixture fixture;
+    REQUIRE(vault::VaultFile::create_new(fixture.file_path, fixture.password));
+
+    auto session = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(session);
+
+    const std::string secret(600 * 1024, 'x');
+    for (int i = 0; i < 3; ++i)
+    {
+        REQUIRE(session.value().add_entry(vault::Entry(
+            util::SecureString("Entry " + std::to_string(i)),
+            util::SecureString("user"),
+            util::SecureString(secret)
+        )));
+    }
+    REQUIRE(session.value().save());
+
+    auto header = vault::VaultFile::inspect(fixture.file_path);
+    REQUIRE(header);
+    CHECK(header.value().chunked());
+    CHECK(header.value().chunk_size == crypto::DEFAULT_CHUNK_SIZE);
+
+    auto reloaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(reloaded);
+    REQUIRE(reloaded.value().entries().size() == 3);
+    CHECK(reloaded.value().entries()[2].secret == secret);
+}
+
+TEST_CASE("A cached key unlocks without prompting, and a stale one is replaced")
+{
+    VaultTestFixture fixture;
+    REQUIRE(vault::VaultFile::create_new(fixture.file_path, fixture.password));
+
+    int prompts = 0;
+    auto prompt = [&]() -> std::optional<util::SecureString>
+    {
+        ++prompts;
+        return util::SecureString(fixture.password.c_str());
+    };
+    const vault::KeyCacheOptions cache{ true, std::chrono::seconds(60) };
+
+    auto first = vault::VaultFile::load(fixture.file_path, prompt, cache);
+    REQUIRE(first);
+    CHECK(prompts == 1);
+
+    auto second = vault::VaultFile::load(fixture.file_path, prompt, cache);
+    REQUIRE(second);
+    if (prompts == 1)
+    {
+        // Replace the vault with a new one (new salt) at the same path:
+        // its key is cached under a different description
+        std::filesystem::remove(fixture.file_path);
+        REQUIRE(vault::VaultFile::create_new(fixture.file_path, fixture.password));
+        auto third = vault::VaultFile::load(fixture.file_path, prompt, cache);
+        REQUIRE(third);
+        CHECK(prompts == 2);
+    }
+    else
+    {
+        MESSAGE("kernel keyring unavailable; every load prompts");
+    }
+
+    // Without opting in, the prompt always runs
+    auto uncached = vault::VaultFile::load(fixture.file_path, prompt, vault::KeyCacheOptions{});
+    REQUIRE(uncached);
+    CHECK(prompts == 3);
+}
+
+TEST_CASE("Cancelling the password prompt cancels the unlock")
+{
+    VaultTestFixture fixture;
+    REQUIRE(vault::VaultFile::create_new(fixture.file_path, fixture.password));
+
+    auto result = vault::VaultFile::load(
+        fixture.file_path,
+        []() -> std::optional<util::SecureString> { return std::nullopt; },
+        vault::KeyCacheOptions{}
+    );
+    CHECK(result.error() == vault::VaultFileError::Cancelled);
+}
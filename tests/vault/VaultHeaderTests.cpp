@@ -0,0 +1,123 @@
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#include "util/ByteOrder.h"
+#include "util/Expected.h"
+#include "vault/VaultFileError.h"
+#include "vault/VaultHeader.h"
+
+static vault::VaultHeader sample_header()
+{
+    vault::VaultHeader header;
+    header.entry_count = 0x01020304;
+    header.payload_length = 0x1122334455667788ULL;
+    header.salt.fill(0xAB);
+    std::fill(header.nonce.begin(), header.nonce.begin() + crypto::NONCE_SIZE, 0xCD);
+    return header;
+}
+
+TEST_CASE("Header encode then decode round-trips")
+{
+    auto header = sample_header();
+    auto bytes = vault::encode_header(header);
+
+    auto decoded = vault::decode_header(bytes);
+    REQUIRE(decoded);
+    CHECK(decoded.value().version == vault::VAULT_VERSION);
+    CHECK(decoded.value().cipher == crypto::CipherSuite::XChaCha20Poly1305);
+    CHECK(decoded.value().kdf.mem_kib == header.kdf.mem_kib);
+    CHECK(decoded.value().entry_count == header.entry_count);
+    CHECK(decoded.value().payload_length == header.payload_length);
+    CHECK(decoded.value().salt == header.salt);
+    CHECK(decoded.value().nonce == header.nonce);
+    CHECK(decoded.value().encoded_size() == vault::VAULT_HEADER_SIZE);
+}
+
+TEST_CASE("Header fields are little-endian regardless of host")
+{
+    auto bytes = vault::encode_header(sample_header());
+
+    // "LUAV" is VAULT_MAGIC stored least-significant byte first
+    CHECK(bytes[0] == 0x4C);
+    CHECK(bytes[3] == 0x56);
+    CHECK(bytes[4] == vault::VAULT_VERSION);
+
+    // entry_count at offset 20, payload_length at offset 24
+    CHECK(bytes[20] == 0x04);
+    CHECK(bytes[23] == 0x01);
+    CHECK(bytes[24] == 0x88);
+    CHECK(bytes[31] == 0x11);
+}
+
+TEST_CASE("Truncated header is rejected")
+{
+    auto bytes = vault::encode_header(sample_header());
+
+    auto decoded = vault::decode_header(std::span<const uint8_t>(bytes).first(bytes.size() - 1));
+    CHECK_FALSE(decoded);
+    CHECK(decoded.error() == vault::VaultFileError::InvalidFormat);
+}
+
+TEST_CASE("Unknown version or cipher is unsupported")
+{
+    auto bytes = vault::encode_header(sample_header());
+
+    auto future = bytes;
+    future[4] = vault::VAULT_VERSION + 1;
+    auto decoded = vault::decode_header(future);
+    CHECK(decoded.error() == vault::VaultFileError::UnsupportedVersion);
+
+    auto cipher = bytes;
+    cipher[6] = 0xFF;
+    decoded = vault::decode_header(cipher);
+    CHECK(decoded.error() == vault::VaultFileError::UnsupportedVersion);
+}
+
+TEST_CASE("Argon2 parallelism other than one is refused at decode")
+{
+    auto header = sample_header();
+    header.kdf.parallelism = 4;
+    auto decoded = vault::decode_header(vault::encode_header(header));
+    CHECK(decoded.error() == vault::VaultFileError::InvalidFormat);
+}
+
+TEST_CASE("Chunk size is recorded only alongside the chunked flag")
+{
+    auto header = sample_header();
+    header.flags = vault::VAULT_FLAG_CHUNKED;
+    header.chunk_size = 1u << 20;
+
+    auto decoded = vault::decode_header(vault::encode_header(header));
+    REQUIRE(decoded);
+    CHECK(decoded.value().chunked());
+    CHECK(decoded.value().chunk_size == header.chunk_size);
+
+    header.chunk_size = 0;
+    decoded = vault::decode_header(vault::encode_header(header));
+    CHECK(decoded.error() == vault::VaultFileError::InvalidFormat);
+
+    header.flags = 0;
+    header.chunk_size = 4096;
+    decoded = vault::decode_header(vault::encode_header(header));
+    CHECK(decoded.error() == vault::VaultFileError::InvalidFormat);
+}
+
+TEST_CASE("Flags outside the known set are refused as a newer format")
+{
+    auto header = sample_header();
+    header.flags = 0x02;
+    auto decoded = vault::decode_header(vault::encode_header(header));
+    CHECK(decoded.error() == vault::VaultFileError::UnsupportedVersion);
+}
+
+TEST_CASE("Byte order helpers swap only for foreign order")
+{
+    std::array<uint8_t, 4> buf{};
+    util::store(uint32_t{0x0A0B0C0D}, std::span(buf), std::endian::big);
+    CHECK(buf[0] == 0x0A);
+    CHECK(util::load<uint32_t>(std::span<const uint8_t, 4>(buf), std::endian::big) == 0x0A0B0C0D);
+    CHECK(util::load<uint32_t>(std::span<const uint8_t, 4>(buf)) == 0x0D0C0B0A);
+}
@@ -0,0 +1,176 @@
+#include <doctest/doctest.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "util/Expected.h"
+#include "util/SecureString.h"
+#include "vault/Entry.h"
+#include "vault/VaultFile.h"
+#include "vault/VaultFileError.h"
+#include "vault/VaultShards.h"
+#include "VaultTestFixture.h"
+#include "vault/VaultSession.h"
+
+namespace
+{
+
+std::set<std::string> shard_files (const std::filesystem::path& vault_path)
+{
+    std::set<std::string> names;
+    const auto dir = vault::VaultShards::directory(vault_path);
+    if (!std::filesystem::exists(dir))
+    {
+        return names;
+    }
+    for (const auto& item : std::filesystem::directory_iterator(dir))
+    {
+        names.insert(item.path().filename().string());
+    }
+    return names;
+}
+
+// Rows come back in shard order, so entries are found by name
+vault::EntryId id_of (const vault::VaultSession& session, std::string_view name)
+{
+    for (size_t row = 0; row < session.entries().size(); ++row)
+    {
+        if (session.entries().name(row) == name)
+        {
+            return session.id_at(row);
+        }
+    }
+    return {};
+}
+
+std::string contents_of (const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), {});
+}
+
+vault::Entry entry (int i)
+{
+    return vault::Entry(
+        util::SecureString{("entry-" + std::to_string(i)).c_str()},
+        util::SecureString{"user"},
+        util::SecureString{("secret-" + std::to_string(i)).c_str()}
+    );
+}
+
+} // unnamed namespace
+
+TEST_CASE("A sharded vault saves only the shards it changed")
+{
+    VaultTestFixture fixture;
+    REQUIRE(vault::VaultFile::create_sharded(fixture.file_path, fixture.password, 8));
+    REQUIRE(vault::VaultFile::inspect(fixture.file_path).value().sharded());
+
+    {
+        auto loaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+        REQUIRE(loaded);
+        REQUIRE(loaded.value().is_sharded());
+        for (int i = 0; i < 64; ++i)
+        {
+            REQUIRE(loaded.value().add_entry(entry(i)));
+        }
+        REQUIRE(loaded.value().save());
+    }
+    const auto first = shard_files(fixture.file_path);
+    CHECK(first.size() == 8);
+
+    auto loaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(loaded);
+    vault::VaultSession& session = loaded.value();
+    REQUIRE(session.entries().size() == 64);
+
+    // Nothing changed: not even the vault file is rewritten
+    const std::string manifest = contents_of(fixture.file_path);
+    REQUIRE(session.save());
+    CHECK(contents_of(fixture.file_path) == manifest);
+
+    // One edit replaces exactly one shard file
+    REQUIRE(session.set_field(id_of(session, "entry-10"), vault::EntryField::Secret, util::SecureString{"changed"}));
+    REQUIRE(session.save());
+    const auto second = shard_files(fixture.file_path);
+    CHECK(second.size() == 8);
+    std::set<std::string> replaced;
+    for (const auto& name : first)
+    {
+        if (!second.contains(name))
+        {
+            replaced.insert(name);
+        }
+    }
+    CHECK(replaced.size() == 1);
+
+    REQUIRE(session.remove_entry(id_of(session, "entry-3")));
+    REQUIRE(session.save());
+
+    auto reloaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(reloaded);
+    CHECK(reloaded.value().entries().size() == 63);
+    CHECK_FALSE(reloaded.value().has_entry("entry-3"));
+    const auto changed = reloaded.value().index_of(id_of(reloaded.value(), "entry-10"));
+    REQUIRE(changed);
+    CHECK(reloaded.value().entries().secret(*changed) == "changed");
+}
+
+TEST_CASE("A sharded vault refuses a shard rolled back to an older save")
+{
+    VaultTestFixture fixture;
+    REQUIRE(vault::VaultFile::create_sharded(fixture.file_path, fixture.password, 1));
+
+    auto loaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(loaded);
+    REQUIRE(loaded.value().add_entry(entry(1)));
+    REQUIRE(loaded.value().save());
+    const std::string old_shard = contents_of(vault::VaultShards::file(fixture.file_path, 0, 1));
+
+    REQUIRE(loaded.value().add_entry(entry(2)));
+    REQUIRE(loaded.value().save());
+    const auto current = vault::VaultShards::file(fixture.file_path, 0, 2);
+    REQUIRE(std::filesystem::exists(current));
+    CHECK_FALSE(std::filesystem::exists(vault::VaultShards::file(fixture.file_path, 0, 1)));
+
+    {
+        std::ofstream file(current, std::ios::binary | std::ios::trunc);
+        file << old_shard;
+    }
+    auto rolled_back = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE_FALSE(rolled_back);
+    CHECK(rolled_back.error() == vault::VaultFileError::CryptoError);
+
+    std::filesystem::remove(current);
+    auto missing = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE_FALSE(missing);
+    CHECK(missing.error() == vault::VaultFileError::FileNotFound);
+}
+
+TEST_CASE("VaultShards keeps each shard's members through removals")
+{
+    const std::vector<uint8_t> key(32, 0x42);
+    vault::VaultShards shards(2, key);
+    for (uint32_t slot = 0; slot < 6; ++slot)
+    {
+        shards.place(vault::EntryId(slot, 1), slot % 2);
+    }
+    shards.clear_dirty();
+
+    shards.remove(vault::EntryId(0, 1));
+    CHECK(shards.dirty(0));
+    CHECK_FALSE(shards.dirty(1));
+    REQUIRE(shards.members(0).size() == 2);
+    CHECK(shards.members(1).size() == 3);
+
+    // The member moved into the freed place can itself be removed
+    const vault::EntryId moved = shards.members(0)[0];
+    shards.remove(moved);
+    REQUIRE(shards.members(0).size() == 1);
+    CHECK_FALSE(shards.members(0)[0] == moved);
+    CHECK(shards.shard_of(shards.members(0)[0]) == 0);
+}
@@ -1,8 +1,30 @@
+#include <cstddef>
 #include <filesystem>
 #include <sodium.h>
+#include <system_error>
 
+#include "crypto/CryptoTypes.h"
 #include "util/SecureString.h"
 
+// A fixed key for stores that are opened directly rather than through a
+// vault's password
+inline crypto::ByteBuffer test_key ()
+{
+    return crypto::ByteBuffer(crypto_kdf_KEYBYTES, 0x42);
+}
+
+// Regular files anywhere under `dir`; 0 if it does not exist
+inline size_t file_count (const std::filesystem::path& dir)
+{
+    size_t count = 0;
+    std::error_code ec;
+    for (const auto& item : std::filesystem::recursive_directory_iterator(dir, ec))
+    {
+        count += item.is_regular_file() ? 1 : 0;
+    }
+    return count;
+}
+
 struct VaultTestFixture 
 {
     std::filesystem::path file_path;
@@ -20,5 +42,11 @@ struct VaultTestFixture
     {
         std::error_code ec;
         std::filesystem::remove(file_path, ec);
+        for (const char* beside : { ".attachments", ".shards", ".backups" })
+        {
+            std::filesystem::path dir = file_path;
+            dir += beside;
+            std::filesystem::remove_all(dir, ec);
+        }
     }
 };
@@ -1,11 +1,17 @@
 #include <doctest/doctest.h>
+#include <algorithm>
+#include <chrono>
 #include <optional>
+#include <string>
 #include <sodium.h>
 
 #include "util/Expected.h"
 #include "util/SecureString.h"
 #include "vault/Entry.h"
+#include "vault/Vault.h"
+#include "vault/VaultError.h"
 #include "vault/VaultFile.h"
+#include "vault/VaultFileError.h"
 #include "VaultTestFixture.h"
 #include "vault/VaultSession.h"
 
@@ -36,8 +42,8 @@ TEST_CASE("Returns all entries")
 
     auto& entries = loaded.value().entries();
     CHECK(entries.size() == 2);
-    CHECK(entries[0].name == util::SecureString("Email"));
-    CHECK(entries[1].secret == util::SecureString("HelloWorld1234!"));
+    CHECK(entries[0].name == "Email");
+    CHECK(entries[1].secret == "HelloWorld1234!");
 }
 
 TEST_CASE("Refuses to add entry with same name")
@@ -102,10 +108,9 @@ TEST_CASE("Saving and reloading preserves entries")
 
     const auto& entries = reloaded.value().entries();
     REQUIRE(entries.size() == 1);
-    CHECK(entries[0] == expected);
-    CHECK(entries[0].name == expected.name);
-    CHECK(entries[0].username == expected.username);
-    CHECK(entries[0].secret == expected.secret);
+    CHECK(entries[0].name == std::string_view(expected.name.c_str(), expected.name.size()));
+    CHECK(entries[0].username == std::string_view(expected.username.c_str(), expected.username.size()));
+    CHECK(entries[0].secret == std::string_view(expected.secret.c_str(), expected.secret.size()));
 }
 
 TEST_CASE("Deletes an entry")
@@ -127,8 +132,573 @@ TEST_CASE("Deletes an entry")
     REQUIRE(loaded.value().add_entry(std::move(entry)));
     REQUIRE(entries.size() == 1);
 
-    auto result = loaded.value().remove_entry(0);
+    auto result = loaded.value().remove_entry(loaded.value().id_at(0));
     REQUIRE(result);
 
     CHECK(entries.size() == 0);
 };
+
+TEST_CASE("Updates an entry in place but refuses to duplicate a name")
+{
+    VaultTestFixture fixture;
+    REQUIRE(vault::VaultFile::create_new(fixture.file_path, fixture.password));
+
+    auto loaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(loaded);
+
+    REQUIRE(loaded.value().add_entry(vault::Entry{
+        util::SecureString{"Email"},
+        util::SecureString{"john.doe@example.com"},
+        util::SecureString{"HelloWorld123!"}
+    }));
+    REQUIRE(loaded.value().add_entry(vault::Entry{
+        util::SecureString{"Froogle"},
+        util::SecureString{"john.doe@example.com"},
+        util::SecureString{"HelloWorld1234!"}
+    }));
+
+    CHECK(loaded.value().update_entry(loaded.value().id_at(0), vault::Entry{
+        util::SecureString{"Email"},
+        util::SecureString{"jane.doe@example.com"},
+        util::SecureString{"Changed!"}
+    }));
+    CHECK_FALSE(loaded.value().update_entry(loaded.value().id_at(1), vault::Entry{
+        util::SecureString{"Email"},
+        util::SecureString{"x"},
+        util::SecureString{"y"}
+    }));
+    CHECK_FALSE(loaded.value().update_entry(vault::EntryId{}, vault::Entry{
+        util::SecureString{"Other"},
+        util::SecureString{"x"},
+        util::SecureString{"y"}
+    }));
+
+    auto& entries = loaded.value().entries();
+    CHECK(entries[0].username == "jane.doe@example.com");
+    CHECK(entries[0].secret == "Changed!");
+    CHECK(entries[1].name == "Froogle");
+}
+
+TEST_CASE("Name completion follows adds, renames and removals")
+{
+    VaultTestFixture fixture;
+    REQUIRE(vault::VaultFile::create_new(fixture.file_path, fixture.password));
+
+    auto loaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(loaded);
+    auto& session = loaded.value();
+
+    REQUIRE(session.add_entry(vault::Entry{
+        util::SecureString{"Email"},
+        util::SecureString{"john.doe@example.com"},
+        util::SecureString{"HelloWorld123!"}
+    }));
+    REQUIRE(session.add_entry(vault::Entry{
+        util::SecureString{"Emergency"},
+        util::SecureString{"john"},
+        util::SecureString{"x"}
+    }));
+
+    CHECK(session.has_entry("Email"));
+    CHECK(session.complete_name("Em", 5).size() == 2);
+
+    REQUIRE(session.update_entry(session.id_at(0), vault::Entry{
+        util::SecureString{"Mail"},
+        util::SecureString{"john.doe@example.com"},
+        util::SecureString{"HelloWorld123!"}
+    }));
+    CHECK_FALSE(session.has_entry("Email"));
+    CHECK(session.has_entry("Mail"));
+
+    REQUIRE(session.remove_entry(session.id_at(1)));
+    CHECK(session.complete_name("Em", 5).empty());
+
+    REQUIRE(session.save());
+    auto reloaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(reloaded);
+    CHECK(reloaded.value().has_entry("Mail"));
+}
+
+TEST_CASE("Frecent entries are ranked as they are used")
+{
+    const auto now = std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+
+    vault::Vault vault;
+    std::vector<vault::EntryId> ids;
+    for (const char* name : { "A", "B", "C", "D", "E", "F", "G" })
+    {
+        auto added = vault.add_entry(vault::Entry{
+            util::SecureString{name},
+            util::SecureString{"user"},
+            util::SecureString{"secret"}
+        });
+        REQUIRE(added);
+        ids.push_back(added.value());
+    }
+    CHECK(vault.frecent().empty());
+
+    REQUIRE(vault.record_access(ids[3], now));
+    REQUIRE(vault.record_access(ids[5], now));
+    REQUIRE(vault.record_access(ids[5], now));
+    CHECK(vault.frecent() == std::vector<size_t>{ 5, 3 });
+
+    for (size_t i : { 0, 1, 2, 6 })
+    {
+        REQUIRE(vault.record_access(ids[i], now));
+    }
+    // Seven used, five kept; equal scores fall back to insertion order
+    CHECK(vault.frecent() == std::vector<size_t>{ 5, 0, 1, 2, 3 });
+    CHECK_FALSE(vault.record_access(vault::EntryId{}, now));
+
+    // Removing an unranked entry moves G into its place but leaves the
+    // ranking alone; removing a ranked one lets the best of the rest in
+    REQUIRE(vault.remove_entry(ids[4]));
+    CHECK(vault.frecent() == std::vector<size_t>{ 5, 0, 1, 2, 3 });
+    REQUIRE(vault.remove_entry(ids[0]));
+    CHECK(vault.entries()[0].name == "F");
+    CHECK(vault.frecent() == std::vector<size_t>{ 0, 1, 2, 3, 4 });
+
+    // Edits keep the history
+    REQUIRE(vault.update_entry(ids[5], vault::Entry{
+        util::SecureString{"F2"},
+        util::SecureString{"user"},
+        util::SecureString{"changed"}
+    }));
+    CHECK(vault.entries()[0].access.count == 2);
+    CHECK(vault.frecent().front() == 0);
+}
+
+TEST_CASE("Recent use outranks older frequent use")
+{
+    using namespace std::chrono;
+    const auto start = system_clock::time_point(hours(24 * 365 * 50));
+
+    vault::Vault vault;
+    auto old = vault.add_entry(vault::Entry{
+        util::SecureString{"Old"}, util::SecureString{""}, util::SecureString{""}
+    });
+    auto recent = vault.add_entry(vault::Entry{
+        util::SecureString{"New"}, util::SecureString{""}, util::SecureString{""}
+    });
+    REQUIRE(old);
+    REQUIRE(recent);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        REQUIRE(vault.record_access(old.value(), start));
+    }
+    // Three uses four half-lives ago score 3/16, below one use now
+    REQUIRE(vault.record_access(recent.value(), start + 4 * vault::Vault::FRECENCY_HALF_LIFE));
+    CHECK(vault.frecent() == std::vector<size_t>{ 1, 0 });
+
+    // Stats travel in the payload and the ranking is rebuilt from them
+    auto restored = vault::Vault::deserialise(vault.serialise());
+    REQUIRE(restored);
+    CHECK(restored.value().frecent() == std::vector<size_t>{ 1, 0 });
+
+    // Payloads in the fixed layout without the stats section still load
+    crypto::ByteBuffer payload;
+    auto append_u32 = [&payload](uint32_t v)
+    {
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            payload.push_back(static_cast<uint8_t>(v >> shift));
+        }
+    };
+    append_u32(2);
+    for (const std::string_view name : { "Old", "New" })
+    {
+        append_u32(static_cast<uint32_t>(name.size()));
+        payload.insert(payload.end(), name.begin(), name.end());
+        append_u32(0);
+        append_u32(0);
+    }
+    auto bare = vault::Vault::deserialise(payload, std::endian::little, 0);
+    REQUIRE(bare);
+    CHECK(bare.value().entries().size() == 2);
+    CHECK(bare.value().frecent().empty());
+
+    // One name twice is refused rather than loaded as a single entry
+    payload.clear();
+    append_u32(2);
+    for (int copy = 0; copy < 2; ++copy)
+    {
+        append_u32(3);
+        payload.insert(payload.end(), { 'O', 'l', 'd' });
+        append_u32(0);
+        append_u32(0);
+    }
+    auto twice = vault::Vault::deserialise(payload, std::endian::little, 0);
+    REQUIRE_FALSE(twice);
+    CHECK(twice.error() == vault::VaultFileError::InvalidFormat);
+}
+
+TEST_CASE("Access stats are saved with the vault")
+{
+    VaultTestFixture fixture;
+    REQUIRE(vault::VaultFile::create_new(fixture.file_path, fixture.password));
+
+    auto loaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(loaded);
+    auto& session = loaded.value();
+
+    REQUIRE(session.add_entry(vault::Entry{
+        util::SecureString{"Email"},
+        util::SecureString{"john.doe@example.com"},
+        util::SecureString{"HelloWorld123!"}
+    }));
+    REQUIRE(session.add_entry(vault::Entry{
+        util::SecureString{"Bank"},
+        util::SecureString{"john"},
+        util::SecureString{"x"}
+    }));
+    REQUIRE(session.record_access(session.id_at(1)));
+    REQUIRE(session.save());
+
+    auto reloaded = vault::VaultFile::load(fixture.file_path, fixture.password);
+    REQUIRE(reloaded);
+    CHECK(reloaded.value().frecent() == std::vector<size_t>{ 1 });
+    CHECK(reloaded.value().entries()[1].access.count == 1);
+    CHECK(reloaded.value().entries()[1].access.last_access > 0);
+}
+
+TEST_CASE("Setting a field edits the entry in place")
+{
+    vault::Vault vault;
+    for (const char* name : { "Email", "Bank", "Shop" })
+    {
+        REQUIRE(vault.add_entry(vault::Entry{
+            util::SecureString{name},
+            util::SecureString{"john"},
+            util::SecureString{"old"}
+        }));
+    }
+    const vault::EntryId bank = vault.id_at(1);
+
+    REQUIRE(vault.set_field(bank, vault::EntryField::Secret, util::SecureString{"rotated"}));
+    REQUIRE(vault.set_field(bank, vault::EntryField::Username, util::SecureString{"jane"}));
+    CHECK(vault.entries()[1].name == "Bank");
+    CHECK(vault.entries()[1].username == "jane");
+    CHECK(vault.entries()[1].secret == "rotated");
+    CHECK(vault.entries()[0].secret == "old");
+
+    auto taken = vault.set_field(bank, vault::EntryField::Name, util::SecureString{"Shop"});
+    REQUIRE_FALSE(taken);
+    CHECK(taken.error() == vault::VaultError::DuplicateEntry);
+    CHECK(vault.entries()[1].name == "Bank");
+
+    REQUIRE(vault.set_field(bank, vault::EntryField::Name, util::SecureString{"Bank"}));
+    REQUIRE(vault.set_field(bank, vault::EntryField::Name, util::SecureString{"Savings"}));
+    CHECK(vault.has_entry("Savings"));
+    CHECK_FALSE(vault.has_entry("Bank"));
+    CHECK(vault.entries()[2].name == "Shop");
+
+    CHECK_FALSE(vault.set_field(vault::EntryId{}, vault::EntryField::Secret, util::SecureString{"x"}));
+}
+
+TEST_CASE("Entry ids survive other removals and go stale with their entry")
+{
+    vault::Vault vault;
+    std::vector<vault::EntryId> ids;
+    for (const char* name : { "A", "B", "C", "D" })
+    {
+        auto added = vault.add_entry(vault::Entry{
+            util::SecureString{name},
+            util::SecureString{"user"},
+            util::SecureString{"secret"}
+        });
+        REQUIRE(added);
+        ids.push_back(added.value());
+    }
+
+    // Removal fills the hole with the last entry instead of shifting
+    REQUIRE(vault.remove_entry(ids[1]));
+    REQUIRE(vault.entries().size() == 3);
+    CHECK(vault.entries()[1].name == "D");
+    CHECK(vault.index_of(ids[3]) == std::optional<size_t>(1));
+    CHECK(vault.id_at(1) == ids[3]);
+    CHECK(vault.index_of(ids[2]) == std::optional<size_t>(2));
+
+    CHECK_FALSE(vault.index_of(ids[1]));
+    auto again = vault.remove_entry(ids[1]);
+    REQUIRE_FALSE(again);
+    CHECK(again.error() == vault::VaultError::EntryNotFound);
+
+    // The freed slot is reused under a new generation
+    auto added = vault.add_entry(vault::Entry{
+        util::SecureString{"E"},
+        util::SecureString{"user"},
+        util::SecureString{"secret"}
+    });
+    REQUIRE(added);
+    CHECK(added.value().slot() == ids[1].slot());
+    CHECK_FALSE(added.value() == ids[1]);
+    CHECK_FALSE(vault.index_of(ids[1]));
+    CHECK(vault.index_of(added.value()) == std::optional<size_t>(3));
+
+    // Only live entries are written
+    auto restored = vault::Vault::deserialise(vault.serialise());
+    REQUIRE(restored);
+    CHECK(restored.value().entries() == vault.entries());
+}
+
+TEST_CASE("Edits stamp modification times, which travel with the vault")
+{
+    using namespace std::chrono;
+    const auto start = system_clock::time_point(hours(24 * 365 * 50));
+
+    vault::Vault vault;
+    auto first = vault.add_entry(vault::Entry{
+        util::SecureString{"First"}, util::SecureString{""}, util::SecureString{""}
+    }, start);
+    auto second = vault.add_entry(vault::Entry{
+        util::SecureString{"Second"}, util::SecureString{""}, util::SecureString{""}
+    }, start + hours(1));
+    REQUIRE(first);
+    REQUIRE(second);
+
+    auto latest = [](const vault::Vault& v)
+    {
+        return std::string((*v.entries().sorted(vault::EntryOrder::Modified).begin()).name);
+    };
+    CHECK(latest(vault) == "Second");
+
+    // Using an entry is not a change; editing one is
+    REQUIRE(vault.record_access(first.value(), start + hours(2)));
+    CHECK(latest(vault) == "Second");
+    REQUIRE(vault.set_field(first.value(), vault::EntryField::Secret, util::SecureString{"new"}, start + hours(3)));
+    CHECK(latest(vault) == "First");
+    CHECK(vault.entries().modified(0) == duration_cast<seconds>((start + hours(3)).time_since_epoch()).count());
+
+    auto restored = vault::Vault::deserialise(vault.serialise());
+    REQUIRE(restored);
+    CHECK(restored.value().entries().modified(0) == vault.entries().modified(0));
+    CHECK(restored.value().entries().modified(1) == vault.entries().modified(1));
+    CHECK(latest(restored.value()) == "First");
+}
+
+TEST_CASE("Tag queries read the posting lists and follow every change")
+{
+    using Tags = std::vector<std::string_view>;
+
+    vault::Vault vault;
+    vault::Entry mail{ util::SecureString{"Mail"}, util::SecureString{""}, util::SecureString{""} };
+    mail.tags = { "work", "personal", "work" };
+    vault::Entry bank{ util::SecureString{"Bank"}, util::SecureString{""}, util::SecureString{""} };
+    bank.tags = { "personal" };
+    vault::Entry repo{ util::SecureString{"Repo"}, util::SecureString{""}, util::SecureString{""} };
+    repo.tags = { "work" };
+
+    auto mail_id = vault.add_entry(std::move(mail));
+    auto bank_id = vault.add_entry(std::move(bank));
+    REQUIRE(mail_id);
+    REQUIRE(bank_id);
+    REQUIRE(vault.add_entry(std::move(repo)));
+
+    // Stored sorted and without repeats
+    CHECK(vault.entries().tags(0) == std::string_view("personal\0work", 13));
+    CHECK(vault.tagged(Tags{ "work" }) == std::vector<size_t>{ 0, 2 });
+    CHECK(vault.tagged(Tags{ "personal", "work" }) == std::vector<size_t>{ 0 });
+    CHECK(vault.tagged(Tags{ "work", "missing" }).empty());
+
+    REQUIRE(vault.add_tag(bank_id.value(), "work"));
+    REQUIRE(vault.remove_tag(mail_id.value(), "work"));
+    CHECK(vault.tagged(Tags{ "personal", "work" }) == std::vector<size_t>{ 1 });
+
+    auto bad = vault.add_tag(bank_id.value(), "");
+    REQUIRE_FALSE(bad);
+    CHECK(bad.error() == vault::VaultError::InvalidTag);
+
+    // Removal moves Repo into Mail's place; the lists hold ids, not indices
+    REQUIRE(vault.remove_entry(mail_id.value()));
+    CHECK(vault.tagged(Tags{ "work" }) == std::vector<size_t>{ 0, 1 });
+    CHECK(vault.tagged(Tags{ "personal" }) == std::vector<size_t>{ 1 });
+
+    auto restored = vault::Vault::deserialise(vault.serialise());
+    REQUIRE(restored);
+    CHECK(restored.value().entries() == vault.entries());
+    CHECK(restored.value().entries().created(1) == vault.entries().created(1));
+    CHECK(restored.value().tagged(Tags{ "personal", "work" }) == std::vector<size_t>{ 1 });
+}
+
+TEST_CASE("Records skip fields they do not know and write them back")
+{
+    // One entry: name "A", then a field of type 99, then a secret
+    const crypto::ByteBuffer payload = {
+        0x01,                   // one record
+        0x0A,                   // of 10 bytes
+        0x01, 0x01, 'A',        // Name
+        0x63, 0x02, 'x', 'y',   // unknown type 99
+        0x03, 0x01, 's'         // Secret
+    };
+
+    auto loaded = vault::Vault::deserialise(payload);
+    REQUIRE(loaded);
+    REQUIRE(loaded.value().entries().size() == 1);
+    CHECK(loaded.value().entries().name(0) == "A");
+    CHECK(loaded.value().entries().secret(0) == "s");
+
+    auto again = vault::Vault::deserialise(loaded.value().serialise());
+    REQUIRE(again);
+    CHECK(again.value().entries().unknown_fields(0) == std::string_view("\x63\x02xy", 4));
+
+    // A field running past its record is corruption
+    crypto::ByteBuffer truncated = payload;
+    truncated[1] = 0x04;
+    truncated.resize(6);
+    CHECK_FALSE(vault::Vault::deserialise(truncated));
+
+    // So is a second record with a name already loaded
+    const crypto::ByteBuffer twice = {
+        0x02,
+        0x03, 0x01, 0x01, 'A',
+        0x03, 0x01, 0x01, 'A'
+    };
+    auto duplicate = vault::Vault::deserialise(twice);
+    REQUIRE_FALSE(duplicate);
+    CHECK(duplicate.error() == vault::VaultFileError::InvalidFormat);
+}
+
+TEST_CASE("Serialised size is exact and every described field round-trips")
+{
+    vault::Vault vault;
+    CHECK(vault.serialised_size() == vault.serialise().size());
+
+    for (int i = 0; i < 200; ++i)
+    {
+        vault::Entry entry{
+            util::SecureString{("entry-" + std::to_string(i)).c_str()},
+            util::SecureString{std::string(static_cast<size_t>(i), 'u').c_str()},
+            util::SecureString{std::string(static_cast<size_t>(i * 3), 's').c_str()}
+        };
+        if (i % 7 == 0)
+        {
+            entry.tags = { "seventh" };
+        }
+        REQUIRE(vault.add_entry(std::move(entry)));
+    }
+    REQUIRE(vault.record_access(vault.id_at(5)));
+
+    const crypto::SecureBuffer payload = vault.serialise();
+    CHECK(vault.serialised_size() == payload.size());
+    CHECK(payload.capacity() == payload.size());
+
+    auto restored = vault::Vault::deserialise(payload);
+    REQUIRE(restored);
+    for (const auto& descriptor : vault::ENTRY_STRING_FIELDS)
+    {
+        const auto& column = vault.entries().column(descriptor.field);
+        const auto& restored_column = restored.value().entries().column(descriptor.field);
+        REQUIRE(restored_column.size() == column.size());
+        CHECK(restored_column.bytes() == column.bytes());
+        CHECK(restored_column[199] == column[199]);
+        CHECK(vault::string_field(descriptor.record) == &descriptor);
+    }
+    CHECK(restored.value().entries() == vault.entries());
+}
+
+TEST_CASE("Serialising into a span or a sink writes the same payload")
+{
+    vault::Vault vault;
+    for (int i = 0; i < 50; ++i)
+    {
+        vault::Entry entry{
+            util::SecureString{("entry-" + std::to_string(i)).c_str()},
+            util::SecureString{"user"},
+            util::SecureString{std::string(static_cast<size_t>(i * 5), 's').c_str()}
+        };
+        entry.tags = { "work" };
+        REQUIRE(vault.add_entry(std::move(entry)));
+    }
+    const crypto::SecureBuffer payload = vault.serialise();
+
+    // Too short a span is refused untouched
+    crypto::ByteBuffer span(payload.size() + 3, 0xAA);
+    CHECK_FALSE(vault.serialise_into(std::span(span).first(payload.size() - 1)));
+    CHECK(span[0] == 0xAA);
+
+    REQUIRE(vault.serialise_into(span));
+    CHECK(std::equal(payload.span().begin(), payload.span().end(), span.begin()));
+    CHECK(span[payload.size()] == 0xAA);
+
+    // A reused buffer shrinks to fit without reallocating
+    crypto::SecureBuffer reused;
+    reused.resize(payload.size() * 2);
+    const size_t capacity = reused.capacity();
+    vault.serialise(reused);
+    CHECK(reused.size() == payload.size());
+    CHECK(reused.capacity() == capacity);
+
+    // Blocks smaller than a secret split fields across pieces
+    for (const size_t block : { size_t{1}, size_t{7}, size_t{64}, payload.size() * 2 })
+    {
+        crypto::ByteBuffer streamed;
+        size_t pieces = 0;
+        bool sized = true;
+        vault.serialise_to([&](std::span<const uint8_t> piece)
+        {
+            sized = sized && !piece.empty() && piece.size() <= block;
+            streamed.insert(streamed.end(), piece.begin(), piece.end());
+            ++pieces;
+        }, block);
+        CHECK(sized);
+        CHECK(pieces == (payload.size() + block - 1) / block);
+        REQUIRE(streamed.size() == payload.size());
+        CHECK(std::equal(streamed.begin(), streamed.end(), payload.span().begin()));
+    }
+}
+
+TEST_CASE("Attachments are kept by name and saved with their entry")
+{
+    vault::Vault vault;
+    auto id = vault.add_entry(vault::Entry(
+        util::SecureString{"server"},
+        util::SecureString{"root"},
+        util::SecureString{"hunter2"}
+    ));
+    REQUIRE(id);
+
+    vault::Blob key{};
+    key.id.fill(0x11);
+    key.size = 411;
+    vault::Blob cert{};
+    cert.id.fill(0x22);
+    cert.size = 1 << 20;
+
+    CHECK(vault.attach(id.value(), "", key).error() == vault::VaultError::InvalidAttachment);
+    REQUIRE(vault.attach(id.value(), "id_ed25519", key));
+    REQUIRE(vault.attach(id.value(), "cert.pem", cert));
+    // Same name replaces
+    REQUIRE(vault.attach(id.value(), "cert.pem", key));
+    REQUIRE(vault.detach(id.value(), "missing"));
+
+    auto restored = vault::Vault::deserialise(vault.serialise());
+    REQUIRE(restored);
+    CHECK(restored.value().entries() == vault.entries());
+
+    std::vector<std::string> names;
+    vault::for_each_attachment(restored.value().entries()[0].attachments, [&](const vault::AttachmentView& attachment)
+    {
+        names.emplace_back(attachment.name);
+        CHECK(attachment.blob == key);
+    });
+    CHECK(names == std::vector<std::string>{ "cert.pem", "id_ed25519" });
+    CHECK(restored.value().attached_blobs() == std::vector<vault::BlobId>{ key.id });
+
+    // The same ids straight from the payload, without loading it
+    const crypto::SecureBuffer payload = vault.serialise();
+    auto scanned = vault::Vault::attached_blobs(payload);
+    REQUIRE(scanned);
+    CHECK(scanned.value() == std::vector<vault::BlobId>{ key.id });
+    CHECK_FALSE(vault::Vault::attached_blobs(payload.span().first(payload.size() - 1)));
+
+    REQUIRE(vault.detach(id.value(), "cert.pem"));
+    REQUIRE(vault.detach(id.value(), "id_ed25519"));
+    CHECK(vault.entries()[0].attachments.empty());
+    CHECK(vault.attached_blobs().empty());
+
+    // An entry may arrive with attachments, but not two of one name
+    vault::Entry twice(util::SecureString{"twice"}, util::SecureString{""}, util::SecureString{""});
+    twice.attachments = { { "a", key }, { "a", cert } };
+    CHECK(vault.add_entry(std::move(twice)).error() == vault::VaultError::InvalidAttachment);
+}